@@ -0,0 +1,119 @@
+/*
+ * gpio_mock.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "driver/gpio.h"
+
+typedef struct gpio_mock_pin
+{
+	gpio_mode_t mode;
+	gpio_int_type_t intr_type;
+	uint32_t level;
+	gpio_isr_t isr;
+	void *isr_arg;
+} gpio_mock_pin_t;
+
+static gpio_mock_pin_t g_pins[GPIO_NUM_MAX];
+static bool g_isr_service_installed = false;
+
+static bool gpio_mock_valid(gpio_num_t gpio_num)
+{
+	return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX;
+}
+
+esp_err_t gpio_config(const gpio_config_t *cfg)
+{
+	for (int i = 0; i < GPIO_NUM_MAX; i++)
+	{
+		if (cfg->pin_bit_mask & BIT64(i))
+		{
+			g_pins[i].mode = cfg->mode;
+			g_pins[i].intr_type = cfg->intr_type;
+			// An input with pull-up idles high, like the BOOT button
+			g_pins[i].level = cfg->pull_up_en == GPIO_PULLUP_ENABLE ? 1 : 0;
+		}
+	}
+	return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+	if (!gpio_mock_valid(gpio_num))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	g_pins[gpio_num] = (gpio_mock_pin_t){ 0 };
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+	if (!gpio_mock_valid(gpio_num))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	g_pins[gpio_num].mode = mode;
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+	if (!gpio_mock_valid(gpio_num))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	g_pins[gpio_num].level = level ? 1 : 0;
+	return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+	return gpio_mock_valid(gpio_num) ? (int)g_pins[gpio_num].level : 0;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+	if (g_isr_service_installed)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	g_isr_service_installed = true;
+	return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+	if (!gpio_mock_valid(gpio_num) || !g_isr_service_installed)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	g_pins[gpio_num].isr = isr_handler;
+	g_pins[gpio_num].isr_arg = args;
+	return ESP_OK;
+}
+
+void gpio_mock_set_input(gpio_num_t gpio_num, uint32_t level)
+{
+	if (!gpio_mock_valid(gpio_num))
+	{
+		return;
+	}
+
+	gpio_mock_pin_t *pin = &g_pins[gpio_num];
+	uint32_t old = pin->level;
+	pin->level = level ? 1 : 0;
+
+	bool fire = (pin->intr_type == GPIO_INTR_NEGEDGE && old && !pin->level)
+			|| (pin->intr_type == GPIO_INTR_POSEDGE && !old && pin->level)
+			|| (pin->intr_type == GPIO_INTR_ANYEDGE && old != pin->level);
+	if (fire && pin->isr != NULL)
+	{
+		pin->isr(pin->isr_arg);
+	}
+}
@@ -0,0 +1,30 @@
+/*
+ * esp_mac.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_MOCKS_ESP_MAC_H_
+#define HOST_MOCKS_ESP_MAC_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define MACSTR			"%02x:%02x:%02x:%02x:%02x:%02x"
+#define MAC2STR(a)		(a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+
+typedef enum {
+	ESP_MAC_WIFI_STA,
+	ESP_MAC_WIFI_SOFTAP,
+	ESP_MAC_BT,
+	ESP_MAC_ETH,
+} esp_mac_type_t;
+
+/**
+ * Host build: a fixed, locally administered base MAC, the last byte is the interface type.
+ */
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type);
+
+#endif /* HOST_MOCKS_ESP_MAC_H_ */
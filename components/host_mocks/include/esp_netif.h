@@ -0,0 +1,106 @@
+/*
+ * esp_netif.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_MOCKS_ESP_NETIF_H_
+#define HOST_MOCKS_ESP_NETIF_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event.h"
+
+/*
+ * Host build network interfaces: the WiFi STA and SoftAP only hold their IP settings,
+ * the traffic goes through the host's own sockets. The subset of esp_netif.h used by main.
+ */
+
+#define ESP_ERR_ESP_NETIF_BASE					0x5000
+#define ESP_ERR_ESP_NETIF_INVALID_PARAMS		(ESP_ERR_ESP_NETIF_BASE + 0x01)
+#define ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED	(ESP_ERR_ESP_NETIF_BASE + 0x04)
+#define ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED	(ESP_ERR_ESP_NETIF_BASE + 0x05)
+
+#define ESP_IPADDR_TYPE_V4						0
+
+// Addresses are in network byte order, as in ESP-IDF
+typedef struct esp_ip4_addr {
+	uint32_t addr;
+} esp_ip4_addr_t;
+
+typedef struct {
+	union {
+		esp_ip4_addr_t ip4;
+	} u_addr;
+	uint8_t type;
+} esp_ip_addr_t;
+
+typedef struct {
+	esp_ip4_addr_t ip;
+	esp_ip4_addr_t netmask;
+	esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+typedef struct {
+	esp_ip_addr_t ip;
+} esp_netif_dns_info_t;
+
+typedef enum {
+	ESP_NETIF_DNS_MAIN = 0,
+	ESP_NETIF_DNS_BACKUP,
+	ESP_NETIF_DNS_FALLBACK,
+	ESP_NETIF_DNS_MAX
+} esp_netif_dns_type_t;
+
+typedef struct esp_netif_obj esp_netif_t;
+
+#define esp_ip4_addr_get_byte(ipaddr, idx)	(((const uint8_t *)(&(ipaddr)->addr))[idx])
+#define esp_ip4_addr1(ipaddr)				esp_ip4_addr_get_byte(ipaddr, 0)
+#define esp_ip4_addr2(ipaddr)				esp_ip4_addr_get_byte(ipaddr, 1)
+#define esp_ip4_addr3(ipaddr)				esp_ip4_addr_get_byte(ipaddr, 2)
+#define esp_ip4_addr4(ipaddr)				esp_ip4_addr_get_byte(ipaddr, 3)
+#define IP2STR(ipaddr)						esp_ip4_addr1(ipaddr), esp_ip4_addr2(ipaddr), esp_ip4_addr3(ipaddr), esp_ip4_addr4(ipaddr)
+#define IPSTR								"%d.%d.%d.%d"
+
+#define ESP_IP4TOUINT32(a, b, c, d)			(((uint32_t)((a) & 0xff) << 24) | ((uint32_t)((b) & 0xff) << 16) | ((uint32_t)((c) & 0xff) << 8) | (uint32_t)((d) & 0xff))
+#define ESP_IP4TOADDR(a, b, c, d)			__builtin_bswap32(ESP_IP4TOUINT32(a, b, c, d))
+
+/**
+ * IP events, posted by the WiFi mock.
+ */
+ESP_EVENT_DECLARE_BASE(IP_EVENT);
+
+typedef enum {
+	IP_EVENT_STA_GOT_IP,
+	IP_EVENT_STA_LOST_IP,
+	IP_EVENT_AP_STAIPASSIGNED,
+} ip_event_t;
+
+typedef struct {
+	esp_netif_t *esp_netif;
+	esp_netif_ip_info_t ip_info;
+	bool ip_changed;
+} ip_event_got_ip_t;
+
+typedef struct {
+	esp_netif_t *esp_netif;
+	esp_ip4_addr_t ip;
+	uint8_t mac[6];
+} ip_event_ap_staipassigned_t;
+
+esp_err_t esp_netif_init(void);
+esp_netif_t *esp_netif_create_default_wifi_sta(void);
+esp_netif_t *esp_netif_create_default_wifi_ap(void);
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info);
+esp_err_t esp_netif_set_ip_info(esp_netif_t *esp_netif, const esp_netif_ip_info_t *ip_info);
+esp_err_t esp_netif_dhcps_start(esp_netif_t *esp_netif);
+esp_err_t esp_netif_dhcps_stop(esp_netif_t *esp_netif);
+esp_err_t esp_netif_dhcpc_start(esp_netif_t *esp_netif);
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t *esp_netif);
+esp_err_t esp_netif_set_dns_info(esp_netif_t *esp_netif, esp_netif_dns_type_t type, esp_netif_dns_info_t *dns);
+esp_err_t esp_netif_str_to_ip4(const char *src, esp_ip4_addr_t *dst);
+
+#endif /* HOST_MOCKS_ESP_NETIF_H_ */
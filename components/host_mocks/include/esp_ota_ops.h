@@ -0,0 +1,39 @@
+/*
+ * esp_ota_ops.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_MOCKS_ESP_OTA_OPS_H_
+#define HOST_MOCKS_ESP_OTA_OPS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+
+/*
+ * Host build OTA on top of the linux partition emulation: images are written to the ota_0/ota_1
+ * partitions of the emulated flash file, the boot selection is kept in memory (the host build
+ * always runs from ota_0). The subset of esp_ota_ops.h used by http_server.c.
+ */
+
+#define OTA_SIZE_UNKNOWN				0xffffffff
+#define ESP_ERR_OTA_BASE				0x1500
+#define ESP_ERR_OTA_PARTITION_CONFLICT	(ESP_ERR_OTA_BASE + 0x01)
+#define ESP_ERR_OTA_VALIDATE_FAILED		(ESP_ERR_OTA_BASE + 0x03)
+
+typedef uint32_t esp_ota_handle_t;
+
+const esp_partition_t *esp_ota_get_running_partition(void);
+const esp_partition_t *esp_ota_get_boot_partition(void);
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from);
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle);
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size);
+esp_err_t esp_ota_end(esp_ota_handle_t handle);
+esp_err_t esp_ota_abort(esp_ota_handle_t handle);
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition);
+
+#endif /* HOST_MOCKS_ESP_OTA_OPS_H_ */
@@ -0,0 +1,51 @@
+/*
+ * esp_wifi.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_MOCKS_ESP_WIFI_H_
+#define HOST_MOCKS_ESP_WIFI_H_
+
+#include "esp_err.h"
+#include "esp_wifi_types.h"
+
+/*
+ * Host build WiFi driver. There is no radio: the STA "connects" to any configured SSID
+ * and gets HOST_MOCK_WIFI_STA_IP, scans report the networks in wifi_mock.c.
+ * Events are posted to the default event loop in the same order as on the ESP32.
+ */
+
+#define ESP_ERR_WIFI_BASE			0x3000
+#define ESP_ERR_WIFI_NOT_INIT		(ESP_ERR_WIFI_BASE + 1)
+#define ESP_ERR_WIFI_NOT_STARTED	(ESP_ERR_WIFI_BASE + 2)
+#define ESP_ERR_WIFI_CONN			(ESP_ERR_WIFI_BASE + 7)
+#define ESP_ERR_WIFI_STATE			(ESP_ERR_WIFI_BASE + 8)
+#define ESP_ERR_WIFI_NOT_CONNECT	(ESP_ERR_WIFI_BASE + 15)
+
+// The STA address reported on IP_EVENT_STA_GOT_IP: the host itself
+#define HOST_MOCK_WIFI_STA_IP		ESP_IP4TOADDR(127, 0, 0, 1)
+
+typedef struct {
+	int magic;
+} wifi_init_config_t;
+
+#define WIFI_INIT_CONFIG_DEFAULT()	{ .magic = 0x1F2F3F4F }
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config);
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage);
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_set_bandwidth(wifi_interface_t ifx, wifi_bandwidth_t bw);
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type);
+esp_err_t esp_wifi_start(void);
+esp_err_t esp_wifi_connect(void);
+esp_err_t esp_wifi_disconnect(void);
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info);
+esp_err_t esp_wifi_ap_get_sta_list(wifi_sta_list_t *sta);
+
+#endif /* HOST_MOCKS_ESP_WIFI_H_ */
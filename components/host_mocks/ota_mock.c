@@ -0,0 +1,166 @@
+/*
+ * ota_mock.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdbool.h>
+
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "ota_mock";
+
+#define OTA_MOCK_MAX_HANDLES	2
+#define OTA_MOCK_IMAGE_MAGIC	0xE9	///> First byte of an ESP app image
+
+typedef struct ota_mock_handle
+{
+	const esp_partition_t *partition;
+	size_t written;
+	bool first_byte_ok;
+	bool in_use;
+} ota_mock_handle_t;
+
+static ota_mock_handle_t g_handles[OTA_MOCK_MAX_HANDLES];
+static const esp_partition_t *g_boot_partition = NULL;
+
+static ota_mock_handle_t *ota_mock_get(esp_ota_handle_t handle)
+{
+	if (handle == 0 || handle > OTA_MOCK_MAX_HANDLES || !g_handles[handle - 1].in_use)
+	{
+		return NULL;
+	}
+	return &g_handles[handle - 1];
+}
+
+const esp_partition_t *esp_ota_get_running_partition(void)
+{
+	return esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, NULL);
+}
+
+const esp_partition_t *esp_ota_get_boot_partition(void)
+{
+	return g_boot_partition != NULL ? g_boot_partition : esp_ota_get_running_partition();
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from)
+{
+	const esp_partition_t *current = start_from != NULL ? start_from : esp_ota_get_running_partition();
+
+	if (current != NULL && current->subtype == ESP_PARTITION_SUBTYPE_APP_OTA_0)
+	{
+		return esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, NULL);
+	}
+	return esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, NULL);
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle)
+{
+	if (partition == NULL || out_handle == NULL || partition->type != ESP_PARTITION_TYPE_APP)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (partition == esp_ota_get_running_partition())
+	{
+		return ESP_ERR_OTA_PARTITION_CONFLICT;
+	}
+
+	size_t erase_size = partition->size;
+	if (image_size != OTA_SIZE_UNKNOWN)
+	{
+		if (image_size > partition->size)
+		{
+			return ESP_ERR_INVALID_SIZE;
+		}
+		erase_size = (image_size + partition->erase_size - 1) / partition->erase_size * partition->erase_size;
+	}
+
+	for (int i = 0; i < OTA_MOCK_MAX_HANDLES; i++)
+	{
+		if (!g_handles[i].in_use)
+		{
+			esp_err_t err = esp_partition_erase_range(partition, 0, erase_size);
+			if (err != ESP_OK)
+			{
+				return err;
+			}
+			g_handles[i] = (ota_mock_handle_t) { .partition = partition, .in_use = true };
+			*out_handle = i + 1;
+			ESP_LOGI(TAG, "Writing %s", partition->label);
+			return ESP_OK;
+		}
+	}
+
+	return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
+{
+	ota_mock_handle_t *h = ota_mock_get(handle);
+
+	if (h == NULL || data == NULL)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (h->written + size > h->partition->size)
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+	if (h->written == 0 && size > 0)
+	{
+		h->first_byte_ok = ((const uint8_t *)data)[0] == OTA_MOCK_IMAGE_MAGIC;
+	}
+
+	esp_err_t err = esp_partition_write(h->partition, h->written, data, size);
+	if (err == ESP_OK)
+	{
+		h->written += size;
+	}
+	return err;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle)
+{
+	ota_mock_handle_t *h = ota_mock_get(handle);
+
+	if (h == NULL)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	// Only the image magic is checked, there is no image to verify on the host
+	bool ok = h->written > 0 && h->first_byte_ok;
+	ESP_LOGI(TAG, "%s: %u bytes, %s", h->partition->label, (unsigned)h->written, ok ? "valid" : "invalid image");
+	h->in_use = false;
+
+	return ok ? ESP_OK : ESP_ERR_OTA_VALIDATE_FAILED;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle)
+{
+	ota_mock_handle_t *h = ota_mock_get(handle);
+
+	if (h == NULL)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+	h->in_use = false;
+
+	return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition)
+{
+	if (partition == NULL || partition->type != ESP_PARTITION_TYPE_APP)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	g_boot_partition = partition;
+	ESP_LOGI(TAG, "Boot partition set to %s", partition->label);
+
+	return ESP_OK;
+}
@@ -0,0 +1,351 @@
+/*
+ * wifi_mock.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <arpa/inet.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "wifi_mock";
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+struct esp_netif_obj
+{
+	esp_netif_ip_info_t ip_info;
+	bool dhcpc_stopped;
+};
+
+static esp_netif_t g_netif_sta;
+static esp_netif_t g_netif_ap;
+
+static bool g_initialized = false;
+static bool g_started = false;
+static bool g_connected = false;
+static wifi_mode_t g_mode = WIFI_MODE_NULL;
+static wifi_config_t g_config[WIFI_IF_MAX];
+
+// What a scan "sees", the connected AP is the first one
+static const wifi_ap_record_t g_scan_records[] = {
+		{ .bssid = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 }, .ssid = "HostNetwork", .primary = 6, .rssi = -48, .authmode = WIFI_AUTH_WPA2_PSK },
+		{ .bssid = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 }, .ssid = "Neighbour", .primary = 1, .rssi = -71, .authmode = WIFI_AUTH_WPA2_PSK },
+		{ .bssid = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x03 }, .ssid = "Guest", .primary = 11, .rssi = -83, .authmode = WIFI_AUTH_OPEN },
+};
+
+#define HOST_MOCK_SCAN_COUNT	(sizeof(g_scan_records) / sizeof(g_scan_records[0]))
+
+static void wifi_mock_post(esp_event_base_t base, int32_t id, const void *data, size_t size)
+{
+	if (esp_event_post(base, id, data, size, portMAX_DELAY) != ESP_OK)
+	{
+		ESP_LOGW(TAG, "Event %s:%d not posted", base, (int)id);
+	}
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)
+{
+	g_initialized = true;
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage)
+{
+	return g_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+	if (!g_initialized)
+	{
+		return ESP_ERR_WIFI_NOT_INIT;
+	}
+
+	if (g_started && (g_mode == WIFI_MODE_APSTA) && (mode == WIFI_MODE_STA))
+	{
+		wifi_mock_post(WIFI_EVENT, WIFI_EVENT_AP_STOP, NULL, 0);
+	}
+	else if (g_started && (g_mode == WIFI_MODE_STA) && (mode == WIFI_MODE_APSTA))
+	{
+		wifi_mock_post(WIFI_EVENT, WIFI_EVENT_AP_START, NULL, 0);
+	}
+	g_mode = mode;
+
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+	if (!g_initialized)
+	{
+		return ESP_ERR_WIFI_NOT_INIT;
+	}
+	if (interface >= WIFI_IF_MAX)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	g_config[interface] = *conf;
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+	if (!g_initialized)
+	{
+		return ESP_ERR_WIFI_NOT_INIT;
+	}
+	if (interface >= WIFI_IF_MAX)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	*conf = g_config[interface];
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_bandwidth(wifi_interface_t ifx, wifi_bandwidth_t bw)
+{
+	return g_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+	return g_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+	if (!g_initialized)
+	{
+		return ESP_ERR_WIFI_NOT_INIT;
+	}
+
+	g_started = true;
+	if (g_mode == WIFI_MODE_STA || g_mode == WIFI_MODE_APSTA)
+	{
+		wifi_mock_post(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0);
+	}
+	if (g_mode == WIFI_MODE_AP || g_mode == WIFI_MODE_APSTA)
+	{
+		wifi_mock_post(WIFI_EVENT, WIFI_EVENT_AP_START, NULL, 0);
+	}
+
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+	if (!g_started)
+	{
+		return ESP_ERR_WIFI_NOT_STARTED;
+	}
+
+	const wifi_sta_config_t *sta = &g_config[WIFI_IF_STA].sta;
+
+	// No credentials: behave like an AP that is not in range
+	if (sta->ssid[0] == '\0')
+	{
+		wifi_event_sta_disconnected_t disconnected = { .reason = WIFI_REASON_NO_AP_FOUND };
+		wifi_mock_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &disconnected, sizeof(disconnected));
+		return ESP_OK;
+	}
+
+	wifi_event_sta_connected_t connected = {
+			.ssid_len = strnlen((const char *)sta->ssid, sizeof(sta->ssid)),
+			.channel = g_scan_records[0].primary,
+			.authmode = WIFI_AUTH_WPA2_PSK,
+	};
+	memcpy(connected.ssid, sta->ssid, sizeof(connected.ssid));
+	memcpy(connected.bssid, g_scan_records[0].bssid, sizeof(connected.bssid));
+	g_connected = true;
+	wifi_mock_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &connected, sizeof(connected));
+
+	// DHCP "lease" of the host address, a static IP is reported as set
+	if (!g_netif_sta.dhcpc_stopped)
+	{
+		g_netif_sta.ip_info.ip.addr = HOST_MOCK_WIFI_STA_IP;
+		g_netif_sta.ip_info.netmask.addr = ESP_IP4TOADDR(255, 0, 0, 0);
+		g_netif_sta.ip_info.gw.addr = HOST_MOCK_WIFI_STA_IP;
+	}
+	ip_event_got_ip_t got_ip = {
+			.esp_netif = &g_netif_sta,
+			.ip_info = g_netif_sta.ip_info,
+			.ip_changed = true,
+	};
+	wifi_mock_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip));
+
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+	if (!g_started)
+	{
+		return ESP_ERR_WIFI_NOT_STARTED;
+	}
+
+	if (g_connected)
+	{
+		wifi_event_sta_disconnected_t disconnected = { .reason = WIFI_REASON_ASSOC_LEAVE, .rssi = g_scan_records[0].rssi };
+		g_connected = false;
+		if (!g_netif_sta.dhcpc_stopped)
+		{
+			memset(&g_netif_sta.ip_info, 0, sizeof(g_netif_sta.ip_info));
+		}
+		wifi_mock_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &disconnected, sizeof(disconnected));
+	}
+
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block)
+{
+	if (!g_started)
+	{
+		return ESP_ERR_WIFI_NOT_STARTED;
+	}
+
+	wifi_event_sta_scan_done_t done = { .status = 0, .number = HOST_MOCK_SCAN_COUNT };
+	if (!block)
+	{
+		wifi_mock_post(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &done, sizeof(done));
+	}
+
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records)
+{
+	uint16_t count = *number < HOST_MOCK_SCAN_COUNT ? *number : HOST_MOCK_SCAN_COUNT;
+
+	memcpy(ap_records, g_scan_records, count * sizeof(wifi_ap_record_t));
+	*number = count;
+
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+	if (!g_connected)
+	{
+		return ESP_ERR_WIFI_NOT_CONNECT;
+	}
+
+	*ap_info = g_scan_records[0];
+	memcpy(ap_info->ssid, g_config[WIFI_IF_STA].sta.ssid, sizeof(g_config[WIFI_IF_STA].sta.ssid));
+
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_ap_get_sta_list(wifi_sta_list_t *sta)
+{
+	memset(sta, 0, sizeof(*sta));
+	return g_started ? ESP_OK : ESP_ERR_WIFI_NOT_STARTED;
+}
+
+esp_err_t esp_netif_init(void)
+{
+	return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+	return &g_netif_sta;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_ap(void)
+{
+	return &g_netif_ap;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info)
+{
+	if (esp_netif == NULL)
+	{
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	}
+
+	*ip_info = esp_netif->ip_info;
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_set_ip_info(esp_netif_t *esp_netif, const esp_netif_ip_info_t *ip_info)
+{
+	if (esp_netif == NULL)
+	{
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	}
+
+	esp_netif->ip_info = *ip_info;
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcps_start(esp_netif_t *esp_netif)
+{
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcps_stop(esp_netif_t *esp_netif)
+{
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_start(esp_netif_t *esp_netif)
+{
+	if (!esp_netif->dhcpc_stopped)
+	{
+		return ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED;
+	}
+
+	esp_netif->dhcpc_stopped = false;
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t *esp_netif)
+{
+	if (esp_netif->dhcpc_stopped)
+	{
+		return ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED;
+	}
+
+	esp_netif->dhcpc_stopped = true;
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_set_dns_info(esp_netif_t *esp_netif, esp_netif_dns_type_t type, esp_netif_dns_info_t *dns)
+{
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_str_to_ip4(const char *src, esp_ip4_addr_t *dst)
+{
+	struct in_addr addr;
+
+	if (src == NULL || dst == NULL || inet_pton(AF_INET, src, &addr) != 1)
+	{
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	}
+
+	dst->addr = addr.s_addr;
+	return ESP_OK;
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+	static const uint8_t base[6] = { 0x02, 0x48, 0x4f, 0x53, 0x54, 0x00 };
+
+	memcpy(mac, base, sizeof(base));
+	mac[5] = (uint8_t)type;
+
+	return ESP_OK;
+}
@@ -0,0 +1,2489 @@
+/*
+ * api_gen.c
+ *
+ * Generated by tools/gen_routes.py from swagger.yaml, do not edit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_netif.h"
+
+#include "api_gen.h"
+#include "http_conn.h"
+#include "http_server.h"
+#include "journal.h"
+#include "trace.h"
+
+#define API_RECV_ANSWERED			-1		///> A 400 was sent
+#define API_RECV_FAILED				-2		///> The connection broke
+
+/**
+ * Receives a JSON body of at most size - 1 bytes.
+ * @return its length, or API_RECV_ANSWERED or API_RECV_FAILED.
+ */
+static int api_recv_body(httpd_req_t *req, char *buf, size_t size, bool required)
+{
+	int total_length = 0;
+	int ret;
+
+	if (req->content_len == 0 && !required)
+	{
+		return 0;
+	}
+	if (req->content_len == 0 || req->content_len >= size)
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, req->content_len ? "Request body too large" : "Request body required");
+		return API_RECV_ANSWERED;
+	}
+
+	while (total_length < req->content_len)
+	{
+		ret = httpd_req_recv(req, buf + total_length, req->content_len - total_length);
+		if (ret == HTTPD_SOCK_ERR_TIMEOUT)
+		{
+			continue;
+		}
+		if (ret <= 0)
+		{
+			return API_RECV_FAILED;
+		}
+		total_length += ret;
+	}
+	buf[total_length] = '\0';
+
+	return total_length;
+}
+
+/**
+ * Gets the query string, empty if there is none.
+ * @return false if it does not fit.
+ */
+static bool api_get_query(httpd_req_t *req, char *query, size_t size)
+{
+	esp_err_t err = httpd_req_get_url_query_str(req, query, size);
+
+	if (err != ESP_OK)
+	{
+		query[0] = '\0';
+	}
+	return err != ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+/**
+ * Parses a decimal integer that fills the whole text.
+ */
+static bool api_parse_int(const char *text, int32_t lo, int32_t hi, int32_t *value)
+{
+	char *end;
+	long n = strtol(text, &end, 10);
+
+	if (end == text || *end != '\0' || n < lo || n > hi)
+	{
+		return false;
+	}
+	*value = n;
+	return true;
+}
+
+/**
+ * Reads an integer query parameter.
+ * @return false if it is present but no integer in lo..hi.
+ */
+static bool api_query_int(const char *query, const char *key, int32_t lo, int32_t hi, int32_t def, int32_t *value)
+{
+	char text[12];
+	esp_err_t err = httpd_query_key_value(query, key, text, sizeof(text));
+
+	if (err == ESP_ERR_NOT_FOUND)
+	{
+		*value = def;
+		return true;
+	}
+	return err == ESP_OK && api_parse_int(text, lo, hi, value);
+}
+
+/**
+ * @return index of text in names, -1 if it is none of them.
+ */
+static int api_enum_index(const char *text, const char *const *names, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp(text, names[i]) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Reads a string enum query parameter.
+ * @return false if it is present but none of names.
+ */
+static bool api_query_enum(const char *query, const char *key, const char *const *names, int count, int def, int *value)
+{
+	char text[16];
+	esp_err_t err = httpd_query_key_value(query, key, text, sizeof(text));
+
+	if (err == ESP_ERR_NOT_FOUND)
+	{
+		*value = def;
+		return true;
+	}
+	return err == ESP_OK && (*value = api_enum_index(text, names, count)) >= 0;
+}
+
+/**
+ * Reads an integer path parameter from the URI, fmt has one %d.
+ */
+static bool api_path_int(httpd_req_t *req, const char *fmt, int32_t lo, int32_t hi, int32_t *value)
+{
+	int n;
+
+	if (sscanf(req->uri, fmt, &n) != 1 || n < lo || n > hi)
+	{
+		return false;
+	}
+	*value = n;
+	return true;
+}
+
+static bool api_read_enum(json_reader_t *r, const char *const *names, int count, int *value)
+{
+	char text[16];
+
+	return json_read_string(r, text, sizeof(text)) && (*value = api_enum_index(text, names, count)) >= 0;
+}
+
+static bool api_read_ipv4(json_reader_t *r, uint32_t *addr)
+{
+	char text[16];
+	esp_ip4_addr_t ip;
+
+	if (!json_read_string(r, text, sizeof(text)) || esp_netif_str_to_ip4(text, &ip) != ESP_OK)
+	{
+		return false;
+	}
+	*addr = ip.addr;
+	return true;
+}
+
+static void api_put_ipv4(json_writer_t *w, uint32_t addr)
+{
+	esp_ip4_addr_t ip = { .addr = addr };
+	char text[18];
+
+	snprintf(text, sizeof(text), "\"" IPSTR "\"", IP2STR(&ip));
+	json_put_raw(w, text);
+}
+
+// Only used from the httpd task, which runs one handler at a time
+static journal_result_e g_api_result;
+
+void api_journal_result(journal_result_e result)
+{
+	g_api_result = result;
+}
+
+bool api_parse_rate_limit(json_reader_t *r, api_rate_limit_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "RateLimit object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "per_minute"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 0 || n > 65535)
+			{
+				*error = "per_minute: integer 0..65535 expected";
+				return false;
+			}
+			v->per_minute = n;
+			seen |= 1u << 0;
+		}
+		else if (json_key_is(key, len, "burst"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 0 || n > 65535)
+			{
+				*error = "burst: integer 0..65535 expected";
+				return false;
+			}
+			v->burst = n;
+			seen |= 1u << 1;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "per_minute is required";
+		return false;
+	}
+	if (!(seen & (1u << 1)))
+	{
+		*error = "burst is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_rate_limit(json_writer_t *w, const api_rate_limit_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"per_minute\":");
+	json_put_int(w, v->per_minute);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"burst\":");
+	json_put_int(w, v->burst);
+	sep = ",";
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_rate_limit(char *buf, size_t size, const api_rate_limit_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_rate_limit(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_rate_limit(httpd_req_t *req, const api_rate_limit_t *v)
+{
+	char buf[API_RATE_LIMIT_JSON_MAX];
+
+	api_format_rate_limit(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+bool api_parse_rate_limits(json_reader_t *r, api_rate_limits_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "RateLimits object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "read"))
+		{
+			if (!api_parse_rate_limit(r, &v->read, error))
+			{
+				return false;
+			}
+			v->has_read = true;
+		}
+		else if (json_key_is(key, len, "control"))
+		{
+			if (!api_parse_rate_limit(r, &v->control, error))
+			{
+				return false;
+			}
+			v->has_control = true;
+		}
+		else if (json_key_is(key, len, "login"))
+		{
+			if (!api_parse_rate_limit(r, &v->login, error))
+			{
+				return false;
+			}
+			v->has_login = true;
+		}
+		else if (json_key_is(key, len, "heavy"))
+		{
+			if (!api_parse_rate_limit(r, &v->heavy, error))
+			{
+				return false;
+			}
+			v->has_heavy = true;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_rate_limits(json_writer_t *w, const api_rate_limits_t *v)
+{
+	const char *sep = "{";
+
+	if (v->has_read)
+	{
+		json_put_raw(w, sep);
+		json_put_raw(w, "\"read\":");
+		api_write_rate_limit(w, &v->read);
+		sep = ",";
+	}
+	if (v->has_control)
+	{
+		json_put_raw(w, sep);
+		json_put_raw(w, "\"control\":");
+		api_write_rate_limit(w, &v->control);
+		sep = ",";
+	}
+	if (v->has_login)
+	{
+		json_put_raw(w, sep);
+		json_put_raw(w, "\"login\":");
+		api_write_rate_limit(w, &v->login);
+		sep = ",";
+	}
+	if (v->has_heavy)
+	{
+		json_put_raw(w, sep);
+		json_put_raw(w, "\"heavy\":");
+		api_write_rate_limit(w, &v->heavy);
+		sep = ",";
+	}
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_rate_limits(char *buf, size_t size, const api_rate_limits_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_rate_limits(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_rate_limits(httpd_req_t *req, const api_rate_limits_t *v)
+{
+	char buf[API_RATE_LIMITS_JSON_MAX];
+
+	api_format_rate_limits(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+bool api_parse_credentials(json_reader_t *r, api_credentials_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "Credentials object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "user"))
+		{
+			if (!json_read_string(r, v->user, sizeof(v->user)) || strlen(v->user) < 1)
+			{
+				*error = "user: string of 1..32 characters expected";
+				return false;
+			}
+			seen |= 1u << 0;
+		}
+		else if (json_key_is(key, len, "password"))
+		{
+			if (!json_read_string(r, v->password, sizeof(v->password)) || strlen(v->password) < 1)
+			{
+				*error = "password: string of 1..64 characters expected";
+				return false;
+			}
+			seen |= 1u << 1;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "user is required";
+		return false;
+	}
+	if (!(seen & (1u << 1)))
+	{
+		*error = "password is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_credentials(json_writer_t *w, const api_credentials_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"user\":");
+	json_put_string(w, v->user);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"password\":");
+	json_put_string(w, v->password);
+	sep = ",";
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_credentials(char *buf, size_t size, const api_credentials_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_credentials(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_credentials(httpd_req_t *req, const api_credentials_t *v)
+{
+	char buf[API_CREDENTIALS_JSON_MAX];
+
+	api_format_credentials(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+bool api_parse_session(json_reader_t *r, api_session_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "Session object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "token"))
+		{
+			if (!json_read_string(r, v->token, sizeof(v->token)))
+			{
+				*error = "token: string of at most 32 characters expected";
+				return false;
+			}
+			seen |= 1u << 0;
+		}
+		else if (json_key_is(key, len, "expires_in"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < -2147483648 || n > 2147483647)
+			{
+				*error = "expires_in: integer expected";
+				return false;
+			}
+			v->expires_in = n;
+			seen |= 1u << 1;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "token is required";
+		return false;
+	}
+	if (!(seen & (1u << 1)))
+	{
+		*error = "expires_in is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_session(json_writer_t *w, const api_session_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"token\":");
+	json_put_string(w, v->token);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"expires_in\":");
+	json_put_int(w, v->expires_in);
+	sep = ",";
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_session(char *buf, size_t size, const api_session_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_session(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_session(httpd_req_t *req, const api_session_t *v)
+{
+	char buf[API_SESSION_JSON_MAX];
+
+	api_format_session(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+static const char *const api_led_state_names[API_LED_STATE_COUNT] = {
+		[API_LED_STATE_ON] = "on",
+		[API_LED_STATE_OFF] = "off",
+};
+
+bool api_parse_led(json_reader_t *r, api_led_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "LED object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "id"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 1 || n > 4)
+			{
+				*error = "id: integer 1..4 expected";
+				return false;
+			}
+			v->id = n;
+			seen |= 1u << 0;
+		}
+		else if (json_key_is(key, len, "state"))
+		{
+			int n;
+
+			if (!api_read_enum(r, api_led_state_names, API_LED_STATE_COUNT, &n))
+			{
+				*error = "state: \"on\" or \"off\" expected";
+				return false;
+			}
+			v->state = n;
+			seen |= 1u << 1;
+		}
+		else if (json_key_is(key, len, "version"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 0 || n > 2147483647)
+			{
+				*error = "version: integer >= 0 expected";
+				return false;
+			}
+			v->version = n;
+			seen |= 1u << 2;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "id is required";
+		return false;
+	}
+	if (!(seen & (1u << 1)))
+	{
+		*error = "state is required";
+		return false;
+	}
+	if (!(seen & (1u << 2)))
+	{
+		*error = "version is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_led(json_writer_t *w, const api_led_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"id\":");
+	json_put_int(w, v->id);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"state\":");
+	json_put_string(w, api_led_state_names[v->state]);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"version\":");
+	json_put_int(w, v->version);
+	sep = ",";
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_led(char *buf, size_t size, const api_led_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_led(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_led(httpd_req_t *req, const api_led_t *v)
+{
+	char buf[API_LED_JSON_MAX];
+
+	api_format_led(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+static const char *const api_scene_state_names[API_SCENE_STATE_COUNT] = {
+		[API_SCENE_STATE_IDLE] = "idle",
+		[API_SCENE_STATE_RUNNING] = "running",
+		[API_SCENE_STATE_DONE] = "done",
+		[API_SCENE_STATE_FAULT] = "fault",
+};
+
+static const char *const api_scene_fault_names[API_SCENE_FAULT_COUNT] = {
+		[API_SCENE_FAULT_NONE] = "none",
+		[API_SCENE_FAULT_BAD_HEADER] = "bad_header",
+		[API_SCENE_FAULT_TOO_LARGE] = "too_large",
+		[API_SCENE_FAULT_BAD_OPCODE] = "bad_opcode",
+		[API_SCENE_FAULT_TRUNCATED] = "truncated",
+		[API_SCENE_FAULT_BAD_TARGET] = "bad_target",
+		[API_SCENE_FAULT_BAD_COUNT] = "bad_count",
+		[API_SCENE_FAULT_NO_END] = "no_end",
+		[API_SCENE_FAULT_LOOP_DEPTH] = "loop_depth",
+		[API_SCENE_FAULT_LOOP_EMPTY] = "loop_empty",
+};
+
+bool api_parse_scene(json_reader_t *r, api_scene_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "Scene object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "slot"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 0 || n > 3)
+			{
+				*error = "slot: integer 0..3 expected";
+				return false;
+			}
+			v->slot = n;
+			seen |= 1u << 0;
+		}
+		else if (json_key_is(key, len, "stored"))
+		{
+			if (!json_read_bool(r, &v->stored))
+			{
+				*error = "stored: true or false expected";
+				return false;
+			}
+			seen |= 1u << 1;
+		}
+		else if (json_key_is(key, len, "autostart"))
+		{
+			if (!json_read_bool(r, &v->autostart))
+			{
+				*error = "autostart: true or false expected";
+				return false;
+			}
+			seen |= 1u << 2;
+		}
+		else if (json_key_is(key, len, "size"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 0 || n > 256)
+			{
+				*error = "size: integer 0..256 expected";
+				return false;
+			}
+			v->size = n;
+			seen |= 1u << 3;
+		}
+		else if (json_key_is(key, len, "state"))
+		{
+			int n;
+
+			if (!api_read_enum(r, api_scene_state_names, API_SCENE_STATE_COUNT, &n))
+			{
+				*error = "state: \"idle\" or \"running\" or \"done\" or \"fault\" expected";
+				return false;
+			}
+			v->state = n;
+			seen |= 1u << 4;
+		}
+		else if (json_key_is(key, len, "fault"))
+		{
+			int n;
+
+			if (!api_read_enum(r, api_scene_fault_names, API_SCENE_FAULT_COUNT, &n))
+			{
+				*error = "fault: \"none\" or \"bad_header\" or \"too_large\" or \"bad_opcode\" or \"truncated\" or \"bad_target\" or \"bad_count\" or \"no_end\" or \"loop_depth\" or \"loop_empty\" expected";
+				return false;
+			}
+			v->fault = n;
+			seen |= 1u << 5;
+		}
+		else if (json_key_is(key, len, "pc"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 0 || n > 2147483647)
+			{
+				*error = "pc: integer >= 0 expected";
+				return false;
+			}
+			v->pc = n;
+			seen |= 1u << 6;
+		}
+		else if (json_key_is(key, len, "instructions"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 0 || n > 2147483647)
+			{
+				*error = "instructions: integer >= 0 expected";
+				return false;
+			}
+			v->instructions = n;
+			seen |= 1u << 7;
+		}
+		else if (json_key_is(key, len, "budget_yields"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < 0 || n > 2147483647)
+			{
+				*error = "budget_yields: integer >= 0 expected";
+				return false;
+			}
+			v->budget_yields = n;
+			seen |= 1u << 8;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "slot is required";
+		return false;
+	}
+	if (!(seen & (1u << 1)))
+	{
+		*error = "stored is required";
+		return false;
+	}
+	if (!(seen & (1u << 2)))
+	{
+		*error = "autostart is required";
+		return false;
+	}
+	if (!(seen & (1u << 3)))
+	{
+		*error = "size is required";
+		return false;
+	}
+	if (!(seen & (1u << 4)))
+	{
+		*error = "state is required";
+		return false;
+	}
+	if (!(seen & (1u << 5)))
+	{
+		*error = "fault is required";
+		return false;
+	}
+	if (!(seen & (1u << 6)))
+	{
+		*error = "pc is required";
+		return false;
+	}
+	if (!(seen & (1u << 7)))
+	{
+		*error = "instructions is required";
+		return false;
+	}
+	if (!(seen & (1u << 8)))
+	{
+		*error = "budget_yields is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_scene(json_writer_t *w, const api_scene_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"slot\":");
+	json_put_int(w, v->slot);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"stored\":");
+	json_put_bool(w, v->stored);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"autostart\":");
+	json_put_bool(w, v->autostart);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"size\":");
+	json_put_int(w, v->size);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"state\":");
+	json_put_string(w, api_scene_state_names[v->state]);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"fault\":");
+	json_put_string(w, api_scene_fault_names[v->fault]);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"pc\":");
+	json_put_int(w, v->pc);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"instructions\":");
+	json_put_int(w, v->instructions);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"budget_yields\":");
+	json_put_int(w, v->budget_yields);
+	sep = ",";
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_scene(char *buf, size_t size, const api_scene_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_scene(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_scene(httpd_req_t *req, const api_scene_t *v)
+{
+	char buf[API_SCENE_JSON_MAX];
+
+	api_format_scene(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+bool api_parse_static_ip(json_reader_t *r, api_static_ip_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "StaticIP object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "ip"))
+		{
+			if (!api_read_ipv4(r, &v->ip))
+			{
+				*error = "ip: IPv4 address expected";
+				return false;
+			}
+			seen |= 1u << 0;
+		}
+		else if (json_key_is(key, len, "netmask"))
+		{
+			if (!api_read_ipv4(r, &v->netmask))
+			{
+				*error = "netmask: IPv4 address expected";
+				return false;
+			}
+			seen |= 1u << 1;
+		}
+		else if (json_key_is(key, len, "gw"))
+		{
+			if (!api_read_ipv4(r, &v->gw))
+			{
+				*error = "gw: IPv4 address expected";
+				return false;
+			}
+			v->has_gw = true;
+		}
+		else if (json_key_is(key, len, "dns"))
+		{
+			if (!api_read_ipv4(r, &v->dns))
+			{
+				*error = "dns: IPv4 address expected";
+				return false;
+			}
+			v->has_dns = true;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "ip is required";
+		return false;
+	}
+	if (!(seen & (1u << 1)))
+	{
+		*error = "netmask is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_static_ip(json_writer_t *w, const api_static_ip_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"ip\":");
+	api_put_ipv4(w, v->ip);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"netmask\":");
+	api_put_ipv4(w, v->netmask);
+	sep = ",";
+	if (v->has_gw)
+	{
+		json_put_raw(w, sep);
+		json_put_raw(w, "\"gw\":");
+		api_put_ipv4(w, v->gw);
+		sep = ",";
+	}
+	if (v->has_dns)
+	{
+		json_put_raw(w, sep);
+		json_put_raw(w, "\"dns\":");
+		api_put_ipv4(w, v->dns);
+		sep = ",";
+	}
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_static_ip(char *buf, size_t size, const api_static_ip_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_static_ip(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_static_ip(httpd_req_t *req, const api_static_ip_t *v)
+{
+	char buf[API_STATIC_IP_JSON_MAX];
+
+	api_format_static_ip(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+bool api_parse_network_config(json_reader_t *r, api_network_config_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "NetworkConfig object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "ssid"))
+		{
+			if (!json_read_string(r, v->ssid, sizeof(v->ssid)))
+			{
+				*error = "ssid: string of at most 32 characters expected";
+				return false;
+			}
+			seen |= 1u << 0;
+		}
+		else if (json_key_is(key, len, "password"))
+		{
+			if (!json_read_string(r, v->password, sizeof(v->password)))
+			{
+				*error = "password: string of at most 64 characters expected";
+				return false;
+			}
+			seen |= 1u << 1;
+		}
+		else if (json_key_is(key, len, "static_ip"))
+		{
+			if (json_peek(r) == JSON_TYPE_NULL)
+			{
+				json_read_null(r);
+				v->static_ip_is_null = true;
+			}
+			else if (!api_parse_static_ip(r, &v->static_ip, error))
+			{
+				return false;
+			}
+			v->has_static_ip = true;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "ssid is required";
+		return false;
+	}
+	if (!(seen & (1u << 1)))
+	{
+		*error = "password is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_network_config(json_writer_t *w, const api_network_config_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"ssid\":");
+	json_put_string(w, v->ssid);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"password\":");
+	json_put_string(w, v->password);
+	sep = ",";
+	if (v->has_static_ip)
+	{
+		json_put_raw(w, sep);
+		json_put_raw(w, "\"static_ip\":");
+		if (v->static_ip_is_null)
+		{
+			json_put_null(w);
+		}
+		else
+		{
+			api_write_static_ip(w, &v->static_ip);
+		}
+		sep = ",";
+	}
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_network_config(char *buf, size_t size, const api_network_config_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_network_config(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_network_config(httpd_req_t *req, const api_network_config_t *v)
+{
+	char buf[API_NETWORK_CONFIG_JSON_MAX];
+
+	api_format_network_config(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+bool api_parse_ip_address(json_reader_t *r, api_ip_address_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "IpAddress object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "ip"))
+		{
+			if (!api_read_ipv4(r, &v->ip))
+			{
+				*error = "ip: IPv4 address expected";
+				return false;
+			}
+			seen |= 1u << 0;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "ip is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_ip_address(json_writer_t *w, const api_ip_address_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"ip\":");
+	api_put_ipv4(w, v->ip);
+	sep = ",";
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_ip_address(char *buf, size_t size, const api_ip_address_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_ip_address(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_ip_address(httpd_req_t *req, const api_ip_address_t *v)
+{
+	char buf[API_IP_ADDRESS_JSON_MAX];
+
+	api_format_ip_address(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+bool api_parse_ota_status(json_reader_t *r, api_ota_status_t *v, const char **error)
+{
+	const char *key;
+	size_t len;
+	uint32_t seen = 0;
+
+	memset(v, 0, sizeof(*v));
+	if (!json_read_object(r))
+	{
+		*error = "OTAStatus object expected";
+		return false;
+	}
+
+	while (json_next_key(r, &key, &len))
+	{
+		if (json_key_is(key, len, "ota_update_status"))
+		{
+			int64_t n;
+
+			if (!json_read_int(r, &n) || n < -1 || n > 1)
+			{
+				*error = "ota_update_status: integer -1..1 expected";
+				return false;
+			}
+			v->ota_update_status = n;
+			seen |= 1u << 0;
+		}
+		else if (json_key_is(key, len, "compile_time"))
+		{
+			if (!json_read_string(r, v->compile_time, sizeof(v->compile_time)))
+			{
+				*error = "compile_time: string of at most 8 characters expected";
+				return false;
+			}
+			seen |= 1u << 1;
+		}
+		else if (json_key_is(key, len, "compile_date"))
+		{
+			if (!json_read_string(r, v->compile_date, sizeof(v->compile_date)))
+			{
+				*error = "compile_date: string of at most 11 characters expected";
+				return false;
+			}
+			seen |= 1u << 2;
+		}
+		else if (!json_skip(r))
+		{
+			break;
+		}
+	}
+	if (r->error)
+	{
+		*error = "Invalid JSON";
+		return false;
+	}
+	if (!(seen & (1u << 0)))
+	{
+		*error = "ota_update_status is required";
+		return false;
+	}
+	if (!(seen & (1u << 1)))
+	{
+		*error = "compile_time is required";
+		return false;
+	}
+	if (!(seen & (1u << 2)))
+	{
+		*error = "compile_date is required";
+		return false;
+	}
+
+	return true;
+}
+
+bool api_write_ota_status(json_writer_t *w, const api_ota_status_t *v)
+{
+	const char *sep = "{";
+
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"ota_update_status\":");
+	json_put_int(w, v->ota_update_status);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"compile_time\":");
+	json_put_string(w, v->compile_time);
+	sep = ",";
+	json_put_raw(w, sep);
+	json_put_raw(w, "\"compile_date\":");
+	json_put_string(w, v->compile_date);
+	sep = ",";
+	json_put_raw(w, *sep == '{' ? "{}" : "}");
+
+	return !w->overflow;
+}
+
+bool api_format_ota_status(char *buf, size_t size, const api_ota_status_t *v)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, size);
+	api_write_ota_status(&w, v);
+
+	return json_writer_finish(&w);
+}
+
+esp_err_t api_send_ota_status(httpd_req_t *req, const api_ota_status_t *v)
+{
+	char buf[API_OTA_STATUS_JSON_MAX];
+
+	api_format_ota_status(buf, sizeof(buf), v);
+	httpd_resp_set_type(req, "application/json");
+
+	return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+const char *const api_operation_names[API_OP_COUNT] = {
+		[API_OP_HTTP_SERVER_INDEX_HTML] = "http_server_index_html",
+		[API_OP_HTTP_SERVER_APP_CSS] = "http_server_app_css",
+		[API_OP_HTTP_SERVER_APP_JS] = "http_server_app_js",
+		[API_OP_HTTP_SERVER_JQUERY] = "http_server_jquery",
+		[API_OP_HTTP_SERVER_FAVICON_ICO] = "http_server_favicon_ico",
+		[API_OP_ASSETS_FILE_GET] = "assets_file_get",
+		[API_OP_ASSETS_GET] = "assets_get",
+		[API_OP_ASSETS_UPDATE_POST] = "assets_update_post",
+		[API_OP_LED_GET] = "led_get",
+		[API_OP_LED_TOGGLE] = "led_toggle",
+		[API_OP_SCENES_GET] = "scenes_get",
+		[API_OP_SCENE_PUT] = "scene_put",
+		[API_OP_SCENE_DELETE] = "scene_delete",
+		[API_OP_SCENE_RUN_POST] = "scene_run_post",
+		[API_OP_SCENE_STOP_POST] = "scene_stop_post",
+		[API_OP_HTTP_SERVER_OTA_UPDATE] = "http_server_OTA_update",
+		[API_OP_HTTP_SERVER_OTA_STATUS] = "http_server_OTA_status",
+		[API_OP_CONFIG_GET] = "config_get",
+		[API_OP_CONFIG_PUT] = "config_put",
+		[API_OP_SETTINGS_NET_GET] = "settings_net_get",
+		[API_OP_SETTINGS_NET_POST] = "settings_net_post",
+		[API_OP_SETTINGS_IP_GET] = "settings_ip_get",
+		[API_OP_METRICS_GET] = "metrics_get",
+		[API_OP_JOURNAL_GET] = "journal_get",
+		[API_OP_BOOT_GET] = "boot_get",
+		[API_OP_MEMORY_GET] = "memory_get",
+		[API_OP_TELEMETRY_GET] = "telemetry_get",
+		[API_OP_TRACE_GET] = "trace_get",
+		[API_OP_LOADGEN_GET] = "loadgen_get",
+		[API_OP_LOADGEN_POST] = "loadgen_post",
+		[API_OP_LOADGEN_SINK_POST] = "loadgen_sink_post",
+		[API_OP_WIFI_SCAN_GET] = "wifi_scan_get",
+		[API_OP_AUTH_LOGIN_POST] = "auth_login_post",
+		[API_OP_AUTH_LOGOUT_POST] = "auth_logout_post",
+		[API_OP_AUTH_CREDENTIALS_POST] = "auth_credentials_post",
+		[API_OP_LIMITS_GET] = "limits_get",
+		[API_OP_LIMITS_POST] = "limits_post",
+};
+
+/**
+ * GET /: Serve index.html
+ */
+static esp_err_t api_http_server_index_html(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_HTTP_SERVER_INDEX_HTML);
+
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return http_server_index_html_handler(req);
+}
+
+/**
+ * GET /app.css: Serve CSS file
+ */
+static esp_err_t api_http_server_app_css(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_HTTP_SERVER_APP_CSS);
+
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return http_server_app_css_handler(req);
+}
+
+/**
+ * GET /app.js: Serve JavaScript file
+ */
+static esp_err_t api_http_server_app_js(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_HTTP_SERVER_APP_JS);
+
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return http_server_app_js_handler(req);
+}
+
+/**
+ * GET /jquery-3.3.1.min.js: Serve jQuery library
+ */
+static esp_err_t api_http_server_jquery(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_HTTP_SERVER_JQUERY);
+
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return http_server_jquery_handler(req);
+}
+
+/**
+ * GET /favicon.ico: Serve favicon
+ */
+static esp_err_t api_http_server_favicon_ico(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_HTTP_SERVER_FAVICON_ICO);
+
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return http_server_favicon_ico_handler(req);
+}
+
+/**
+ * GET /api/assets: Get the state of the assets partition
+ */
+static esp_err_t api_assets_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_ASSETS_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return assets_get_handler(req);
+}
+
+/**
+ * POST /api/assets/update: Replace the web page
+ */
+static esp_err_t api_assets_update_post(httpd_req_t *req)
+{
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_ASSETS_UPDATE_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_ASSETS_UPDATE_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = assets_update_post_handler(req);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * GET /api/leds/{id}: Get LED state
+ */
+static esp_err_t api_led_get(httpd_req_t *req)
+{
+	api_led_get_in_t in = { 0 };
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_LED_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+	if (!api_path_int(req, "/api/leds/%d", 1, 4, &in.id))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "id: integer 1..4 expected");
+		return ESP_OK;
+	}
+
+	return led_get_handler(req, &in);
+}
+
+/**
+ * POST /api/leds/{id}/toggle: Toggle LED state
+ */
+static esp_err_t api_led_toggle(httpd_req_t *req)
+{
+	api_led_toggle_in_t in = { 0 };
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_LED_TOGGLE);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_LED_TOGGLE, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+	if (!api_path_int(req, "/api/leds/%d/toggle", 1, 4, &in.id))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "id: integer 1..4 expected");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	rec.channel = in.id;
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = led_toggle_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * GET /api/scenes: Get the lighting program slots
+ */
+static esp_err_t api_scenes_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_SCENES_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return scenes_get_handler(req);
+}
+
+/**
+ * PUT /api/scenes/{slot}: Store a lighting program
+ */
+static esp_err_t api_scene_put(httpd_req_t *req)
+{
+	api_scene_put_in_t in = { 0 };
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_SCENE_PUT);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_SCENE_PUT, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+	if (!api_path_int(req, "/api/scenes/%d", 0, 3, &in.slot))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "slot: integer 0..3 expected");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	rec.channel = in.slot;
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = scene_put_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * DELETE /api/scenes/{slot}: Stop and remove a lighting program
+ */
+static esp_err_t api_scene_delete(httpd_req_t *req)
+{
+	api_scene_delete_in_t in = { 0 };
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_SCENE_DELETE);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_SCENE_DELETE, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+	if (!api_path_int(req, "/api/scenes/%d", 0, 3, &in.slot))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "slot: integer 0..3 expected");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	rec.channel = in.slot;
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = scene_delete_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * POST /api/scenes/{slot}/run: Start a lighting program from the beginning
+ */
+static esp_err_t api_scene_run_post(httpd_req_t *req)
+{
+	api_scene_run_post_in_t in = { 0 };
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_SCENE_RUN_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_SCENE_RUN_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+	if (!api_path_int(req, "/api/scenes/%d/run", 0, 3, &in.slot))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "slot: integer 0..3 expected");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	rec.channel = in.slot;
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = scene_run_post_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * POST /api/scenes/{slot}/stop: Stop a lighting program
+ */
+static esp_err_t api_scene_stop_post(httpd_req_t *req)
+{
+	api_scene_stop_post_in_t in = { 0 };
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_SCENE_STOP_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_SCENE_STOP_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+	if (!api_path_int(req, "/api/scenes/%d/stop", 0, 3, &in.slot))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "slot: integer 0..3 expected");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	rec.channel = in.slot;
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = scene_stop_post_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * POST /api/OTA/update: Perform OTA firmware update
+ */
+static esp_err_t api_http_server_OTA_update(httpd_req_t *req)
+{
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_HTTP_SERVER_OTA_UPDATE);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_HTTP_SERVER_OTA_UPDATE, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = http_server_OTA_update_handler(req);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * GET /api/OTA/status: Get OTA update status
+ */
+static esp_err_t api_http_server_OTA_status(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_HTTP_SERVER_OTA_STATUS);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return http_server_OTA_status_handler(req);
+}
+
+/**
+ * GET /api/config: Export the configuration
+ */
+static esp_err_t api_config_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_CONFIG_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		return ESP_OK;
+	}
+
+	return config_get_handler(req);
+}
+
+/**
+ * PUT /api/config: Import the configuration
+ */
+static esp_err_t api_config_put(httpd_req_t *req)
+{
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_CONFIG_PUT);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_CONFIG_PUT, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = config_put_handler(req);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * GET /api/config/network: Get network configuration
+ */
+static esp_err_t api_settings_net_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_SETTINGS_NET_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		return ESP_OK;
+	}
+
+	return settings_net_get_handler(req);
+}
+
+/**
+ * POST /api/config/network: Set network configuration
+ */
+static esp_err_t api_settings_net_post(httpd_req_t *req)
+{
+	api_settings_net_post_in_t in = { 0 };
+	char body[API_NETWORK_CONFIG_JSON_MAX + 128];
+	const char *error = "Invalid JSON";
+	json_reader_t r;
+	int len;
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_SETTINGS_NET_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_SETTINGS_NET_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+
+	len = api_recv_body(req, body, sizeof(body), true);
+	if (len < 0)
+	{
+		journal_end(&rec, len == API_RECV_FAILED ? JOURNAL_RESULT_FAILED : JOURNAL_RESULT_BAD_REQUEST);
+		return len == API_RECV_FAILED ? ESP_FAIL : ESP_OK;
+	}
+	json_reader_init(&r, body, len);
+	if (!api_parse_network_config(&r, &in.body, &error) || !json_reader_done(&r))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = settings_net_post_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * GET /api/config/ip_addr: Get current IP address
+ */
+static esp_err_t api_settings_ip_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_SETTINGS_IP_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return settings_ip_get_handler(req);
+}
+
+/**
+ * GET /api/metrics: Get STA connection metrics
+ */
+static esp_err_t api_metrics_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_METRICS_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return metrics_get_handler(req);
+}
+
+/**
+ * GET /api/journal: Read the command journal
+ */
+static esp_err_t api_journal_get(httpd_req_t *req)
+{
+	api_journal_get_in_t in = { 0 };
+	char query[96];
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_JOURNAL_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		return ESP_OK;
+	}
+	if (!api_get_query(req, query, sizeof(query)))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Query string too long");
+		return ESP_OK;
+	}
+	if (!api_query_int(query, "since", 0, 2147483647, 0, &in.since))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "since: integer >= 0 expected");
+		return ESP_OK;
+	}
+	if (!api_query_int(query, "limit", 1, 64, 32, &in.limit))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "limit: integer 1..64 expected");
+		return ESP_OK;
+	}
+
+	return journal_get_handler(req, &in);
+}
+
+/**
+ * GET /api/boot: Get the boot timeline
+ */
+static esp_err_t api_boot_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_BOOT_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return boot_get_handler(req);
+}
+
+/**
+ * GET /api/memory: Get the memory budget report
+ */
+static esp_err_t api_memory_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_MEMORY_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return memory_get_handler(req);
+}
+
+static const char *const api_telemetry_get_tier_names[API_TELEMETRY_GET_TIER_COUNT] = {
+		[API_TELEMETRY_GET_TIER_S] = "s",
+		[API_TELEMETRY_GET_TIER_M] = "m",
+		[API_TELEMETRY_GET_TIER_H] = "h",
+};
+
+/**
+ * GET /api/telemetry: Get the CPU, heap and RSSI time series
+ */
+static esp_err_t api_telemetry_get(httpd_req_t *req)
+{
+	api_telemetry_get_in_t in = { 0 };
+	char query[96];
+	int n;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_TELEMETRY_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+	if (!api_get_query(req, query, sizeof(query)))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Query string too long");
+		return ESP_OK;
+	}
+	if (!api_query_enum(query, "tier", api_telemetry_get_tier_names, API_TELEMETRY_GET_TIER_COUNT, API_TELEMETRY_GET_TIER_S, &n))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "tier: \"s\" or \"m\" or \"h\" expected");
+		return ESP_OK;
+	}
+	in.tier = n;
+
+	return telemetry_get_handler(req, &in);
+}
+
+#if CONFIG_TRACE_ENABLE
+/**
+ * GET /api/trace: Dump and clear the event trace
+ */
+static esp_err_t api_trace_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_TRACE_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		return ESP_OK;
+	}
+
+	return trace_get_handler(req);
+}
+
+#endif
+
+#if CONFIG_LOADGEN_ENABLE
+/**
+ * GET /api/loadgen: Get the result of the last load generator run
+ */
+static esp_err_t api_loadgen_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_LOADGEN_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return loadgen_get_handler(req);
+}
+
+/**
+ * POST /api/loadgen: Start a load generator run
+ */
+static esp_err_t api_loadgen_post(httpd_req_t *req)
+{
+	api_loadgen_post_in_t in = { 0 };
+	char query[96];
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_LOADGEN_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_LOADGEN_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+	if (!api_get_query(req, query, sizeof(query)))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Query string too long");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	if (!api_query_int(query, "clients", 1, 8, 4, &in.clients))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "clients: integer 1..8 expected");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	if (!api_query_int(query, "requests", 1, 2000, 400, &in.requests))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "requests: integer 1..2000 expected");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	if (!api_query_int(query, "upload_kb", 0, 2048, 0, &in.upload_kb))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "upload_kb: integer 0..2048 expected");
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = loadgen_post_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * POST /api/loadgen/sink: Upload target of the load generator, the body is discarded
+ */
+static esp_err_t api_loadgen_sink_post(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_LOADGEN_SINK_POST);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return loadgen_sink_post_handler(req);
+}
+
+#endif
+
+/**
+ * GET /api/wifi/scan: Get cached WiFi scan results
+ */
+static esp_err_t api_wifi_scan_get(httpd_req_t *req)
+{
+	api_wifi_scan_get_in_t in = { 0 };
+	char query[96];
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_WIFI_SCAN_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+	if (!api_get_query(req, query, sizeof(query)))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Query string too long");
+		return ESP_OK;
+	}
+	if (!api_query_int(query, "refresh", 0, 1, 0, &in.refresh))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "refresh: integer 0..1 expected");
+		return ESP_OK;
+	}
+
+	return wifi_scan_get_handler(req, &in);
+}
+
+/**
+ * POST /api/auth/login: Log in and get a session token
+ */
+static esp_err_t api_auth_login_post(httpd_req_t *req)
+{
+	api_auth_login_post_in_t in = { 0 };
+	char body[API_CREDENTIALS_JSON_MAX + 128];
+	const char *error = "Invalid JSON";
+	json_reader_t r;
+	int len;
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_AUTH_LOGIN_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_AUTH_LOGIN_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+
+	len = api_recv_body(req, body, sizeof(body), true);
+	if (len < 0)
+	{
+		journal_end(&rec, len == API_RECV_FAILED ? JOURNAL_RESULT_FAILED : JOURNAL_RESULT_BAD_REQUEST);
+		return len == API_RECV_FAILED ? ESP_FAIL : ESP_OK;
+	}
+	json_reader_init(&r, body, len);
+	if (!api_parse_credentials(&r, &in.body, &error) || !json_reader_done(&r))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = auth_login_post_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * POST /api/auth/logout: End the session of the token
+ */
+static esp_err_t api_auth_logout_post(httpd_req_t *req)
+{
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_AUTH_LOGOUT_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_AUTH_LOGOUT_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = auth_logout_post_handler(req);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * POST /api/auth/credentials: Set the login
+ */
+static esp_err_t api_auth_credentials_post(httpd_req_t *req)
+{
+	api_auth_credentials_post_in_t in = { 0 };
+	char body[API_CREDENTIALS_JSON_MAX + 128];
+	const char *error = "Invalid JSON";
+	json_reader_t r;
+	int len;
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_AUTH_CREDENTIALS_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_AUTH_CREDENTIALS_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+
+	len = api_recv_body(req, body, sizeof(body), true);
+	if (len < 0)
+	{
+		journal_end(&rec, len == API_RECV_FAILED ? JOURNAL_RESULT_FAILED : JOURNAL_RESULT_BAD_REQUEST);
+		return len == API_RECV_FAILED ? ESP_FAIL : ESP_OK;
+	}
+	json_reader_init(&r, body, len);
+	if (!api_parse_credentials(&r, &in.body, &error) || !json_reader_done(&r))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = auth_credentials_post_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * GET /api/config/limits: Get the rate limits
+ */
+static esp_err_t api_limits_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_LIMITS_GET);
+
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return limits_get_handler(req);
+}
+
+/**
+ * POST /api/config/limits: Set the rate limits
+ */
+static esp_err_t api_limits_post(httpd_req_t *req)
+{
+	api_limits_post_in_t in = { 0 };
+	char body[API_RATE_LIMITS_JSON_MAX + 128];
+	const char *error = "Invalid JSON";
+	json_reader_t r;
+	int len;
+	journal_record_t rec;
+	esp_err_t err;
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_LIMITS_POST);
+
+	journal_begin(&rec, JOURNAL_SOURCE_HTTP, API_OP_LIMITS_POST, http_conn_client(req));
+	set_cors_headers(req);
+	if (!http_admit(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_LIMITED);
+		return ESP_OK;
+	}
+	if (!http_server_authorize(req))
+	{
+		journal_end(&rec, JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+
+	len = api_recv_body(req, body, sizeof(body), true);
+	if (len < 0)
+	{
+		journal_end(&rec, len == API_RECV_FAILED ? JOURNAL_RESULT_FAILED : JOURNAL_RESULT_BAD_REQUEST);
+		return len == API_RECV_FAILED ? ESP_FAIL : ESP_OK;
+	}
+	json_reader_init(&r, body, len);
+	if (!api_parse_rate_limits(&r, &in.body, &error) || !json_reader_done(&r))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);
+		journal_end(&rec, JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	g_api_result = JOURNAL_RESULT_OK;
+	err = limits_post_handler(req, &in);
+	journal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);
+	return err;
+}
+
+/**
+ * GET /{path}: Serve any other file of the assets partition
+ */
+static esp_err_t api_assets_file_get(httpd_req_t *req)
+{
+	TRACE_SCOPE(TRACE_EV_HTTP_REQUEST, API_OP_ASSETS_FILE_GET);
+
+	if (!http_admit(req))
+	{
+		return ESP_OK;
+	}
+
+	return assets_file_get_handler(req);
+}
+
+const api_route_t api_routes[] = {
+		{ "/", HTTP_GET, api_http_server_index_html, HTTP_ADMIT_READ },
+		{ "/app.css", HTTP_GET, api_http_server_app_css, HTTP_ADMIT_READ },
+		{ "/app.js", HTTP_GET, api_http_server_app_js, HTTP_ADMIT_READ },
+		{ "/jquery-3.3.1.min.js", HTTP_GET, api_http_server_jquery, HTTP_ADMIT_READ },
+		{ "/favicon.ico", HTTP_GET, api_http_server_favicon_ico, HTTP_ADMIT_READ },
+		{ "/api/assets", HTTP_GET, api_assets_get, HTTP_ADMIT_READ },
+		{ "/api/assets/update", HTTP_POST, api_assets_update_post, HTTP_ADMIT_HEAVY },
+		{ "/api/leds/1", HTTP_GET, api_led_get, HTTP_ADMIT_READ },
+		{ "/api/leds/2", HTTP_GET, api_led_get, HTTP_ADMIT_READ },
+		{ "/api/leds/3", HTTP_GET, api_led_get, HTTP_ADMIT_READ },
+		{ "/api/leds/4", HTTP_GET, api_led_get, HTTP_ADMIT_READ },
+		{ "/api/leds/1/toggle", HTTP_POST, api_led_toggle, HTTP_ADMIT_CONTROL },
+		{ "/api/leds/2/toggle", HTTP_POST, api_led_toggle, HTTP_ADMIT_CONTROL },
+		{ "/api/leds/3/toggle", HTTP_POST, api_led_toggle, HTTP_ADMIT_CONTROL },
+		{ "/api/leds/4/toggle", HTTP_POST, api_led_toggle, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes", HTTP_GET, api_scenes_get, HTTP_ADMIT_READ },
+		{ "/api/scenes/0", HTTP_PUT, api_scene_put, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/1", HTTP_PUT, api_scene_put, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/2", HTTP_PUT, api_scene_put, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/3", HTTP_PUT, api_scene_put, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/0", HTTP_DELETE, api_scene_delete, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/1", HTTP_DELETE, api_scene_delete, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/2", HTTP_DELETE, api_scene_delete, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/3", HTTP_DELETE, api_scene_delete, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/0/run", HTTP_POST, api_scene_run_post, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/1/run", HTTP_POST, api_scene_run_post, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/2/run", HTTP_POST, api_scene_run_post, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/3/run", HTTP_POST, api_scene_run_post, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/0/stop", HTTP_POST, api_scene_stop_post, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/1/stop", HTTP_POST, api_scene_stop_post, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/2/stop", HTTP_POST, api_scene_stop_post, HTTP_ADMIT_CONTROL },
+		{ "/api/scenes/3/stop", HTTP_POST, api_scene_stop_post, HTTP_ADMIT_CONTROL },
+		{ "/api/OTA/update", HTTP_POST, api_http_server_OTA_update, HTTP_ADMIT_HEAVY },
+		{ "/api/OTA/status", HTTP_GET, api_http_server_OTA_status, HTTP_ADMIT_READ },
+		{ "/api/config", HTTP_GET, api_config_get, HTTP_ADMIT_READ },
+		{ "/api/config", HTTP_PUT, api_config_put, HTTP_ADMIT_CONTROL },
+		{ "/api/config/network", HTTP_GET, api_settings_net_get, HTTP_ADMIT_READ },
+		{ "/api/config/network", HTTP_POST, api_settings_net_post, HTTP_ADMIT_CONTROL },
+		{ "/api/config/ip_addr", HTTP_GET, api_settings_ip_get, HTTP_ADMIT_READ },
+		{ "/api/metrics", HTTP_GET, api_metrics_get, HTTP_ADMIT_READ },
+		{ "/api/journal", HTTP_GET, api_journal_get, HTTP_ADMIT_READ },
+		{ "/api/boot", HTTP_GET, api_boot_get, HTTP_ADMIT_READ },
+		{ "/api/memory", HTTP_GET, api_memory_get, HTTP_ADMIT_READ },
+		{ "/api/telemetry", HTTP_GET, api_telemetry_get, HTTP_ADMIT_READ },
+#if CONFIG_TRACE_ENABLE
+		{ "/api/trace", HTTP_GET, api_trace_get, HTTP_ADMIT_HEAVY },
+#endif
+#if CONFIG_LOADGEN_ENABLE
+		{ "/api/loadgen", HTTP_GET, api_loadgen_get, HTTP_ADMIT_READ },
+		{ "/api/loadgen", HTTP_POST, api_loadgen_post, HTTP_ADMIT_HEAVY },
+		{ "/api/loadgen/sink", HTTP_POST, api_loadgen_sink_post, HTTP_ADMIT_READ },
+#endif
+		{ "/api/wifi/scan", HTTP_GET, api_wifi_scan_get, HTTP_ADMIT_CONTROL },
+		{ "/api/auth/login", HTTP_POST, api_auth_login_post, HTTP_ADMIT_LOGIN },
+		{ "/api/auth/logout", HTTP_POST, api_auth_logout_post, HTTP_ADMIT_CONTROL },
+		{ "/api/auth/credentials", HTTP_POST, api_auth_credentials_post, HTTP_ADMIT_LOGIN },
+		{ "/api/config/limits", HTTP_GET, api_limits_get, HTTP_ADMIT_READ },
+		{ "/api/config/limits", HTTP_POST, api_limits_post, HTTP_ADMIT_CONTROL },
+		{ "/*", HTTP_GET, api_assets_file_get, HTTP_ADMIT_READ },
+};
+
+const size_t api_route_count = sizeof(api_routes) / sizeof(api_routes[0]);
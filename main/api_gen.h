@@ -0,0 +1,446 @@
+/*
+ * api_gen.h
+ *
+ * Generated by tools/gen_routes.py from swagger.yaml, do not edit.
+ */
+
+#ifndef MAIN_API_GEN_H_
+#define MAIN_API_GEN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_http_server.h"
+#include "http_admit.h"
+#include "journal.h"
+#include "json_codec.h"
+
+/**
+ * One registration of a URI with httpd, the admission class goes to user_ctx.
+ */
+typedef struct api_route
+{
+	const char *uri;
+	httpd_method_t method;
+	esp_err_t (*handler)(httpd_req_t *req);	///> Generated wrapper, validates and calls the operation handler
+	http_admit_route_e admit;
+} api_route_t;
+
+// Routes in registration order, the wildcard last
+extern const api_route_t api_routes[];
+extern const size_t api_route_count;
+
+/**
+ * Sets the journal result of the running operation, for a handler that answers an error
+ * itself and returns ESP_OK. Its record is OK otherwise. Only from the operation handlers.
+ */
+void api_journal_result(journal_result_e result);
+
+// For max_uri_handlers, with every x-if option enabled
+#define API_ROUTE_COUNT				55
+
+/**
+ * Operations in swagger.yaml order, the route of an HTTP journal record.
+ */
+typedef enum api_operation
+{
+	API_OP_HTTP_SERVER_INDEX_HTML = 0,
+	API_OP_HTTP_SERVER_APP_CSS,
+	API_OP_HTTP_SERVER_APP_JS,
+	API_OP_HTTP_SERVER_JQUERY,
+	API_OP_HTTP_SERVER_FAVICON_ICO,
+	API_OP_ASSETS_FILE_GET,
+	API_OP_ASSETS_GET,
+	API_OP_ASSETS_UPDATE_POST,
+	API_OP_LED_GET,
+	API_OP_LED_TOGGLE,
+	API_OP_SCENES_GET,
+	API_OP_SCENE_PUT,
+	API_OP_SCENE_DELETE,
+	API_OP_SCENE_RUN_POST,
+	API_OP_SCENE_STOP_POST,
+	API_OP_HTTP_SERVER_OTA_UPDATE,
+	API_OP_HTTP_SERVER_OTA_STATUS,
+	API_OP_CONFIG_GET,
+	API_OP_CONFIG_PUT,
+	API_OP_SETTINGS_NET_GET,
+	API_OP_SETTINGS_NET_POST,
+	API_OP_SETTINGS_IP_GET,
+	API_OP_METRICS_GET,
+	API_OP_JOURNAL_GET,
+	API_OP_BOOT_GET,
+	API_OP_MEMORY_GET,
+	API_OP_TELEMETRY_GET,
+	API_OP_TRACE_GET,
+	API_OP_LOADGEN_GET,
+	API_OP_LOADGEN_POST,
+	API_OP_LOADGEN_SINK_POST,
+	API_OP_WIFI_SCAN_GET,
+	API_OP_AUTH_LOGIN_POST,
+	API_OP_AUTH_LOGOUT_POST,
+	API_OP_AUTH_CREDENTIALS_POST,
+	API_OP_LIMITS_GET,
+	API_OP_LIMITS_POST,
+	API_OP_COUNT
+} api_operation_e;
+
+extern const char *const api_operation_names[API_OP_COUNT];
+
+/*
+ * Component schemas. API_<NAME>_JSON_MAX is the longest text of the writer, null included.
+ */
+
+#define API_RATE_LIMIT_JSON_MAX			48
+
+typedef struct api_rate_limit
+{
+	int32_t per_minute;				///> Tokens refilled per minute
+	int32_t burst;				///> Bucket size, requests a client may send at once
+} api_rate_limit_t;
+
+bool api_parse_rate_limit(json_reader_t *r, api_rate_limit_t *v, const char **error);
+bool api_write_rate_limit(json_writer_t *w, const api_rate_limit_t *v);
+bool api_format_rate_limit(char *buf, size_t size, const api_rate_limit_t *v);
+esp_err_t api_send_rate_limit(httpd_req_t *req, const api_rate_limit_t *v);
+
+#define API_RATE_LIMITS_JSON_MAX			228
+
+typedef struct api_rate_limits
+{
+	bool has_read;
+	api_rate_limit_t read;
+	bool has_control;
+	api_rate_limit_t control;
+	bool has_login;
+	api_rate_limit_t login;
+	bool has_heavy;
+	api_rate_limit_t heavy;
+} api_rate_limits_t;
+
+bool api_parse_rate_limits(json_reader_t *r, api_rate_limits_t *v, const char **error);
+bool api_write_rate_limits(json_writer_t *w, const api_rate_limits_t *v);
+bool api_format_rate_limits(char *buf, size_t size, const api_rate_limits_t *v);
+esp_err_t api_send_rate_limits(httpd_req_t *req, const api_rate_limits_t *v);
+
+#define API_CREDENTIALS_JSON_MAX			603
+
+typedef struct api_credentials
+{
+	char user[33];
+	char password[65];
+} api_credentials_t;
+
+bool api_parse_credentials(json_reader_t *r, api_credentials_t *v, const char **error);
+bool api_write_credentials(json_writer_t *w, const api_credentials_t *v);
+bool api_format_credentials(char *buf, size_t size, const api_credentials_t *v);
+esp_err_t api_send_credentials(httpd_req_t *req, const api_credentials_t *v);
+
+#define API_SESSION_JSON_MAX			231
+
+typedef struct api_session
+{
+	char token[33];
+	int32_t expires_in;				///> Idle timeout in seconds
+} api_session_t;
+
+bool api_parse_session(json_reader_t *r, api_session_t *v, const char **error);
+bool api_write_session(json_writer_t *w, const api_session_t *v);
+bool api_format_session(char *buf, size_t size, const api_session_t *v);
+esp_err_t api_send_session(httpd_req_t *req, const api_session_t *v);
+
+typedef enum api_led_state
+{
+	API_LED_STATE_ON = 0,
+	API_LED_STATE_OFF,
+	API_LED_STATE_COUNT
+} api_led_state_e;
+
+#define API_LED_JSON_MAX			56
+
+typedef struct api_led
+{
+	int32_t id;
+	api_led_state_e state;
+	int32_t version;				///> LED state version, increases with every change of the LEDs from any source
+} api_led_t;
+
+bool api_parse_led(json_reader_t *r, api_led_t *v, const char **error);
+bool api_write_led(json_writer_t *w, const api_led_t *v);
+bool api_format_led(char *buf, size_t size, const api_led_t *v);
+esp_err_t api_send_led(httpd_req_t *req, const api_led_t *v);
+
+typedef enum api_scene_state
+{
+	API_SCENE_STATE_IDLE = 0,
+	API_SCENE_STATE_RUNNING,
+	API_SCENE_STATE_DONE,
+	API_SCENE_STATE_FAULT,
+	API_SCENE_STATE_COUNT
+} api_scene_state_e;
+
+typedef enum api_scene_fault
+{
+	API_SCENE_FAULT_NONE = 0,
+	API_SCENE_FAULT_BAD_HEADER,
+	API_SCENE_FAULT_TOO_LARGE,
+	API_SCENE_FAULT_BAD_OPCODE,
+	API_SCENE_FAULT_TRUNCATED,
+	API_SCENE_FAULT_BAD_TARGET,
+	API_SCENE_FAULT_BAD_COUNT,
+	API_SCENE_FAULT_NO_END,
+	API_SCENE_FAULT_LOOP_DEPTH,
+	API_SCENE_FAULT_LOOP_EMPTY,
+	API_SCENE_FAULT_COUNT
+} api_scene_fault_e;
+
+#define API_SCENE_JSON_MAX			185
+
+/**
+ * A lighting program slot
+ */
+typedef struct api_scene
+{
+	int32_t slot;
+	bool stored;				///> The slot holds a program
+	bool autostart;				///> Started at boot
+	int32_t size;				///> Blob size in bytes, header included
+	api_scene_state_e state;
+	api_scene_fault_e fault;				///> Why the program stopped, in the fault state
+	int32_t pc;				///> Code offset of the next instruction, of the faulting one in the fault state
+	int32_t instructions;				///> Instructions executed since the last start
+	int32_t budget_yields;				///> Ticks the program used up its instruction budget without yielding
+} api_scene_t;
+
+bool api_parse_scene(json_reader_t *r, api_scene_t *v, const char **error);
+bool api_write_scene(json_writer_t *w, const api_scene_t *v);
+bool api_format_scene(char *buf, size_t size, const api_scene_t *v);
+esp_err_t api_send_scene(httpd_req_t *req, const api_scene_t *v);
+
+#define API_STATIC_IP_JSON_MAX			101
+
+/**
+ * Optional static IPv4 setup for the STA, null switches back to DHCP
+ */
+typedef struct api_static_ip
+{
+	uint32_t ip;				///> IPv4 in network order
+	uint32_t netmask;				///> IPv4 in network order
+	bool has_gw;
+	uint32_t gw;				///> IPv4 in network order
+	bool has_dns;
+	uint32_t dns;				///> IPv4 in network order
+} api_static_ip_t;
+
+bool api_parse_static_ip(json_reader_t *r, api_static_ip_t *v, const char **error);
+bool api_write_static_ip(json_writer_t *w, const api_static_ip_t *v);
+bool api_format_static_ip(char *buf, size_t size, const api_static_ip_t *v);
+esp_err_t api_send_static_ip(httpd_req_t *req, const api_static_ip_t *v);
+
+#define API_NETWORK_CONFIG_JSON_MAX			716
+
+typedef struct api_network_config
+{
+	char ssid[33];				///> WiFi SSID
+	char password[65];				///> WiFi password
+	bool has_static_ip;
+	bool static_ip_is_null;
+	api_static_ip_t static_ip;
+} api_network_config_t;
+
+bool api_parse_network_config(json_reader_t *r, api_network_config_t *v, const char **error);
+bool api_write_network_config(json_writer_t *w, const api_network_config_t *v);
+bool api_format_network_config(char *buf, size_t size, const api_network_config_t *v);
+esp_err_t api_send_network_config(httpd_req_t *req, const api_network_config_t *v);
+
+#define API_IP_ADDRESS_JSON_MAX			26
+
+typedef struct api_ip_address
+{
+	uint32_t ip;				///> IPv4 in network order
+} api_ip_address_t;
+
+bool api_parse_ip_address(json_reader_t *r, api_ip_address_t *v, const char **error);
+bool api_write_ip_address(json_writer_t *w, const api_ip_address_t *v);
+bool api_format_ip_address(char *buf, size_t size, const api_ip_address_t *v);
+esp_err_t api_send_ip_address(httpd_req_t *req, const api_ip_address_t *v);
+
+#define API_OTA_STATUS_JSON_MAX			185
+
+typedef struct api_ota_status
+{
+	int32_t ota_update_status;				///> Firmware update status, 0 pending, 1 successful, -1 failed
+	char compile_time[9];				///> Firmware compile time
+	char compile_date[12];				///> Firmware compile date
+} api_ota_status_t;
+
+bool api_parse_ota_status(json_reader_t *r, api_ota_status_t *v, const char **error);
+bool api_write_ota_status(json_writer_t *w, const api_ota_status_t *v);
+bool api_format_ota_status(char *buf, size_t size, const api_ota_status_t *v);
+esp_err_t api_send_ota_status(httpd_req_t *req, const api_ota_status_t *v);
+
+/*
+ * Operation inputs, parsed and validated before the handler runs.
+ */
+
+typedef struct api_led_get_in
+{
+	int32_t id;
+} api_led_get_in_t;
+
+typedef struct api_led_toggle_in
+{
+	int32_t id;
+} api_led_toggle_in_t;
+
+typedef struct api_scene_put_in
+{
+	int32_t slot;
+} api_scene_put_in_t;
+
+typedef struct api_scene_delete_in
+{
+	int32_t slot;
+} api_scene_delete_in_t;
+
+typedef struct api_scene_run_post_in
+{
+	int32_t slot;
+} api_scene_run_post_in_t;
+
+typedef struct api_scene_stop_post_in
+{
+	int32_t slot;
+} api_scene_stop_post_in_t;
+
+typedef struct api_settings_net_post_in
+{
+	api_network_config_t body;
+} api_settings_net_post_in_t;
+
+typedef struct api_journal_get_in
+{
+	int32_t since;
+	int32_t limit;
+} api_journal_get_in_t;
+
+typedef enum api_telemetry_get_tier
+{
+	API_TELEMETRY_GET_TIER_S = 0,
+	API_TELEMETRY_GET_TIER_M,
+	API_TELEMETRY_GET_TIER_H,
+	API_TELEMETRY_GET_TIER_COUNT
+} api_telemetry_get_tier_e;
+
+typedef struct api_telemetry_get_in
+{
+	api_telemetry_get_tier_e tier;
+} api_telemetry_get_in_t;
+
+typedef struct api_loadgen_post_in
+{
+	int32_t clients;
+	int32_t requests;
+	int32_t upload_kb;
+} api_loadgen_post_in_t;
+
+typedef struct api_wifi_scan_get_in
+{
+	int32_t refresh;
+} api_wifi_scan_get_in_t;
+
+typedef struct api_auth_login_post_in
+{
+	api_credentials_t body;
+} api_auth_login_post_in_t;
+
+typedef struct api_auth_credentials_post_in
+{
+	api_credentials_t body;
+} api_auth_credentials_post_in_t;
+
+typedef struct api_limits_post_in
+{
+	api_rate_limits_t body;
+} api_limits_post_in_t;
+
+/*
+ * Operation handlers, implemented in http_server.c.
+ */
+
+// GET /
+esp_err_t http_server_index_html_handler(httpd_req_t *req);
+// GET /app.css
+esp_err_t http_server_app_css_handler(httpd_req_t *req);
+// GET /app.js
+esp_err_t http_server_app_js_handler(httpd_req_t *req);
+// GET /jquery-3.3.1.min.js
+esp_err_t http_server_jquery_handler(httpd_req_t *req);
+// GET /favicon.ico
+esp_err_t http_server_favicon_ico_handler(httpd_req_t *req);
+// GET /{path}
+esp_err_t assets_file_get_handler(httpd_req_t *req);
+// GET /api/assets
+esp_err_t assets_get_handler(httpd_req_t *req);
+// POST /api/assets/update
+esp_err_t assets_update_post_handler(httpd_req_t *req);
+// GET /api/leds/{id}
+esp_err_t led_get_handler(httpd_req_t *req, const api_led_get_in_t *in);
+// POST /api/leds/{id}/toggle
+esp_err_t led_toggle_handler(httpd_req_t *req, const api_led_toggle_in_t *in);
+// GET /api/scenes
+esp_err_t scenes_get_handler(httpd_req_t *req);
+// PUT /api/scenes/{slot}
+esp_err_t scene_put_handler(httpd_req_t *req, const api_scene_put_in_t *in);
+// DELETE /api/scenes/{slot}
+esp_err_t scene_delete_handler(httpd_req_t *req, const api_scene_delete_in_t *in);
+// POST /api/scenes/{slot}/run
+esp_err_t scene_run_post_handler(httpd_req_t *req, const api_scene_run_post_in_t *in);
+// POST /api/scenes/{slot}/stop
+esp_err_t scene_stop_post_handler(httpd_req_t *req, const api_scene_stop_post_in_t *in);
+// POST /api/OTA/update
+esp_err_t http_server_OTA_update_handler(httpd_req_t *req);
+// GET /api/OTA/status
+esp_err_t http_server_OTA_status_handler(httpd_req_t *req);
+// GET /api/config
+esp_err_t config_get_handler(httpd_req_t *req);
+// PUT /api/config
+esp_err_t config_put_handler(httpd_req_t *req);
+// GET /api/config/network
+esp_err_t settings_net_get_handler(httpd_req_t *req);
+// POST /api/config/network
+esp_err_t settings_net_post_handler(httpd_req_t *req, const api_settings_net_post_in_t *in);
+// GET /api/config/ip_addr
+esp_err_t settings_ip_get_handler(httpd_req_t *req);
+// GET /api/metrics
+esp_err_t metrics_get_handler(httpd_req_t *req);
+// GET /api/journal
+esp_err_t journal_get_handler(httpd_req_t *req, const api_journal_get_in_t *in);
+// GET /api/boot
+esp_err_t boot_get_handler(httpd_req_t *req);
+// GET /api/memory
+esp_err_t memory_get_handler(httpd_req_t *req);
+// GET /api/telemetry
+esp_err_t telemetry_get_handler(httpd_req_t *req, const api_telemetry_get_in_t *in);
+// GET /api/trace
+esp_err_t trace_get_handler(httpd_req_t *req);
+// GET /api/loadgen
+esp_err_t loadgen_get_handler(httpd_req_t *req);
+// POST /api/loadgen
+esp_err_t loadgen_post_handler(httpd_req_t *req, const api_loadgen_post_in_t *in);
+// POST /api/loadgen/sink
+esp_err_t loadgen_sink_post_handler(httpd_req_t *req);
+// GET /api/wifi/scan
+esp_err_t wifi_scan_get_handler(httpd_req_t *req, const api_wifi_scan_get_in_t *in);
+// POST /api/auth/login
+esp_err_t auth_login_post_handler(httpd_req_t *req, const api_auth_login_post_in_t *in);
+// POST /api/auth/logout
+esp_err_t auth_logout_post_handler(httpd_req_t *req);
+// POST /api/auth/credentials
+esp_err_t auth_credentials_post_handler(httpd_req_t *req, const api_auth_credentials_post_in_t *in);
+// GET /api/config/limits
+esp_err_t limits_get_handler(httpd_req_t *req);
+// POST /api/config/limits
+esp_err_t limits_post_handler(httpd_req_t *req, const api_limits_post_in_t *in);
+
+#endif /* MAIN_API_GEN_H_ */
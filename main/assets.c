@@ -0,0 +1,337 @@
+/*
+ * assets.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_crc.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "sys/param.h"
+
+#include "assets.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "assets";
+
+// Flash is read and sent in pieces of this size, from the httpd task stack
+#define ASSETS_CHUNK_SIZE			1024
+#define ASSETS_SECTOR_SIZE			4096
+
+typedef struct assets_type
+{
+	const char *ext;
+	const char *type;
+} assets_type_t;
+
+static const assets_type_t g_types[] = {
+		{ ".html", "text/html" },
+		{ ".js", "application/javascript" },
+		{ ".css", "text/css" },
+		{ ".ico", "image/x-icon" },
+		{ ".png", "image/png" },
+		{ ".svg", "image/svg+xml" },
+		{ ".json", "application/json" },
+		{ ".txt", "text/plain" },
+};
+
+static const esp_partition_t *g_partition = NULL;
+static assets_header_t g_header;
+static assets_entry_t g_index[ASSETS_MAX_FILES];
+static bool g_valid = false;
+static uint32_t g_served = 0;
+static uint32_t g_not_modified = 0;
+
+// Upload in progress
+static size_t g_update_size = 0;
+static size_t g_update_written = 0;
+
+/**
+ * Reads and checks the image on the partition, fills the index.
+ */
+static esp_err_t assets_load(void)
+{
+	uint8_t buf[ASSETS_CHUNK_SIZE];
+	esp_err_t err;
+
+	g_valid = false;
+
+	err = esp_partition_read(g_partition, 0, &g_header, sizeof(g_header));
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+	if (g_header.magic != ASSETS_MAGIC)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+	if (g_header.version != ASSETS_VERSION || g_header.count > ASSETS_MAX_FILES)
+	{
+		return ESP_ERR_INVALID_VERSION;
+	}
+	if (g_header.size > g_partition->size
+			|| g_header.size < sizeof(g_header) + g_header.count * sizeof(assets_entry_t))
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	uint32_t crc = 0;
+	for (uint32_t offset = sizeof(g_header); offset < g_header.size; offset += sizeof(buf))
+	{
+		size_t len = MIN(sizeof(buf), g_header.size - offset);
+
+		err = esp_partition_read(g_partition, offset, buf, len);
+		if (err != ESP_OK)
+		{
+			return err;
+		}
+		crc = esp_crc32_le(crc, buf, len);
+	}
+	if (crc != g_header.crc)
+	{
+		return ESP_ERR_INVALID_CRC;
+	}
+
+	err = esp_partition_read(g_partition, sizeof(g_header), g_index, g_header.count * sizeof(assets_entry_t));
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+	for (int i = 0; i < g_header.count; i++)
+	{
+		assets_entry_t *e = &g_index[i];
+
+		if (e->path[0] != '/' || memchr(e->path, '\0', sizeof(e->path)) == NULL
+				|| e->offset > g_header.size || e->size > g_header.size - e->offset)
+		{
+			return ESP_ERR_INVALID_ARG;
+		}
+	}
+
+	g_valid = true;
+	return ESP_OK;
+}
+
+void assets_init(void)
+{
+	g_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, ASSETS_PARTITION_LABEL);
+	if (g_partition == NULL)
+	{
+		ESP_LOGW(TAG, "No %s partition, serving the embedded web page", ASSETS_PARTITION_LABEL);
+		return;
+	}
+
+	esp_err_t err = assets_load();
+	if (err == ESP_OK)
+	{
+		ESP_LOGI(TAG, "%u files, %lu bytes, crc %08lx", g_header.count, (unsigned long)g_header.size, (unsigned long)g_header.crc);
+	}
+	else
+	{
+		ESP_LOGW(TAG, "No valid image (%s), serving the embedded web page", esp_err_to_name(err));
+	}
+}
+
+static const assets_entry_t *assets_find(const char *path, size_t len)
+{
+	if (len == 1 && path[0] == '/')
+	{
+		path = "/index.html";
+		len = strlen(path);
+	}
+
+	for (int i = 0; i < g_header.count; i++)
+	{
+		if (strncmp(g_index[i].path, path, len) == 0 && g_index[i].path[len] == '\0')
+		{
+			return &g_index[i];
+		}
+	}
+
+	return NULL;
+}
+
+static const char *assets_type(const char *path)
+{
+	const char *ext = strrchr(path, '.');
+
+	for (int i = 0; ext != NULL && i < sizeof(g_types) / sizeof(g_types[0]); i++)
+	{
+		if (strcmp(ext, g_types[i].ext) == 0)
+		{
+			return g_types[i].type;
+		}
+	}
+
+	return "application/octet-stream";
+}
+
+bool assets_try_serve(httpd_req_t *req, const char *path)
+{
+	char etag[12];
+	char if_none_match[12];
+	char accept_encoding[64];
+	uint8_t buf[ASSETS_CHUNK_SIZE];
+
+	if (!g_valid)
+	{
+		return false;
+	}
+
+	const assets_entry_t *file = assets_find(path, strcspn(path, "?"));
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	// Every browser sends gzip, a bare curl gets the embedded copy
+	if ((file->flags & ASSETS_FLAG_GZIP)
+			&& (httpd_req_get_hdr_value_str(req, "Accept-Encoding", accept_encoding, sizeof(accept_encoding)) != ESP_OK
+					|| strstr(accept_encoding, "gzip") == NULL))
+	{
+		return false;
+	}
+
+	snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)file->crc);
+	httpd_resp_set_hdr(req, "ETag", etag);
+	httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+	if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK
+			&& strcmp(if_none_match, etag) == 0)
+	{
+		g_not_modified++;
+		httpd_resp_set_status(req, "304 Not Modified");
+		httpd_resp_send(req, NULL, 0);
+		return true;
+	}
+
+	httpd_resp_set_type(req, assets_type(file->path));
+	if (file->flags & ASSETS_FLAG_GZIP)
+	{
+		httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+		httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+	}
+
+	// The headers go out with the first chunk, while etag is still in scope
+	for (uint32_t sent = 0; sent < file->size; )
+	{
+		size_t len = MIN(sizeof(buf), file->size - sent);
+
+		if (esp_partition_read(g_partition, file->offset + sent, buf, len) != ESP_OK
+				|| httpd_resp_send_chunk(req, (const char *)buf, len) != ESP_OK)
+		{
+			ESP_LOGW(TAG, "%s aborted after %lu bytes", file->path, (unsigned long)sent);
+			httpd_resp_send_chunk(req, NULL, 0);
+			return true;
+		}
+		sent += len;
+	}
+	httpd_resp_send_chunk(req, NULL, 0);
+	g_served++;
+
+	return true;
+}
+
+esp_err_t assets_update_begin(size_t size)
+{
+	if (g_partition == NULL)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+	if (size < sizeof(assets_header_t) || size > g_partition->size)
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	g_valid = false;
+	g_update_size = size;
+	g_update_written = 0;
+
+	return ESP_OK;
+}
+
+esp_err_t assets_update_write(const void *data, size_t len)
+{
+	if (len > g_update_size - g_update_written)
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	// Erase the sectors this part reaches into, the first write of a sector starts at its beginning
+	size_t erased = (g_update_written + ASSETS_SECTOR_SIZE - 1) / ASSETS_SECTOR_SIZE * ASSETS_SECTOR_SIZE;
+	size_t end = g_update_written + len;
+	if (end > erased)
+	{
+		size_t erase_len = (end - erased + ASSETS_SECTOR_SIZE - 1) / ASSETS_SECTOR_SIZE * ASSETS_SECTOR_SIZE;
+		esp_err_t err = esp_partition_erase_range(g_partition, erased, erase_len);
+		if (err != ESP_OK)
+		{
+			return err;
+		}
+	}
+
+	esp_err_t err = esp_partition_write(g_partition, g_update_written, data, len);
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+	g_update_written = end;
+
+	return ESP_OK;
+}
+
+esp_err_t assets_update_end(bool complete)
+{
+	esp_err_t err = ESP_ERR_INVALID_SIZE;
+
+	if (g_partition == NULL)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+	if (complete && g_update_written == g_update_size)
+	{
+		err = assets_load();
+	}
+	g_update_size = 0;
+
+	if (err != ESP_OK)
+	{
+		ESP_LOGW(TAG, "Update failed (%s)", esp_err_to_name(err));
+		// Leave no half image behind, the embedded page is served instead
+		esp_partition_erase_range(g_partition, 0, ASSETS_SECTOR_SIZE);
+		g_header.count = 0;
+		return err;
+	}
+
+	ESP_LOGI(TAG, "Updated: %u files, %lu bytes, crc %08lx", g_header.count, (unsigned long)g_header.size, (unsigned long)g_header.crc);
+	g_served = 0;
+	g_not_modified = 0;
+
+	return ESP_OK;
+}
+
+void assets_get_info(assets_info_t *info)
+{
+	memset(info, 0, sizeof(*info));
+
+	info->partition = g_partition != NULL;
+	info->capacity = g_partition != NULL ? g_partition->size : 0;
+	info->valid = g_valid;
+	if (g_valid)
+	{
+		info->count = g_header.count;
+		info->size = g_header.size;
+		info->crc = g_header.crc;
+	}
+	info->served = g_served;
+	info->not_modified = g_not_modified;
+}
+
+const assets_entry_t *assets_get_entry(int i)
+{
+	return g_valid && i >= 0 && i < g_header.count ? &g_index[i] : NULL;
+}
@@ -0,0 +1,123 @@
+/*
+ * assets.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_ASSETS_H_
+#define MAIN_ASSETS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+/*
+ * Web page files on the "assets" data partition, so a UI change is a small upload
+ * (POST /api/assets/update) instead of a firmware OTA.
+ * The partition holds one image built by tools/pack_assets.py:
+ *   header   assets_header_t
+ *   index    assets_entry_t[count]
+ *   data     the files, each gzip compressed unless that made it larger
+ * The header and index are loaded into RAM once, files are streamed from flash in chunks.
+ * An erased partition or an image with a bad CRC is ignored, the firmware then serves
+ * its embedded copy (CONFIG_HTTP_ASSETS_EMBEDDED).
+ * Serving and updating both run in the httpd task, so the index needs no lock.
+ */
+
+#define ASSETS_PARTITION_LABEL		"assets"
+#define ASSETS_MAGIC				0x31534157	///> "WAS1"
+#define ASSETS_VERSION				1
+#define ASSETS_MAX_FILES			24
+#define ASSETS_PATH_SIZE			40
+
+#define ASSETS_FLAG_GZIP			0x01
+
+/**
+ * Image header, little endian like the ESP32.
+ */
+typedef struct __attribute__((packed)) assets_header
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t count;						///> Index entries
+	uint32_t size;						///> Whole image, header included
+	uint32_t crc;						///> CRC32 of everything after the header
+} assets_header_t;
+
+/**
+ * Index entry of one file.
+ */
+typedef struct __attribute__((packed)) assets_entry
+{
+	char path[ASSETS_PATH_SIZE];		///> URI path, e.g. "/app.js", NUL terminated
+	uint32_t offset;					///> From the start of the image
+	uint32_t size;						///> Stored size
+	uint32_t crc;						///> CRC32 of the stored bytes, sent as ETag
+	uint32_t flags;						///> ASSETS_FLAG_*
+} assets_entry_t;
+
+_Static_assert(sizeof(assets_header_t) == 16, "assets_header_t must match tools/pack_assets.py");
+_Static_assert(sizeof(assets_entry_t) == 56, "assets_entry_t must match tools/pack_assets.py");
+
+/**
+ * State of the partition, for GET /api/assets
+ */
+typedef struct assets_info
+{
+	bool partition;						///> Partition present in the partition table
+	bool valid;							///> Holds a valid image
+	uint16_t count;
+	uint32_t size;						///> Image size
+	uint32_t capacity;					///> Partition size
+	uint32_t crc;						///> Image CRC, identifies a deploy
+	uint32_t served;					///> Files sent from the partition
+	uint32_t not_modified;				///> 304 sent
+} assets_info_t;
+
+/**
+ * Finds the partition and loads the index of its image. Call before the server starts.
+ */
+void assets_init(void);
+
+/**
+ * Answers a GET from the partition: 304 if If-None-Match is the file's ETag, else 200 streamed
+ * in chunks with ETag and Cache-Control: no-cache.
+ * @param path URI path, "/" is /index.html, a query string is ignored.
+ * @return false if the image has no such file or the client does not take gzip, the caller falls back.
+ */
+bool assets_try_serve(httpd_req_t *req, const char *path);
+
+/**
+ * Starts replacing the image. The partition is not served until assets_update_end succeeds.
+ * @param size of the new image.
+ * @return ESP_ERR_NOT_FOUND without a partition, ESP_ERR_INVALID_SIZE if the image does not fit.
+ */
+esp_err_t assets_update_begin(size_t size);
+
+/**
+ * Writes the next part of the image, erasing flash sectors as they are reached.
+ */
+esp_err_t assets_update_write(const void *data, size_t len);
+
+/**
+ * Checks the written image and serves it.
+ * @param complete false if the upload broke off.
+ * @return ESP_OK, or an error if the image is not valid (the partition is then left empty).
+ */
+esp_err_t assets_update_end(bool complete);
+
+/**
+ * Gets the state of the partition.
+ */
+void assets_get_info(assets_info_t *info);
+
+/**
+ * Index entry i of the image in use, NULL past the end.
+ */
+const assets_entry_t *assets_get_entry(int i);
+
+#endif /* MAIN_ASSETS_H_ */
@@ -0,0 +1,436 @@
+/*
+ * auth.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "mbedtls/constant_time.h"
+#include "mbedtls/pkcs5.h"
+#include "sdkconfig.h"
+
+#include "auth.h"
+#include "nvs_utils.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "auth";
+
+// Hash buckets, a power of two with at least twice as many buckets as sessions keeps chains short
+#define AUTH_BUCKET_COUNT			32
+#define AUTH_NONE					0xFF
+#define AUTH_IDLE_TIMEOUT_US		((int64_t)CONFIG_AUTH_SESSION_IDLE_TIMEOUT_S * 1000000)
+
+_Static_assert(CONFIG_AUTH_MAX_SESSIONS * 2 <= AUTH_BUCKET_COUNT, "AUTH_BUCKET_COUNT too small for CONFIG_AUTH_MAX_SESSIONS");
+
+/**
+ * A session slot. Live slots are on a bucket chain and on the LRU list, free slots on the free list (next).
+ */
+typedef struct auth_session
+{
+	uint8_t token[AUTH_TOKEN_SIZE];
+	int64_t last_used_us;
+	uint8_t next;						///> Next slot in the bucket chain or the free list
+	uint8_t lru_prev;					///> More recently used neighbour
+	uint8_t lru_next;					///> Less recently used neighbour
+} auth_session_t;
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static auth_session_t g_sessions[CONFIG_AUTH_MAX_SESSIONS];
+static uint8_t g_buckets[AUTH_BUCKET_COUNT];
+static uint8_t g_free;
+static uint8_t g_lru_head;				///> Most recently used
+static uint8_t g_lru_tail;				///> Least recently used, evicted first
+static auth_stats_t g_stats;
+static bool g_initialized = false;
+
+// Credentials from the config record
+static nvs_auth_t g_auth;
+
+/**
+ * Empties the session table. Called with g_lock held.
+ */
+static void auth_reset_sessions(void)
+{
+	memset(g_buckets, AUTH_NONE, sizeof(g_buckets));
+	for (int i = 0; i < CONFIG_AUTH_MAX_SESSIONS; i++)
+	{
+		g_sessions[i].next = (i + 1 < CONFIG_AUTH_MAX_SESSIONS) ? i + 1 : AUTH_NONE;
+	}
+	g_free = 0;
+	g_lru_head = g_lru_tail = AUTH_NONE;
+	g_stats.active = 0;
+}
+
+/**
+ * The token is random, its first bytes are as good as any hash of it.
+ */
+static uint8_t auth_bucket(const uint8_t *token)
+{
+	return (token[0] | (token[1] << 8)) & (AUTH_BUCKET_COUNT - 1);
+}
+
+static bool auth_token_decode(const char *hex, uint8_t *token)
+{
+	if (hex == NULL || strlen(hex) != AUTH_TOKEN_HEX_LEN)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < AUTH_TOKEN_HEX_LEN; i++)
+	{
+		char c = hex[i];
+		uint8_t nibble;
+
+		if (c >= '0' && c <= '9')
+		{
+			nibble = c - '0';
+		}
+		else if (c >= 'a' && c <= 'f')
+		{
+			nibble = c - 'a' + 10;
+		}
+		else if (c >= 'A' && c <= 'F')
+		{
+			nibble = c - 'A' + 10;
+		}
+		else
+		{
+			return false;
+		}
+		token[i / 2] = (i % 2) ? (token[i / 2] | nibble) : (nibble << 4);
+	}
+
+	return true;
+}
+
+static void auth_token_encode(const uint8_t *token, char *hex)
+{
+	static const char digits[] = "0123456789abcdef";
+
+	for (int i = 0; i < AUTH_TOKEN_SIZE; i++)
+	{
+		hex[2 * i] = digits[token[i] >> 4];
+		hex[2 * i + 1] = digits[token[i] & 0x0F];
+	}
+	hex[AUTH_TOKEN_HEX_LEN] = '\0';
+}
+
+/**
+ * Finds the slot of a token. Called with g_lock held.
+ * @return slot index or AUTH_NONE.
+ */
+static uint8_t auth_find(const uint8_t *token)
+{
+	for (uint8_t i = g_buckets[auth_bucket(token)]; i != AUTH_NONE; i = g_sessions[i].next)
+	{
+		// Constant time, the response time must not tell how much of a guessed token was right
+		if (mbedtls_ct_memcmp(g_sessions[i].token, token, AUTH_TOKEN_SIZE) == 0)
+		{
+			return i;
+		}
+	}
+
+	return AUTH_NONE;
+}
+
+static void auth_lru_unlink(uint8_t i)
+{
+	auth_session_t *s = &g_sessions[i];
+
+	if (s->lru_prev != AUTH_NONE)
+	{
+		g_sessions[s->lru_prev].lru_next = s->lru_next;
+	}
+	else
+	{
+		g_lru_head = s->lru_next;
+	}
+	if (s->lru_next != AUTH_NONE)
+	{
+		g_sessions[s->lru_next].lru_prev = s->lru_prev;
+	}
+	else
+	{
+		g_lru_tail = s->lru_prev;
+	}
+}
+
+static void auth_lru_push_front(uint8_t i)
+{
+	g_sessions[i].lru_prev = AUTH_NONE;
+	g_sessions[i].lru_next = g_lru_head;
+	if (g_lru_head != AUTH_NONE)
+	{
+		g_sessions[g_lru_head].lru_prev = i;
+	}
+	g_lru_head = i;
+	if (g_lru_tail == AUTH_NONE)
+	{
+		g_lru_tail = i;
+	}
+}
+
+/**
+ * Removes a live slot from its bucket and the LRU list and frees it. Called with g_lock held.
+ */
+static void auth_remove(uint8_t i)
+{
+	uint8_t *link = &g_buckets[auth_bucket(g_sessions[i].token)];
+
+	while (*link != i)
+	{
+		link = &g_sessions[*link].next;
+	}
+	*link = g_sessions[i].next;
+
+	auth_lru_unlink(i);
+	memset(g_sessions[i].token, 0, AUTH_TOKEN_SIZE);
+	g_sessions[i].next = g_free;
+	g_free = i;
+	g_stats.active--;
+}
+
+/**
+ * Adds a session, evicting the least recently used one if the table is full. Called with g_lock held.
+ */
+static void auth_insert(const uint8_t *token, int64_t now)
+{
+	if (g_free == AUTH_NONE)
+	{
+		if (now - g_sessions[g_lru_tail].last_used_us > AUTH_IDLE_TIMEOUT_US)
+		{
+			g_stats.expired++;
+		}
+		else
+		{
+			g_stats.evicted++;
+		}
+		auth_remove(g_lru_tail);
+	}
+
+	uint8_t i = g_free;
+	uint8_t bucket = auth_bucket(token);
+
+	g_free = g_sessions[i].next;
+	memcpy(g_sessions[i].token, token, AUTH_TOKEN_SIZE);
+	g_sessions[i].last_used_us = now;
+	g_sessions[i].next = g_buckets[bucket];
+	g_buckets[bucket] = i;
+	auth_lru_push_front(i);
+	g_stats.active++;
+}
+
+static esp_err_t auth_hash(const char *password, const uint8_t *salt, uint32_t iterations, uint8_t *hash)
+{
+	int ret = mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA256,
+			(const unsigned char *)password, strlen(password),
+			salt, sizeof(g_auth.salt), iterations, sizeof(g_auth.hash), hash);
+
+	return ret == 0 ? ESP_OK : ESP_FAIL;
+}
+
+void auth_init(void)
+{
+	nvs_config_t cfg;
+
+	if (g_initialized)
+	{
+		return;
+	}
+
+	nvs_config_get(&cfg);
+	cfg.auth.user[sizeof(cfg.auth.user) - 1] = '\0';
+
+	taskENTER_CRITICAL(&g_lock);
+	g_auth = cfg.auth;
+	auth_reset_sessions();
+	g_initialized = true;
+	taskEXIT_CRITICAL(&g_lock);
+
+	ESP_LOGI(TAG, "%s", g_auth.iterations ? "API login required" : "No credentials set, API open");
+}
+
+void auth_reload(void)
+{
+	nvs_config_t cfg;
+
+	nvs_config_get(&cfg);
+	cfg.auth.user[sizeof(cfg.auth.user) - 1] = '\0';
+
+	taskENTER_CRITICAL(&g_lock);
+	bool changed = memcmp(&g_auth, &cfg.auth, sizeof(g_auth)) != 0;
+	if (changed)
+	{
+		g_auth = cfg.auth;
+		auth_reset_sessions();
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	if (changed)
+	{
+		ESP_LOGI(TAG, "%s", g_auth.iterations ? "Credentials replaced, sessions ended" : "No credentials set, API open");
+	}
+}
+
+bool auth_is_enabled(void)
+{
+	return g_auth.iterations != 0;
+}
+
+/**
+ * nvs_config_update function: replaces the credentials with ctx (nvs_auth_t).
+ */
+static bool auth_store(nvs_config_t *cfg, void *ctx)
+{
+	cfg->auth = *(const nvs_auth_t *)ctx;
+	return true;
+}
+
+esp_err_t auth_set_credentials(const char *user, const char *password)
+{
+	nvs_auth_t auth = { .iterations = CONFIG_AUTH_PBKDF2_ITERATIONS };
+
+	if (user == NULL || password == NULL
+			|| user[0] == '\0' || strlen(user) > AUTH_USER_MAX_LEN
+			|| password[0] == '\0' || strlen(password) > AUTH_PASSWORD_MAX_LEN)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	strcpy(auth.user, user);
+	esp_fill_random(auth.salt, sizeof(auth.salt));
+	if (auth_hash(password, auth.salt, auth.iterations, auth.hash) != ESP_OK)
+	{
+		return ESP_FAIL;
+	}
+
+	esp_err_t err = nvs_config_update(auth_store, &auth);
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+
+	// Old tokens belong to the old credentials
+	taskENTER_CRITICAL(&g_lock);
+	g_auth = auth;
+	auth_reset_sessions();
+	taskEXIT_CRITICAL(&g_lock);
+
+	ESP_LOGI(TAG, "Credentials set for '%s'", user);
+	return ESP_OK;
+}
+
+esp_err_t auth_login(const char *user, const char *password, char token[AUTH_TOKEN_HEX_LEN + 1])
+{
+	nvs_auth_t auth;
+	char user_buf[sizeof(auth.user)] = { 0 };
+	uint8_t hash[sizeof(auth.hash)];
+	uint8_t raw[AUTH_TOKEN_SIZE];
+
+	taskENTER_CRITICAL(&g_lock);
+	auth = g_auth;
+	taskEXIT_CRITICAL(&g_lock);
+
+	if (auth.iterations == 0)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	// Hash even for an unknown user, so the response time doesn't reveal valid user names
+	strncpy(user_buf, user, sizeof(user_buf) - 1);
+	if (auth_hash(password, auth.salt, auth.iterations, hash) != ESP_OK)
+	{
+		return ESP_FAIL;
+	}
+	bool ok = (mbedtls_ct_memcmp(user_buf, auth.user, sizeof(user_buf)) == 0)
+			& (mbedtls_ct_memcmp(hash, auth.hash, sizeof(hash)) == 0);
+
+	if (!ok)
+	{
+		taskENTER_CRITICAL(&g_lock);
+		g_stats.login_failures++;
+		taskEXIT_CRITICAL(&g_lock);
+		ESP_LOGW(TAG, "Login failed for '%s'", user_buf);
+		return ESP_FAIL;
+	}
+
+	esp_fill_random(raw, sizeof(raw));
+
+	taskENTER_CRITICAL(&g_lock);
+	auth_insert(raw, esp_timer_get_time());
+	g_stats.logins++;
+	taskEXIT_CRITICAL(&g_lock);
+
+	auth_token_encode(raw, token);
+	return ESP_OK;
+}
+
+bool auth_authorize(const char *token)
+{
+	uint8_t raw[AUTH_TOKEN_SIZE];
+	bool ok = false;
+
+	if (!auth_is_enabled())
+	{
+		return true;
+	}
+
+	bool valid = auth_token_decode(token, raw);
+	int64_t now = esp_timer_get_time();
+
+	taskENTER_CRITICAL(&g_lock);
+	uint8_t i = valid ? auth_find(raw) : AUTH_NONE;
+	if (i != AUTH_NONE)
+	{
+		if (now - g_sessions[i].last_used_us > AUTH_IDLE_TIMEOUT_US)
+		{
+			auth_remove(i);
+			g_stats.expired++;
+		}
+		else
+		{
+			g_sessions[i].last_used_us = now;
+			auth_lru_unlink(i);
+			auth_lru_push_front(i);
+			ok = true;
+		}
+	}
+	if (!ok)
+	{
+		g_stats.rejected++;
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	return ok;
+}
+
+void auth_logout(const char *token)
+{
+	uint8_t raw[AUTH_TOKEN_SIZE];
+
+	if (!auth_token_decode(token, raw))
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL(&g_lock);
+	uint8_t i = auth_find(raw);
+	if (i != AUTH_NONE)
+	{
+		auth_remove(i);
+	}
+	taskEXIT_CRITICAL(&g_lock);
+}
+
+void auth_get_stats(auth_stats_t *stats)
+{
+	taskENTER_CRITICAL(&g_lock);
+	*stats = g_stats;
+	taskEXIT_CRITICAL(&g_lock);
+}
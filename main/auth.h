@@ -0,0 +1,103 @@
+/*
+ * auth.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_AUTH_H_
+#define MAIN_AUTH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * Login for the REST API.
+ * The password is checked once per login against a PBKDF2-HMAC-SHA256 hash kept in the config record.
+ * A successful login hands out a random 128-bit session token. Every further request is authorized
+ * by looking the token up in a fixed-size hash table, which takes microseconds and no hashing.
+ * Sessions expire after CONFIG_AUTH_SESSION_IDLE_TIMEOUT_S without use. When the table is full,
+ * a new login evicts the least recently used session.
+ * Until credentials are set the API stays open, as in earlier firmware.
+ *
+ * UDP control frames (udp_ctrl.h) carry no credentials, so they are refused while a login is set.
+ * MQTT commands (mqtt_app.h) rely on the access control of the broker: any client of the broker
+ * can switch the LEDs. Disable CONFIG_MQTT_APP_ENABLE where that is not acceptable.
+ */
+
+#define AUTH_TOKEN_SIZE				16
+#define AUTH_TOKEN_HEX_LEN			(AUTH_TOKEN_SIZE * 2)
+
+// Longest user name and password accepted by auth_set_credentials
+#define AUTH_USER_MAX_LEN			32
+#define AUTH_PASSWORD_MAX_LEN		64
+
+// PBKDF2 cost accepted with an imported hash: below, the hash is cheap to attack, above, every
+// login would hold the httpd task for many times the configured cost
+#define AUTH_PBKDF2_ITERATIONS_MIN	1000
+#define AUTH_PBKDF2_ITERATIONS_MAX	(10 * CONFIG_AUTH_PBKDF2_ITERATIONS)
+
+/**
+ * Session table counters, for /api/metrics
+ */
+typedef struct auth_stats
+{
+	uint32_t logins;					///> Successful logins
+	uint32_t login_failures;			///> Wrong user or password
+	uint32_t rejected;					///> Requests with a missing, unknown or expired token
+	uint32_t evicted;					///> Sessions dropped for a new login, least recently used first
+	uint32_t expired;					///> Sessions dropped after the idle timeout
+	uint8_t active;						///> Sessions in the table
+} auth_stats_t;
+
+/**
+ * Prepares the session table. Call before the HTTP server starts.
+ */
+void auth_init(void);
+
+/**
+ * Takes the credentials from the config record after it was replaced as a whole (PUT /api/config).
+ * Ends all sessions if they changed.
+ */
+void auth_reload(void);
+
+/**
+ * @return true once credentials are set and requests need a token.
+ */
+bool auth_is_enabled(void);
+
+/**
+ * Stores new credentials in the config record and ends all sessions.
+ * Runs PBKDF2, takes about as long as a login.
+ * @return ESP_ERR_INVALID_ARG for an empty or too long user or password, otherwise the NVS result.
+ */
+esp_err_t auth_set_credentials(const char *user, const char *password);
+
+/**
+ * Checks user and password and opens a session.
+ * @param token set to the session token as AUTH_TOKEN_HEX_LEN hex characters and a null.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if no credentials are set, ESP_FAIL for a wrong user or password.
+ */
+esp_err_t auth_login(const char *user, const char *password, char token[AUTH_TOKEN_HEX_LEN + 1]);
+
+/**
+ * Authorizes a request: true if credentials are not set, or the token belongs to a live session.
+ * A valid token refreshes its session.
+ * @param token hex token from the Authorization header, NULL if there was none.
+ */
+bool auth_authorize(const char *token);
+
+/**
+ * Ends the session of a token, if any.
+ */
+void auth_logout(const char *token);
+
+/**
+ * Gets the session table counters.
+ */
+void auth_get_stats(auth_stats_t *stats);
+
+#endif /* MAIN_AUTH_H_ */
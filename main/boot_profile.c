@@ -0,0 +1,96 @@
+/*
+ * boot_profile.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "boot_profile.h"
+
+// Written once per field by whichever task reaches the phase first, 64-bit stores need the lock
+static boot_phase_time_t g_boot_times[BOOT_PHASE_COUNT];
+static portMUX_TYPE g_boot_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const g_boot_phase_names[BOOT_PHASE_COUNT] = {
+		[BOOT_PHASE_APP_MAIN] = "app_main",
+		[BOOT_PHASE_IO_INIT] = "io_init",
+		[BOOT_PHASE_NVS_INIT] = "nvs_init",
+		[BOOT_PHASE_NETIF_INIT] = "netif_init",
+		[BOOT_PHASE_HTTP_SERVER_START] = "http_server_start",
+		[BOOT_PHASE_WIFI_INIT] = "wifi_init",
+		[BOOT_PHASE_AP_CONFIG] = "ap_config",
+		[BOOT_PHASE_STA_CONFIG] = "sta_config",
+		[BOOT_PHASE_WIFI_START] = "wifi_start",
+		[BOOT_PHASE_AP_STARTED] = "ap_started",
+		[BOOT_PHASE_FIRST_HTTP_RESPONSE] = "first_http_response",
+		[BOOT_PHASE_STA_GOT_IP] = "sta_got_ip",
+};
+
+/**
+ * Stores now in *field unless it is already set.
+ */
+static void boot_profile_record(int64_t *field)
+{
+	int64_t now = esp_timer_get_time();
+
+	taskENTER_CRITICAL(&g_boot_lock);
+	if (*field == 0)
+	{
+		*field = now;
+	}
+	taskEXIT_CRITICAL(&g_boot_lock);
+}
+
+void boot_profile_begin(boot_phase_e phase)
+{
+	if (phase < BOOT_PHASE_COUNT)
+	{
+		boot_profile_record(&g_boot_times[phase].begin_us);
+	}
+}
+
+void boot_profile_end(boot_phase_e phase)
+{
+	if (phase < BOOT_PHASE_COUNT)
+	{
+		boot_profile_record(&g_boot_times[phase].end_us);
+	}
+}
+
+void boot_profile_mark(boot_phase_e phase)
+{
+	if (phase < BOOT_PHASE_COUNT)
+	{
+		int64_t now = esp_timer_get_time();
+
+		taskENTER_CRITICAL(&g_boot_lock);
+		if (g_boot_times[phase].end_us == 0)
+		{
+			g_boot_times[phase].begin_us = now;
+			g_boot_times[phase].end_us = now;
+		}
+		taskEXIT_CRITICAL(&g_boot_lock);
+	}
+}
+
+boot_phase_time_t boot_profile_get(boot_phase_e phase)
+{
+	boot_phase_time_t t = { 0 };
+
+	if (phase < BOOT_PHASE_COUNT)
+	{
+		taskENTER_CRITICAL(&g_boot_lock);
+		t = g_boot_times[phase];
+		taskEXIT_CRITICAL(&g_boot_lock);
+	}
+
+	return t;
+}
+
+const char* boot_profile_phase_name(boot_phase_e phase)
+{
+	return phase < BOOT_PHASE_COUNT ? g_boot_phase_names[phase] : "unknown";
+}
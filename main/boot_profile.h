@@ -0,0 +1,68 @@
+/*
+ * boot_profile.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_BOOT_PROFILE_H_
+#define MAIN_BOOT_PROFILE_H_
+
+#include <stdint.h>
+
+/**
+ * Boot phases and milestones, in the order they are expected to complete.
+ * Milestones are points in time: their begin and end are the same.
+ */
+typedef enum boot_phase
+{
+	BOOT_PHASE_APP_MAIN = 0,			// Milestone: app_main entered
+	BOOT_PHASE_IO_INIT,
+	BOOT_PHASE_NVS_INIT,				// NVS flash init + config record load
+	BOOT_PHASE_NETIF_INIT,				// TCP/IP stack + default event loop
+	BOOT_PHASE_HTTP_SERVER_START,		// Runs in app_main while the WiFi task brings up WiFi
+	BOOT_PHASE_WIFI_INIT,
+	BOOT_PHASE_AP_CONFIG,
+	BOOT_PHASE_STA_CONFIG,
+	BOOT_PHASE_WIFI_START,
+	BOOT_PHASE_AP_STARTED,				// Milestone: SoftAP up, pages can be served
+	BOOT_PHASE_FIRST_HTTP_RESPONSE,		// Milestone: index.html served for the first time
+	BOOT_PHASE_STA_GOT_IP,				// Milestone: first STA IP
+	BOOT_PHASE_COUNT
+} boot_phase_e;
+
+/**
+ * Timestamps of one phase, esp_timer time (us since reset), 0 = not reached yet.
+ */
+typedef struct boot_phase_time
+{
+	int64_t begin_us;
+	int64_t end_us;
+} boot_phase_time_t;
+
+/**
+ * Records the start of a phase. Only the first call per phase counts.
+ */
+void boot_profile_begin(boot_phase_e phase);
+
+/**
+ * Records the end of a phase. Only the first call per phase counts.
+ */
+void boot_profile_end(boot_phase_e phase);
+
+/**
+ * Records a milestone (begin = end = now). Only the first call per phase counts.
+ */
+void boot_profile_mark(boot_phase_e phase);
+
+/**
+ * Gets the timestamps of a phase.
+ */
+boot_phase_time_t boot_profile_get(boot_phase_e phase);
+
+/**
+ * @return short name of a phase, e.g. "nvs_init".
+ */
+const char* boot_profile_phase_name(boot_phase_e phase);
+
+#endif /* MAIN_BOOT_PROFILE_H_ */
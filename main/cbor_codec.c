@@ -0,0 +1,332 @@
+/*
+ * cbor_codec.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "cbor_codec.h"
+
+// Additional information of the initial byte
+#define CBOR_AI_1BYTE				24
+#define CBOR_AI_8BYTE				27
+
+#define CBOR_SIMPLE_FALSE			20
+#define CBOR_SIMPLE_TRUE			21
+#define CBOR_SIMPLE_NULL			22
+
+static bool cbor_fail(cbor_reader_t *r)
+{
+	r->error = true;
+	return false;
+}
+
+/**
+ * Reads the initial byte and the argument that follows it.
+ */
+static bool cbor_read_head(cbor_reader_t *r, uint8_t *major, uint64_t *arg)
+{
+	if (r->error || r->p >= r->end)
+	{
+		return cbor_fail(r);
+	}
+
+	uint8_t ib = *r->p++;
+	uint8_t ai = ib & 0x1f;
+
+	*major = ib >> 5;
+	if (ai < CBOR_AI_1BYTE)
+	{
+		*arg = ai;
+		return true;
+	}
+	if (ai > CBOR_AI_8BYTE)
+	{
+		// Indefinite lengths and reserved values
+		return cbor_fail(r);
+	}
+
+	size_t n = 1u << (ai - CBOR_AI_1BYTE);
+	if ((size_t)(r->end - r->p) < n)
+	{
+		return cbor_fail(r);
+	}
+
+	*arg = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		*arg = (*arg << 8) | *r->p++;
+	}
+	return true;
+}
+
+static bool cbor_read_expect(cbor_reader_t *r, uint8_t expected, uint64_t *arg)
+{
+	uint8_t major;
+
+	if (!cbor_read_head(r, &major, arg))
+	{
+		return false;
+	}
+	if (major != expected)
+	{
+		return cbor_fail(r);
+	}
+	return true;
+}
+
+static bool cbor_read_string(cbor_reader_t *r, uint8_t major, const uint8_t **data, size_t *len)
+{
+	uint64_t n;
+
+	if (!cbor_read_expect(r, major, &n))
+	{
+		return false;
+	}
+	if (n > (uint64_t)(r->end - r->p))
+	{
+		return cbor_fail(r);
+	}
+
+	*data = r->p;
+	*len = n;
+	r->p += n;
+	return true;
+}
+
+void cbor_reader_init(cbor_reader_t *r, const uint8_t *buf, size_t len)
+{
+	r->p = buf;
+	r->end = buf + len;
+	r->error = false;
+}
+
+cbor_type_e cbor_peek(cbor_reader_t *r)
+{
+	if (r->error || r->p >= r->end)
+	{
+		return CBOR_TYPE_INVALID;
+	}
+
+	uint8_t major = *r->p >> 5;
+	uint8_t ai = *r->p & 0x1f;
+
+	if (major == CBOR_TYPE_SIMPLE)
+	{
+		if (ai == CBOR_SIMPLE_FALSE || ai == CBOR_SIMPLE_TRUE)
+		{
+			return CBOR_TYPE_BOOL;
+		}
+		if (ai == CBOR_SIMPLE_NULL)
+		{
+			return CBOR_TYPE_NULL;
+		}
+	}
+	return (cbor_type_e)major;
+}
+
+bool cbor_read_uint(cbor_reader_t *r, uint64_t *value)
+{
+	return cbor_read_expect(r, CBOR_TYPE_UINT, value);
+}
+
+bool cbor_read_bool(cbor_reader_t *r, bool *value)
+{
+	if (cbor_peek(r) != CBOR_TYPE_BOOL)
+	{
+		return cbor_fail(r);
+	}
+
+	*value = (*r->p++ & 0x1f) == CBOR_SIMPLE_TRUE;
+	return true;
+}
+
+bool cbor_read_null(cbor_reader_t *r)
+{
+	if (cbor_peek(r) != CBOR_TYPE_NULL)
+	{
+		return cbor_fail(r);
+	}
+
+	r->p++;
+	return true;
+}
+
+bool cbor_read_text(cbor_reader_t *r, const char **str, size_t *len)
+{
+	return cbor_read_string(r, CBOR_TYPE_TEXT, (const uint8_t **)str, len);
+}
+
+bool cbor_read_bytes(cbor_reader_t *r, const uint8_t **bytes, size_t *len)
+{
+	return cbor_read_string(r, CBOR_TYPE_BYTES, bytes, len);
+}
+
+bool cbor_read_array(cbor_reader_t *r, uint32_t *count)
+{
+	uint64_t n;
+
+	// Every item takes at least a byte, a larger count can't be valid
+	if (!cbor_read_expect(r, CBOR_TYPE_ARRAY, &n) || n > (uint64_t)(r->end - r->p))
+	{
+		return cbor_fail(r);
+	}
+
+	*count = n;
+	return true;
+}
+
+bool cbor_read_map(cbor_reader_t *r, uint32_t *pairs)
+{
+	uint64_t n;
+
+	if (!cbor_read_expect(r, CBOR_TYPE_MAP, &n) || n > (uint64_t)(r->end - r->p) / 2)
+	{
+		return cbor_fail(r);
+	}
+
+	*pairs = n;
+	return true;
+}
+
+static bool cbor_skip_depth(cbor_reader_t *r, int depth)
+{
+	uint8_t major;
+	uint64_t arg;
+
+	if (depth > CBOR_MAX_DEPTH || !cbor_read_head(r, &major, &arg))
+	{
+		return cbor_fail(r);
+	}
+
+	switch (major)
+	{
+		case CBOR_TYPE_BYTES:
+		case CBOR_TYPE_TEXT:
+			if (arg > (uint64_t)(r->end - r->p))
+			{
+				return cbor_fail(r);
+			}
+			r->p += arg;
+			return true;
+
+		case CBOR_TYPE_MAP:
+			if (arg > (uint64_t)(r->end - r->p) / 2)
+			{
+				return cbor_fail(r);
+			}
+			arg *= 2;
+			// fall through
+		case CBOR_TYPE_ARRAY:
+			for (uint64_t i = 0; i < arg; i++)
+			{
+				if (!cbor_skip_depth(r, depth + 1))
+				{
+					return false;
+				}
+			}
+			return true;
+
+		case CBOR_TYPE_TAG:
+			return cbor_skip_depth(r, depth + 1);
+
+		default:
+			// Integers and simple values are all head
+			return true;
+	}
+}
+
+bool cbor_skip(cbor_reader_t *r)
+{
+	return cbor_skip_depth(r, 0);
+}
+
+bool cbor_reader_done(const cbor_reader_t *r)
+{
+	return !r->error && r->p == r->end;
+}
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t size)
+{
+	w->buf = buf;
+	w->size = size;
+	w->len = 0;
+	w->overflow = false;
+}
+
+static void cbor_put_raw(cbor_writer_t *w, const void *data, size_t len)
+{
+	if (w->overflow || len > w->size - w->len)
+	{
+		w->overflow = true;
+		return;
+	}
+
+	memcpy(w->buf + w->len, data, len);
+	w->len += len;
+}
+
+/**
+ * Writes an initial byte with the shortest encoding of its argument.
+ */
+static void cbor_put_head(cbor_writer_t *w, uint8_t major, uint64_t arg)
+{
+	uint8_t head[9];
+	size_t n;
+
+	if (arg < CBOR_AI_1BYTE)
+	{
+		head[0] = (major << 5) | arg;
+		cbor_put_raw(w, head, 1);
+		return;
+	}
+
+	n = arg <= 0xff ? 1 : arg <= 0xffff ? 2 : arg <= 0xffffffff ? 4 : 8;
+	head[0] = (major << 5) | (CBOR_AI_1BYTE + (n == 1 ? 0 : n == 2 ? 1 : n == 4 ? 2 : 3));
+	for (size_t i = 0; i < n; i++)
+	{
+		head[n - i] = arg >> (8 * i);
+	}
+	cbor_put_raw(w, head, n + 1);
+}
+
+void cbor_put_uint(cbor_writer_t *w, uint64_t value)
+{
+	cbor_put_head(w, CBOR_TYPE_UINT, value);
+}
+
+void cbor_put_bool(cbor_writer_t *w, bool value)
+{
+	cbor_put_head(w, CBOR_TYPE_SIMPLE, value ? CBOR_SIMPLE_TRUE : CBOR_SIMPLE_FALSE);
+}
+
+void cbor_put_null(cbor_writer_t *w)
+{
+	cbor_put_head(w, CBOR_TYPE_SIMPLE, CBOR_SIMPLE_NULL);
+}
+
+void cbor_put_text(cbor_writer_t *w, const char *str)
+{
+	size_t len = strlen(str);
+
+	cbor_put_head(w, CBOR_TYPE_TEXT, len);
+	cbor_put_raw(w, str, len);
+}
+
+void cbor_put_bytes(cbor_writer_t *w, const void *bytes, size_t len)
+{
+	cbor_put_head(w, CBOR_TYPE_BYTES, len);
+	cbor_put_raw(w, bytes, len);
+}
+
+void cbor_put_array(cbor_writer_t *w, uint32_t count)
+{
+	cbor_put_head(w, CBOR_TYPE_ARRAY, count);
+}
+
+void cbor_put_map(cbor_writer_t *w, uint32_t pairs)
+{
+	cbor_put_head(w, CBOR_TYPE_MAP, pairs);
+}
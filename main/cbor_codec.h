@@ -0,0 +1,102 @@
+/*
+ * cbor_codec.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_CBOR_CODEC_H_
+#define MAIN_CBOR_CODEC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Minimal CBOR (RFC 8949) for small documents in one buffer.
+ * The reader pulls one item at a time off the buffer, like a SAX parser: strings are returned
+ * as pointers into the buffer, nothing is allocated and no tree is built.
+ * Supported: unsigned integers, byte and text strings, arrays, maps, false/true/null,
+ * all with definite lengths. Negative integers, tags and floats are only skipped.
+ * Any error (truncated input, wrong type, unsupported item) sticks in the reader or writer,
+ * so a caller can run a sequence of calls and check once.
+ */
+
+#define CBOR_MAX_DEPTH				8		///> Nesting cbor_skip follows
+
+/**
+ * Major types, plus the simple values as their own types.
+ */
+typedef enum cbor_type
+{
+	CBOR_TYPE_UINT = 0,
+	CBOR_TYPE_NEGINT,
+	CBOR_TYPE_BYTES,
+	CBOR_TYPE_TEXT,
+	CBOR_TYPE_ARRAY,
+	CBOR_TYPE_MAP,
+	CBOR_TYPE_TAG,
+	CBOR_TYPE_SIMPLE,						///> Floats and other simple values
+	CBOR_TYPE_BOOL,
+	CBOR_TYPE_NULL,
+	CBOR_TYPE_INVALID						///> End of input or an error
+} cbor_type_e;
+
+typedef struct cbor_reader
+{
+	const uint8_t *p;
+	const uint8_t *end;
+	bool error;
+} cbor_reader_t;
+
+typedef struct cbor_writer
+{
+	uint8_t *buf;
+	size_t size;
+	size_t len;								///> Bytes written
+	bool overflow;							///> buf was too small, len is not valid
+} cbor_writer_t;
+
+void cbor_reader_init(cbor_reader_t *r, const uint8_t *buf, size_t len);
+
+/**
+ * @return type of the next item, without consuming it.
+ */
+cbor_type_e cbor_peek(cbor_reader_t *r);
+
+bool cbor_read_uint(cbor_reader_t *r, uint64_t *value);
+bool cbor_read_bool(cbor_reader_t *r, bool *value);
+bool cbor_read_null(cbor_reader_t *r);
+
+/**
+ * @param str set to the string inside the buffer, not null terminated.
+ */
+bool cbor_read_text(cbor_reader_t *r, const char **str, size_t *len);
+bool cbor_read_bytes(cbor_reader_t *r, const uint8_t **bytes, size_t *len);
+
+/**
+ * Reads the head of an array or map, its items (key/value pairs for a map) follow.
+ */
+bool cbor_read_array(cbor_reader_t *r, uint32_t *count);
+bool cbor_read_map(cbor_reader_t *r, uint32_t *pairs);
+
+/**
+ * Skips the next item with everything nested in it.
+ */
+bool cbor_skip(cbor_reader_t *r);
+
+/**
+ * @return true if the whole buffer was read without an error.
+ */
+bool cbor_reader_done(const cbor_reader_t *r);
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t size);
+void cbor_put_uint(cbor_writer_t *w, uint64_t value);
+void cbor_put_bool(cbor_writer_t *w, bool value);
+void cbor_put_null(cbor_writer_t *w);
+void cbor_put_text(cbor_writer_t *w, const char *str);
+void cbor_put_bytes(cbor_writer_t *w, const void *bytes, size_t len);
+void cbor_put_array(cbor_writer_t *w, uint32_t count);
+void cbor_put_map(cbor_writer_t *w, uint32_t pairs);
+
+#endif /* MAIN_CBOR_CODEC_H_ */
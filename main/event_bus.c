@@ -0,0 +1,216 @@
+/*
+ * event_bus.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "event_bus.h"
+
+/*
+ * Events live in a fixed pool of reference counted slots.
+ * Subscriber queues carry only the slot index, so publishing is a slot
+ * allocation plus one non-blocking queue send per subscriber. The last
+ * subscriber to release an event returns its slot to the free stack.
+ */
+
+static event_t g_pool[EVENT_BUS_POOL_SIZE];
+static uint8_t g_refcount[EVENT_BUS_POOL_SIZE];
+static uint8_t g_free_stack[EVENT_BUS_POOL_SIZE];
+static uint8_t g_free_top;
+
+static QueueHandle_t g_subscribers[EVENT_TOPIC_COUNT][EVENT_BUS_MAX_SUBSCRIBERS];
+static uint8_t g_subscriber_count[EVENT_TOPIC_COUNT];
+
+static event_bus_stats_t g_stats;
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void event_bus_init(void)
+{
+	taskENTER_CRITICAL(&g_lock);
+	for (uint8_t i = 0; i < EVENT_BUS_POOL_SIZE; i++)
+	{
+		g_refcount[i] = 0;
+		g_free_stack[i] = EVENT_BUS_POOL_SIZE - 1 - i;
+	}
+	g_free_top = EVENT_BUS_POOL_SIZE;
+	taskEXIT_CRITICAL(&g_lock);
+}
+
+QueueHandle_t event_bus_queue_create(static_queue_e id)
+{
+	return static_alloc_queue_create(id, sizeof(uint8_t));
+}
+
+esp_err_t event_bus_subscribe(event_topic_e topic, QueueHandle_t queue)
+{
+	esp_err_t err = ESP_OK;
+
+	if (topic >= EVENT_TOPIC_COUNT || queue == NULL)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	taskENTER_CRITICAL(&g_lock);
+	if (g_subscriber_count[topic] < EVENT_BUS_MAX_SUBSCRIBERS)
+	{
+		g_subscribers[topic][g_subscriber_count[topic]++] = queue;
+	}
+	else
+	{
+		err = ESP_ERR_NO_MEM;
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	return err;
+}
+
+/**
+ * Drops one reference, the last one frees the slot.
+ * Must be called with g_lock held.
+ */
+static void IRAM_ATTR event_bus_unref_locked(uint8_t slot)
+{
+	if (--g_refcount[slot] == 0)
+	{
+		g_free_stack[g_free_top++] = slot;
+		g_stats.pool_in_use--;
+	}
+}
+
+/**
+ * Common publish path, the queue send differs between task and ISR context.
+ * Control events may use the reserved slots and must reach every subscriber.
+ */
+static bool IRAM_ATTR event_bus_publish_common(event_topic_e topic, int id, const event_payload_t *payload, bool control, BaseType_t *higher_prio_woken)
+{
+	uint8_t slot;
+	uint8_t subscribers;
+	uint8_t delivered = 0;
+	QueueHandle_t queues[EVENT_BUS_MAX_SUBSCRIBERS];
+
+	if (topic >= EVENT_TOPIC_COUNT)
+	{
+		return false;
+	}
+
+	taskENTER_CRITICAL_SAFE(&g_lock);
+	subscribers = g_subscriber_count[topic];
+	if (subscribers == 0)
+	{
+		g_stats.dropped_no_subscriber++;
+		g_stats.dropped_control += control;
+		taskEXIT_CRITICAL_SAFE(&g_lock);
+		return false;
+	}
+	if (g_free_top <= (control ? 0 : EVENT_BUS_CONTROL_RESERVE))
+	{
+		g_stats.dropped_pool_full++;
+		g_stats.dropped_control += control;
+		taskEXIT_CRITICAL_SAFE(&g_lock);
+		return false;
+	}
+
+	slot = g_free_stack[--g_free_top];
+	// One reference per subscriber, plus one held while delivering
+	g_refcount[slot] = subscribers + 1;
+	memcpy(queues, g_subscribers[topic], sizeof(queues));
+	g_stats.published++;
+	if (++g_stats.pool_in_use > g_stats.pool_high_water)
+	{
+		g_stats.pool_high_water = g_stats.pool_in_use;
+	}
+	taskEXIT_CRITICAL_SAFE(&g_lock);
+
+	event_t *event = &g_pool[slot];
+	event->topic = topic;
+	event->id = id;
+	event->timestamp_us = esp_timer_get_time();
+	if (payload)
+	{
+		event->data = *payload;
+	}
+	else
+	{
+		memset(&event->data, 0, sizeof(event->data));
+	}
+
+	for (uint8_t i = 0; i < subscribers; i++)
+	{
+		BaseType_t sent = higher_prio_woken
+				? xQueueSendFromISR(queues[i], &slot, higher_prio_woken)
+				: xQueueSend(queues[i], &slot, 0);
+
+		taskENTER_CRITICAL_SAFE(&g_lock);
+		if (sent == pdTRUE)
+		{
+			g_stats.delivered++;
+			delivered++;
+		}
+		else
+		{
+			g_stats.dropped_queue_full++;
+			event_bus_unref_locked(slot);
+		}
+		taskEXIT_CRITICAL_SAFE(&g_lock);
+	}
+
+	taskENTER_CRITICAL_SAFE(&g_lock);
+	event_bus_unref_locked(slot);
+	if (control && delivered < subscribers)
+	{
+		g_stats.dropped_control++;
+	}
+	taskEXIT_CRITICAL_SAFE(&g_lock);
+
+	return control ? delivered == subscribers : delivered > 0;
+}
+
+bool event_bus_publish(event_topic_e topic, int id, const event_payload_t *payload)
+{
+	return event_bus_publish_common(topic, id, payload, false, NULL);
+}
+
+bool event_bus_publish_control(event_topic_e topic, int id, const event_payload_t *payload)
+{
+	return event_bus_publish_common(topic, id, payload, true, NULL);
+}
+
+bool IRAM_ATTR event_bus_publish_from_isr(event_topic_e topic, int id, const event_payload_t *payload, BaseType_t *higher_prio_woken)
+{
+	return event_bus_publish_common(topic, id, payload, false, higher_prio_woken);
+}
+
+const event_t* event_bus_receive(QueueHandle_t queue, TickType_t wait)
+{
+	uint8_t slot;
+
+	if (xQueueReceive(queue, &slot, wait) != pdTRUE)
+	{
+		return NULL;
+	}
+	return &g_pool[slot];
+}
+
+void event_bus_release(const event_t *event)
+{
+	uint8_t slot = event - g_pool;
+
+	taskENTER_CRITICAL(&g_lock);
+	event_bus_unref_locked(slot);
+	taskEXIT_CRITICAL(&g_lock);
+}
+
+void event_bus_get_stats(event_bus_stats_t *stats)
+{
+	taskENTER_CRITICAL(&g_lock);
+	*stats = g_stats;
+	taskEXIT_CRITICAL(&g_lock);
+}
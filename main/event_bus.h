@@ -0,0 +1,150 @@
+/*
+ * event_bus.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_EVENT_BUS_H_
+#define MAIN_EVENT_BUS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#include "static_alloc.h"
+
+// Events in flight at the same time (shared by all topics)
+#define EVENT_BUS_POOL_SIZE				16
+// Slots of the pool left to control events, see event_bus_publish_control
+#define EVENT_BUS_CONTROL_RESERVE		4
+// Subscriber queues per topic
+#define EVENT_BUS_MAX_SUBSCRIBERS		4
+
+/**
+ * Event topics, the event id is interpreted per topic
+ */
+typedef enum event_topic
+{
+	EVENT_TOPIC_WIFI_APP = 0,			///> id is a wifi_app_message_e
+	EVENT_TOPIC_HTTP_MONITOR,			///> id is a http_server_message_e
+	EVENT_TOPIC_COUNT
+} event_topic_e;
+
+/**
+ * Typed event payloads
+ */
+typedef union event_payload
+{
+	struct
+	{
+		uint32_t ip;					///> network byte order
+		uint32_t netmask;
+		uint32_t gw;
+	} ip;								///> WIFI_APP_MSG_STA_CONNECTED_GOT_IP
+	struct
+	{
+		uint8_t reason;					///> wifi_err_reason_t
+		int8_t rssi;
+	} sta_disconnected;					///> WIFI_APP_MSG_STA_DISCONNECTED
+	struct
+	{
+		uint32_t received;
+		uint32_t total;
+	} ota;								///> HTTP_MSG_FIRMWARE_UPDATE_*
+	uint32_t u32;
+} event_payload_t;
+
+/**
+ * Event as delivered to subscribers
+ */
+typedef struct event
+{
+	event_topic_e topic;
+	int id;
+	int64_t timestamp_us;				///> esp_timer time of publishing
+	event_payload_t data;
+} event_t;
+
+/**
+ * Bus statistics
+ */
+typedef struct event_bus_stats
+{
+	uint32_t published;					///> events accepted into the pool
+	uint32_t delivered;					///> queue deliveries (one event may have several)
+	uint32_t dropped_pool_full;			///> publish failed, no free slot
+	uint32_t dropped_queue_full;		///> delivery to one subscriber failed, its queue was full
+	uint32_t dropped_no_subscriber;		///> nobody listens on the topic (yet)
+	uint32_t dropped_control;			///> control publishes that missed a subscriber, also counted above
+	uint8_t pool_in_use;
+	uint8_t pool_high_water;
+} event_bus_stats_t;
+
+/**
+ * Initializes the pool. Call once before any other event bus function.
+ */
+void event_bus_init(void);
+
+/**
+ * Creates a subscriber queue from its static storage (see static_alloc.c for the depth).
+ * @param id static queue of the subscriber.
+ * @return queue handle, or NULL if the queue already exists.
+ */
+QueueHandle_t event_bus_queue_create(static_queue_e id);
+
+/**
+ * Subscribes a queue to a topic. One queue can subscribe to several topics.
+ * @param topic topic to subscribe to.
+ * @param queue queue from event_bus_queue_create.
+ * @return ESP_OK, or ESP_ERR_NO_MEM when the topic has EVENT_BUS_MAX_SUBSCRIBERS already.
+ */
+esp_err_t event_bus_subscribe(event_topic_e topic, QueueHandle_t queue);
+
+/**
+ * Publishes an event to every subscriber of the topic. Never blocks.
+ * @param topic event topic.
+ * @param id event id within the topic.
+ * @param payload optional payload, NULL for none.
+ * @return true if at least one subscriber got the event.
+ */
+bool event_bus_publish(event_topic_e topic, int id, const event_payload_t *payload);
+
+/**
+ * Publishes an event a subscriber's state depends on, e.g. a timer expiry or a scan result.
+ * Only control events may take the last EVENT_BUS_CONTROL_RESERVE slots of the pool, so a
+ * burst of ordinary events cannot starve them. Never blocks.
+ * A subscriber queue can still be full: the caller retries on false, the subscribers that
+ * got the event already receive it once more and must tolerate that.
+ * @return true if every subscriber got the event.
+ */
+bool event_bus_publish_control(event_topic_e topic, int id, const event_payload_t *payload);
+
+/**
+ * ISR version of event_bus_publish.
+ * @param higher_prio_woken set to pdTRUE if a context switch should be requested.
+ */
+bool event_bus_publish_from_isr(event_topic_e topic, int id, const event_payload_t *payload, BaseType_t *higher_prio_woken);
+
+/**
+ * Waits for the next event on a subscriber queue.
+ * @param queue subscriber queue.
+ * @param wait ticks to wait.
+ * @return event, which must be given back with event_bus_release, or NULL on timeout.
+ */
+const event_t* event_bus_receive(QueueHandle_t queue, TickType_t wait);
+
+/**
+ * Releases an event returned by event_bus_receive.
+ */
+void event_bus_release(const event_t *event);
+
+/**
+ * Gets a copy of the bus statistics.
+ */
+void event_bus_get_stats(event_bus_stats_t *stats);
+
+#endif /* MAIN_EVENT_BUS_H_ */
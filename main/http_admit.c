@@ -0,0 +1,202 @@
+/*
+ * http_admit.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+
+#include "http_admit.h"
+#include "http_conn.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "http_admit";
+
+// Bucket levels are kept in thousandths of a token, so slow rates still refill between requests
+#define HTTP_ADMIT_TOKEN			1000
+
+// Limits used for a route class with 0 in the config record
+static const nvs_rate_limit_t g_default_limits[HTTP_ADMIT_ROUTE_COUNT] = {
+		[HTTP_ADMIT_READ] = { .per_minute = 1200, .burst = 40 },
+		[HTTP_ADMIT_CONTROL] = { .per_minute = 300, .burst = 10 },
+		[HTTP_ADMIT_LOGIN] = { .per_minute = 6, .burst = 3 },
+		[HTTP_ADMIT_HEAVY] = { .per_minute = 2, .burst = 1 },
+};
+
+static const char *const g_route_names[HTTP_ADMIT_ROUTE_COUNT] = {
+		[HTTP_ADMIT_READ] = "read",
+		[HTTP_ADMIT_CONTROL] = "control",
+		[HTTP_ADMIT_LOGIN] = "login",
+		[HTTP_ADMIT_HEAVY] = "heavy",
+};
+
+/**
+ * Buckets of one client address. All buckets are refilled together from last_used_us.
+ */
+typedef struct http_admit_client
+{
+	uint32_t addr;						///> 0 = free entry
+	int64_t last_used_us;
+	uint32_t tokens[HTTP_ADMIT_ROUTE_COUNT];
+} http_admit_client_t;
+
+// Only used from the httpd task, which runs one handler at a time
+static http_admit_client_t g_clients[HTTP_ADMIT_CLIENTS];
+static nvs_rate_limit_t g_limits[HTTP_ADMIT_ROUTE_COUNT];
+static http_admit_stats_t g_stats;
+
+// Set from the HTTP server monitor task
+static volatile bool g_hold_heavy = false;
+
+void http_admit_load_limits(void)
+{
+	nvs_config_t cfg;
+
+	nvs_config_get(&cfg);
+	for (int i = 0; i < HTTP_ADMIT_ROUTE_COUNT; i++)
+	{
+		g_limits[i].per_minute = cfg.rate_limits[i].per_minute ? cfg.rate_limits[i].per_minute : g_default_limits[i].per_minute;
+		g_limits[i].burst = cfg.rate_limits[i].burst ? cfg.rate_limits[i].burst : g_default_limits[i].burst;
+	}
+
+	// Start everyone over with full buckets of the new size
+	memset(g_clients, 0, sizeof(g_clients));
+}
+
+void http_admit_get_limits(nvs_rate_limit_t limits[HTTP_ADMIT_ROUTE_COUNT])
+{
+	memcpy(limits, g_limits, sizeof(g_limits));
+}
+
+const char *http_admit_route_name(http_admit_route_e route)
+{
+	return route < HTTP_ADMIT_ROUTE_COUNT ? g_route_names[route] : "";
+}
+
+/**
+ * Finds the buckets of a client, or gives it the entry of the least recently seen one.
+ */
+static http_admit_client_t *http_admit_find_client(uint32_t addr, int64_t now)
+{
+	http_admit_client_t *oldest = &g_clients[0];
+
+	for (int i = 0; i < HTTP_ADMIT_CLIENTS; i++)
+	{
+		if (g_clients[i].addr == addr)
+		{
+			return &g_clients[i];
+		}
+		if (g_clients[i].last_used_us < oldest->last_used_us)
+		{
+			oldest = &g_clients[i];
+		}
+	}
+
+	// Free entries have last_used_us 0 and are taken first
+	if (oldest->addr != 0)
+	{
+		g_stats.clients_evicted++;
+	}
+
+	oldest->addr = addr;
+	oldest->last_used_us = now;
+	for (int i = 0; i < HTTP_ADMIT_ROUTE_COUNT; i++)
+	{
+		oldest->tokens[i] = g_limits[i].burst * HTTP_ADMIT_TOKEN;
+	}
+
+	return oldest;
+}
+
+static void http_admit_refill(http_admit_client_t *client, int64_t now)
+{
+	int64_t elapsed = now - client->last_used_us;
+
+	client->last_used_us = now;
+	for (int i = 0; i < HTTP_ADMIT_ROUTE_COUNT; i++)
+	{
+		uint32_t full = g_limits[i].burst * HTTP_ADMIT_TOKEN;
+		// An empty bucket is full after fill_us, a longer idle adds nothing and would overflow the product
+		// (elapsed * per_minute * HTTP_ADMIT_TOKEN wraps after 78 h at the largest rate)
+		uint64_t fill_us = (uint64_t)g_limits[i].burst * 60000000 / g_limits[i].per_minute + 1;
+		uint64_t refill_us = (uint64_t)elapsed < fill_us ? (uint64_t)elapsed : fill_us;
+		uint64_t tokens = client->tokens[i] + refill_us * g_limits[i].per_minute * HTTP_ADMIT_TOKEN / 60000000;
+
+		client->tokens[i] = tokens > full ? full : tokens;
+	}
+}
+
+/**
+ * Answers without a body, the cheapest response httpd can send.
+ */
+static void http_admit_reject(httpd_req_t *req, const char *status, uint32_t retry_after_s)
+{
+	// httpd sends the header after the handler returns, the value must outlive this function
+	static char retry_after[12];
+
+	snprintf(retry_after, sizeof(retry_after), "%u", (unsigned)retry_after_s);
+	httpd_resp_set_status(req, status);
+	httpd_resp_set_hdr(req, "Retry-After", retry_after);
+	httpd_resp_send(req, NULL, 0);
+}
+
+bool http_admit(httpd_req_t *req)
+{
+	http_admit_route_e route = (http_admit_route_e)(intptr_t)req->user_ctx;
+	uint32_t addr = http_conn_client(req);
+	int64_t now = esp_timer_get_time();
+
+	http_conn_request(req);
+
+	if (route >= HTTP_ADMIT_ROUTE_COUNT)
+	{
+		route = HTTP_ADMIT_READ;
+	}
+
+	if (route == HTTP_ADMIT_HEAVY && g_hold_heavy)
+	{
+		g_stats.busy++;
+		http_admit_reject(req, "503 Service Unavailable", 10);
+		return false;
+	}
+
+	if (addr == 0 || addr == htonl(INADDR_LOOPBACK))
+	{
+		g_stats.admitted++;
+		return true;
+	}
+
+	http_admit_client_t *client = http_admit_find_client(addr, now);
+	http_admit_refill(client, now);
+
+	if (client->tokens[route] < HTTP_ADMIT_TOKEN)
+	{
+		uint64_t wait_us = (uint64_t)(HTTP_ADMIT_TOKEN - client->tokens[route]) * 60000000 / HTTP_ADMIT_TOKEN / g_limits[route].per_minute;
+
+		g_stats.limited[route]++;
+		ESP_LOGD(TAG, "429 %s for " IPSTR, g_route_names[route], IP2STR((esp_ip4_addr_t *)&addr));
+		http_admit_reject(req, "429 Too Many Requests", wait_us / 1000000 + 1);
+		return false;
+	}
+
+	client->tokens[route] -= HTTP_ADMIT_TOKEN;
+	g_stats.admitted++;
+	return true;
+}
+
+void http_admit_hold_heavy(bool hold)
+{
+	g_hold_heavy = hold;
+}
+
+void http_admit_get_stats(http_admit_stats_t *stats)
+{
+	*stats = g_stats;
+}
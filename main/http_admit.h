@@ -0,0 +1,87 @@
+/*
+ * http_admit.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_HTTP_ADMIT_H_
+#define MAIN_HTTP_ADMIT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_http_server.h"
+#include "nvs_utils.h"
+
+/*
+ * Admission control of the HTTP server, runs before every handler body.
+ * Each URI is registered with a route class in user_ctx. Every client address has a token bucket
+ * per class, so a script hammering the LED toggle is answered with an empty 429 long before it
+ * keeps the httpd task or the GPIOs busy, while its page can still read state.
+ * Heavy routes are also refused with 503 while heavy work is pending (an OTA image waiting for the reboot).
+ * The buckets live in a fixed table of HTTP_ADMIT_CLIENTS entries, the least recently seen client
+ * gives up its entry. Limits come from the config record, 0 means the firmware default.
+ * 127.0.0.1 (the load generator) is not limited.
+ */
+
+#define HTTP_ADMIT_CLIENTS			16
+
+/**
+ * Route classes, passed as user_ctx when registering a URI. NULL is HTTP_ADMIT_READ.
+ */
+typedef enum http_admit_route
+{
+	HTTP_ADMIT_READ = 0,				///> Static files and state polled by the page
+	HTTP_ADMIT_CONTROL,					///> LED toggle, settings, scans: drive hardware or flash
+	HTTP_ADMIT_LOGIN,					///> Login and credentials, PBKDF2 per request
+	HTTP_ADMIT_HEAVY,					///> OTA upload, load generator
+	HTTP_ADMIT_ROUTE_COUNT
+} http_admit_route_e;
+
+_Static_assert(HTTP_ADMIT_ROUTE_COUNT == NVS_RATE_LIMIT_ROUTES, "nvs_config_t has a limit per route class");
+
+/**
+ * Counters, for /api/metrics
+ */
+typedef struct http_admit_stats
+{
+	uint32_t admitted;
+	uint32_t limited[HTTP_ADMIT_ROUTE_COUNT];	///> 429 per route class
+	uint32_t busy;								///> 503 for a heavy route
+	uint32_t clients_evicted;					///> Table entries reused for a new client
+} http_admit_stats_t;
+
+/**
+ * Loads the limits from the config record. Call before the server starts and after the limits change.
+ */
+void http_admit_load_limits(void);
+
+/**
+ * Gets the limits in force, defaults filled in.
+ */
+void http_admit_get_limits(nvs_rate_limit_t limits[HTTP_ADMIT_ROUTE_COUNT]);
+
+/**
+ * @return name of a route class, as used in the JSON of /api/config/limits.
+ */
+const char *http_admit_route_name(http_admit_route_e route);
+
+/**
+ * Admits a request: accounts it to its connection (http_conn_request) and takes a token from the bucket
+ * of its client and route class. Call first in every handler.
+ * @return false if the request was answered with 429 or 503 and the handler must return.
+ */
+bool http_admit(httpd_req_t *req);
+
+/**
+ * Refuses heavy routes with 503 while set, e.g. from a successful OTA until the reboot.
+ */
+void http_admit_hold_heavy(bool hold);
+
+/**
+ * Gets the counters.
+ */
+void http_admit_get_stats(http_admit_stats_t *stats);
+
+#endif /* MAIN_HTTP_ADMIT_H_ */
@@ -0,0 +1,135 @@
+/*
+ * http_cache.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+
+#include "http_cache.h"
+
+// "xxxxxxxx-nnnnnnnnnn" with quotes
+#define HTTP_CACHE_ETAG_SIZE		24
+
+/**
+ * A cached body. version is the data version, valid_version the one the body was built for.
+ */
+typedef struct http_cache_slot
+{
+	uint32_t version;
+	uint32_t valid_version;
+	bool valid;
+	char body[HTTP_CACHE_BODY_SIZE];
+} http_cache_slot_t;
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static http_cache_slot_t g_slots[HTTP_CACHE_COUNT];
+static http_cache_stats_t g_stats;
+
+// Random per boot, so an ETag from before a reboot never matches the restarted counters
+static uint32_t g_boot_tag = 0;
+
+static void http_cache_etag(char *etag, size_t size, http_cache_entry_e entry, uint32_t version)
+{
+	if (g_boot_tag == 0)
+	{
+		g_boot_tag = esp_random() | 1;
+	}
+	snprintf(etag, size, "\"%08x-%u\"", (unsigned)(g_boot_tag + entry), (unsigned)version);
+}
+
+void http_cache_invalidate(http_cache_entry_e entry)
+{
+	if (entry >= HTTP_CACHE_COUNT)
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL_SAFE(&g_lock);
+	g_slots[entry].version++;
+	taskEXIT_CRITICAL_SAFE(&g_lock);
+}
+
+bool http_cache_try_serve(httpd_req_t *req, http_cache_entry_e entry, uint32_t *version)
+{
+	// Handlers run one at a time in the httpd task, so these can be static: httpd keeps
+	// pointers to the header values until the response is sent
+	static char etag[HTTP_CACHE_ETAG_SIZE];
+	static char body[HTTP_CACHE_BODY_SIZE];
+	char if_none_match[HTTP_CACHE_ETAG_SIZE];
+	bool hit;
+
+	taskENTER_CRITICAL(&g_lock);
+	http_cache_slot_t *slot = &g_slots[entry];
+	*version = slot->version;
+	hit = slot->valid && slot->valid_version == slot->version;
+	if (hit)
+	{
+		strcpy(body, slot->body);
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	http_cache_etag(etag, sizeof(etag), entry, *version);
+
+	if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK
+			&& strcmp(if_none_match, etag) == 0)
+	{
+		g_stats.not_modified++;
+		httpd_resp_set_status(req, "304 Not Modified");
+		httpd_resp_set_hdr(req, "ETag", etag);
+		httpd_resp_send(req, NULL, 0);
+		return true;
+	}
+
+	if (!hit)
+	{
+		g_stats.misses++;
+		return false;
+	}
+
+	g_stats.hits++;
+	httpd_resp_set_type(req, "application/json");
+	httpd_resp_set_hdr(req, "ETag", etag);
+	httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+	httpd_resp_send(req, body, HTTPD_RESP_USE_STRLEN);
+
+	return true;
+}
+
+esp_err_t http_cache_send(httpd_req_t *req, http_cache_entry_e entry, uint32_t version, const char *body)
+{
+	static char etag[HTTP_CACHE_ETAG_SIZE];
+	bool stored = false;
+
+	taskENTER_CRITICAL(&g_lock);
+	http_cache_slot_t *slot = &g_slots[entry];
+	if (slot->version == version && strlen(body) < sizeof(slot->body))
+	{
+		strcpy(slot->body, body);
+		slot->valid_version = version;
+		slot->valid = true;
+		stored = true;
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	httpd_resp_set_type(req, "application/json");
+	// A body that changed while it was built, or is too long to store, goes out without an ETag
+	if (stored)
+	{
+		http_cache_etag(etag, sizeof(etag), entry, version);
+		httpd_resp_set_hdr(req, "ETag", etag);
+		httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+	}
+
+	return httpd_resp_send(req, body, HTTPD_RESP_USE_STRLEN);
+}
+
+void http_cache_get_stats(http_cache_stats_t *stats)
+{
+	*stats = g_stats;
+}
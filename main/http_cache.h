@@ -0,0 +1,74 @@
+/*
+ * http_cache.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_HTTP_CACHE_H_
+#define MAIN_HTTP_CACHE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+/*
+ * Response cache for the small dynamic JSON endpoints the web page polls.
+ * Each entry has a version counter that is bumped by whatever changes the data
+ * (config saved, IP acquired or lost, OTA status). The ETag is the boot tag plus the version,
+ * so a client presenting it in If-None-Match gets 304 without the body being looked at,
+ * and a hit on a current entry sends the stored body without building JSON or reading NVS.
+ */
+
+#define HTTP_CACHE_BODY_SIZE		256
+
+/**
+ * Cached endpoints
+ */
+typedef enum http_cache_entry
+{
+	HTTP_CACHE_SETTINGS_NET = 0,		///> GET /api/config/network
+	HTTP_CACHE_SETTINGS_IP,				///> GET /api/config/ip_addr
+	HTTP_CACHE_OTA_STATUS,				///> POST /api/OTA/status
+	HTTP_CACHE_COUNT
+} http_cache_entry_e;
+
+/**
+ * Hit counters, for /api/metrics
+ */
+typedef struct http_cache_stats
+{
+	uint32_t not_modified;				///> 304 sent
+	uint32_t hits;						///> Body sent from the cache
+	uint32_t misses;					///> Body built by the handler
+} http_cache_stats_t;
+
+/**
+ * Marks an entry stale. Safe from any task, including the default event loop.
+ */
+void http_cache_invalidate(http_cache_entry_e entry);
+
+/**
+ * Answers a request from the cache: 304 if If-None-Match is the current ETag,
+ * or 200 with the stored body if the entry is current.
+ * @param version set to the version the caller must pass to http_cache_send on a miss.
+ * @return true if the request was answered.
+ */
+bool http_cache_try_serve(httpd_req_t *req, http_cache_entry_e entry, uint32_t *version);
+
+/**
+ * Stores a body built after a miss and sends it as application/json with its ETag.
+ * The body is not stored if the entry was invalidated while it was built.
+ * @param version from http_cache_try_serve.
+ * @return result of httpd_resp_send.
+ */
+esp_err_t http_cache_send(httpd_req_t *req, http_cache_entry_e entry, uint32_t version, const char *body);
+
+/**
+ * Gets the hit counters.
+ */
+void http_cache_get_stats(http_cache_stats_t *stats);
+
+#endif /* MAIN_HTTP_CACHE_H_ */
@@ -0,0 +1,347 @@
+/*
+ * http_conn.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "sdkconfig.h"
+
+#include "http_conn.h"
+#include "trace.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "http_conn";
+
+#define HTTP_CONN_SWEEP_PERIOD_US		(5 * 1000 * 1000)
+#define HTTP_CONN_IDLE_TIMEOUT_US		((int64_t)CONFIG_HTTP_CONN_IDLE_TIMEOUT_S * 1000000)
+
+// httpd keeps three sockets for itself (listener and control). The host build uses the OS sockets.
+#ifdef CONFIG_LWIP_MAX_SOCKETS
+_Static_assert(CONFIG_HTTP_CONN_MAX_SOCKETS <= CONFIG_LWIP_MAX_SOCKETS - 3, "CONFIG_HTTP_CONN_MAX_SOCKETS exceeds CONFIG_LWIP_MAX_SOCKETS - 3");
+#endif
+
+/**
+ * An open socket. fd is -1 for a free slot.
+ */
+typedef struct http_conn_session
+{
+	int fd;
+	uint32_t client;					///> IPv4 address of the peer
+	int64_t last_used_us;				///> Open or last request
+	uint16_t requests;
+	bool closing;						///> Close triggered, waiting for httpd
+} http_conn_session_t;
+
+static http_conn_session_t g_sessions[CONFIG_HTTP_CONN_MAX_SOCKETS];
+static http_conn_stats_t g_stats;
+static httpd_handle_t g_server = NULL;
+static esp_timer_handle_t g_sweep_timer = NULL;
+
+/**
+ * @return IPv4 address of the peer, IPv4-mapped for the IPv6 listener, 0 if unknown.
+ */
+static uint32_t http_conn_peer(int fd)
+{
+	struct sockaddr_storage addr;
+	socklen_t len = sizeof(addr);
+
+	if (getpeername(fd, (struct sockaddr *)&addr, &len) != 0)
+	{
+		return 0;
+	}
+	if (addr.ss_family == AF_INET)
+	{
+		return ((struct sockaddr_in *)&addr)->sin_addr.s_addr;
+	}
+#if CONFIG_LWIP_IPV6
+	if (addr.ss_family == AF_INET6)
+	{
+		uint32_t last;
+
+		// The last word identifies the client well enough for native IPv6 too
+		memcpy(&last, &((struct sockaddr_in6 *)&addr)->sin6_addr.s6_addr[12], sizeof(last));
+		return last;
+	}
+#endif
+
+	return 0;
+}
+
+static http_conn_session_t *http_conn_find(int fd)
+{
+	for (int i = 0; i < CONFIG_HTTP_CONN_MAX_SOCKETS; i++)
+	{
+		if (g_sessions[i].fd == fd)
+		{
+			return &g_sessions[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @return open sockets of a client, not counting those already closing.
+ */
+static int http_conn_client_count(uint32_t client)
+{
+	int count = 0;
+
+	for (int i = 0; i < CONFIG_HTTP_CONN_MAX_SOCKETS; i++)
+	{
+		if (g_sessions[i].fd >= 0 && !g_sessions[i].closing && g_sessions[i].client == client)
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void http_conn_count_clients(void)
+{
+	uint8_t clients = 0;
+
+	for (int i = 0; i < CONFIG_HTTP_CONN_MAX_SOCKETS; i++)
+	{
+		if (g_sessions[i].fd < 0)
+		{
+			continue;
+		}
+
+		bool first = true;
+		for (int j = 0; j < i; j++)
+		{
+			if (g_sessions[j].fd >= 0 && g_sessions[j].client == g_sessions[i].client)
+			{
+				first = false;
+				break;
+			}
+		}
+		clients += first;
+	}
+
+	g_stats.clients = clients;
+}
+
+static void http_conn_close(http_conn_session_t *session)
+{
+	session->closing = true;
+	httpd_sess_trigger_close(g_server, session->fd);
+}
+
+/**
+ * Closes the least recently used socket of the client with the most open sockets.
+ * @param keep socket just opened, never chosen.
+ */
+static void http_conn_purge(int keep)
+{
+	http_conn_session_t *victim = NULL;
+	int victim_count = 0;
+
+	for (int i = 0; i < CONFIG_HTTP_CONN_MAX_SOCKETS; i++)
+	{
+		http_conn_session_t *s = &g_sessions[i];
+
+		if (s->fd < 0 || s->fd == keep || s->closing)
+		{
+			continue;
+		}
+
+		int count = http_conn_client_count(s->client);
+		if (victim == NULL || count > victim_count
+				|| (count == victim_count && s->last_used_us < victim->last_used_us))
+		{
+			victim = s;
+			victim_count = count;
+		}
+	}
+
+	if (victim != NULL)
+	{
+		ESP_LOGD(TAG, "Purging fd %d, client holds %d sockets", victim->fd, victim_count);
+		http_conn_close(victim);
+		g_stats.purged++;
+	}
+}
+
+static esp_err_t http_conn_open(httpd_handle_t hd, int sockfd)
+{
+	uint32_t client = http_conn_peer(sockfd);
+	http_conn_session_t *session = http_conn_find(-1);
+
+	g_server = hd;
+	TRACE_INSTANT(TRACE_EV_HTTP_ACCEPT, sockfd);
+
+	// The load generator connects from 127.0.0.1 and is not capped, the host build can test the cap from 127.0.0.2+
+	if (session == NULL
+			|| (client != htonl(INADDR_LOOPBACK) && http_conn_client_count(client) >= CONFIG_HTTP_CONN_PER_CLIENT))
+	{
+		g_stats.refused++;
+		ESP_LOGD(TAG, "Refused fd %d", sockfd);
+#if CONFIG_HTTP_SERVER_HTTPS
+		// esp_https_server ignores the result of this hook
+		httpd_sess_trigger_close(hd, sockfd);
+		return ESP_OK;
+#else
+		return ESP_FAIL;
+#endif
+	}
+
+	session->fd = sockfd;
+	session->client = client;
+	session->last_used_us = esp_timer_get_time();
+	session->requests = 0;
+	session->closing = false;
+
+	g_stats.accepted++;
+	g_stats.active++;
+	if (g_stats.active > g_stats.active_high_water)
+	{
+		g_stats.active_high_water = g_stats.active;
+	}
+
+	// Keep one socket free, the next client must not wait for httpd to find one
+	if (g_stats.active == CONFIG_HTTP_CONN_MAX_SOCKETS)
+	{
+		http_conn_purge(sockfd);
+	}
+
+	http_conn_count_clients();
+	return ESP_OK;
+}
+
+static void http_conn_close_fn(httpd_handle_t hd, int sockfd)
+{
+	http_conn_session_t *session = http_conn_find(sockfd);
+
+	TRACE_INSTANT(TRACE_EV_HTTP_CLOSE, sockfd);
+	if (session != NULL)
+	{
+		session->fd = -1;
+		g_stats.active--;
+		http_conn_count_clients();
+	}
+
+	close(sockfd);
+}
+
+/**
+ * Closes idle sockets, runs in the httpd task.
+ */
+static void http_conn_sweep(void *arg)
+{
+	int64_t now = esp_timer_get_time();
+
+	for (int i = 0; i < CONFIG_HTTP_CONN_MAX_SOCKETS; i++)
+	{
+		http_conn_session_t *s = &g_sessions[i];
+
+		if (s->fd >= 0 && !s->closing && now - s->last_used_us > HTTP_CONN_IDLE_TIMEOUT_US)
+		{
+			http_conn_close(s);
+			g_stats.idle_closed++;
+		}
+	}
+}
+
+static void http_conn_sweep_timer_cb(void *arg)
+{
+	if (g_server != NULL)
+	{
+		httpd_queue_work(g_server, http_conn_sweep, NULL);
+	}
+}
+
+void http_conn_configure(httpd_config_t *config)
+{
+	for (int i = 0; i < CONFIG_HTTP_CONN_MAX_SOCKETS; i++)
+	{
+		g_sessions[i].fd = -1;
+	}
+	g_stats.active = 0;
+	g_stats.clients = 0;
+
+	config->max_open_sockets = CONFIG_HTTP_CONN_MAX_SOCKETS;
+	config->backlog_conn = CONFIG_HTTP_CONN_MAX_SOCKETS;
+	config->open_fn = http_conn_open;
+	config->close_fn = http_conn_close_fn;
+
+	// Fallback if a connect arrives before the purged socket is closed
+	config->lru_purge_enable = true;
+
+	// TCP keep-alive reaps clients that left without closing, e.g. a phone that dropped off the SoftAP
+	config->keep_alive_enable = true;
+	config->keep_alive_idle = 10;
+	config->keep_alive_interval = 5;
+	config->keep_alive_count = 3;
+}
+
+void http_conn_start(httpd_handle_t server)
+{
+	const esp_timer_create_args_t args = {
+			.callback = &http_conn_sweep_timer_cb,
+			.name = "http_conn_sweep"
+	};
+
+	g_server = server;
+
+	if (CONFIG_HTTP_CONN_IDLE_TIMEOUT_S == 0)
+	{
+		return;
+	}
+	if (g_sweep_timer == NULL && esp_timer_create(&args, &g_sweep_timer) != ESP_OK)
+	{
+		ESP_LOGE(TAG, "Idle sweep timer not created");
+		return;
+	}
+	esp_timer_start_periodic(g_sweep_timer, HTTP_CONN_SWEEP_PERIOD_US);
+}
+
+void http_conn_stop(void)
+{
+	if (g_sweep_timer != NULL)
+	{
+		esp_timer_stop(g_sweep_timer);
+	}
+	g_server = NULL;
+}
+
+void http_conn_request(httpd_req_t *req)
+{
+	http_conn_session_t *session = http_conn_find(httpd_req_to_sockfd(req));
+
+	if (session == NULL)
+	{
+		return;
+	}
+
+	session->last_used_us = esp_timer_get_time();
+	session->requests++;
+
+	if (CONFIG_HTTP_CONN_MAX_REQUESTS > 0 && session->requests >= CONFIG_HTTP_CONN_MAX_REQUESTS && !session->closing)
+	{
+		// Closed once this response is out, the header tells the client not to send another
+		httpd_resp_set_hdr(req, "Connection", "close");
+		http_conn_close(session);
+		g_stats.limit_closed++;
+	}
+}
+
+uint32_t http_conn_client(httpd_req_t *req)
+{
+	http_conn_session_t *session = http_conn_find(httpd_req_to_sockfd(req));
+
+	return session != NULL ? session->client : 0;
+}
+
+void http_conn_get_stats(http_conn_stats_t *stats)
+{
+	*stats = g_stats;
+}
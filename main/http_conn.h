@@ -0,0 +1,74 @@
+/*
+ * http_conn.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_HTTP_CONN_H_
+#define MAIN_HTTP_CONN_H_
+
+#include <stdint.h>
+
+#include "esp_http_server.h"
+
+/*
+ * Connection manager of the HTTP server.
+ * Tracks every socket httpd opens by the client address, through the httpd open_fn/close_fn hooks:
+ * - a client may hold at most CONFIG_HTTP_CONN_PER_CLIENT sockets, further connects are refused
+ *   (except from 127.0.0.1, the load generator)
+ * - when the last socket is taken, the least recently used socket of the client holding the most
+ *   is closed, so a newcomer always finds a free one and a busy browser can't starve the others
+ * - sockets without a request for CONFIG_HTTP_CONN_IDLE_TIMEOUT_S are closed
+ * - a socket is closed after CONFIG_HTTP_CONN_MAX_REQUESTS requests
+ * Everything runs in the httpd task (hooks, handlers and the idle sweep queued with httpd_queue_work),
+ * so the session table needs no lock.
+ */
+
+/**
+ * Counters, for /api/metrics
+ */
+typedef struct http_conn_stats
+{
+	uint32_t accepted;					///> Sockets opened
+	uint32_t refused;					///> Connects over the per-client cap
+	uint32_t purged;					///> Closed to free a socket for another client
+	uint32_t idle_closed;				///> Closed after the idle timeout
+	uint32_t limit_closed;				///> Closed after the request limit
+	uint8_t active;						///> Open sockets
+	uint8_t active_high_water;			///> Most open sockets at once
+	uint8_t clients;					///> Distinct client addresses with an open socket
+} http_conn_stats_t;
+
+/**
+ * Sets the socket limits and the session hooks in the httpd configuration.
+ */
+void http_conn_configure(httpd_config_t *config);
+
+/**
+ * Starts the idle sweep for a started server.
+ */
+void http_conn_start(httpd_handle_t server);
+
+/**
+ * Stops the idle sweep, call before stopping the server.
+ */
+void http_conn_stop(void);
+
+/**
+ * Accounts a request to its socket: refreshes the idle timer and applies the request limit.
+ * Call at the start of every handler.
+ */
+void http_conn_request(httpd_req_t *req);
+
+/**
+ * @return IPv4 address (network order) of the client that sent a request, 0 if unknown.
+ */
+uint32_t http_conn_client(httpd_req_t *req);
+
+/**
+ * Gets the counters.
+ */
+void http_conn_get_stats(http_conn_stats_t *stats);
+
+#endif /* MAIN_HTTP_CONN_H_ */
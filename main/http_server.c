@@ -6,17 +6,37 @@
  */
 
 #include "esp_http_server.h"
+#if CONFIG_HTTP_SERVER_HTTPS
+#include "esp_https_server.h"
+#endif
 #include "esp_log.h"
 
+#include "api_gen.h"
+#include "assets.h"
+#include "auth.h"
+#include "boot_profile.h"
+#include "esp_heap_caps.h"
+#include "event_bus.h"
+#include "http_admit.h"
+#include "http_cache.h"
+#include "http_conn.h"
 #include "http_server.h"
+#include "loadgen.h"
+#include "provision.h"
+#include "scene.h"
 #include "tasks_common.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "udp_ctrl.h"
 #include "wifi_app.h"
 #include "freertos/idf_additions.h"
 #include "sys/param.h"
 
+#include <stdlib.h>
 #include <string.h> 
-#include <cJSON.h> 
 #include "io.h"
+#include "io_cmd.h"
+#include "journal.h"
 #include "nvs_flash.h"
 #include "nvs_utils.h"
 #include "esp_timer.h"
@@ -38,19 +58,13 @@ static httpd_handle_t http_server_handle = NULL;
 // HTTP server monitor task handle
 static TaskHandle_t task_http_server_monitor = NULL;
 
-// Queue handle used to manipulate the main queue of events
+// Event bus queue of the HTTP server monitor
 static QueueHandle_t http_server_monitor_queue_handle;
 
-//control led handlers
-static esp_err_t led_get_handler(httpd_req_t *req);
-static esp_err_t led_toggle_handler(httpd_req_t *req);
-//net settings handlers
-static esp_err_t settings_net_post_handler(httpd_req_t *req); 
-static esp_err_t settings_net_get_handler(httpd_req_t *req);
-static esp_err_t settings_ip_get_handler(httpd_req_t *req);
 
-
-// Embedded files: JQuery, index.html, app.css, app.js and favicon.ico files
+#if CONFIG_HTTP_ASSETS_EMBEDDED
+// Embedded files: JQuery, index.html, app.css, app.js and favicon.ico files,
+// served when the assets partition has no newer copy
 extern const uint8_t jquery_3_3_1_min_js_start[]	asm("_binary_jquery_3_3_1_min_js_start");
 extern const uint8_t jquery_3_3_1_min_js_end[]		asm("_binary_jquery_3_3_1_min_js_end");
 extern const uint8_t index_html_start[]				asm("_binary_index_html_start");
@@ -61,6 +75,18 @@ extern const uint8_t app_js_start[]					asm("_binary_app_js_start");
 extern const uint8_t app_js_end[]					asm("_binary_app_js_end");
 extern const uint8_t favicon_ico_start[]			asm("_binary_favicon_ico_start");
 extern const uint8_t favicon_ico_end[]				asm("_binary_favicon_ico_end");
+#define EMBEDDED_FILE(name)							name##_start, name##_end
+#else
+#define EMBEDDED_FILE(name)							NULL, NULL
+#endif
+
+#if CONFIG_HTTP_SERVER_HTTPS
+// ECDSA P-256 certificate and key from main/certs (tools/gen_https_cert.sh)
+extern const uint8_t servercert_pem_start[]			asm("_binary_servercert_pem_start");
+extern const uint8_t servercert_pem_end[]			asm("_binary_servercert_pem_end");
+extern const uint8_t prvtkey_pem_start[]			asm("_binary_prvtkey_pem_start");
+extern const uint8_t prvtkey_pem_end[]				asm("_binary_prvtkey_pem_end");
+#endif
 
 /**
  * Disable CORS policy by setting appropriate headers.
@@ -69,10 +95,48 @@ extern const uint8_t favicon_ico_end[]				asm("_binary_favicon_ico_end");
 
 void set_cors_headers(httpd_req_t *req) {
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, PUT, OPTIONS");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type, Authorization");
 }
 
+/**
+ * Gets the session token from an "Authorization: Bearer <token>" header.
+ * @return false if there is none.
+ */
+static bool http_server_get_token(httpd_req_t *req, char *token, size_t size)
+{
+	char header[AUTH_TOKEN_HEX_LEN + 16];
+
+	if (httpd_req_get_hdr_value_str(req, "Authorization", header, sizeof(header)) != ESP_OK
+			|| strncmp(header, "Bearer ", 7) != 0)
+	{
+		return false;
+	}
+
+	strlcpy(token, header + 7, size);
+	return true;
+}
+
+/**
+ * Answers 401 unless the request carries the token of a live session, or no credentials are set.
+ * A session lookup, no hashing: see auth.h.
+ * @param req HTTP request to authorize, CORS headers already set.
+ * @return true if the handler may go on.
+ */
+bool http_server_authorize(httpd_req_t *req)
+{
+	char token[AUTH_TOKEN_HEX_LEN + 1];
+
+	if (auth_authorize(http_server_get_token(req, token, sizeof(token)) ? token : NULL))
+	{
+		return true;
+	}
+
+	httpd_resp_set_hdr(req, "WWW-Authenticate", "Bearer");
+	httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Login required");
+	return false;
+}
+
 /**
  * ESP32 timer configuration passed to esp_timer_create.
  */
@@ -117,13 +181,15 @@ static void http_server_fw_update_reset_timer(void)
  */
 static void http_server_monitor(void *parameter)
 {
-	http_server_queue_message_t msg;
+	const event_t *msg;
 
 	for (;;)
 	{
-		if (xQueueReceive(http_server_monitor_queue_handle, &msg, portMAX_DELAY))
+		if ((msg = event_bus_receive(http_server_monitor_queue_handle, portMAX_DELAY)) != NULL)
 		{
-			switch (msg.msgID)
+			TRACE_SCOPE(TRACE_EV_HTTP_MONITOR_MSG, msg->id);
+
+			switch (msg->id)
 			{
 				case HTTP_MSG_WIFI_CONNECT_INIT:
 					ESP_LOGI(TAG, "HTTP_MSG_WIFI_CONNECT_INIT");
@@ -141,15 +207,19 @@ static void http_server_monitor(void *parameter)
 					break;
 
 				case HTTP_MSG_FIRMWARE_UPDATE_SUCCESSFUL:
-					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_SUCCESSFUL");
+					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_SUCCESSFUL, %u bytes", (unsigned)msg->data.ota.received);
 					g_fw_update_status = OTA_UPDATE_SUCCESSFUL;
+					http_cache_invalidate(HTTP_CACHE_OTA_STATUS);
+					// No second upload while the new image waits for the reboot
+					http_admit_hold_heavy(true);
 					http_server_fw_update_reset_timer();
 
 					break;
 
 				case HTTP_MSG_FIRMWARE_UPDATE_FAILED:
-					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_FAILED");
+					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_FAILED after %u of %u bytes", (unsigned)msg->data.ota.received, (unsigned)msg->data.ota.total);
 					g_fw_update_status = OTA_UPDATE_FAILED;
+					http_cache_invalidate(HTTP_CACHE_OTA_STATUS);
 
 					break;
 
@@ -157,26 +227,69 @@ static void http_server_monitor(void *parameter)
 					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPATE_INITIALIZED");
 
 
+					break;
+
+				case HTTP_MSG_USER_LOGIN_DONE:
+					ESP_LOGI(TAG, "HTTP_MSG_USER_LOGIN_DONE");
+
+					break;
+
+				case HTTP_MGS_USER_LOGIN_FAIL:
+					ESP_LOGW(TAG, "HTTP_MSG_USER_LOGIN_FAIL");
+
+					break;
+
+				case HTTP_MSG_USER_REGISTER_DONE:
+					ESP_LOGI(TAG, "HTTP_MSG_USER_REGISTER_DONE");
+
+					break;
+
+				case HTTP_MGS_USER_REGISTER_FAIL:
+					ESP_LOGW(TAG, "HTTP_MSG_USER_REGISTER_FAIL");
+
 					break;
 
 				default:
 					break;
 			}
+
+			event_bus_release(msg);
 		}
 	}
 }
 
+/**
+ * Sends a file of the web page from the assets partition, or else its embedded copy.
+ * @param path of the file in the assets image.
+ * @param type Content-Type of the embedded copy.
+ * @param start embedded copy, NULL if the firmware has none.
+ */
+static void http_server_send_static(httpd_req_t *req, const char *path, const char *type, const uint8_t *start, const uint8_t *end)
+{
+	if (assets_try_serve(req, path))
+	{
+		return;
+	}
+	if (start == NULL)
+	{
+		httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Web page not installed, upload it to /api/assets/update");
+		return;
+	}
+
+	httpd_resp_set_type(req, type);
+	httpd_resp_send(req, (const char *)start, end - start);
+}
+
 /**
  * Jquery get handler is requested when accessing the web page.
  * @param req HTTP request for which the uri needs to be handled.
  * @return ESP_OK
  */
-static esp_err_t http_server_jquery_handler(httpd_req_t *req)
+esp_err_t http_server_jquery_handler(httpd_req_t *req)
 {
 	ESP_LOGI(TAG, "Jquery requested");
 
-	httpd_resp_set_type(req, "application/javascript");
-	httpd_resp_send(req, (const char *)jquery_3_3_1_min_js_start, jquery_3_3_1_min_js_end - jquery_3_3_1_min_js_start);
+	http_server_send_static(req, "/jquery-3.3.1.min.js", "application/javascript", EMBEDDED_FILE(jquery_3_3_1_min_js));
 
 	return ESP_OK;
 }
@@ -186,12 +299,12 @@ static esp_err_t http_server_jquery_handler(httpd_req_t *req)
  * @param req HTTP request for which the uri needs to be handled.
  * @return ESP_OK
  */
-static esp_err_t http_server_index_html_handler(httpd_req_t *req)
+esp_err_t http_server_index_html_handler(httpd_req_t *req)
 {
 	ESP_LOGI(TAG, "index.html requested");
 
-	httpd_resp_set_type(req, "text/html");
-	httpd_resp_send(req, (const char *)index_html_start, index_html_end - index_html_start);
+	http_server_send_static(req, "/index.html", "text/html", EMBEDDED_FILE(index_html));
+	boot_profile_mark(BOOT_PHASE_FIRST_HTTP_RESPONSE);
 
 	return ESP_OK;
 }
@@ -201,12 +314,11 @@ static esp_err_t http_server_index_html_handler(httpd_req_t *req)
  * @param req HTTP request for which the uri needs to be handled.
  * @return ESP_OK
  */
-static esp_err_t http_server_app_css_handler(httpd_req_t *req)
+esp_err_t http_server_app_css_handler(httpd_req_t *req)
 {
 	ESP_LOGI(TAG, "app.css requested");
 
-	httpd_resp_set_type(req, "text/css");
-	httpd_resp_send(req, (const char *)app_css_start, app_css_end - app_css_start);
+	http_server_send_static(req, "/app.css", "text/css", EMBEDDED_FILE(app_css));
 
 	return ESP_OK;
 }
@@ -216,12 +328,11 @@ static esp_err_t http_server_app_css_handler(httpd_req_t *req)
  * @param req HTTP request for which the uri needs to be handled.
  * @return ESP_OK
  */
-static esp_err_t http_server_app_js_handler(httpd_req_t *req)
+esp_err_t http_server_app_js_handler(httpd_req_t *req)
 {
 	ESP_LOGI(TAG, "app.js requested");
 
-	httpd_resp_set_type(req, "application/javascript");
-	httpd_resp_send(req, (const char *)app_js_start, app_js_end - app_js_start);
+	http_server_send_static(req, "/app.js", "application/javascript", EMBEDDED_FILE(app_js));
 
 	return ESP_OK;
 }
@@ -231,20 +342,17 @@ static esp_err_t http_server_app_js_handler(httpd_req_t *req)
  * @param req HTTP request for which the uri needs to be handled.
  * @return ESP_OK
  */
-static esp_err_t http_server_favicon_ico_handler(httpd_req_t *req)
+esp_err_t http_server_favicon_ico_handler(httpd_req_t *req)
 {
 	ESP_LOGI(TAG, "favicon.ico requested");
 
-	httpd_resp_set_type(req, "image/x-icon");
-	httpd_resp_send(req, (const char *)favicon_ico_start, favicon_ico_end - favicon_ico_start);
+	http_server_send_static(req, "/favicon.ico", "image/x-icon", EMBEDDED_FILE(favicon_ico));
 
 	return ESP_OK;
 }
 
 esp_err_t http_server_OTA_update_handler(httpd_req_t *req)
 {
-	//deactivate CORS
-	set_cors_headers(req);
 	esp_ota_handle_t ota_handle;
 
 	char ota_buff[1024];
@@ -327,25 +435,53 @@ esp_err_t http_server_OTA_update_handler(httpd_req_t *req)
 		ESP_LOGI(TAG, "http_server_OTA_update_handler: esp_ota_end ERROR!!!");
 	}
 
-	// We won't update the global variables throughout the file, so send the message about the status
-	if (flash_successful) { http_server_monitor_send_message(HTTP_MSG_FIRMWARE_UPDATE_SUCCESSFUL); } else { http_server_monitor_send_message(HTTP_MSG_FIRMWARE_UPDATE_FAILED); }
+	// We won't update the global variables throughout the file, so send the message about the status.
+	// A lost result would leave the status pending and a good image without its reboot: retry, this is the httpd task
+	event_payload_t payload = { .ota = { .received = content_received, .total = content_length } };
+	http_server_message_e result = flash_successful ? HTTP_MSG_FIRMWARE_UPDATE_SUCCESSFUL : HTTP_MSG_FIRMWARE_UPDATE_FAILED;
+	bool delivered = false;
+
+	for (int i = 0; i <= HTTP_SERVER_OTA_RESULT_RETRIES && !delivered; i++)
+	{
+		if (i > 0)
+		{
+			vTaskDelay(pdMS_TO_TICKS(HTTP_SERVER_OTA_RESULT_RETRY_MS));
+		}
+		delivered = event_bus_publish_control(EVENT_TOPIC_HTTP_MONITOR, result, &payload);
+	}
+	if (!delivered)
+	{
+		ESP_LOGE(TAG, "http_server_OTA_update_handler: OTA result %d lost, the monitor queue stayed full", result);
+		api_journal_result(JOURNAL_RESULT_FAILED);
+		httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
+				flash_successful ? "Firmware written but the status was not updated, restart the device" : "OTA update failed");
+		return ESP_OK;
+	}
+	if (!flash_successful)
+	{
+		api_journal_result(JOURNAL_RESULT_FAILED);
+	}
 
 	return ESP_OK;
 }
 
 esp_err_t http_server_OTA_status_handler(httpd_req_t *req)
 {
-	set_cors_headers(req);
-	char otaJSON[100];
+	api_ota_status_t status = { .ota_update_status = g_fw_update_status, .compile_time = __TIME__, .compile_date = __DATE__ };
+	char otaJSON[API_OTA_STATUS_JSON_MAX];
+	uint32_t version;
 
-	ESP_LOGI(TAG, "OTAstatus requested");
+	// Polled during an upload, only rebuilt when the monitor task changes the status
+	if (http_cache_try_serve(req, HTTP_CACHE_OTA_STATUS, &version))
+	{
+		return ESP_OK;
+	}
 
-	sprintf(otaJSON, "{\"ota_update_status\":%d,\"compile_time\":\"%s\",\"compile_date\":\"%s\"}", g_fw_update_status, __TIME__, __DATE__);
+	ESP_LOGI(TAG, "OTAstatus requested");
 
-	httpd_resp_set_type(req, "application/json");
-	httpd_resp_send(req, otaJSON, strlen(otaJSON));
+	api_format_ota_status(otaJSON, sizeof(otaJSON), &status);
 
-	return ESP_OK;
+	return http_cache_send(req, HTTP_CACHE_OTA_STATUS, version, otaJSON);
 }
 
 
@@ -358,11 +494,19 @@ static httpd_handle_t http_server_configure(void)
 	// Generate the default configuration
 	httpd_config_t config = HTTPD_DEFAULT_CONFIG();
 
-	// Create HTTP server monitor task
-	xTaskCreatePinnedToCore(&http_server_monitor, "http_server_monitor", HTTP_SERVER_MONITOR_STACK_SIZE, NULL, HTTP_SERVER_MONITOR_PRIORITY, &task_http_server_monitor, HTTP_SERVER_MONITOR_CORE_ID);
+	// Create the message queue and the monitor task that reads it, both stay across restarts
+	if (http_server_monitor_queue_handle == NULL)
+	{
+		http_server_monitor_queue_handle = event_bus_queue_create(STATIC_QUEUE_HTTP_SERVER_MONITOR);
+		ESP_ERROR_CHECK(event_bus_subscribe(EVENT_TOPIC_HTTP_MONITOR, http_server_monitor_queue_handle));
+		task_http_server_monitor = static_alloc_task_create(STATIC_TASK_HTTP_SERVER_MONITOR, &http_server_monitor, NULL);
+	}
 
-	// Create the message queue
-	http_server_monitor_queue_handle = xQueueCreate(3, sizeof(http_server_queue_message_t));
+	auth_init();
+	http_admit_load_limits();
+	assets_init();
+
+	// httpd allocates its task from the heap, its stack is listed in GET /api/memory
 
 	// The core that the HTTP server will run on
 	config.core_id = HTTP_SERVER_TASK_CORE_ID;
@@ -373,181 +517,71 @@ static httpd_handle_t http_server_configure(void)
 	// Bump up the stack size (default is 4096)
 	config.stack_size = HTTP_SERVER_TASK_STACK_SIZE;
 
-	// Increase uri handlers
-	config.max_uri_handlers = 20;
+	// 80 on the device, the host build listens on an unprivileged port
+	config.server_port = CONFIG_HTTP_SERVER_PORT;
+
+	// One per generated route
+	config.max_uri_handlers = API_ROUTE_COUNT;
+
+	// For the catch-all GET of the files only found in the assets partition
+	config.uri_match_fn = httpd_uri_match_wildcard;
 
 	// Increase the timeout limits
 	config.recv_wait_timeout = 10;
 	config.send_wait_timeout = 10;
 
+	// Socket limits, fair sharing between clients and idle timeouts, see http_conn.h.
+	// Connections (and with HTTPS their TLS sessions) stay open for repeat requests.
+	http_conn_configure(&config);
+
+#if CONFIG_HTTP_SERVER_HTTPS
+	httpd_ssl_config_t ssl_config = HTTPD_SSL_CONFIG_DEFAULT();
+
+	ssl_config.httpd = config;
+	ssl_config.port_secure = CONFIG_HTTP_SERVER_HTTPS_PORT;
+	ssl_config.servercert = servercert_pem_start;
+	ssl_config.servercert_len = servercert_pem_end - servercert_pem_start;
+	ssl_config.prvtkey_pem = prvtkey_pem_start;
+	ssl_config.prvtkey_len = prvtkey_pem_end - prvtkey_pem_start;
+#if CONFIG_HTTP_SERVER_HTTPS_SESSION_TICKETS
+	// Returning clients resume with a ticket and skip the ECDHE and ECDSA operations
+	ssl_config.session_tickets = true;
+#endif
+
+	ESP_LOGI(TAG,
+			"http_server_configure: Starting HTTPS server on port: '%d' with task priority: '%d'",
+			ssl_config.port_secure,
+			config.task_priority);
+
+	esp_err_t err = httpd_ssl_start(&http_server_handle, &ssl_config);
+#else
 	ESP_LOGI(TAG,
 			"http_server_configure: Starting server on port: '%d' with task priority: '%d'",
 			config.server_port,
 			config.task_priority);
 
+	esp_err_t err = httpd_start(&http_server_handle, &config);
+#endif
+
 	// Start the httpd server
-	if (httpd_start(&http_server_handle, &config) == ESP_OK)
+	if (err == ESP_OK)
 	{
+		http_conn_start(http_server_handle);
+
 		ESP_LOGI(TAG, "http_server_configure: Registering URI handlers");
 
-		// register query handler
-		httpd_uri_t jquery_js = {
-				.uri = "/jquery-3.3.1.min.js",
-				.method = HTTP_GET,
-				.handler = http_server_jquery_handler,
-				.user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &jquery_js);
-
-		// register index.html handler
-		httpd_uri_t index_html = {
-				.uri = "/",
-				.method = HTTP_GET,
-				.handler = http_server_index_html_handler,
-				.user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &index_html);
-
-		// register app.css handler
-		httpd_uri_t app_css = {
-				.uri = "/app.css",
-				.method = HTTP_GET,
-				.handler = http_server_app_css_handler,
-				.user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &app_css);
-
-		// register app.js handler
-		httpd_uri_t app_js = {
-				.uri = "/app.js",
-				.method = HTTP_GET,
-				.handler = http_server_app_js_handler,
-				.user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &app_js);
-		// register favicon.ico handler
-		httpd_uri_t favicon_ico = {
-				.uri = "/favicon.ico",
-				.method = HTTP_GET,
-				.handler = http_server_favicon_ico_handler,
-				.user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &favicon_ico);
-		
-		httpd_uri_t OTA_update = {
-				.uri = "/api/OTA/update",
-				.method = HTTP_POST,
-				.handler = http_server_OTA_update_handler,
-				.user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &OTA_update);
-
-		// register OTAstatus handler
-		httpd_uri_t OTA_status = {
-				.uri = "/api/OTA/status",
-				.method = HTTP_POST,
-				.handler = http_server_OTA_status_handler,
-				.user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &OTA_status);
-
-
-	    // GET /api/leds/1
-	    httpd_uri_t get_led1 = {
-	        .uri = "/api/leds/1",
-	        .method = HTTP_GET,
-	        .handler = led_get_handler,
-	        .user_ctx = NULL
-	    };
-	    httpd_register_uri_handler(http_server_handle, &get_led1);
-	
-	    // GET /api/leds/2
-	    httpd_uri_t get_led2 = {
-	        .uri = "/api/leds/2",
-	        .method = HTTP_GET,
-	        .handler = led_get_handler,
-	        .user_ctx = NULL
-	    };
-	    httpd_register_uri_handler(http_server_handle, &get_led2);
-	    
-	    // GET /api/leds/3
-		httpd_uri_t get_led3 = {
-		    .uri = "/api/leds/3",
-		    .method = HTTP_GET,
-		    .handler = led_get_handler,
-		    .user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &get_led3);
-		
-		// GET /api/leds/4
-		httpd_uri_t get_led4 = {
-		    .uri = "/api/leds/4",
-		    .method = HTTP_GET,
-		    .handler = led_get_handler,
-		    .user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &get_led4);
-	
-	    // POST /api/leds/1/toggle
-	    httpd_uri_t post_toggle1 = {
-	        .uri = "/api/leds/1/toggle",
-	        .method = HTTP_POST,
-	        .handler = led_toggle_handler,
-	        .user_ctx = NULL
-	    };
-	    httpd_register_uri_handler(http_server_handle, &post_toggle1);
-	
-	    // POST /api/leds/2/toggle
-	    httpd_uri_t post_toggle2 = {
-	        .uri = "/api/leds/2/toggle",
-	        .method = HTTP_POST,
-	        .handler = led_toggle_handler,
-	        .user_ctx = NULL
-	    };
-	    httpd_register_uri_handler(http_server_handle, &post_toggle2);
-	    
-	    // POST /api/leds/3/toggle
-		httpd_uri_t post_toggle3 = {
-		    .uri = "/api/leds/3/toggle",
-		    .method = HTTP_POST,
-		    .handler = led_toggle_handler,
-		    .user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &post_toggle3);
-		
-		// POST /api/leds/4/toggle
-		httpd_uri_t post_toggle4 = {
-		    .uri = "/api/leds/4/toggle",
-		    .method = HTTP_POST,
-		    .handler = led_toggle_handler,
-		    .user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &post_toggle4);
-		
-		//network settings handlers	    
-	    httpd_uri_t settings_net_post = {
-    			 .uri = "/api/config/network",
-   				 .method = HTTP_POST,
-   				 .handler = settings_net_post_handler,
-   				 .user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &settings_net_post);
-		
-		httpd_uri_t settings_net_get = {
-    			 .uri = "/api/config/network",
-   				 .method = HTTP_GET,
-   				 .handler = settings_net_get_handler,
-   				 .user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &settings_net_get);
-		
-				httpd_uri_t ip_addr_get = {
-    			 .uri = "/api/config/ip_addr",
-   				 .method = HTTP_GET,
-   				 .handler = settings_ip_get_handler,
-   				 .user_ctx = NULL
-		};
-		httpd_register_uri_handler(http_server_handle, &ip_addr_get);
+		// Routes, wrappers and request validation are generated from swagger.yaml (tools/gen_routes.py),
+		// the wrappers admit, authorize and parse before they call the handlers below
+		for (size_t i = 0; i < api_route_count; i++)
+		{
+			httpd_uri_t uri = {
+					.uri = api_routes[i].uri,
+					.method = api_routes[i].method,
+					.handler = api_routes[i].handler,
+					.user_ctx = (void *)api_routes[i].admit
+			};
+			httpd_register_uri_handler(http_server_handle, &uri);
+		}
 		
 		return http_server_handle;
 	}
@@ -568,232 +602,298 @@ void http_server_stop(void)
 {
 	if (http_server_handle)
 	{
+		http_conn_stop();
+#if CONFIG_HTTP_SERVER_HTTPS
+		httpd_ssl_stop(http_server_handle);
+#else
 		httpd_stop(http_server_handle);
+#endif
 		ESP_LOGI(TAG, "http_server_stop: stopping HTTP server");
 		http_server_handle = NULL;
 	}
-	if (task_http_server_monitor)
-	{
-		vTaskDelete(task_http_server_monitor);
-		ESP_LOGI(TAG, "http_server_stop: stopping HTTP server monitor");
-		task_http_server_monitor = NULL;
-	}
+	// The monitor task lives in static memory and keeps running, see http_server_configure
 }
 
 BaseType_t http_server_monitor_send_message(http_server_message_e msgID)
 {
-	http_server_queue_message_t msg;
-	msg.msgID = msgID;
-	return xQueueSend(http_server_monitor_queue_handle, &msg, portMAX_DELAY);
+	TRACE_INSTANT(TRACE_EV_HTTP_MONITOR_SEND, msgID);
+
+	// Dropped (and counted) if the server monitor is not up yet
+	return event_bus_publish(EVENT_TOPIC_HTTP_MONITOR, msgID, NULL) ? pdTRUE : pdFALSE;
 }
 
 
 /**
- * Helper: convert numeric led state (0/1) to "off"/"on" string.
- * Returns pointer to a literal (do not free).
+ * GET handler for /api/leds/{id}
+ * Responds with JSON: { "id": n, "state": "on"|"off", "version": v }
  */
-static const char* led_state_str_from_level(int level)
+esp_err_t led_get_handler(httpd_req_t *req, const api_led_get_in_t *in)
 {
-    return level ? "on" : "off";
-}
+    io_cmd_result_t state;
 
+    io_cmd_get_state(&state);
+
+    api_led_t led = {
+        .id = in->id,
+        .state = (state.mask & BIT(in->id - 1)) ? API_LED_STATE_ON : API_LED_STATE_OFF,
+        .version = state.version,
+    };
+
+    return api_send_led(req, &led);
+}
 
 /**
- * GET handler for /api/leds/{id}
- * Responds with JSON: { "id": n, "state": "on"|"off" }
+ * POST handler for /api/leds/{id}/toggle
+ * A request body is ignored, httpd discards it. Queues the toggle, waits until the
+ * IO task wrote it and returns the new state with its version.
+ *
+ * Response JSON: { "id": n, "state": "on"|"off", "version": v }
  */
-static esp_err_t led_get_handler(httpd_req_t *req)
+esp_err_t led_toggle_handler(httpd_req_t *req, const api_led_toggle_in_t *in)
 {
-	set_cors_headers(req);
-    ESP_LOGI(TAG, "LED GET request: %s", req->uri);
-
-    int led_id = 0;
-    // parse LED id from URI: /api/leds/<id>
-    if (sscanf(req->uri, "/api/leds/%d", &led_id) != 1) {
-        ESP_LOGE(TAG, "Failed to parse LED id from URI: %s", req->uri);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid URI");
-        return ESP_FAIL;
-    }
+    io_cmd_result_t state;
+    TRACE_SCOPE(TRACE_EV_LED_TOGGLE, in->id);
 
-    if (led_id < 1 || led_id > 4) {
-        ESP_LOGE(TAG, "Invalid LED id: %d", led_id);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid LED ID");
-        return ESP_FAIL;
+    esp_err_t err = io_cmd_toggle(IO_CMD_SOURCE_HTTP, BIT(in->id - 1), &state);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "LED%d toggle not queued: %s", (int)in->id, esp_err_to_name(err));
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        httpd_resp_sendstr(req, "IO command queue full");
+        api_journal_result(JOURNAL_RESULT_BUSY);
+        return ESP_OK;
     }
 
-    int level = io_led_get_state(led_id);
-    if (level < 0) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "GPIO read error");
-        return ESP_FAIL;
-    }
+    api_led_t led = {
+        .id = in->id,
+        .state = (state.mask & BIT(in->id - 1)) ? API_LED_STATE_ON : API_LED_STATE_OFF,
+        .version = state.version,
+    };
 
-    cJSON *resp = cJSON_CreateObject();
-    cJSON_AddNumberToObject(resp, "id", led_id);
-    cJSON_AddStringToObject(resp, "state", led_state_str_from_level(level));
+    return api_send_led(req, &led);
+}
 
-    const char *json_out = cJSON_PrintUnformatted(resp);
-    if (json_out == NULL) {
-        cJSON_Delete(resp);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "JSON error");
-        return ESP_FAIL;
-    }
+//***************************SCENE HANDLERS*****************************/
+
+// The API enums list the names of scene_vm.h in the same order
+_Static_assert((int)API_SCENE_STATE_COUNT == (int)SCENE_VM_STATE_COUNT, "api_scene_state_e and scene_vm_state_e differ");
+_Static_assert((int)API_SCENE_FAULT_COUNT == (int)SCENE_VM_FAULT_COUNT, "api_scene_fault_e and scene_vm_fault_e differ");
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_out, strlen(json_out));
+static void scene_get_api(int slot, api_scene_t *scene)
+{
+	scene_status_t status;
+
+	scene_get_status(slot, &status);
+	*scene = (api_scene_t){
+			.slot = slot,
+			.stored = status.stored,
+			.autostart = status.autostart,
+			.size = status.size,
+			.state = (api_scene_state_e)status.state,
+			.fault = (api_scene_fault_e)status.fault,
+			.pc = status.pc,
+			.instructions = (int32_t)status.instructions,
+			.budget_yields = (int32_t)status.budget_yields,
+	};
+}
 
-    free((void*)json_out);
-    cJSON_Delete(resp);
+static esp_err_t scene_send_status(httpd_req_t *req, int slot)
+{
+	api_scene_t scene;
 
-    return ESP_OK;
+	scene_get_api(slot, &scene);
+	httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+	return api_send_scene(req, &scene);
 }
 
 /**
- * POST handler for /api/leds/{id}/toggle
- *
- * It reads request body (if any) similarly to example you provided,
- * but body content is ignored — endpoint toggles the LED and returns new state.
- *
- * Response JSON: { "id": n, "state": "on"|"off" }
+ * GET /api/scenes
+ * Scheduler settings and statistics, then the state of every slot.
  */
-static esp_err_t led_toggle_handler(httpd_req_t *req)
-{
-	set_cors_headers(req);
-    ESP_LOGI(TAG, "LED TOGGLE request: %s", req->uri);
-
-    int led_id = 0;
-    // parse LED id from URI: /api/leds/<id>/toggle
-    if (sscanf(req->uri, "/api/leds/%d/toggle", &led_id) != 1) {
-        ESP_LOGE(TAG, "Failed to parse LED id from URI: %s", req->uri);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid URI");
-        return ESP_FAIL;
-    }
+esp_err_t scenes_get_handler(httpd_req_t *req){
+	scene_stats_t stats;
+	api_scene_t scene;
+	char resp_str[API_SCENE_JSON_MAX + 1];
 
-    if (led_id < 1 || led_id > 4) {
-        ESP_LOGE(TAG, "Invalid LED id: %d", led_id);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid LED ID");
-        return ESP_FAIL;
-    }
+	scene_get_stats(&stats);
 
+	snprintf(resp_str, sizeof(resp_str), "{\"tick_ms\":%d,\"budget\":%d,\"ticks\":%u,\"writes\":%u,\"writes_dropped\":%u,\"slots\":[",
+			CONFIG_SCENE_TICK_MS, CONFIG_SCENE_STEP_BUDGET, (unsigned)stats.ticks, (unsigned)stats.writes,
+			(unsigned)stats.writes_dropped);
+	httpd_resp_set_type(req, "application/json");
+	httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+	httpd_resp_sendstr_chunk(req, resp_str);
 
-    int content_len = req->content_len;
-    if (content_len > 0) {
-        // limit to reasonable size
-        const int max_buf = 1024;
-        int to_read = content_len > max_buf - 1 ? max_buf - 1 : content_len;
-        char *buf = malloc(to_read + 1);
-        if (buf == NULL) {
-            ESP_LOGE(TAG, "Out of memory reading body");
-            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
-            return ESP_FAIL;
-        }
-        int read_len = 0;
-        while (read_len < to_read) {
-            int r = httpd_req_recv(req, buf + read_len, to_read - read_len);
-            if (r == HTTPD_SOCK_ERR_TIMEOUT) {
-                ESP_LOGW(TAG, "recv timeout, continuing");
-                continue;
-            } else if (r <= 0) {
-                ESP_LOGW(TAG, "recv returned %d", r);
-                break;
-            }
-            read_len += r;
-        }
-        buf[read_len] = '\0';
-        ESP_LOGI(TAG, "Received body (truncated to %d bytes): %s", read_len, buf);
-        free(buf);
+	for (int i = 0; i < SCENE_SLOTS; i++)
+	{
+		scene_get_api(i, &scene);
+		if (i > 0)
+		{
+			httpd_resp_sendstr_chunk(req, ",");
+		}
+		api_format_scene(resp_str, sizeof(resp_str), &scene);
+		httpd_resp_sendstr_chunk(req, resp_str);
+	}
 
-        
-    } else ESP_LOGI(TAG, "No request body");
-    
+	httpd_resp_sendstr_chunk(req, "]}");
+	httpd_resp_sendstr_chunk(req, NULL);
 
-    // Toggle LED using io layer
-    esp_err_t err = io_led_toggle(led_id);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to toggle LED%d", led_id);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "GPIO toggle failed");
-        return ESP_FAIL;
-    }
+	return ESP_OK;
+}
 
-    // read new level
-    int new_level = io_led_get_state(led_id);
-    if (new_level < 0) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "GPIO read error");
-        return ESP_FAIL;
-    }
+/**
+ * PUT /api/scenes/{slot}
+ * Body: a program blob of tools/scene_asm.py. Verified, saved to NVS, not started.
+ */
+esp_err_t scene_put_handler(httpd_req_t *req, const api_scene_put_in_t *in){
+	uint8_t blob[SCENE_VM_BLOB_MAX];
+	char msg[64];
+	int received = 0;
+	int ret;
+	scene_vm_fault_e fault;
+	uint16_t fault_pc;
+
+	if (req->content_len == 0 || req->content_len > sizeof(blob))
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Program of 1..256 bytes expected");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
 
-    // build response JSON
-    cJSON *resp = cJSON_CreateObject();
-    cJSON_AddNumberToObject(resp, "id", led_id);
-    cJSON_AddStringToObject(resp, "state", led_state_str_from_level(new_level));
+	while (received < req->content_len)
+	{
+		ret = httpd_req_recv(req, (char*)blob + received, req->content_len - received);
+		if (ret == HTTPD_SOCK_ERR_TIMEOUT)
+		{
+			continue;
+		}
+		if (ret <= 0)
+		{
+			return ESP_FAIL;
+		}
+		received += ret;
+	}
 
-    const char *json_out = cJSON_PrintUnformatted(resp);
-    if (json_out == NULL) {
-        cJSON_Delete(resp);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "JSON error");
-        return ESP_FAIL;
-    }
+	esp_err_t err = scene_store(in->slot, blob, received, &fault, &fault_pc);
+	if (err == ESP_ERR_INVALID_ARG)
+	{
+		snprintf(msg, sizeof(msg), "Invalid program: %s at %u", scene_vm_fault_name(fault), fault_pc);
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, msg);
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	if (err != ESP_OK)
+	{
+		httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save the program");
+		return err;
+	}
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_out, strlen(json_out));
+	return scene_send_status(req, in->slot);
+}
 
-    free((void*)json_out);
-    cJSON_Delete(resp);
+/**
+ * DELETE /api/scenes/{slot}
+ */
+esp_err_t scene_delete_handler(httpd_req_t *req, const api_scene_delete_in_t *in){
+	esp_err_t err = scene_erase(in->slot);
 
-    return ESP_OK;
+	if (err == ESP_ERR_NOT_FOUND)
+	{
+		httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No program in this slot");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	if (err != ESP_OK)
+	{
+		// Gone from RAM, the NVS copy comes back at the next boot
+		ESP_LOGW(TAG, "Scene slot %d not erased from NVS: %s", (int)in->slot, esp_err_to_name(err));
+	}
+
+	return scene_send_status(req, in->slot);
+}
+
+/**
+ * POST /api/scenes/{slot}/run
+ * Starts the program from the beginning, the response shows it running.
+ */
+esp_err_t scene_run_post_handler(httpd_req_t *req, const api_scene_run_post_in_t *in){
+	if (scene_run(in->slot) != ESP_OK)
+	{
+		httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No program in this slot");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	return scene_send_status(req, in->slot);
+}
+
+/**
+ * POST /api/scenes/{slot}/stop
+ */
+esp_err_t scene_stop_post_handler(httpd_req_t *req, const api_scene_stop_post_in_t *in){
+	if (scene_stop(in->slot) != ESP_OK)
+	{
+		httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No program in this slot");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	return scene_send_status(req, in->slot);
 }
 
 //***************************SETTINGS HANDLERS*****************************/
-static esp_err_t settings_net_post_handler(httpd_req_t *req){
-	set_cors_headers(req);
-    ESP_LOGI(TAG, "Set serial number requested");
-    char buf[256] = { 0 };
-    int ret, total_length = 0;
-    
-    
-   // Receive full request body
-    do {
-        ret = httpd_req_recv(req, buf + total_length, sizeof(buf) - total_length - 1);
-        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
-            ESP_LOGI(TAG, "timeout, continue receiving");
-            continue;
-        }
-        if (ret < 0) {
-            ESP_LOGE(TAG, "Error receiving data! (status = %d)", ret);
-            return ESP_FAIL;
-        }
-        total_length += ret;
-        buf[total_length] = '\0';
-    } while (ret >= sizeof(buf) - total_length);
-
-    ESP_LOGI(TAG, "Received JSON: %s", buf);
-
-    // Parse JSON to extract password and ssid
-    cJSON *json = cJSON_Parse(buf);
-    if (!json) {
-        ESP_LOGE(TAG, "Failed to parse JSON");
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
-        return ESP_FAIL;
-    }
 
-    const cJSON *password_json = cJSON_GetObjectItemCaseSensitive(json, "password");
-    const cJSON *ssid_json = cJSON_GetObjectItemCaseSensitive(json, "ssid");
-    if (!cJSON_IsString(password_json) || (password_json->valuestring == NULL)||!cJSON_IsString(ssid_json) || (ssid_json->valuestring == NULL)) {
-        ESP_LOGE(TAG, "network data missing or not a string");
-        cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "serial_number is required");
-        return ESP_FAIL;
-    }
-	
-	strcpy(network_data.ssid, ssid_json->valuestring);
-	strcpy(network_data.password, password_json->valuestring);
-	
+/**
+ * nvs_config_update function of POST /api/config/network, ctx is the checked request body.
+ */
+static bool settings_net_store(nvs_config_t *cfg, void *ctx){
+	const api_network_config_t *net = ctx;
+
+	// A different network invalidates the cached AP used for the fast reconnect
+	if (strcmp(cfg->network.ssid, net->ssid) != 0) {
+		memset(&cfg->sta_cache, 0, sizeof(cfg->sta_cache));
+	}
+	strcpy(cfg->network.ssid, net->ssid);
+	strcpy(cfg->network.password, net->password);
+
+	if (net->has_static_ip && net->static_ip_is_null) {
+		cfg->static_ip.enabled = false;
+	} else if (net->has_static_ip) {
+		cfg->static_ip = (nvs_static_ip_t){
+			.enabled = true,
+			.ip = net->static_ip.ip,
+			.netmask = net->static_ip.netmask,
+			.gw = net->static_ip.gw,
+			.dns = net->static_ip.dns,
+		};
+	}
+	network_data = cfg->network;
+	return true;
+}
+
+/**
+ * POST /api/config/network { "ssid", "password", "static_ip": { "ip", "netmask", "gw", "dns" } | null }
+ * static_ip left out keeps the IP setup, null switches back to DHCP.
+ */
+esp_err_t settings_net_post_handler(httpd_req_t *req, const api_settings_net_post_in_t *in){
+    const api_network_config_t *net = &in->body;
+
+    ESP_LOGI(TAG, "Network settings received, SSID %s", net->ssid);
+
+	if (net->has_static_ip && !net->static_ip_is_null
+			&& (net->static_ip.ip == 0 || net->static_ip.netmask == 0)) {
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid static IP settings");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
     // Save to NVS
-    esp_err_t err = nvs_save_network_data(&network_data);
-    cJSON_Delete(json);
+    esp_err_t err = nvs_config_update(settings_net_store, (void *)net);
+    http_cache_invalidate(HTTP_CACHE_SETTINGS_NET);
 
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save serial number (err=0x%x)", err);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save serial number");
+        ESP_LOGE(TAG, "Failed to save network settings (err=0x%x)", err);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save network settings");
         return err;
     }
 
@@ -801,50 +901,906 @@ static esp_err_t settings_net_post_handler(httpd_req_t *req){
     return ESP_OK;
 }
 
-static esp_err_t settings_net_get_handler(httpd_req_t *req){
-	set_cors_headers(req);
+esp_err_t settings_net_get_handler(httpd_req_t *req){
+    uint32_t version;
+
+    // Only changes when the settings are saved, a hit doesn't touch NVS
+    if (http_cache_try_serve(req, HTTP_CACHE_SETTINGS_NET, &version)) {
+        return ESP_OK;
+    }
+
     ESP_LOGI(TAG, "JSON data requested");
 
     esp_err_t err = nvs_load_network_data(&network_data);
 
     if (err == ESP_ERR_NVS_NOT_FOUND) {
         ESP_LOGW(TAG, "Serial number not found");
-        httpd_resp_sendstr(req, "{\"serial_number\":null}");
-        return ESP_OK;
+        return http_cache_send(req, HTTP_CACHE_SETTINGS_NET, version, "{\"serial_number\":null}");
     } else if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to load serial number (err=0x%x)", err);
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read serial number");
         return err;
     }
 
-    // Construct JSON response
-    char json_response[128];
-    snprintf(json_response, sizeof(json_response), "{\"ssid\":\"%s\",\"password\":\"%s\"}", network_data.ssid, network_data.password);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, json_response);
+    nvs_config_t cfg;
+    api_network_config_t net = { 0 };
+    char json_response[API_NETWORK_CONFIG_JSON_MAX];
+
+    nvs_config_get(&cfg);
+
+    strlcpy(net.ssid, network_data.ssid, sizeof(net.ssid));
+    strlcpy(net.password, network_data.password, sizeof(net.password));
+    if (cfg.static_ip.enabled) {
+        net.has_static_ip = true;
+        net.static_ip = (api_static_ip_t){
+            .ip = cfg.static_ip.ip,
+            .netmask = cfg.static_ip.netmask,
+            .has_gw = true,
+            .gw = cfg.static_ip.gw,
+            .has_dns = true,
+            .dns = cfg.static_ip.dns,
+        };
+    }
+    api_format_network_config(json_response, sizeof(json_response), &net);
 
-    return ESP_OK;
+    return http_cache_send(req, HTTP_CACHE_SETTINGS_NET, version, json_response);
 
 }
 
 
-static esp_err_t settings_ip_get_handler(httpd_req_t *req){
-    char resp_str[64] = {0};
+esp_err_t settings_ip_get_handler(httpd_req_t *req){
+    char resp_str[API_IP_ADDRESS_JSON_MAX];
+    api_ip_address_t addr = { 0 };
+    uint32_t version;
+
+    // Invalidated by the WiFi application on IP changes
+    if (http_cache_try_serve(req, HTTP_CACHE_SETTINGS_IP, &version)) {
+        return ESP_OK;
+    }
 
     if (esp_netif_sta != NULL){
         esp_netif_ip_info_t ip_info;
         if (esp_netif_get_ip_info(esp_netif_sta, &ip_info) == ESP_OK){
-            snprintf(resp_str, sizeof(resp_str), "{\"ip\":\"" IPSTR "\"}", IP2STR(&ip_info.ip));
+            addr.ip = ip_info.ip.addr;
         }
-        else snprintf(resp_str, sizeof(resp_str), "{\"ip\":\"0.0.0.0\"}");
-
     }
-    else snprintf(resp_str, sizeof(resp_str), "{\"ip\":\"0.0.0.0\"}");
-    
+    api_format_ip_address(resp_str, sizeof(resp_str), &addr);
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp_str, HTTPD_RESP_USE_STRLEN);
+    return http_cache_send(req, HTTP_CACHE_SETTINGS_IP, version, resp_str);
+}
 
-    return ESP_OK;
+/**
+ * GET handler for /api/metrics
+ * Responds with the STA connection metrics.
+ */
+esp_err_t metrics_get_handler(httpd_req_t *req){
+	wifi_app_metrics_t metrics;
+	event_bus_stats_t bus;
+	http_cache_stats_t cache;
+	auth_stats_t auth;
+	http_conn_stats_t conn;
+	http_admit_stats_t admit;
+	io_cmd_stats_t io;
+	char resp_str[1424];
+
+	wifi_app_get_metrics(&metrics);
+	event_bus_get_stats(&bus);
+	http_cache_get_stats(&cache);
+	auth_get_stats(&auth);
+	http_conn_get_stats(&conn);
+	http_admit_get_stats(&admit);
+	io_cmd_get_stats(&io);
+
+	snprintf(resp_str, sizeof(resp_str),
+			"{\"time_to_ip_ms\":%d,\"fast_connect\":%s,\"fast_connect_ok\":%s,\"static_ip\":%s,"
+			"\"sta_state\":\"%s\",\"connect_attempts\":%u,\"circuit_breaks\":%u,\"ap_active\":%s,\"ap_channel\":%d,"
+			"\"event_bus\":{\"published\":%u,\"delivered\":%u,\"dropped_pool_full\":%u,\"dropped_queue_full\":%u,"
+			"\"dropped_no_subscriber\":%u,\"dropped_control\":%u,\"pool_in_use\":%u,\"pool_high_water\":%u},"
+			"\"http_cache\":{\"not_modified\":%u,\"hits\":%u,\"misses\":%u},"
+			"\"auth\":{\"enabled\":%s,\"sessions\":%u,\"logins\":%u,\"login_failures\":%u,\"rejected\":%u,\"evicted\":%u,\"expired\":%u},"
+			"\"connections\":{\"active\":%u,\"active_high_water\":%u,\"clients\":%u,\"accepted\":%u,\"refused\":%u,"
+			"\"purged\":%u,\"idle_closed\":%u,\"limit_closed\":%u},"
+			"\"admission\":{\"admitted\":%u,\"limited\":{\"read\":%u,\"control\":%u,\"login\":%u,\"heavy\":%u},"
+			"\"busy\":%u,\"clients_evicted\":%u},"
+			"\"io_cmd\":{\"commands\":{\"http\":%u,\"udp\":%u,\"mqtt\":%u,\"scene\":%u},\"batches\":%u,\"queue_full\":%u,"
+			"\"batch_high_water\":%u,\"latency_max_us\":%u}}",
+			(int)(metrics.time_to_ip_us / 1000),
+			metrics.fast_connect ? "true" : "false",
+			metrics.fast_connect_ok ? "true" : "false",
+			metrics.static_ip ? "true" : "false",
+			metrics.sta_state,
+			(unsigned)metrics.connect_attempts,
+			(unsigned)metrics.circuit_breaks,
+			metrics.ap_active ? "true" : "false",
+			metrics.ap_channel,
+			(unsigned)bus.published,
+			(unsigned)bus.delivered,
+			(unsigned)bus.dropped_pool_full,
+			(unsigned)bus.dropped_queue_full,
+			(unsigned)bus.dropped_no_subscriber,
+			(unsigned)bus.dropped_control,
+			(unsigned)bus.pool_in_use,
+			(unsigned)bus.pool_high_water,
+			(unsigned)cache.not_modified,
+			(unsigned)cache.hits,
+			(unsigned)cache.misses,
+			auth_is_enabled() ? "true" : "false",
+			(unsigned)auth.active,
+			(unsigned)auth.logins,
+			(unsigned)auth.login_failures,
+			(unsigned)auth.rejected,
+			(unsigned)auth.evicted,
+			(unsigned)auth.expired,
+			(unsigned)conn.active,
+			(unsigned)conn.active_high_water,
+			(unsigned)conn.clients,
+			(unsigned)conn.accepted,
+			(unsigned)conn.refused,
+			(unsigned)conn.purged,
+			(unsigned)conn.idle_closed,
+			(unsigned)conn.limit_closed,
+			(unsigned)admit.admitted,
+			(unsigned)admit.limited[HTTP_ADMIT_READ],
+			(unsigned)admit.limited[HTTP_ADMIT_CONTROL],
+			(unsigned)admit.limited[HTTP_ADMIT_LOGIN],
+			(unsigned)admit.limited[HTTP_ADMIT_HEAVY],
+			(unsigned)admit.busy,
+			(unsigned)admit.clients_evicted,
+			(unsigned)io.commands[IO_CMD_SOURCE_HTTP],
+			(unsigned)io.commands[IO_CMD_SOURCE_UDP],
+			(unsigned)io.commands[IO_CMD_SOURCE_MQTT],
+			(unsigned)io.commands[IO_CMD_SOURCE_SCENE],
+			(unsigned)io.batches,
+			(unsigned)io.queue_full,
+			(unsigned)io.batch_high_water,
+			(unsigned)io.latency_max_us);
+
+	httpd_resp_set_type(req, "application/json");
+	httpd_resp_send(req, resp_str, HTTPD_RESP_USE_STRLEN);
+
+	return ESP_OK;
+}
+
+/**
+ * Name of the command of a journal record, from the tables of the running firmware.
+ */
+static const char* journal_route_name(const journal_record_t *rec, char *buf, size_t size)
+{
+	static const char *const udp_cmds[] = {
+			[UDP_CTRL_CMD_GET] = "get",
+			[UDP_CTRL_CMD_SET] = "set",
+			[UDP_CTRL_CMD_CLEAR] = "clear",
+			[UDP_CTRL_CMD_TOGGLE] = "toggle",
+			[UDP_CTRL_CMD_WRITE] = "write",
+	};
+	static const char *const mqtt_ops[] = {
+			[IO_CMD_OP_WRITE] = "write",
+			[IO_CMD_OP_TOGGLE] = "toggle",
+	};
+
+	if (rec->source == JOURNAL_SOURCE_HTTP && rec->route < API_OP_COUNT)
+	{
+		return api_operation_names[rec->route];
+	}
+	if (rec->source == JOURNAL_SOURCE_UDP && rec->route < sizeof(udp_cmds) / sizeof(udp_cmds[0]))
+	{
+		return udp_cmds[rec->route];
+	}
+	if (rec->source == JOURNAL_SOURCE_MQTT && rec->route < sizeof(mqtt_ops) / sizeof(mqtt_ops[0]))
+	{
+		return mqtt_ops[rec->route];
+	}
+
+	snprintf(buf, size, "%u", (unsigned)rec->route);
+	return buf;
+}
+
+/**
+ * GET /api/journal?since=&limit=
+ * One page of the command journal, streamed a record per chunk. next is the cursor of
+ * the following page.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t journal_get_handler(httpd_req_t *req, const api_journal_get_in_t *in){
+	journal_record_t rec;
+	uint32_t oldest, next, seq, end;
+	esp_ip4_addr_t client;
+	char client_str[16];
+	char route_str[8];
+	char resp_str[256];
+	bool first = true;
+
+	journal_get_range(&oldest, &next);
+
+	// A cursor beyond the end belongs to a journal that started over
+	seq = (uint32_t)in->since > next ? oldest : MAX((uint32_t)in->since, oldest);
+	end = MIN(next, seq + in->limit);
+
+	snprintf(resp_str, sizeof(resp_str), "{\"boot\":%u,\"oldest\":%u,\"next\":%u,\"more\":%s,\"records\":[",
+			(unsigned)journal_boot(), (unsigned)oldest, (unsigned)end, end < next ? "true" : "false");
+	httpd_resp_set_type(req, "application/json");
+	httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+	httpd_resp_sendstr_chunk(req, resp_str);
+
+	for (; seq < end; seq++)
+	{
+		// Overwritten while the page was sent
+		if (!journal_read(seq, &rec))
+		{
+			continue;
+		}
+
+		client_str[0] = '\0';
+		if (rec.client != 0)
+		{
+			client.addr = rec.client;
+			snprintf(client_str, sizeof(client_str), IPSTR, IP2STR(&client));
+		}
+
+		snprintf(resp_str, sizeof(resp_str),
+				"%s{\"seq\":%u,\"boot\":%u,\"time_ms\":%u,\"source\":\"%s\",\"client\":\"%s\",\"route\":\"%s\","
+				"\"channel\":%u,\"result\":\"%s\",\"latency_us\":%u}",
+				first ? "" : ",",
+				(unsigned)rec.seq,
+				(unsigned)rec.boot,
+				(unsigned)rec.time_ms,
+				journal_source_name((journal_source_e)rec.source),
+				client_str,
+				journal_route_name(&rec, route_str, sizeof(route_str)),
+				(unsigned)rec.channel,
+				journal_result_name((journal_result_e)rec.result),
+				(unsigned)rec.latency_us);
+		httpd_resp_sendstr_chunk(req, resp_str);
+		first = false;
+	}
+
+	httpd_resp_sendstr_chunk(req, "]}");
+	httpd_resp_sendstr_chunk(req, NULL);
+
+	return ESP_OK;
+}
+
+/**
+ * Boot timeline, all timestamps in us since reset (esp_timer), 0 = phase not reached.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t boot_get_handler(httpd_req_t *req){
+	char resp_str[96];
+
+	httpd_resp_set_type(req, "application/json");
+	httpd_resp_sendstr_chunk(req, "{\"phases\":[");
+
+	for (int i = 0; i < BOOT_PHASE_COUNT; i++)
+	{
+		boot_phase_time_t t = boot_profile_get((boot_phase_e)i);
+		snprintf(resp_str, sizeof(resp_str), "%s{\"name\":\"%s\",\"begin_us\":%lld,\"end_us\":%lld}",
+				i ? "," : "", boot_profile_phase_name((boot_phase_e)i), (long long)t.begin_us, (long long)t.end_us);
+		httpd_resp_sendstr_chunk(req, resp_str);
+	}
+
+	httpd_resp_sendstr_chunk(req, "]}");
+	httpd_resp_sendstr_chunk(req, NULL);
+
+	return ESP_OK;
+}
+
+/**
+ * Memory budget: stack size against the high-water mark (minimum free bytes) of each
+ * long-lived task, queue usage, static and heap totals.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t memory_get_handler(httpd_req_t *req){
+	char resp_str[160];
+	static_alloc_task_info_t task;
+	static_alloc_queue_info_t queue;
+
+	httpd_resp_set_type(req, "application/json");
+	httpd_resp_sendstr_chunk(req, "{\"tasks\":[");
+
+	for (int i = 0; i < static_alloc_task_count(); i++)
+	{
+		static_alloc_get_task_info(i, &task);
+		snprintf(resp_str, sizeof(resp_str), "%s{\"name\":\"%s\",\"stack\":%u,\"high_water\":%u,\"running\":%s,\"static\":%s}",
+				i ? "," : "", task.name, (unsigned)task.stack_size, (unsigned)task.high_water,
+				task.running ? "true" : "false", task.is_static ? "true" : "false");
+		httpd_resp_sendstr_chunk(req, resp_str);
+	}
+
+	httpd_resp_sendstr_chunk(req, "],\"queues\":[");
+
+	for (int i = 0; i < STATIC_QUEUE_COUNT; i++)
+	{
+		static_alloc_get_queue_info((static_queue_e)i, &queue);
+		snprintf(resp_str, sizeof(resp_str), "%s{\"name\":\"%s\",\"depth\":%u,\"item_size\":%u,\"waiting\":%u}",
+				i ? "," : "", queue.name, (unsigned)queue.depth, (unsigned)queue.item_size, (unsigned)queue.waiting);
+		httpd_resp_sendstr_chunk(req, resp_str);
+	}
+
+	snprintf(resp_str, sizeof(resp_str), "],\"static_bytes\":%u,\"heap\":{\"total\":%u,\"free\":%u,\"min_free\":%u,\"largest_free_block\":%u}}",
+			(unsigned)static_alloc_total_bytes(),
+			(unsigned)heap_caps_get_total_size(MALLOC_CAP_8BIT),
+			(unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+			(unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+			(unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+	httpd_resp_sendstr_chunk(req, resp_str);
+	httpd_resp_sendstr_chunk(req, NULL);
+
+	return ESP_OK;
+}
+
+/**
+ * Telemetry time series of one tier: GET /api/telemetry?tier=s|m|h (default s).
+ * Each sample is [uptime_s, heap_free, heap_min, largest_block, rssi, [cpu_permille per task]],
+ * the CPU values are in the order of the tasks array.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t telemetry_get_handler(httpd_req_t *req, const api_telemetry_get_in_t *in){
+	static const char *const tier_names[TELEMETRY_TIER_COUNT] = { "s", "m", "h" };
+	static const int tier_periods[TELEMETRY_TIER_COUNT] = { 1, 60, 3600 };
+	telemetry_task_info_t task;
+	telemetry_sample_t sample;
+	char buf[160];
+	int len;
+
+	// The tier enum of swagger.yaml lists the tiers in the order of telemetry_tier_e
+	_Static_assert((int)API_TELEMETRY_GET_TIER_COUNT == (int)TELEMETRY_TIER_COUNT, "one tier per telemetry ring");
+	telemetry_tier_e tier = (telemetry_tier_e)in->tier;
+
+	// Tasks first, samples can't reference more tasks than listed here
+	int task_count = telemetry_get_task_count();
+
+	httpd_resp_set_type(req, "application/json");
+	snprintf(buf, sizeof(buf), "{\"tier\":\"%s\",\"period_s\":%d,\"tasks\":[", tier_names[tier], tier_periods[tier]);
+	httpd_resp_sendstr_chunk(req, buf);
+
+	for (int i = 0; i < task_count && telemetry_get_task(i, &task); i++) {
+		snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"core\":%d,\"stack_free\":%u,\"alive\":%s}",
+				i ? "," : "", task.name, task.core, (unsigned)task.stack_high_water, task.alive ? "true" : "false");
+		httpd_resp_sendstr_chunk(req, buf);
+	}
+
+	httpd_resp_sendstr_chunk(req, "],\"samples\":[");
+
+	for (int i = 0; telemetry_get_sample(tier, i, &sample); i++) {
+		len = snprintf(buf, sizeof(buf), "%s[%u,%u,%u,%u,%d,[", i ? "," : "", (unsigned)sample.uptime_s,
+				(unsigned)sample.heap_free, (unsigned)sample.heap_min, (unsigned)sample.largest_block, sample.rssi);
+		for (int t = 0; t < task_count && len < (int)sizeof(buf) - 8; t++) {
+			len += snprintf(&buf[len], sizeof(buf) - len, "%s%u", t ? "," : "", (unsigned)sample.cpu_permille[t]);
+		}
+		snprintf(&buf[len], sizeof(buf) - len, "]]");
+		httpd_resp_sendstr_chunk(req, buf);
+	}
+
+	httpd_resp_sendstr_chunk(req, "]}");
+	httpd_resp_sendstr_chunk(req, NULL);
+
+	return ESP_OK;
+}
+
+#if CONFIG_LOADGEN_ENABLE
+/**
+ * Starts a load generator run: POST /api/loadgen?clients=4&requests=400&upload_kb=256
+ * Missing parameters take the defaults of swagger.yaml, the ranges are checked before this runs.
+ * Poll GET /api/loadgen for the result.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t loadgen_post_handler(httpd_req_t *req, const api_loadgen_post_in_t *in){
+	loadgen_config_t config = { .clients = in->clients, .requests = in->requests, .upload_kb = in->upload_kb };
+
+	esp_err_t err = loadgen_start(&config);
+	if (err == ESP_ERR_INVALID_ARG) {
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid load parameters");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	} else if (err == ESP_ERR_INVALID_STATE) {
+		httpd_resp_set_status(req, "409 Conflict");
+		httpd_resp_sendstr(req, "Load run in progress");
+		api_journal_result(JOURNAL_RESULT_BUSY);
+		return ESP_OK;
+	} else if (err != ESP_OK) {
+		httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+		api_journal_result(JOURNAL_RESULT_FAILED);
+		return ESP_OK;
+	}
+
+	httpd_resp_set_status(req, "202 Accepted");
+	httpd_resp_set_type(req, "application/json");
+	httpd_resp_sendstr(req, "{\"started\":true}");
+
+	return ESP_OK;
+}
+
+/**
+ * Result of the last load generator run: GET /api/loadgen
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t loadgen_get_handler(httpd_req_t *req){
+	loadgen_result_t result;
+	char buf[160];
+
+	loadgen_get_result(&result);
+
+	httpd_resp_set_type(req, "application/json");
+	snprintf(buf, sizeof(buf), "{\"running\":%s,\"affinity\":\"%s\",\"priority\":\"%s\",\"clients\":%u,\"requests\":%u,\"upload_kb\":%u,",
+			result.running ? "true" : "false", result.affinity_profile, result.priority_profile,
+			result.config.clients, result.config.requests, result.config.upload_kb);
+	httpd_resp_sendstr_chunk(req, buf);
+	snprintf(buf, sizeof(buf), "\"ok\":%u,\"failed\":%u,\"p50_us\":%u,\"p90_us\":%u,\"p99_us\":%u,\"max_us\":%u,",
+			(unsigned)result.requests_ok, (unsigned)result.requests_failed, (unsigned)result.p50_us,
+			(unsigned)result.p90_us, (unsigned)result.p99_us, (unsigned)result.max_us);
+	httpd_resp_sendstr_chunk(req, buf);
+	snprintf(buf, sizeof(buf), "\"duration_ms\":%u,\"upload_kbps\":%u,\"core_util_permille\":[%u,%u]}",
+			(unsigned)result.duration_ms, (unsigned)result.upload_kbps,
+			result.core_util_permille[0], result.core_util_permille[1]);
+	httpd_resp_sendstr_chunk(req, buf);
+	httpd_resp_sendstr_chunk(req, NULL);
+
+	return ESP_OK;
+}
+
+/**
+ * Upload target of the load generator: reads the body like the OTA handler and discards it.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK, ESP_FAIL if the connection broke.
+ */
+esp_err_t loadgen_sink_post_handler(httpd_req_t *req){
+	char buf[LOADGEN_CHUNK_SIZE];
+	int remaining = req->content_len;
+	int recv_len;
+
+	while (remaining > 0) {
+		recv_len = httpd_req_recv(req, buf, MIN(remaining, sizeof(buf)));
+		if (recv_len == HTTPD_SOCK_ERR_TIMEOUT) {
+			continue;
+		} else if (recv_len <= 0) {
+			return ESP_FAIL;
+		}
+		remaining -= recv_len;
+	}
+
+	httpd_resp_sendstr(req, "OK");
+
+	return ESP_OK;
+}
+#endif
+
+#if CONFIG_TRACE_ENABLE
+/**
+ * Dump of the event trace: GET /api/trace, binary in the layout of trace.h.
+ * Recording pauses while the rings are sent and starts over empty afterwards.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK, ESP_FAIL if the connection broke.
+ */
+esp_err_t trace_get_handler(httpd_req_t *req){
+	trace_dump_header_t header;
+	trace_dump_task_t task;
+	// Whole events per chunk
+	trace_event_t events[32];
+	esp_err_t err;
+
+	trace_dump_begin(&header);
+
+	httpd_resp_set_type(req, "application/octet-stream");
+	httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+	err = httpd_resp_send_chunk(req, (const char *)&header, sizeof(header));
+
+	for (int i = 0; i < TRACE_EV_COUNT && err == ESP_OK; i++) {
+		err = httpd_resp_send_chunk(req, trace_event_name((trace_event_id_e)i), TRACE_NAME_SIZE);
+	}
+	for (int i = 0; i < header.tasks && err == ESP_OK; i++) {
+		trace_dump_task(i, &task);
+		err = httpd_resp_send_chunk(req, (const char *)&task, sizeof(task));
+	}
+	for (uint32_t i = 0; i < header.events && err == ESP_OK; ) {
+		int n = 0;
+		for (; n < (int)(sizeof(events) / sizeof(events[0])) && i < header.events; n++, i++) {
+			trace_dump_event(i, &events[n]);
+		}
+		err = httpd_resp_send_chunk(req, (const char *)events, n * sizeof(events[0]));
+	}
+	if (err == ESP_OK) {
+		err = httpd_resp_send_chunk(req, NULL, 0);
+	}
+
+	trace_dump_end();
+
+	return err == ESP_OK ? ESP_OK : ESP_FAIL;
+}
+#endif
+
+/**
+ * Copies src into dst as the body of a JSON string (quotes, backslashes and control characters escaped).
+ * dst_size of 6 * strlen(src) + 7 is always enough.
+ */
+static void json_escape(char *dst, size_t dst_size, const char *src)
+{
+	size_t o = 0;
+
+	for (; *src != '\0' && o + 7 < dst_size; src++) {
+		unsigned char c = (unsigned char)*src;
+		if (c == '"' || c == '\\') {
+			dst[o++] = '\\';
+			dst[o++] = c;
+		} else if (c < 0x20) {
+			o += snprintf(&dst[o], dst_size - o, "\\u%04x", c);
+		} else {
+			dst[o++] = c;
+		}
+	}
+	dst[o] = '\0';
+}
+
+/**
+ * GET handler for /api/wifi/scan[?refresh=1]
+ * Serves the scan cache of the WiFi application task and never waits for the radio:
+ * a stale cache (or refresh=1) only queues a background scan, poll again while "scanning" is true.
+ * Response JSON: { "age_ms": n, "scanning": bool, "aps": [ { "ssid", "rssi", "channel", "auth" } ] }
+ */
+esp_err_t wifi_scan_get_handler(httpd_req_t *req, const api_wifi_scan_get_in_t *in){
+	wifi_app_scan_result_t results[WIFI_SCAN_MAX_RESULTS];
+	wifi_app_scan_info_t info;
+	char ssid[6 * MAX_SSID_LENGTH + 7];
+	char buf[128 + sizeof(ssid)];
+
+	wifi_app_scan_refresh(in->refresh == 1);
+	wifi_app_get_scan_results(results, &info);
+
+	httpd_resp_set_type(req, "application/json");
+
+	snprintf(buf, sizeof(buf), "{\"age_ms\":%d,\"scanning\":%s,\"aps\":[", (int)info.age_ms, info.scanning ? "true" : "false");
+	httpd_resp_sendstr_chunk(req, buf);
+
+	for (uint8_t i = 0; i < info.count; i++) {
+		json_escape(ssid, sizeof(ssid), results[i].ssid);
+		snprintf(buf, sizeof(buf), "%s{\"ssid\":\"%s\",\"rssi\":%d,\"channel\":%d,\"auth\":%d}",
+				i ? "," : "", ssid, results[i].rssi, results[i].channel, results[i].authmode);
+		httpd_resp_sendstr_chunk(req, buf);
+	}
+
+	httpd_resp_sendstr_chunk(req, "]}");
+	httpd_resp_sendstr_chunk(req, NULL);
+
+	return ESP_OK;
+}
+
+//***************************AUTH HANDLERS*****************************/
+
+/**
+ * POST /api/auth/login { "user", "password" }
+ * Checks the password once (PBKDF2) and responds with a session token for the Authorization header:
+ * { "token": "<32 hex>", "expires_in": idle timeout in s }
+ */
+esp_err_t auth_login_post_handler(httpd_req_t *req, const api_auth_login_post_in_t *in){
+	api_session_t session = { .expires_in = CONFIG_AUTH_SESSION_IDLE_TIMEOUT_S };
+
+	esp_err_t err = auth_login(in->body.user, in->body.password, session.token);
+
+	if (err == ESP_ERR_INVALID_STATE) {
+		httpd_resp_set_status(req, "409 Conflict");
+		httpd_resp_sendstr(req, "No credentials set");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	} else if (err != ESP_OK) {
+		http_server_monitor_send_message(HTTP_MGS_USER_LOGIN_FAIL);
+		httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Wrong user or password");
+		api_journal_result(JOURNAL_RESULT_UNAUTHORIZED);
+		return ESP_OK;
+	}
+
+	http_server_monitor_send_message(HTTP_MSG_USER_LOGIN_DONE);
+
+	httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+	return api_send_session(req, &session);
+}
+
+/**
+ * POST /api/auth/logout, ends the session of the Authorization header token.
+ */
+esp_err_t auth_logout_post_handler(httpd_req_t *req){
+	char token[AUTH_TOKEN_HEX_LEN + 1];
+
+	if (http_server_get_token(req, token, sizeof(token))) {
+		auth_logout(token);
+	}
+
+	httpd_resp_sendstr(req, "Logged out");
+	return ESP_OK;
+}
+
+/**
+ * POST /api/auth/credentials { "user", "password" }
+ * Sets the login. Open while no credentials are set, so the first user can claim the device,
+ * afterwards it needs a session. Ends all sessions, log in again with the new password.
+ */
+esp_err_t auth_credentials_post_handler(httpd_req_t *req, const api_auth_credentials_post_in_t *in){
+	esp_err_t err = auth_set_credentials(in->body.user, in->body.password);
+
+	if (err == ESP_ERR_INVALID_ARG) {
+		http_server_monitor_send_message(HTTP_MGS_USER_REGISTER_FAIL);
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "User (max 32) and password (max 64) must not be empty");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	} else if (err != ESP_OK) {
+		http_server_monitor_send_message(HTTP_MGS_USER_REGISTER_FAIL);
+		httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save credentials");
+		api_journal_result(JOURNAL_RESULT_FAILED);
+		return ESP_OK;
+	}
+
+	http_server_monitor_send_message(HTTP_MSG_USER_REGISTER_DONE);
+	httpd_resp_sendstr(req, "Credentials set");
+	return ESP_OK;
+}
+
+//***************************ADMISSION CONTROL HANDLERS*****************************/
+
+/**
+ * Sends the limits in force per route class: { "read": { "per_minute": n, "burst": n }, "control", "login", "heavy" }
+ */
+static void limits_send(httpd_req_t *req){
+	nvs_rate_limit_t limits[HTTP_ADMIT_ROUTE_COUNT];
+	api_rate_limits_t out = { .has_read = true, .has_control = true, .has_login = true, .has_heavy = true };
+	api_rate_limit_t *routes[HTTP_ADMIT_ROUTE_COUNT] = {
+			[HTTP_ADMIT_READ] = &out.read,
+			[HTTP_ADMIT_CONTROL] = &out.control,
+			[HTTP_ADMIT_LOGIN] = &out.login,
+			[HTTP_ADMIT_HEAVY] = &out.heavy,
+	};
+
+	http_admit_get_limits(limits);
+
+	for (int i = 0; i < HTTP_ADMIT_ROUTE_COUNT; i++) {
+		routes[i]->per_minute = limits[i].per_minute;
+		routes[i]->burst = limits[i].burst;
+	}
+	api_send_rate_limits(req, &out);
+}
+
+/**
+ * GET /api/config/limits
+ */
+esp_err_t limits_get_handler(httpd_req_t *req){
+	limits_send(req);
+
+	return ESP_OK;
+}
+
+/**
+ * nvs_config_update function of POST /api/config/limits, ctx holds the new limit of each
+ * route class or NULL.
+ */
+static bool limits_store(nvs_config_t *cfg, void *ctx){
+	const api_rate_limit_t *const *routes = ctx;
+
+	for (int i = 0; i < HTTP_ADMIT_ROUTE_COUNT; i++) {
+		if (routes[i] != NULL) {
+			cfg->rate_limits[i].per_minute = routes[i]->per_minute;
+			cfg->rate_limits[i].burst = routes[i]->burst;
+		}
+	}
+	return true;
 }
 
+/**
+ * POST /api/config/limits, same shape as GET. Route classes left out keep their limit,
+ * 0 restores the firmware default. Saved in the config record, applies at once.
+ */
+esp_err_t limits_post_handler(httpd_req_t *req, const api_limits_post_in_t *in){
+	const api_rate_limits_t *body = &in->body;
+	const api_rate_limit_t *routes[HTTP_ADMIT_ROUTE_COUNT] = {
+			[HTTP_ADMIT_READ] = body->has_read ? &body->read : NULL,
+			[HTTP_ADMIT_CONTROL] = body->has_control ? &body->control : NULL,
+			[HTTP_ADMIT_LOGIN] = body->has_login ? &body->login : NULL,
+			[HTTP_ADMIT_HEAVY] = body->has_heavy ? &body->heavy : NULL,
+	};
+
+	esp_err_t err = nvs_config_update(limits_store, routes);
+	if (err != ESP_OK) {
+		httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save limits");
+		api_journal_result(JOURNAL_RESULT_FAILED);
+		return ESP_OK;
+	}
+
+	http_admit_load_limits();
+	limits_send(req);
+
+	return ESP_OK;
+}
+
+//***************************ASSETS HANDLERS*****************************/
+
+/**
+ * Sends the state of the assets partition and the files of its image.
+ */
+static void assets_send_info(httpd_req_t *req){
+	assets_info_t info;
+	const assets_entry_t *entry;
+	char buf[160];
+
+	assets_get_info(&info);
+
+	httpd_resp_set_type(req, "application/json");
+	snprintf(buf, sizeof(buf),
+			"{\"partition\":%s,\"valid\":%s,\"size\":%lu,\"capacity\":%lu,\"crc\":\"%08lx\","
+			"\"served\":%lu,\"not_modified\":%lu,\"files\":[",
+			info.partition ? "true" : "false",
+			info.valid ? "true" : "false",
+			(unsigned long)info.size,
+			(unsigned long)info.capacity,
+			(unsigned long)info.crc,
+			(unsigned long)info.served,
+			(unsigned long)info.not_modified);
+	httpd_resp_sendstr_chunk(req, buf);
+
+	for (int i = 0; (entry = assets_get_entry(i)) != NULL; i++) {
+		snprintf(buf, sizeof(buf), "%s{\"path\":\"%s\",\"size\":%lu,\"gzip\":%s}",
+				i ? "," : "", entry->path, (unsigned long)entry->size,
+				(entry->flags & ASSETS_FLAG_GZIP) ? "true" : "false");
+		httpd_resp_sendstr_chunk(req, buf);
+	}
+	httpd_resp_sendstr_chunk(req, "]}");
+	httpd_resp_sendstr_chunk(req, NULL);
+}
+
+/**
+ * GET /api/assets
+ */
+esp_err_t assets_get_handler(httpd_req_t *req){
+	assets_send_info(req);
+
+	return ESP_OK;
+}
+
+/**
+ * POST /api/assets/update
+ * Body: an image from tools/pack_assets.py (application/octet-stream). Replaces the web page
+ * without a firmware update, the new files are served as soon as the image checks out.
+ */
+esp_err_t assets_update_post_handler(httpd_req_t *req){
+	char buf[1024];
+	int received = 0;
+	int ret;
+
+	esp_err_t err = assets_update_begin(req->content_len);
+	if (err == ESP_ERR_NOT_FOUND) {
+		httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No assets partition");
+		api_journal_result(JOURNAL_RESULT_FAILED);
+		return ESP_OK;
+	}
+	if (err != ESP_OK) {
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Image does not fit the assets partition");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	while (received < req->content_len && err == ESP_OK) {
+		ret = httpd_req_recv(req, buf, MIN(req->content_len - received, sizeof(buf)));
+		if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+			continue;
+		}
+		if (ret <= 0) {
+			assets_update_end(false);
+			return ESP_FAIL;
+		}
+		err = assets_update_write(buf, ret);
+		received += ret;
+	}
+
+	esp_err_t end_err = assets_update_end(err == ESP_OK);
+	if (err != ESP_OK || end_err != ESP_OK) {
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid assets image");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+
+	assets_send_info(req);
+	return ESP_OK;
+}
+
+/**
+ * GET of any other path: a file that only exists in the assets image, else 404.
+ */
+esp_err_t assets_file_get_handler(httpd_req_t *req){
+	if (!assets_try_serve(req, req->uri)) {
+		httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, NULL);
+	}
+
+	return ESP_OK;
+}
+
+//***************************PROVISIONING HANDLERS*****************************/
+
+/**
+ * GET /api/config
+ * The whole configuration as one CBOR document (see provision.h), holds the WiFi password.
+ */
+esp_err_t config_get_handler(httpd_req_t *req){
+	nvs_config_t cfg;
+	uint8_t buf[PROVISION_DOC_MAX_SIZE];
+	size_t len;
+
+	nvs_config_get(&cfg);
+	if (provision_export(&cfg, buf, sizeof(buf), &len) != ESP_OK) {
+		httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Configuration too large");
+		return ESP_OK;
+	}
+
+	httpd_resp_set_type(req, "application/cbor");
+	httpd_resp_send(req, (const char *)buf, len);
+
+	return ESP_OK;
+}
+
+// PUT /api/config document, imported onto the config with the record locked
+typedef struct {
+	const uint8_t *buf;
+	size_t len;
+	const char *error;			///> Why the document was rejected, NULL if it was not
+} config_import_t;
+
+static bool config_import_store(nvs_config_t *cfg, void *ctx){
+	config_import_t *import = ctx;
+
+	return provision_import(import->buf, import->len, cfg, &import->error) == ESP_OK;
+}
+
+/**
+ * PUT /api/config
+ * Body: a CBOR document (see provision.h). Validated as a whole, then saved in one write of
+ * the config record, so a unit is provisioned completely or not at all.
+ */
+esp_err_t config_put_handler(httpd_req_t *req){
+	uint8_t buf[PROVISION_DOC_MAX_SIZE];
+	int total_length = 0;
+	int ret;
+	config_import_t import = { .buf = buf };
+	nvs_config_t cfg;
+
+	if (req->content_len <= 0 || req->content_len > sizeof(buf)) {
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Document empty or larger than 512 bytes");
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	while (total_length < req->content_len) {
+		ret = httpd_req_recv(req, (char *)buf + total_length, req->content_len - total_length);
+		if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+			continue;
+		}
+		if (ret <= 0) {
+			return ESP_FAIL;
+		}
+		total_length += ret;
+	}
+
+	import.len = total_length;
+	esp_err_t err = nvs_config_update(config_import_store, &import);
+	if (import.error != NULL) {
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, import.error);
+		api_journal_result(JOURNAL_RESULT_BAD_REQUEST);
+		return ESP_OK;
+	}
+	if (err != ESP_OK) {
+		httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save configuration");
+		api_journal_result(JOURNAL_RESULT_FAILED);
+		return ESP_OK;
+	}
+	ESP_LOGI(TAG, "Configuration imported, %d bytes", total_length);
+
+	// Everything that keeps a copy of the record picks up the new one
+	nvs_config_get(&cfg);
+	network_data = cfg.network;
+	http_cache_invalidate(HTTP_CACHE_SETTINGS_NET);
+	http_admit_load_limits();
+	auth_reload();
+
+	httpd_resp_set_status(req, "204 No Content");
+	httpd_resp_send(req, NULL, 0);
+
+	return ESP_OK;
+}
@@ -9,10 +9,21 @@
 #ifndef MAIN_HTTP_SERVER_H_
 #define MAIN_HTTP_SERVER_H_
 
+#include <stdbool.h>
+
+#include "esp_http_server.h"
+
 #define OTA_UPDATE_PENDING 		0
 #define OTA_UPDATE_SUCCESSFUL	1
 #define OTA_UPDATE_FAILED	   -1
 
+// Pending events of the HTTP server monitor
+#define HTTP_SERVER_MONITOR_QUEUE_DEPTH	8
+
+// The OTA handler retries its result while the monitor queue is full
+#define HTTP_SERVER_OTA_RESULT_RETRY_MS	20
+#define HTTP_SERVER_OTA_RESULT_RETRIES	5
+
 
 
 /**
@@ -34,22 +45,27 @@ typedef enum http_server_message
 	HTTP_MSG_OPEN_WEB_PAGE
 } http_server_message_e;
 
-/**
- * Structure for the message queue
- */
-typedef struct http_server_queue_message
-{
-	http_server_message_e msgID;
-} http_server_queue_message_t;
 
 /**
- * Sends a message to the queue
+ * Publishes a message without payload on the HTTP monitor event bus topic.
+ * Never blocks, a full pool or queue drops the message (see event_bus_get_stats).
  * @param msgID message ID from the http_server_message_e enum.
- * @return pdTRUE if an item was successfully sent to the queue, otherwise pdFALSE.
- * @note Expand the parameter list based on your requirements e.g. how you've expanded the http_server_queue_message_t.
+ * @return pdTRUE if the monitor got the message, otherwise pdFALSE.
  */
 BaseType_t http_server_monitor_send_message(http_server_message_e msgID);
 
+/**
+ * Sets the CORS headers of the API responses, called by the generated route wrappers (api_gen.c).
+ */
+void set_cors_headers(httpd_req_t *req);
+
+/**
+ * Answers 401 unless the request carries the token of a live session, or no credentials are set.
+ * Called by the generated route wrappers of the operations with security in swagger.yaml.
+ * @return true if the handler may go on.
+ */
+bool http_server_authorize(httpd_req_t *req);
+
 /**
  * Starts the HTTP server.
  */
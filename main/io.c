@@ -7,11 +7,34 @@
 
 #include "io.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include "trace.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#endif
 
 static const char *TAG = "IO";
 
 /* --- Local LED state tracking --- */
-static led_state_t led_states[2] = { LED_OFF, LED_OFF };
+static const gpio_num_t led_gpios[LED_COUNT] = { LED1_GPIO, LED2_GPIO, LED3_GPIO, LED4_GPIO };
+static led_state_t led_states[LED_COUNT] = { LED_OFF, LED_OFF, LED_OFF, LED_OFF };
+// HTTP, UDP and other tasks may change the LEDs concurrently
+static portMUX_TYPE led_lock = portMUX_INITIALIZER_UNLOCKED;
+static io_led_change_callback_t led_change_cb = NULL;
+
+#if !CONFIG_IDF_TARGET_LINUX
+// All LEDs are driven by one write to the set and one to the clear register
+_Static_assert(LED1_GPIO < 32 && LED2_GPIO < 32 && LED3_GPIO < 32 && LED4_GPIO < 32,
+               "LED GPIOs must be in the first output register");
+#endif
+
+/* --- Button --- */
+static io_button_callback_t button_cb = NULL;
+static gpio_num_t button_gpio = GPIO_NUM_NC;
+static int64_t button_last_us = 0;
 
 void io_init(void)
 {
@@ -33,46 +56,191 @@ void io_init(void)
     gpio_set_direction(LED4_GPIO, GPIO_MODE_OUTPUT);
     gpio_set_level(LED4_GPIO, LED_OFF);
 
-    led_states[0] = LED_OFF;
-    led_states[1] = LED_OFF;
+    for (int i = 0; i < LED_COUNT; i++) {
+        led_states[i] = LED_OFF;
+    }
 }
 
 
+esp_err_t io_led_set(int led_id, led_state_t state)
+{
+    if (led_id < 1 || led_id > LED_COUNT) {
+        ESP_LOGE(TAG, "Invalid LED ID: %d", led_id);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    io_led_write_mask(BIT(led_id - 1), state == LED_ON ? BIT(led_id - 1) : 0);
+
+    ESP_LOGI(TAG, "LED%d set to %s", led_id, state == LED_ON ? "ON" : "OFF");
+    return ESP_OK;
+}
+
 esp_err_t io_led_toggle(int led_id)
 {
-    gpio_num_t gpio;
-    int index;
-
-    switch (led_id) {
-        case 1: gpio = LED1_GPIO; index = 0; break;
-        case 2: gpio = LED2_GPIO; index = 1; break;
-        case 3: gpio = LED3_GPIO; index = 2; break;
-        case 4: gpio = LED4_GPIO; index = 3; break;
-        default:
-            ESP_LOGE(TAG, "Invalid LED ID: %d", led_id);
-            return ESP_ERR_INVALID_ARG;
+    if (led_id < 1 || led_id > LED_COUNT) {
+        ESP_LOGE(TAG, "Invalid LED ID: %d", led_id);
+        return ESP_ERR_INVALID_ARG;
     }
 
-    led_states[index] = (led_states[index] == LED_ON) ? LED_OFF : LED_ON;
-    gpio_set_level(gpio, (int)led_states[index]);
+    uint8_t mask = io_led_toggle_mask(BIT(led_id - 1));
 
-    ESP_LOGI(TAG, "LED%d toggled to %s", led_id, led_states[index] == LED_ON ? "ON" : "OFF");
+    ESP_LOGI(TAG, "LED%d toggled to %s", led_id, (mask & BIT(led_id - 1)) ? "ON" : "OFF");
     return ESP_OK;
 }
 
 int io_led_get_state(int led_id)
 {
-    int index;
-
-    switch (led_id) {
-        case 1: index = 0; break;
-        case 2: index = 1; break;
-        case 3: index = 2; break;
-        case 4: index = 3; break;
-        default:
-            ESP_LOGE(TAG, "Invalid LED ID: %d", led_id);
-            return -1;
+    if (led_id < 1 || led_id > LED_COUNT) {
+        ESP_LOGE(TAG, "Invalid LED ID: %d", led_id);
+        return -1;
     }
 
-    return (int)led_states[index];
+    return (int)led_states[led_id - 1];
+}
+
+/*
+ * Drives the LEDs in mask to led_states, all pins in the same instant.
+ * Must be called with led_lock held.
+ */
+static void io_led_output_locked(uint8_t mask)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    for (int i = 0; i < LED_COUNT; i++) {
+        if (mask & BIT(i)) {
+            gpio_set_level(led_gpios[i], (int)led_states[i]);
+        }
+    }
+#else
+    uint32_t set = 0;
+    uint32_t clear = 0;
+
+    for (int i = 0; i < LED_COUNT; i++) {
+        if (mask & BIT(i)) {
+            if (led_states[i] == LED_ON) {
+                set |= BIT(led_gpios[i]);
+            } else {
+                clear |= BIT(led_gpios[i]);
+            }
+        }
+    }
+    // W1TS/W1TC leave the other pins of the register alone
+    REG_WRITE(GPIO_OUT_W1TS_REG, set);
+    REG_WRITE(GPIO_OUT_W1TC_REG, clear);
+#endif
+}
+
+uint8_t io_led_get_mask(void)
+{
+    uint8_t mask = 0;
+
+    taskENTER_CRITICAL(&led_lock);
+    for (int i = 0; i < LED_COUNT; i++) {
+        if (led_states[i] == LED_ON) {
+            mask |= BIT(i);
+        }
+    }
+    taskEXIT_CRITICAL(&led_lock);
+
+    return mask;
+}
+
+uint8_t io_led_write_mask(uint8_t mask, uint8_t value)
+{
+    uint8_t result = 0;
+    TRACE_SCOPE(TRACE_EV_IO_WRITE, mask);
+
+    taskENTER_CRITICAL(&led_lock);
+    for (int i = 0; i < LED_COUNT; i++) {
+        if (mask & BIT(i)) {
+            led_states[i] = (value & BIT(i)) ? LED_ON : LED_OFF;
+        }
+        if (led_states[i] == LED_ON) {
+            result |= BIT(i);
+        }
+    }
+    io_led_output_locked(mask);
+    taskEXIT_CRITICAL(&led_lock);
+
+    if (led_change_cb && (mask & (BIT(LED_COUNT) - 1))) {
+        led_change_cb(result);
+    }
+
+    return result;
+}
+
+uint8_t io_led_toggle_mask(uint8_t mask)
+{
+    uint8_t result = 0;
+    TRACE_SCOPE(TRACE_EV_IO_WRITE, mask);
+
+    taskENTER_CRITICAL(&led_lock);
+    for (int i = 0; i < LED_COUNT; i++) {
+        if (mask & BIT(i)) {
+            led_states[i] = (led_states[i] == LED_ON) ? LED_OFF : LED_ON;
+        }
+        if (led_states[i] == LED_ON) {
+            result |= BIT(i);
+        }
+    }
+    io_led_output_locked(mask);
+    taskEXIT_CRITICAL(&led_lock);
+
+    if (led_change_cb && (mask & (BIT(LED_COUNT) - 1))) {
+        led_change_cb(result);
+    }
+
+    return result;
+}
+
+void io_led_set_change_callback(io_led_change_callback_t cb)
+{
+    led_change_cb = cb;
+}
+
+static void IRAM_ATTR io_button_isr(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (now - button_last_us < IO_BUTTON_DEBOUNCE_US) {
+        return;
+    }
+    button_last_us = now;
+    TRACE_INSTANT(TRACE_EV_IO_BUTTON, 0);
+
+    if (button_cb) {
+        button_cb();
+    }
+}
+
+esp_err_t io_button_init(gpio_num_t gpio, io_button_callback_t cb)
+{
+    gpio_config_t cfg = {
+        .pin_bit_mask = BIT64(gpio),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+
+    esp_err_t err = gpio_config(&cfg);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // The ISR service may already be installed by another module
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return err;
+    }
+
+    button_cb = cb;
+    button_gpio = gpio;
+    ESP_LOGI(TAG, "Button on GPIO%d", gpio);
+    return gpio_isr_handler_add(gpio, io_button_isr, NULL);
+}
+
+bool io_button_is_pressed(void)
+{
+    // Active low
+    return button_gpio != GPIO_NUM_NC && gpio_get_level(button_gpio) == 0;
 }
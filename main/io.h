@@ -34,6 +34,11 @@ extern "C" {
 #endif
 
 
+#define LED_COUNT   4
+
+// Minimum time between two accepted button presses
+#define IO_BUTTON_DEBOUNCE_US   200000
+
 // ==============================
 // LED logical states
 // ==============================
@@ -49,14 +54,14 @@ typedef enum {
 /**
  * @brief Initialize GPIOs used for LEDs.
  *
- * Sets LED1_GPIO and LED2_GPIO as outputs and turns them off.
+ * Sets LED1_GPIO to LED4_GPIO as outputs and turns them off.
  */
 void io_init(void);
 
 /**
  * @brief Set LED state (ON/OFF).
  *
- * @param led_id LED index (1 or 2)
+ * @param led_id LED index (1 to LED_COUNT)
  * @param state LED_ON or LED_OFF
  * @return ESP_OK if success, ESP_ERR_INVALID_ARG on invalid LED ID
  */
@@ -65,7 +70,7 @@ esp_err_t io_led_set(int led_id, led_state_t state);
 /**
  * @brief Toggle LED state.
  *
- * @param led_id LED index (1 or 2)
+ * @param led_id LED index (1 to LED_COUNT)
  * @return ESP_OK if success, ESP_ERR_INVALID_ARG otherwise
  */
 esp_err_t io_led_toggle(int led_id);
@@ -73,11 +78,75 @@ esp_err_t io_led_toggle(int led_id);
 /**
  * @brief Get current LED state.
  *
- * @param led_id LED index (1 or 2)
+ * @param led_id LED index (1 to LED_COUNT)
  * @return LED_ON / LED_OFF, or -1 if invalid ID
  */
 int io_led_get_state(int led_id);
 
+/**
+ * @brief Get the state of all LEDs.
+ *
+ * @return bitmap, bit 0 is LED1
+ */
+uint8_t io_led_get_mask(void);
+
+/**
+ * @brief Set the LEDs selected by mask to the matching bits of value, atomically.
+ *
+ * The pins switch together in one register write. Control interfaces queue their
+ * commands through io_cmd.h instead, which merges bursts into one call of this.
+ *
+ * @param mask LEDs to change, bit 0 is LED1 (bits above LED_COUNT are ignored)
+ * @param value new states of the selected LEDs
+ * @return bitmap of all LED states after the change
+ */
+uint8_t io_led_write_mask(uint8_t mask, uint8_t value);
+
+/**
+ * @brief Toggle the LEDs selected by mask, atomically.
+ *
+ * @param mask LEDs to toggle, bit 0 is LED1 (bits above LED_COUNT are ignored)
+ * @return bitmap of all LED states after the change
+ */
+uint8_t io_led_toggle_mask(uint8_t mask);
+
+/**
+ * @brief LED change callback.
+ *
+ * Called from the task that changed the LEDs - keep it short and non-blocking.
+ *
+ * @param mask bitmap of all LED states after the change
+ */
+typedef void (*io_led_change_callback_t)(uint8_t mask);
+
+/**
+ * @brief Register the callback called after every LED change (one callback, NULL to remove).
+ */
+void io_led_set_change_callback(io_led_change_callback_t cb);
+
+/**
+ * @brief Button press callback.
+ *
+ * Called from the GPIO ISR - must be IRAM-safe and only use *FromISR APIs.
+ */
+typedef void (*io_button_callback_t)(void);
+
+/**
+ * @brief Configure an active-low push button with a debounced press callback.
+ *
+ * @param gpio button GPIO (internal pull-up enabled)
+ * @param cb callback called from the ISR on each debounced press
+ * @return ESP_OK if success, error from the GPIO driver otherwise
+ */
+esp_err_t io_button_init(gpio_num_t gpio, io_button_callback_t cb);
+
+/**
+ * @brief Read the button configured by io_button_init.
+ *
+ * @return true while the button is held, false if it is released or not configured
+ */
+bool io_button_is_pressed(void);
+
 #ifdef __cplusplus
 }
 #endif
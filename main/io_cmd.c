@@ -0,0 +1,252 @@
+/*
+ * io_cmd.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdbool.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#include "io.h"
+#include "io_cmd.h"
+#include "static_alloc.h"
+#include "trace.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "io_cmd";
+
+#define IO_CMD_LED_ALL			((uint8_t)(BIT(LED_COUNT) - 1))
+
+// Notification value a caller of io_cmd_submit waits on. Index 0 stays with the
+// caller's own use (scene and MQTT tasks wait on it), a late answer never lands there.
+#define IO_CMD_NOTIFY_INDEX		1
+
+_Static_assert(IO_CMD_NOTIFY_INDEX < CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES, "io_cmd needs CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES >= 2");
+
+/**
+ * A caller blocked in io_cmd_submit, lives on the caller's stack.
+ */
+typedef struct io_cmd_waiter
+{
+	TaskHandle_t task;
+	io_cmd_result_t result;
+	volatile bool done;			// Set by the IO task before it notifies the caller
+} io_cmd_waiter_t;
+
+static QueueHandle_t g_queue = NULL;
+static TaskHandle_t g_task_handle = NULL;
+
+// State as of the last write, read by io_cmd_get_state without queueing
+static io_cmd_result_t g_state;
+static io_cmd_stats_t g_stats;
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Applies a batch in arrival order to a copy of the LED state, writes the pins that
+ * changed at once and answers the waiting callers.
+ */
+static void io_cmd_apply(const io_cmd_t *batch, int count)
+{
+	uint8_t before = io_led_get_mask();
+	uint8_t state = before;
+	uint8_t changed;
+	io_cmd_result_t result;
+	uint32_t now_us;
+	uint32_t latency_us = 0;
+	TRACE_SCOPE(TRACE_EV_IO_CMD_APPLY, count);
+
+	for (int i = 0; i < count; i++)
+	{
+		if (batch[i].op == IO_CMD_OP_TOGGLE)
+		{
+			state ^= batch[i].mask;
+		}
+		else
+		{
+			state = (state & ~batch[i].mask) | (batch[i].value & batch[i].mask);
+		}
+	}
+
+	// Commands that cancel out (two toggles) leave the pins alone
+	changed = (state ^ before) & IO_CMD_LED_ALL;
+	result.mask = changed ? io_led_write_mask(changed, state) : before;
+
+	now_us = (uint32_t)esp_timer_get_time();
+	for (int i = 0; i < count; i++)
+	{
+		if (now_us - batch[i].queued_us > latency_us)
+		{
+			latency_us = now_us - batch[i].queued_us;
+		}
+	}
+
+	taskENTER_CRITICAL(&g_lock);
+	if (changed)
+	{
+		g_state.version++;
+	}
+	g_state.mask = result.mask;
+	result.version = g_state.version;
+	g_stats.batches++;
+	if (count > g_stats.batch_high_water)
+	{
+		g_stats.batch_high_water = count;
+	}
+	if (latency_us > g_stats.latency_max_us)
+	{
+		g_stats.latency_max_us = latency_us;
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	ESP_LOGD(TAG, "%d command(s), LEDs 0x%02x, version %u", count, result.mask, (unsigned)result.version);
+
+	for (int i = 0; i < count; i++)
+	{
+		io_cmd_waiter_t *waiter = batch[i].waiter;
+
+		if (waiter != NULL)
+		{
+			// The waiter is gone once done is seen, take its task first
+			TaskHandle_t task = waiter->task;
+			waiter->result = result;
+			waiter->done = true;
+			xTaskNotifyGiveIndexed(task, IO_CMD_NOTIFY_INDEX);
+		}
+	}
+}
+
+/**
+ * IO task: the first command opens a batch, the commands that follow within
+ * CONFIG_IO_CMD_COALESCE_MS (rounded to the tick) join it.
+ */
+static void io_cmd_task(void *pvParameters)
+{
+	io_cmd_t batch[IO_CMD_BATCH_MAX];
+	const TickType_t window = pdMS_TO_TICKS(CONFIG_IO_CMD_COALESCE_MS);
+
+	for (;;)
+	{
+		int count = 0;
+
+		if (xQueueReceive(g_queue, &batch[count], portMAX_DELAY) != pdTRUE)
+		{
+			continue;
+		}
+		count++;
+
+		TickType_t start = xTaskGetTickCount();
+		while (count < IO_CMD_BATCH_MAX)
+		{
+			TickType_t elapsed = xTaskGetTickCount() - start;
+
+			if (xQueueReceive(g_queue, &batch[count], elapsed < window ? window - elapsed : 0) != pdTRUE)
+			{
+				break;
+			}
+			count++;
+		}
+
+		io_cmd_apply(batch, count);
+	}
+}
+
+static esp_err_t io_cmd_submit(io_cmd_source_e source, io_cmd_op_e op, uint8_t mask, uint8_t value, io_cmd_result_t *result)
+{
+	io_cmd_waiter_t waiter = {
+			.task = xTaskGetCurrentTaskHandle(),
+			.done = false,
+	};
+	io_cmd_t cmd = {
+			.op = op,
+			.source = source,
+			.mask = mask,
+			.value = value,
+			.queued_us = (uint32_t)esp_timer_get_time(),
+			.waiter = result != NULL ? &waiter : NULL,
+	};
+
+	if (g_queue == NULL || source >= IO_CMD_SOURCE_COUNT)
+	{
+		return g_queue == NULL ? ESP_ERR_INVALID_STATE : ESP_ERR_INVALID_ARG;
+	}
+
+	TRACE_INSTANT(TRACE_EV_IO_CMD_QUEUE, mask);
+	if (xQueueSend(g_queue, &cmd, pdMS_TO_TICKS(IO_CMD_SUBMIT_WAIT_MS)) != pdTRUE)
+	{
+		taskENTER_CRITICAL(&g_lock);
+		g_stats.queue_full++;
+		taskEXIT_CRITICAL(&g_lock);
+		return ESP_ERR_TIMEOUT;
+	}
+
+	taskENTER_CRITICAL(&g_lock);
+	g_stats.commands[source]++;
+	taskEXIT_CRITICAL(&g_lock);
+
+	if (result == NULL)
+	{
+		return ESP_OK;
+	}
+
+	// The IO task always answers a queued command. The answer of an earlier call can still be
+	// pending if its caller saw done first, so done decides, not the notification.
+	while (!waiter.done)
+	{
+		ulTaskNotifyTakeIndexed(IO_CMD_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+	}
+	*result = waiter.result;
+
+	return ESP_OK;
+}
+
+void io_cmd_start(void)
+{
+	if (g_task_handle != NULL)
+	{
+		return;
+	}
+
+	g_state.mask = io_led_get_mask();
+	g_state.version = 0;
+
+	g_queue = static_alloc_queue_create(STATIC_QUEUE_IO_CMD, sizeof(io_cmd_t));
+	if (g_queue == NULL)
+	{
+		ESP_LOGE(TAG, "Unable to create the command queue");
+		return;
+	}
+
+	g_task_handle = static_alloc_task_create(STATIC_TASK_IO_CMD, &io_cmd_task, NULL);
+}
+
+esp_err_t io_cmd_write(io_cmd_source_e source, uint8_t mask, uint8_t value, io_cmd_result_t *result)
+{
+	return io_cmd_submit(source, IO_CMD_OP_WRITE, mask, value, result);
+}
+
+esp_err_t io_cmd_toggle(io_cmd_source_e source, uint8_t mask, io_cmd_result_t *result)
+{
+	return io_cmd_submit(source, IO_CMD_OP_TOGGLE, mask, 0, result);
+}
+
+void io_cmd_get_state(io_cmd_result_t *state)
+{
+	taskENTER_CRITICAL(&g_lock);
+	*state = g_state;
+	taskEXIT_CRITICAL(&g_lock);
+}
+
+void io_cmd_get_stats(io_cmd_stats_t *stats)
+{
+	taskENTER_CRITICAL(&g_lock);
+	*stats = g_stats;
+	taskEXIT_CRITICAL(&g_lock);
+}
@@ -0,0 +1,114 @@
+/*
+ * io_cmd.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_IO_CMD_H_
+#define MAIN_IO_CMD_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/*
+ * LED command queue between the control interfaces (HTTP, UDP, MQTT) and the IO driver.
+ * One IO task takes the commands in arrival order. Commands that arrive within
+ * CONFIG_IO_CMD_COALESCE_MS of the first one are applied to a copy of the state and
+ * written to the pins together (io_led_write_mask), so a scene sent as several commands
+ * switches at once and a burst costs one GPIO write and one change callback.
+ * Every write that changes the LEDs gets the next state version.
+ */
+
+#define IO_CMD_QUEUE_DEPTH			16
+// Commands merged into one write at most, a longer burst is split
+#define IO_CMD_BATCH_MAX			16
+// Time a caller waits for room in a full queue
+#define IO_CMD_SUBMIT_WAIT_MS		20
+
+/**
+ * Command sources, counted separately in the statistics.
+ */
+typedef enum io_cmd_source
+{
+	IO_CMD_SOURCE_HTTP = 0,
+	IO_CMD_SOURCE_UDP,
+	IO_CMD_SOURCE_MQTT,
+	IO_CMD_SOURCE_SCENE,					///> Lighting programs, scene.h
+	IO_CMD_SOURCE_COUNT
+} io_cmd_source_e;
+
+typedef enum io_cmd_op
+{
+	IO_CMD_OP_WRITE = 0,					///> LEDs in mask take the matching bits of value
+	IO_CMD_OP_TOGGLE,						///> LEDs in mask are toggled
+} io_cmd_op_e;
+
+struct io_cmd_waiter;
+
+/**
+ * Queue item (public for the queue storage in static_alloc.c).
+ */
+typedef struct io_cmd
+{
+	uint8_t op;								///> io_cmd_op_e
+	uint8_t source;							///> io_cmd_source_e
+	uint8_t mask;							///> bit 0 is LED1
+	uint8_t value;
+	uint32_t queued_us;						///> esp_timer time of queueing, low 32 bits
+	struct io_cmd_waiter *waiter;			///> NULL if the caller does not wait
+} io_cmd_t;
+
+/**
+ * LED state after a command.
+ */
+typedef struct io_cmd_result
+{
+	uint8_t mask;							///> bitmap of all LED states, bit 0 is LED1
+	uint32_t version;						///> increases with every change of the LEDs
+} io_cmd_result_t;
+
+/**
+ * Queue statistics
+ */
+typedef struct io_cmd_stats
+{
+	uint32_t commands[IO_CMD_SOURCE_COUNT];	///> commands queued per source
+	uint32_t batches;						///> writes, each applying one or more commands
+	uint32_t queue_full;					///> commands refused, the queue stayed full
+	uint8_t batch_high_water;				///> most commands merged into one write
+	uint32_t latency_max_us;				///> longest time from queueing to the write
+} io_cmd_stats_t;
+
+/**
+ * Creates the queue and starts the IO task. Call after io_init.
+ */
+void io_cmd_start(void);
+
+/**
+ * Queues a write of the LEDs in mask.
+ * @param result filled with the state after the write, which blocks until it is applied.
+ * NULL queues the command and returns. The wait uses notification index 1 of the calling task,
+ * index 0 stays free for the task's own use.
+ * @return ESP_OK, ESP_ERR_TIMEOUT if the queue stayed full for IO_CMD_SUBMIT_WAIT_MS,
+ * ESP_ERR_INVALID_STATE before io_cmd_start.
+ */
+esp_err_t io_cmd_write(io_cmd_source_e source, uint8_t mask, uint8_t value, io_cmd_result_t *result);
+
+/**
+ * Queues a toggle of the LEDs in mask, see io_cmd_write.
+ */
+esp_err_t io_cmd_toggle(io_cmd_source_e source, uint8_t mask, io_cmd_result_t *result);
+
+/**
+ * Gets the current LED state with its version, without queueing.
+ */
+void io_cmd_get_state(io_cmd_result_t *state);
+
+/**
+ * Gets a copy of the queue statistics.
+ */
+void io_cmd_get_stats(io_cmd_stats_t *stats);
+
+#endif /* MAIN_IO_CMD_H_ */
@@ -0,0 +1,260 @@
+/*
+ * journal.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+#include <sys/param.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#if CONFIG_JOURNAL_FLASH_FLUSH
+#include "nvs.h"
+#endif
+
+#include "journal.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "journal";
+
+// "JRN" and the layout version, a firmware with another layout starts a new journal
+#define JOURNAL_MAGIC				0x4a524e01
+
+#define JOURNAL_NVS_NAMESPACE		"journal"
+#define JOURNAL_NVS_KEY				"ring"
+
+_Static_assert(sizeof(journal_record_t) == 24, "journal_record_t is a fixed 24 byte record");
+_Static_assert((JOURNAL_RECORDS & (JOURNAL_RECORDS - 1)) == 0, "JOURNAL_RECORDS must be a power of two");
+
+/**
+ * The ring as kept in RTC memory and in NVS.
+ */
+typedef struct journal_ring
+{
+	uint32_t magic;
+	uint16_t boot;
+	uint16_t capacity;				// JOURNAL_RECORDS of the firmware that wrote it
+	uint32_t next_seq;				// Advanced after the record is copied, a torn record is never visible
+	journal_record_t records[JOURNAL_RECORDS];
+} journal_ring_t;
+
+// Not cleared on a software reset, garbage after power-on
+static RTC_NOINIT_ATTR journal_ring_t g_ring;
+static bool g_ready = false;
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const g_source_names[JOURNAL_SOURCE_COUNT] = {
+		[JOURNAL_SOURCE_HTTP] = "http",
+		[JOURNAL_SOURCE_UDP] = "udp",
+		[JOURNAL_SOURCE_MQTT] = "mqtt",
+};
+
+static const char *const g_result_names[JOURNAL_RESULT_COUNT] = {
+		[JOURNAL_RESULT_OK] = "ok",
+		[JOURNAL_RESULT_BAD_REQUEST] = "bad_request",
+		[JOURNAL_RESULT_UNAUTHORIZED] = "unauthorized",
+		[JOURNAL_RESULT_LIMITED] = "limited",
+		[JOURNAL_RESULT_BUSY] = "busy",
+		[JOURNAL_RESULT_FAILED] = "failed",
+		[JOURNAL_RESULT_REPLAYED] = "replayed",
+};
+
+static bool journal_ring_valid(const journal_ring_t *ring)
+{
+	return ring->magic == JOURNAL_MAGIC && ring->capacity == JOURNAL_RECORDS;
+}
+
+#if CONFIG_JOURNAL_FLASH_FLUSH
+
+// Snapshot written to NVS, the ring keeps taking records meanwhile
+static journal_ring_t g_flush_copy;
+static uint32_t g_flushed_seq;
+static esp_timer_handle_t g_flush_timer;
+
+/**
+ * Saves the ring to NVS if records were added since the last flush.
+ */
+static void journal_flush(void *arg)
+{
+	nvs_handle_t handle;
+
+	taskENTER_CRITICAL(&g_lock);
+	bool changed = g_ring.next_seq != g_flushed_seq;
+	if (changed)
+	{
+		memcpy(&g_flush_copy, &g_ring, sizeof(g_flush_copy));
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	if (!changed)
+	{
+		return;
+	}
+
+	esp_err_t err = nvs_open(JOURNAL_NVS_NAMESPACE, NVS_READWRITE, &handle);
+	if (err == ESP_OK)
+	{
+		err = nvs_set_blob(handle, JOURNAL_NVS_KEY, &g_flush_copy, sizeof(g_flush_copy));
+		if (err == ESP_OK)
+		{
+			err = nvs_commit(handle);
+		}
+		nvs_close(handle);
+	}
+
+	if (err == ESP_OK)
+	{
+		g_flushed_seq = g_flush_copy.next_seq;
+	}
+	else
+	{
+		ESP_LOGW(TAG, "Flush failed: %s", esp_err_to_name(err));
+	}
+}
+
+/**
+ * Loads the last flushed ring into RTC memory.
+ * @return true if NVS held a valid ring.
+ */
+static bool journal_restore(void)
+{
+	nvs_handle_t handle;
+	size_t size = sizeof(g_ring);
+
+	if (nvs_open(JOURNAL_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+	{
+		return false;
+	}
+	esp_err_t err = nvs_get_blob(handle, JOURNAL_NVS_KEY, &g_ring, &size);
+	nvs_close(handle);
+
+	return err == ESP_OK && size == sizeof(g_ring) && journal_ring_valid(&g_ring);
+}
+
+#endif
+
+void journal_init(void)
+{
+	if (g_ready)
+	{
+		return;
+	}
+
+	if (journal_ring_valid(&g_ring))
+	{
+		ESP_LOGI(TAG, "Kept %u records of boot %u in RTC memory", (unsigned)MIN(g_ring.next_seq, JOURNAL_RECORDS), g_ring.boot);
+	}
+#if CONFIG_JOURNAL_FLASH_FLUSH
+	else if (journal_restore())
+	{
+		ESP_LOGI(TAG, "Restored the journal of boot %u from NVS", g_ring.boot);
+	}
+#endif
+	else
+	{
+		memset(&g_ring, 0, sizeof(g_ring));
+		g_ring.magic = JOURNAL_MAGIC;
+		g_ring.capacity = JOURNAL_RECORDS;
+	}
+	g_ring.boot++;
+
+#if CONFIG_JOURNAL_FLASH_FLUSH
+	// The first flush always writes: the records kept in RTC memory may be newer than NVS
+	g_flushed_seq = g_ring.next_seq - 1;
+
+	const esp_timer_create_args_t flush_timer_args = {
+			.callback = &journal_flush,
+			.arg = NULL,
+			.dispatch_method = ESP_TIMER_TASK,
+			.name = "journal"
+	};
+	ESP_ERROR_CHECK(esp_timer_create(&flush_timer_args, &g_flush_timer));
+	ESP_ERROR_CHECK(esp_timer_start_periodic(g_flush_timer, (uint64_t)CONFIG_JOURNAL_FLUSH_INTERVAL_S * 1000000));
+#endif
+
+	g_ready = true;
+}
+
+void journal_begin(journal_record_t *rec, journal_source_e source, uint16_t route, uint32_t client)
+{
+	int64_t now_us = esp_timer_get_time();
+
+	rec->seq = 0;
+	rec->time_ms = (uint32_t)(now_us / 1000);
+	rec->client = client;
+	// Start time until journal_end turns it into the latency
+	rec->latency_us = (uint32_t)now_us;
+	rec->boot = g_ring.boot;
+	rec->route = route;
+	rec->source = source;
+	rec->channel = 0;
+	rec->result = JOURNAL_RESULT_OK;
+	rec->reserved = 0;
+}
+
+void journal_end(journal_record_t *rec, journal_result_e result)
+{
+	rec->latency_us = (uint32_t)esp_timer_get_time() - rec->latency_us;
+	rec->result = result;
+
+	if (!g_ready)
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL(&g_lock);
+	rec->seq = g_ring.next_seq;
+	memcpy(&g_ring.records[rec->seq % JOURNAL_RECORDS], rec, sizeof(*rec));
+	g_ring.next_seq = rec->seq + 1;
+	taskEXIT_CRITICAL(&g_lock);
+}
+
+bool journal_read(uint32_t seq, journal_record_t *rec)
+{
+	bool found = false;
+
+	if (!g_ready)
+	{
+		return false;
+	}
+
+	taskENTER_CRITICAL(&g_lock);
+	if (g_ring.next_seq - seq - 1 < JOURNAL_RECORDS)
+	{
+		memcpy(rec, &g_ring.records[seq % JOURNAL_RECORDS], sizeof(*rec));
+		found = rec->seq == seq;
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	return found;
+}
+
+void journal_get_range(uint32_t *oldest, uint32_t *next)
+{
+	taskENTER_CRITICAL(&g_lock);
+	*next = g_ready ? g_ring.next_seq : 0;
+	taskEXIT_CRITICAL(&g_lock);
+
+	*oldest = *next > JOURNAL_RECORDS ? *next - JOURNAL_RECORDS : 0;
+}
+
+uint16_t journal_boot(void)
+{
+	return g_ready ? g_ring.boot : 0;
+}
+
+const char* journal_source_name(journal_source_e source)
+{
+	return source < JOURNAL_SOURCE_COUNT ? g_source_names[source] : "unknown";
+}
+
+const char* journal_result_name(journal_result_e result)
+{
+	return result < JOURNAL_RESULT_COUNT ? g_result_names[result] : "unknown";
+}
@@ -0,0 +1,102 @@
+/*
+ * journal.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_JOURNAL_H_
+#define MAIN_JOURNAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/*
+ * Command journal: the last JOURNAL_RECORDS commands received over HTTP, UDP and MQTT,
+ * with client, latency and result. The ring lives in RTC slow memory (RTC_NOINIT), so it
+ * survives a software reset, a panic, the watchdog and the reboot after an OTA update.
+ * Appending is one memcpy of a fixed record under a spinlock. With
+ * CONFIG_JOURNAL_FLASH_FLUSH the ring is also saved to NVS periodically, and restored from
+ * there when a power loss cleared the RTC memory. GET /api/journal reads it page by page.
+ */
+
+#define JOURNAL_RECORDS				128		///> Power of two, 24 bytes each
+#define JOURNAL_PAGE_MAX			64		///> Records per GET /api/journal response
+
+typedef enum journal_source
+{
+	JOURNAL_SOURCE_HTTP = 0,
+	JOURNAL_SOURCE_UDP,
+	JOURNAL_SOURCE_MQTT,
+	JOURNAL_SOURCE_COUNT
+} journal_source_e;
+
+typedef enum journal_result
+{
+	JOURNAL_RESULT_OK = 0,
+	JOURNAL_RESULT_BAD_REQUEST,				///> Invalid parameters or body, or an empty scene slot
+	JOURNAL_RESULT_UNAUTHORIZED,			///> No valid session or a failed login
+	JOURNAL_RESULT_LIMITED,					///> Refused by admission control
+	JOURNAL_RESULT_BUSY,					///> IO command queue full or a run in progress, try again later
+	JOURNAL_RESULT_FAILED,					///> The handler returned an error or answered 5xx
+	JOURNAL_RESULT_REPLAYED,				///> UDP retry, answered from the ack cache
+	JOURNAL_RESULT_COUNT
+} journal_result_e;
+
+/**
+ * One journal record (24 bytes).
+ */
+typedef struct journal_record
+{
+	uint32_t seq;							///> Position in the journal, the cursor of GET /api/journal
+	uint32_t time_ms;						///> Reception, ms since the start of boot
+	uint32_t client;						///> IPv4 of the client, network byte order, 0 if unknown
+	uint32_t latency_us;					///> Reception to result
+	uint16_t boot;							///> Boot the command was received in
+	uint16_t route;							///> HTTP: api_operation_e, UDP: udp_ctrl_cmd_e, MQTT: io_cmd_op_e
+	uint8_t source;							///> journal_source_e
+	uint8_t channel;						///> HTTP: LED id or scene slot of the path, UDP and MQTT: LED mask, else 0
+	uint8_t result;							///> journal_result_e
+	uint8_t reserved;
+} journal_record_t;
+
+/**
+ * Checks the ring kept in RTC memory, restores it from NVS or starts a new one, and counts
+ * the boot. Call once after nvs_init_storage, commands before that are not recorded.
+ */
+void journal_init(void);
+
+/**
+ * Starts a record on reception of a command.
+ * @param route source specific command, see journal_record_t.
+ * @param client IPv4 of the client, network byte order, 0 if unknown.
+ */
+void journal_begin(journal_record_t *rec, journal_source_e source, uint16_t route, uint32_t client);
+
+/**
+ * Completes a record with its result and latency and appends it to the journal.
+ */
+void journal_end(journal_record_t *rec, journal_result_e result);
+
+/**
+ * Copies one record.
+ * @return false if seq was overwritten already or is not written yet.
+ */
+bool journal_read(uint32_t seq, journal_record_t *rec);
+
+/**
+ * Gets the range of readable records: oldest .. next - 1.
+ */
+void journal_get_range(uint32_t *oldest, uint32_t *next);
+
+/**
+ * @return number of the current boot, counted since the journal was created.
+ */
+uint16_t journal_boot(void);
+
+const char* journal_source_name(journal_source_e source);
+const char* journal_result_name(journal_result_e result);
+
+#endif /* MAIN_JOURNAL_H_ */
@@ -0,0 +1,545 @@
+/*
+ * json_codec.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "json_codec.h"
+
+static bool json_fail(json_reader_t *r)
+{
+	r->error = true;
+	return false;
+}
+
+static void json_skip_ws(json_reader_t *r)
+{
+	while (r->p < r->end && (*r->p == ' ' || *r->p == '\t' || *r->p == '\n' || *r->p == '\r'))
+	{
+		r->p++;
+	}
+}
+
+/**
+ * Consumes the comma between two values of an array or object, where one is due.
+ */
+static bool json_value_start(json_reader_t *r)
+{
+	if (r->error)
+	{
+		return false;
+	}
+	json_skip_ws(r);
+	if (r->need_comma)
+	{
+		if (r->p >= r->end || *r->p != ',')
+		{
+			return json_fail(r);
+		}
+		r->p++;
+		json_skip_ws(r);
+		r->need_comma = false;
+	}
+	return r->p < r->end || json_fail(r);
+}
+
+static bool json_literal(json_reader_t *r, const char *literal)
+{
+	size_t len = strlen(literal);
+
+	if ((size_t)(r->end - r->p) < len || memcmp(r->p, literal, len) != 0)
+	{
+		return json_fail(r);
+	}
+	r->p += len;
+	r->need_comma = true;
+	return true;
+}
+
+static int json_hex(char c)
+{
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+/**
+ * Scans a string from its opening quote.
+ * @param dst receives the unescaped string, NULL to only skip it.
+ */
+static bool json_scan_string(json_reader_t *r, char *dst, size_t size)
+{
+	size_t n = 0;
+
+	if (r->p >= r->end || *r->p != '"')
+	{
+		return json_fail(r);
+	}
+	r->p++;
+
+	while (r->p < r->end && *r->p != '"')
+	{
+		uint32_t c = (uint8_t)*r->p++;
+		bool code_point = false;
+		char utf8[3];
+		size_t len = 1;
+
+		if (c < 0x20)
+		{
+			return json_fail(r);
+		}
+		if (c == '\\')
+		{
+			if (r->p >= r->end)
+			{
+				return json_fail(r);
+			}
+			c = *r->p++;
+			switch (c)
+			{
+				case '"': case '\\': case '/':	break;
+				case 'b': c = '\b';				break;
+				case 'f': c = '\f';				break;
+				case 'n': c = '\n';				break;
+				case 'r': c = '\r';				break;
+				case 't': c = '\t';				break;
+				case 'u':
+					if (r->end - r->p < 4)
+					{
+						return json_fail(r);
+					}
+					c = 0;
+					for (int i = 0; i < 4; i++)
+					{
+						int h = json_hex(*r->p++);
+						if (h < 0)
+						{
+							return json_fail(r);
+						}
+						c = (c << 4) | h;
+					}
+					// No NULs inside C strings, surrogate pairs are not needed for SSIDs and user names
+					if (c == 0 || (c >= 0xd800 && c <= 0xdfff))
+					{
+						return json_fail(r);
+					}
+					code_point = true;
+					break;
+				default:
+					return json_fail(r);
+			}
+		}
+
+		if (c < 0x80 || !code_point)
+		{
+			// Plain bytes, UTF-8 included, are copied as they are
+			utf8[0] = c;
+		}
+		else if (c < 0x800)
+		{
+			utf8[0] = 0xc0 | (c >> 6);
+			utf8[1] = 0x80 | (c & 0x3f);
+			len = 2;
+		}
+		else
+		{
+			utf8[0] = 0xe0 | (c >> 12);
+			utf8[1] = 0x80 | ((c >> 6) & 0x3f);
+			utf8[2] = 0x80 | (c & 0x3f);
+			len = 3;
+		}
+
+		if (dst != NULL)
+		{
+			if (n + len >= size)
+			{
+				return json_fail(r);
+			}
+			memcpy(dst + n, utf8, len);
+		}
+		n += len;
+	}
+
+	if (r->p >= r->end)
+	{
+		return json_fail(r);
+	}
+	r->p++;
+	if (dst != NULL)
+	{
+		dst[n] = '\0';
+	}
+	r->need_comma = true;
+	return true;
+}
+
+void json_reader_init(json_reader_t *r, const char *buf, size_t len)
+{
+	r->p = buf;
+	r->end = buf + len;
+	r->need_comma = false;
+	r->error = false;
+}
+
+json_type_e json_peek(json_reader_t *r)
+{
+	const char *p = r->p;
+
+	if (r->error)
+	{
+		return JSON_TYPE_INVALID;
+	}
+	while (p < r->end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || (*p == ',' && r->need_comma)))
+	{
+		p++;
+	}
+	if (p >= r->end)
+	{
+		return JSON_TYPE_INVALID;
+	}
+
+	switch (*p)
+	{
+		case '{':	return JSON_TYPE_OBJECT;
+		case '[':	return JSON_TYPE_ARRAY;
+		case '"':	return JSON_TYPE_STRING;
+		case 't':
+		case 'f':	return JSON_TYPE_BOOL;
+		case 'n':	return JSON_TYPE_NULL;
+		default:
+			return (*p == '-' || (*p >= '0' && *p <= '9')) ? JSON_TYPE_NUMBER : JSON_TYPE_INVALID;
+	}
+}
+
+bool json_read_object(json_reader_t *r)
+{
+	if (!json_value_start(r) || *r->p != '{')
+	{
+		return json_fail(r);
+	}
+	r->p++;
+	r->need_comma = false;
+	return true;
+}
+
+bool json_next_key(json_reader_t *r, const char **key, size_t *len)
+{
+	if (r->error)
+	{
+		return false;
+	}
+	json_skip_ws(r);
+	if (r->p < r->end && *r->p == '}')
+	{
+		r->p++;
+		r->need_comma = true;
+		return false;
+	}
+	if (!json_value_start(r))
+	{
+		return false;
+	}
+
+	const char *start = r->p + 1;
+	if (!json_scan_string(r, NULL, 0))
+	{
+		return false;
+	}
+	*key = start;
+	*len = r->p - 1 - start;
+
+	json_skip_ws(r);
+	if (r->p >= r->end || *r->p != ':')
+	{
+		return json_fail(r);
+	}
+	r->p++;
+	r->need_comma = false;
+	return true;
+}
+
+bool json_read_string(json_reader_t *r, char *dst, size_t size)
+{
+	return json_value_start(r) && json_scan_string(r, dst, size);
+}
+
+bool json_read_int(json_reader_t *r, int64_t *value)
+{
+	bool negative = false;
+	uint64_t v = 0;
+	int digits = 0;
+
+	if (!json_value_start(r))
+	{
+		return false;
+	}
+	if (*r->p == '-')
+	{
+		negative = true;
+		r->p++;
+	}
+	while (r->p < r->end && *r->p >= '0' && *r->p <= '9')
+	{
+		if (v > (INT64_MAX - 9) / 10)
+		{
+			return json_fail(r);
+		}
+		v = v * 10 + (*r->p++ - '0');
+		digits++;
+	}
+	// Fractions and exponents are not integers
+	if (digits == 0 || (r->p < r->end && (*r->p == '.' || *r->p == 'e' || *r->p == 'E')))
+	{
+		return json_fail(r);
+	}
+
+	*value = negative ? -(int64_t)v : (int64_t)v;
+	r->need_comma = true;
+	return true;
+}
+
+bool json_read_bool(json_reader_t *r, bool *value)
+{
+	if (!json_value_start(r))
+	{
+		return false;
+	}
+	*value = *r->p == 't';
+	return json_literal(r, *value ? "true" : "false");
+}
+
+bool json_read_null(json_reader_t *r)
+{
+	return json_value_start(r) && json_literal(r, "null");
+}
+
+/**
+ * @return number of digits at r->p, consumed.
+ */
+static int json_skip_digits(json_reader_t *r)
+{
+	int digits = 0;
+
+	while (r->p < r->end && *r->p >= '0' && *r->p <= '9')
+	{
+		r->p++;
+		digits++;
+	}
+	return digits;
+}
+
+/**
+ * Skips a number, which may have a fraction and an exponent unlike the ones json_read_int reads.
+ */
+static bool json_skip_number(json_reader_t *r)
+{
+	if (*r->p == '-')
+	{
+		r->p++;
+	}
+	if (json_skip_digits(r) == 0)
+	{
+		return json_fail(r);
+	}
+	if (r->p < r->end && *r->p == '.')
+	{
+		r->p++;
+		if (json_skip_digits(r) == 0)
+		{
+			return json_fail(r);
+		}
+	}
+	if (r->p < r->end && (*r->p == 'e' || *r->p == 'E'))
+	{
+		r->p++;
+		if (r->p < r->end && (*r->p == '+' || *r->p == '-'))
+		{
+			r->p++;
+		}
+		if (json_skip_digits(r) == 0)
+		{
+			return json_fail(r);
+		}
+	}
+	r->need_comma = true;
+	return true;
+}
+
+static bool json_skip_depth(json_reader_t *r, int depth)
+{
+	const char *key;
+	size_t len;
+	bool flag;
+
+	if (depth > JSON_MAX_DEPTH)
+	{
+		return json_fail(r);
+	}
+
+	switch (json_peek(r))
+	{
+		case JSON_TYPE_OBJECT:
+			if (!json_read_object(r))
+			{
+				return false;
+			}
+			while (json_next_key(r, &key, &len))
+			{
+				if (!json_skip_depth(r, depth + 1))
+				{
+					return false;
+				}
+			}
+			return !r->error;
+
+		case JSON_TYPE_ARRAY:
+			json_value_start(r);
+			r->p++;
+			r->need_comma = false;
+			for (;;)
+			{
+				json_skip_ws(r);
+				if (r->p < r->end && *r->p == ']')
+				{
+					r->p++;
+					r->need_comma = true;
+					return true;
+				}
+				if (!json_skip_depth(r, depth + 1))
+				{
+					return false;
+				}
+			}
+
+		case JSON_TYPE_STRING:
+			return json_read_string(r, NULL, 0);
+
+		case JSON_TYPE_NUMBER:
+			json_value_start(r);
+			return json_skip_number(r);
+
+		case JSON_TYPE_BOOL:
+			return json_read_bool(r, &flag);
+
+		case JSON_TYPE_NULL:
+			return json_read_null(r);
+
+		default:
+			return json_fail(r);
+	}
+}
+
+bool json_skip(json_reader_t *r)
+{
+	return json_skip_depth(r, 0);
+}
+
+bool json_reader_done(json_reader_t *r)
+{
+	json_skip_ws(r);
+	return !r->error && r->p == r->end;
+}
+
+bool json_key_is(const char *key, size_t len, const char *name)
+{
+	return strlen(name) == len && memcmp(key, name, len) == 0;
+}
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size)
+{
+	w->buf = buf;
+	w->size = size;
+	w->len = 0;
+	w->overflow = size == 0;
+}
+
+static void json_put_bytes(json_writer_t *w, const char *data, size_t len)
+{
+	// One byte stays free for the null of json_writer_finish
+	if (w->overflow || len >= w->size - w->len)
+	{
+		w->overflow = true;
+		return;
+	}
+	memcpy(w->buf + w->len, data, len);
+	w->len += len;
+}
+
+void json_put_raw(json_writer_t *w, const char *text)
+{
+	json_put_bytes(w, text, strlen(text));
+}
+
+void json_put_string(json_writer_t *w, const char *str)
+{
+	char esc[7];
+
+	json_put_bytes(w, "\"", 1);
+	for (const char *p = str; *p != '\0'; p++)
+	{
+		uint8_t c = *p;
+
+		if (c == '"' || c == '\\')
+		{
+			esc[0] = '\\';
+			esc[1] = c;
+			json_put_bytes(w, esc, 2);
+		}
+		else if (c < 0x20)
+		{
+			snprintf(esc, sizeof(esc), "\\u%04x", c);
+			json_put_bytes(w, esc, 6);
+		}
+		else
+		{
+			json_put_bytes(w, p, 1);
+		}
+	}
+	json_put_bytes(w, "\"", 1);
+}
+
+void json_put_int(json_writer_t *w, int64_t value)
+{
+	char num[24];
+
+	snprintf(num, sizeof(num), "%lld", (long long)value);
+	json_put_raw(w, num);
+}
+
+void json_put_bool(json_writer_t *w, bool value)
+{
+	json_put_raw(w, value ? "true" : "false");
+}
+
+void json_put_null(json_writer_t *w)
+{
+	json_put_raw(w, "null");
+}
+
+bool json_writer_finish(json_writer_t *w)
+{
+	if (w->overflow)
+	{
+		if (w->size > 0)
+		{
+			w->buf[0] = '\0';
+		}
+		return false;
+	}
+	w->buf[w->len] = '\0';
+	return true;
+}
@@ -0,0 +1,111 @@
+/*
+ * json_codec.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_JSON_CODEC_H_
+#define MAIN_JSON_CODEC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * JSON pull reader and writer over fixed buffers, for the parsers and serializers
+ * generated from swagger.yaml (api_gen.c). Same model as cbor_codec.h: the reader walks the
+ * text one value at a time and copies strings into the caller's buffers, nothing is allocated.
+ * Numbers are integers only, the API has no other. Errors stick in the reader or writer.
+ */
+
+#define JSON_MAX_DEPTH				8		///> Nesting json_skip follows
+
+typedef enum json_type
+{
+	JSON_TYPE_OBJECT = 0,
+	JSON_TYPE_ARRAY,
+	JSON_TYPE_STRING,
+	JSON_TYPE_NUMBER,
+	JSON_TYPE_BOOL,
+	JSON_TYPE_NULL,
+	JSON_TYPE_INVALID						///> End of input or an error
+} json_type_e;
+
+typedef struct json_reader
+{
+	const char *p;
+	const char *end;
+	bool need_comma;						///> A value was read, the next key or item follows a comma
+	bool error;
+} json_reader_t;
+
+typedef struct json_writer
+{
+	char *buf;
+	size_t size;
+	size_t len;								///> Characters written, without the terminating null
+	bool overflow;							///> buf was too small
+} json_writer_t;
+
+void json_reader_init(json_reader_t *r, const char *buf, size_t len);
+
+/**
+ * @return type of the next value, without consuming it.
+ */
+json_type_e json_peek(json_reader_t *r);
+
+/**
+ * Reads the '{' of an object. Its members follow with json_next_key.
+ */
+bool json_read_object(json_reader_t *r);
+
+/**
+ * Reads the next key of an object and the ':' after it, the value follows.
+ * @param key set to the key inside the buffer, not null terminated and not unescaped.
+ * @return false after the closing '}' or on an error (see r->error).
+ */
+bool json_next_key(json_reader_t *r, const char **key, size_t *len);
+
+/**
+ * Reads a string, unescaped, into dst.
+ * @return false if it is no string or does not fit dst with its null.
+ */
+bool json_read_string(json_reader_t *r, char *dst, size_t size);
+bool json_read_int(json_reader_t *r, int64_t *value);
+bool json_read_bool(json_reader_t *r, bool *value);
+bool json_read_null(json_reader_t *r);
+
+/**
+ * Skips the next value with everything nested in it.
+ */
+bool json_skip(json_reader_t *r);
+
+/**
+ * @return true if only whitespace is left and no error occurred.
+ */
+bool json_reader_done(json_reader_t *r);
+
+/**
+ * @return true if key is the null terminated name.
+ */
+bool json_key_is(const char *key, size_t len, const char *name);
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size);
+
+/**
+ * Appends text as it is, for the punctuation and keys of generated code.
+ */
+void json_put_raw(json_writer_t *w, const char *text);
+void json_put_string(json_writer_t *w, const char *str);
+void json_put_int(json_writer_t *w, int64_t value);
+void json_put_bool(json_writer_t *w, bool value);
+void json_put_null(json_writer_t *w);
+
+/**
+ * Terminates the text.
+ * @return false if buf was too small.
+ */
+bool json_writer_finish(json_writer_t *w);
+
+#endif /* MAIN_JSON_CODEC_H_ */
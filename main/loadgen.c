@@ -0,0 +1,349 @@
+/*
+ * loadgen.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "sys/param.h"
+
+#include "loadgen.h"
+#include "tasks_common.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "loadgen";
+
+#define LOADGEN_HOST			"127.0.0.1"
+#define LOADGEN_REQUEST_PATH	"/api/leds/1"
+#define LOADGEN_SINK_PATH		"/api/loadgen/sink"
+#define LOADGEN_TIMEOUT_MS		5000
+
+// Each loopback connection holds two lwIP sockets, the client's and the one httpd accepted.
+// httpd keeps three for itself (http_conn.c), the UDP control server one, and the client
+// polling GET /api/loadgen one more. All runs connect from 127.0.0.1: the per-client cap
+// of the connection manager applies to the whole run.
+#if CONFIG_UDP_CTRL_ENABLE
+#define LOADGEN_UDP_SOCKETS		1
+#else
+#define LOADGEN_UDP_SOCKETS		0
+#endif
+#define LOADGEN_SOCKET_BUDGET	((CONFIG_LWIP_MAX_SOCKETS - 3 - LOADGEN_UDP_SOCKETS - 1) / 2)
+#define LOADGEN_MAX_CONNECTIONS	MIN(MIN(LOADGEN_SOCKET_BUDGET, CONFIG_HTTP_CONN_MAX_SOCKETS - 1), CONFIG_HTTP_CONN_PER_CLIENT)
+
+_Static_assert(LOADGEN_MAX_CONNECTIONS >= 2, "The load generator needs sockets for one client and the upload, raise CONFIG_LWIP_MAX_SOCKETS");
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static loadgen_result_t g_result;
+static loadgen_config_t g_config;
+static TaskHandle_t g_coordinator = NULL;
+
+// Per-run state, shared by the client tasks under g_lock
+static uint32_t *g_latency_us = NULL;
+static uint32_t g_latency_count;
+static uint32_t g_requests_issued;
+static uint32_t g_requests_failed;
+static uint32_t g_upload_kbps;
+
+/**
+ * Hands out the next request of the run.
+ * @return false once all requests are taken.
+ */
+static bool loadgen_take_request(void)
+{
+	bool ok;
+
+	taskENTER_CRITICAL(&g_lock);
+	ok = g_requests_issued < g_config.requests;
+	if (ok)
+	{
+		g_requests_issued++;
+	}
+	taskEXIT_CRITICAL(&g_lock);
+
+	return ok;
+}
+
+/**
+ * Request client: keeps one connection open and sends requests until the run has none left.
+ */
+static void loadgen_client_task(void *pvParameters)
+{
+	esp_http_client_config_t config = {
+			.host = LOADGEN_HOST,
+			.port = CONFIG_HTTP_SERVER_PORT,
+			.path = LOADGEN_REQUEST_PATH,
+			.timeout_ms = LOADGEN_TIMEOUT_MS,
+			.keep_alive_enable = true,
+	};
+	esp_http_client_handle_t client = esp_http_client_init(&config);
+
+	while (client != NULL && loadgen_take_request())
+	{
+		int64_t start = esp_timer_get_time();
+		esp_err_t err = esp_http_client_perform(client);
+		uint32_t latency = esp_timer_get_time() - start;
+		bool ok = err == ESP_OK && esp_http_client_get_status_code(client) == 200;
+
+		taskENTER_CRITICAL(&g_lock);
+		if (ok)
+		{
+			g_latency_us[g_latency_count++] = latency;
+		}
+		else
+		{
+			g_requests_failed++;
+		}
+		taskEXIT_CRITICAL(&g_lock);
+	}
+
+	if (client != NULL)
+	{
+		esp_http_client_cleanup(client);
+	}
+
+	xTaskNotifyGive(g_coordinator);
+	vTaskDelete(NULL);
+}
+
+/**
+ * Upload client: streams g_config.upload_kb to the sink endpoint, like an OTA upload.
+ */
+static void loadgen_upload_task(void *pvParameters)
+{
+	esp_http_client_config_t config = {
+			.host = LOADGEN_HOST,
+			.port = CONFIG_HTTP_SERVER_PORT,
+			.path = LOADGEN_SINK_PATH,
+			.method = HTTP_METHOD_POST,
+			.timeout_ms = LOADGEN_TIMEOUT_MS,
+	};
+	char chunk[LOADGEN_CHUNK_SIZE];
+	int total = g_config.upload_kb * LOADGEN_CHUNK_SIZE;
+	int sent = 0;
+	esp_http_client_handle_t client = esp_http_client_init(&config);
+
+	memset(chunk, 0xA5, sizeof(chunk));
+	int64_t start = esp_timer_get_time();
+
+	if (client != NULL && esp_http_client_open(client, total) == ESP_OK)
+	{
+		while (sent < total)
+		{
+			int len = esp_http_client_write(client, chunk, sizeof(chunk));
+			if (len <= 0)
+			{
+				break;
+			}
+			sent += len;
+		}
+
+		esp_http_client_fetch_headers(client);
+		if (sent == total && esp_http_client_get_status_code(client) == 200)
+		{
+			uint32_t ms = (esp_timer_get_time() - start) / 1000;
+			g_upload_kbps = (uint32_t)((uint64_t)g_config.upload_kb * 1000 / (ms ? ms : 1));
+		}
+		esp_http_client_close(client);
+	}
+	else
+	{
+		ESP_LOGW(TAG, "Upload connection failed");
+	}
+
+	if (client != NULL)
+	{
+		esp_http_client_cleanup(client);
+	}
+
+	xTaskNotifyGive(g_coordinator);
+	vTaskDelete(NULL);
+}
+
+/**
+ * Reads the run time counter of each idle task.
+ * @return total run time counter.
+ */
+static uint32_t loadgen_idle_snapshot(uint32_t idle[2])
+{
+	uint32_t total = 0;
+	UBaseType_t count = uxTaskGetNumberOfTasks() + 4;
+	TaskStatus_t *status = malloc(count * sizeof(TaskStatus_t));
+
+	idle[0] = idle[1] = 0;
+	if (status == NULL)
+	{
+		return 0;
+	}
+
+	count = uxTaskGetSystemState(status, count, &total);
+	for (UBaseType_t i = 0; i < count; i++)
+	{
+		for (int core = 0; core < portNUM_PROCESSORS && core < 2; core++)
+		{
+			if (status[i].xHandle == xTaskGetIdleTaskHandleForCore(core))
+			{
+				idle[core] = status[i].ulRunTimeCounter;
+			}
+		}
+	}
+
+	free(status);
+	return total;
+}
+
+static int loadgen_compare_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * @return p-th percentile of a sorted array.
+ */
+static uint32_t loadgen_percentile(const uint32_t *sorted, uint32_t count, int p)
+{
+	return count ? sorted[(count - 1) * p / 100] : 0;
+}
+
+/**
+ * Coordinator: starts the clients, waits for them and computes the result.
+ */
+static void loadgen_task(void *pvParameters)
+{
+	uint32_t idle_before[2];
+	uint32_t idle_after[2];
+	int workers = 0;
+
+	uint32_t total_before = loadgen_idle_snapshot(idle_before);
+	int64_t start = esp_timer_get_time();
+
+	for (int i = 0; i < g_config.clients; i++)
+	{
+		if (xTaskCreatePinnedToCore(&loadgen_client_task, "loadgen_client", LOADGEN_TASK_STACK_SIZE, NULL, LOADGEN_TASK_PRIORITY, NULL, LOADGEN_TASK_CORE_ID) == pdPASS)
+		{
+			workers++;
+		}
+	}
+	if (g_config.upload_kb > 0
+			&& xTaskCreatePinnedToCore(&loadgen_upload_task, "loadgen_upload", LOADGEN_TASK_STACK_SIZE, NULL, LOADGEN_TASK_PRIORITY, NULL, LOADGEN_TASK_CORE_ID) == pdPASS)
+	{
+		workers++;
+	}
+
+	while (workers-- > 0)
+	{
+		ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+	}
+
+	uint32_t elapsed = loadgen_idle_snapshot(idle_after) - total_before;
+	uint32_t duration_ms = (esp_timer_get_time() - start) / 1000;
+
+	qsort(g_latency_us, g_latency_count, sizeof(uint32_t), loadgen_compare_u32);
+
+	taskENTER_CRITICAL(&g_lock);
+	g_result.requests_ok = g_latency_count;
+	g_result.requests_failed = g_requests_failed;
+	g_result.p50_us = loadgen_percentile(g_latency_us, g_latency_count, 50);
+	g_result.p90_us = loadgen_percentile(g_latency_us, g_latency_count, 90);
+	g_result.p99_us = loadgen_percentile(g_latency_us, g_latency_count, 99);
+	g_result.max_us = g_latency_count ? g_latency_us[g_latency_count - 1] : 0;
+	g_result.duration_ms = duration_ms;
+	g_result.upload_kbps = g_upload_kbps;
+	for (int core = 0; core < 2; core++)
+	{
+		uint32_t idle = idle_after[core] - idle_before[core];
+		g_result.core_util_permille[core] = (elapsed && idle < elapsed) ? 1000 - (uint64_t)idle * 1000 / elapsed : 0;
+	}
+	g_result.running = false;
+	taskEXIT_CRITICAL(&g_lock);
+
+	free(g_latency_us);
+	g_latency_us = NULL;
+
+	ESP_LOGI(TAG, "%s/%s: %u ok, %u failed, p50 %u us, p99 %u us, cores %u/%u permille",
+			g_result.affinity_profile, g_result.priority_profile,
+			(unsigned)g_result.requests_ok, (unsigned)g_result.requests_failed,
+			(unsigned)g_result.p50_us, (unsigned)g_result.p99_us,
+			(unsigned)g_result.core_util_permille[0], (unsigned)g_result.core_util_permille[1]);
+
+	g_coordinator = NULL;
+	vTaskDelete(NULL);
+}
+
+esp_err_t loadgen_start(const loadgen_config_t *config)
+{
+	if (config->clients < 1 || config->clients > LOADGEN_MAX_CLIENTS
+			|| config->requests < 1 || config->requests > LOADGEN_MAX_REQUESTS
+			|| config->upload_kb > LOADGEN_MAX_UPLOAD_KB)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	taskENTER_CRITICAL(&g_lock);
+	bool running = g_result.running;
+	g_result.running = true;
+	taskEXIT_CRITICAL(&g_lock);
+
+	if (running)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	g_latency_us = malloc(config->requests * sizeof(uint32_t));
+	if (g_latency_us == NULL)
+	{
+		g_result.running = false;
+		return ESP_ERR_NO_MEM;
+	}
+
+	// More clients would be refused or purge each other, clamp them to the sockets of the build
+	g_config = *config;
+	int connections = LOADGEN_MAX_CONNECTIONS - (config->upload_kb > 0 ? 1 : 0);
+	if (g_config.clients > connections)
+	{
+		ESP_LOGW(TAG, "%u clients requested, the sockets of this build fit %d", g_config.clients, connections);
+		g_config.clients = connections;
+	}
+	g_latency_count = 0;
+	g_requests_issued = 0;
+	g_requests_failed = 0;
+	g_upload_kbps = 0;
+
+	memset(&g_result, 0, sizeof(g_result));
+	g_result.running = true;
+	g_result.config = g_config;
+	g_result.affinity_profile = TASK_AFFINITY_PROFILE_NAME;
+	g_result.priority_profile = TASK_PRIORITY_PROFILE_NAME;
+
+	if (xTaskCreatePinnedToCore(&loadgen_task, "loadgen", LOADGEN_TASK_STACK_SIZE, NULL, LOADGEN_TASK_PRIORITY, &g_coordinator, LOADGEN_TASK_CORE_ID) != pdPASS)
+	{
+		free(g_latency_us);
+		g_latency_us = NULL;
+		g_result.running = false;
+		return ESP_ERR_NO_MEM;
+	}
+
+	return ESP_OK;
+}
+
+void loadgen_get_result(loadgen_result_t *result)
+{
+	taskENTER_CRITICAL(&g_lock);
+	*result = g_result;
+	taskEXIT_CRITICAL(&g_lock);
+
+	// Profile names of the running firmware, even before the first run
+	result->affinity_profile = TASK_AFFINITY_PROFILE_NAME;
+	result->priority_profile = TASK_PRIORITY_PROFILE_NAME;
+}
@@ -0,0 +1,70 @@
+/*
+ * loadgen.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_LOADGEN_H_
+#define MAIN_LOADGEN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/*
+ * Built-in load generator for comparing task affinity/priority profiles (tasks_common.h).
+ * Client tasks send concurrent GET /api/leds/1 requests to the device's own HTTP server over
+ * the loopback interface. One more client uploads a firmware-sized body to /api/loadgen/sink,
+ * which reads it like the OTA handler but discards it. Loopback traffic exercises lwIP and httpd
+ * but not the WiFi driver, so compare profiles with the same run parameters only.
+ */
+
+#define LOADGEN_MAX_CLIENTS			8		// Accepted by loadgen_start, which clamps them to the socket budget
+#define LOADGEN_MAX_REQUESTS		2000
+#define LOADGEN_MAX_UPLOAD_KB		2048
+#define LOADGEN_CHUNK_SIZE			1024
+
+/**
+ * Run parameters.
+ */
+typedef struct loadgen_config
+{
+	uint8_t clients;			///> Concurrent request clients, 1 .. LOADGEN_MAX_CLIENTS (requested) or the budget (result)
+	uint16_t requests;			///> Requests over all clients, 1 .. LOADGEN_MAX_REQUESTS
+	uint16_t upload_kb;			///> OTA-like upload in parallel, 0 = none
+} loadgen_config_t;
+
+/**
+ * Result of the last run.
+ */
+typedef struct loadgen_result
+{
+	bool running;
+	loadgen_config_t config;
+	const char *affinity_profile;
+	const char *priority_profile;
+	uint32_t requests_ok;
+	uint32_t requests_failed;
+	uint32_t p50_us;
+	uint32_t p90_us;
+	uint32_t p99_us;
+	uint32_t max_us;
+	uint32_t duration_ms;
+	uint32_t upload_kbps;		///> 0 if no upload or it failed
+	uint16_t core_util_permille[2];	///> 1000 - idle share of each core during the run
+} loadgen_result_t;
+
+/**
+ * Starts a run in the background.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if a run is in progress, ESP_ERR_NO_MEM.
+ */
+esp_err_t loadgen_start(const loadgen_config_t *config);
+
+/**
+ * Gets the result of the last (or running) run.
+ */
+void loadgen_get_result(loadgen_result_t *result);
+
+#endif /* MAIN_LOADGEN_H_ */
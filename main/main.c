@@ -7,20 +7,72 @@
 
 
 #include "wifi_app.h"
+#include "boot_profile.h"
+#include "event_bus.h"
+#include "esp_event.h"
+#include "esp_timer.h"
 #include "freertos/task.h"
+#include "http_server.h"
 #include "io.h"
+#include "io_cmd.h"
+#include "journal.h"
 #include "nvs_utils.h"
+#include "scene.h"
+#include "static_alloc.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "udp_ctrl.h"
 
 
 void app_main(void){
-    // Initialize NVS
+    // Reference point of the boot timeline (GET /api/boot)
+    boot_profile_mark(BOOT_PHASE_APP_MAIN);
+
+#if CONFIG_TRACE_ENABLE
+    // Event trace (GET /api/trace) from the first LED write on
+    trace_init();
+#endif
+
+    // Event pool shared by the WiFi application and the HTTP server
+    event_bus_init();
+
+    // LEDs first: a defined output state microseconds after reset
+    boot_profile_begin(BOOT_PHASE_IO_INIT);
+    io_init();
+    io_cmd_start();
+    boot_profile_end(BOOT_PHASE_IO_INIT);
+
+    // Initialize NVS, the WiFi driver and the STA config need it
+    boot_profile_begin(BOOT_PHASE_NVS_INIT);
     esp_err_t ret = nvs_init_storage();
     ESP_ERROR_CHECK(ret);
+    // Command journal kept in RTC memory, before any server takes commands
+    journal_init();
+    // Lighting programs stored in NVS, the autostart ones run from here on
+    scene_init();
+    boot_profile_end(BOOT_PHASE_NVS_INIT);
 
-    // Initialize the TCP stack
+    // Initialize the TCP stack and the default event loop
+    boot_profile_begin(BOOT_PHASE_NETIF_INIT);
 	ESP_ERROR_CHECK(esp_netif_init());
+	ESP_ERROR_CHECK(esp_event_loop_create_default());
+    boot_profile_end(BOOT_PHASE_NETIF_INIT);
+
+	// WiFi bring-up runs in the WiFi application task (core 1)...
 	wifi_app_start();
-	io_init();
+
+	// ...while the servers start here: they listen on INADDR_ANY, so they
+	// need the TCP stack but not WiFi, and answer as soon as the SoftAP is up
+	boot_profile_begin(BOOT_PHASE_HTTP_SERVER_START);
+	http_server_start();
+	boot_profile_end(BOOT_PHASE_HTTP_SERVER_START);
+#if CONFIG_UDP_CTRL_ENABLE
+	udp_ctrl_start();
+#endif
+
+	static_alloc_log_report();
+
+	telemetry_start();
 
 }
 
@@ -0,0 +1,276 @@
+/*
+ * mqtt_app.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mqtt_client.h"
+
+#include "io.h"
+#include "io_cmd.h"
+#include "journal.h"
+#include "mqtt_app.h"
+#include "static_alloc.h"
+#include "tasks_common.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "mqtt_app";
+
+static esp_mqtt_client_handle_t g_client = NULL;
+static TaskHandle_t g_task_handle = NULL;
+static volatile bool g_connected = false;
+static volatile bool g_republish = false;
+
+static char g_device_id[16];
+static char g_cmd_topic[MQTT_APP_TOPIC_MAX_LEN];
+static char g_group_topic[MQTT_APP_TOPIC_MAX_LEN];
+static char g_state_topic[MQTT_APP_TOPIC_MAX_LEN];
+static char g_status_topic[MQTT_APP_TOPIC_MAX_LEN];
+
+/**
+ * Applies a JSON LED command, the resulting change is published by the LED change callback.
+ * The command goes to the journal with the result of queueing it.
+ */
+static void mqtt_app_handle_command(const char *data, int len)
+{
+	journal_record_t rec;
+	journal_result_e result = JOURNAL_RESULT_BAD_REQUEST;
+	esp_err_t err = ESP_OK;
+
+	journal_begin(&rec, JOURNAL_SOURCE_MQTT, IO_CMD_OP_WRITE, 0);
+
+	cJSON *root = cJSON_ParseWithLength(data, len);
+	if (root == NULL)
+	{
+		ESP_LOGW(TAG, "Invalid command payload");
+		journal_end(&rec, result);
+		return;
+	}
+
+	uint8_t mask = BIT(LED_COUNT) - 1;
+	const cJSON *led = cJSON_GetObjectItemCaseSensitive(root, "led");
+	const cJSON *mask_item = cJSON_GetObjectItemCaseSensitive(root, "mask");
+	const cJSON *state = cJSON_GetObjectItemCaseSensitive(root, "state");
+	const cJSON *value = cJSON_GetObjectItemCaseSensitive(root, "value");
+
+	if (cJSON_IsNumber(led))
+	{
+		mask = (led->valueint >= 1 && led->valueint <= LED_COUNT) ? BIT(led->valueint - 1) : 0;
+	}
+	else if (cJSON_IsNumber(mask_item))
+	{
+		mask = (uint8_t)mask_item->valueint;
+	}
+	rec.channel = mask;
+
+	if (mask == 0)
+	{
+		ESP_LOGW(TAG, "Command selects no LED");
+	}
+	// Queued without waiting, the new state is published once the IO task applied it
+	else if (cJSON_IsNumber(value))
+	{
+		err = io_cmd_write(IO_CMD_SOURCE_MQTT, mask, (uint8_t)value->valueint, NULL);
+		result = JOURNAL_RESULT_OK;
+	}
+	else if (cJSON_IsString(state) && strcmp(state->valuestring, "on") == 0)
+	{
+		err = io_cmd_write(IO_CMD_SOURCE_MQTT, mask, 0xFF, NULL);
+		result = JOURNAL_RESULT_OK;
+	}
+	else if (cJSON_IsString(state) && strcmp(state->valuestring, "off") == 0)
+	{
+		err = io_cmd_write(IO_CMD_SOURCE_MQTT, mask, 0x00, NULL);
+		result = JOURNAL_RESULT_OK;
+	}
+	else if (cJSON_IsString(state) && strcmp(state->valuestring, "toggle") == 0)
+	{
+		rec.route = IO_CMD_OP_TOGGLE;
+		err = io_cmd_toggle(IO_CMD_SOURCE_MQTT, mask, NULL);
+		result = JOURNAL_RESULT_OK;
+	}
+	else
+	{
+		ESP_LOGW(TAG, "Command has no valid state or value");
+	}
+
+	if (err != ESP_OK)
+	{
+		ESP_LOGW(TAG, "Command dropped: %s", esp_err_to_name(err));
+		result = err == ESP_ERR_TIMEOUT ? JOURNAL_RESULT_BUSY : JOURNAL_RESULT_FAILED;
+	}
+
+	cJSON_Delete(root);
+	journal_end(&rec, result);
+}
+
+/**
+ * @return true if the received topic equals topic.
+ */
+static bool mqtt_app_topic_is(const esp_mqtt_event_handle_t event, const char *topic)
+{
+	return event->topic_len == (int)strlen(topic) && strncmp(event->topic, topic, event->topic_len) == 0;
+}
+
+/**
+ * esp-mqtt event handler, runs in the esp-mqtt task.
+ */
+static void mqtt_app_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+	esp_mqtt_event_handle_t event = event_data;
+
+	switch ((esp_mqtt_event_id_t)event_id)
+	{
+		case MQTT_EVENT_CONNECTED:
+			ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED");
+			esp_mqtt_client_subscribe(g_client, g_cmd_topic, 0);
+			esp_mqtt_client_subscribe(g_client, g_group_topic, 0);
+			esp_mqtt_client_publish(g_client, g_status_topic, "online", 0, 0, 1);
+			g_connected = true;
+			// The broker may have lost the retained state, or it changed while offline
+			g_republish = true;
+			xTaskNotifyGive(g_task_handle);
+			break;
+
+		case MQTT_EVENT_DISCONNECTED:
+			ESP_LOGI(TAG, "MQTT_EVENT_DISCONNECTED");
+			g_connected = false;
+			break;
+
+		case MQTT_EVENT_DATA:
+			// Commands are tiny, anything fragmented is not ours
+			if (event->current_data_offset != 0 || event->data_len != event->total_data_len)
+			{
+				break;
+			}
+			if (mqtt_app_topic_is(event, g_cmd_topic) || mqtt_app_topic_is(event, g_group_topic))
+			{
+				mqtt_app_handle_command(event->data, event->data_len);
+			}
+			break;
+
+		case MQTT_EVENT_ERROR:
+			ESP_LOGW(TAG, "MQTT_EVENT_ERROR");
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * LED change callback, only wakes the publisher: a burst of changes is sent as one state.
+ */
+static void mqtt_app_led_changed(uint8_t mask)
+{
+	if (g_task_handle != NULL)
+	{
+		xTaskNotifyGive(g_task_handle);
+	}
+}
+
+/**
+ * Publishes the retained LED state.
+ */
+static void mqtt_app_publish_state(uint8_t mask)
+{
+	char payload[64];
+	int len = snprintf(payload, sizeof(payload), "{\"mask\":%u,\"leds\":[", (unsigned)mask);
+
+	for (int i = 0; i < LED_COUNT; i++)
+	{
+		len += snprintf(&payload[len], sizeof(payload) - len, "%s\"%s\"", i ? "," : "", (mask & BIT(i)) ? "on" : "off");
+	}
+	len += snprintf(&payload[len], sizeof(payload) - len, "]}");
+
+	esp_mqtt_client_publish(g_client, g_state_topic, payload, len, 0, 1);
+}
+
+/**
+ * Publisher task. The first change is sent right away, the changes made while
+ * CONFIG_MQTT_APP_COALESCE_MS passes are folded into the next publish of the latest state.
+ */
+static void mqtt_app_task(void *pvParameters)
+{
+	int published_mask = -1;
+
+	for (;;)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		// Published on MQTT_EVENT_CONNECTED
+		if (!g_connected)
+		{
+			continue;
+		}
+
+		uint8_t mask = io_led_get_mask();
+		if (mask == published_mask && !g_republish)
+		{
+			continue;
+		}
+
+		g_republish = false;
+		published_mask = mask;
+		mqtt_app_publish_state(mask);
+
+		vTaskDelay(pdMS_TO_TICKS(CONFIG_MQTT_APP_COALESCE_MS));
+	}
+}
+
+void mqtt_app_start(void)
+{
+	uint8_t mac[6];
+
+	if (g_task_handle != NULL)
+	{
+		return;
+	}
+
+	esp_read_mac(mac, ESP_MAC_WIFI_STA);
+	snprintf(g_device_id, sizeof(g_device_id), "esp32-%02x%02x%02x", mac[3], mac[4], mac[5]);
+	snprintf(g_cmd_topic, sizeof(g_cmd_topic), "%s/%s/led/set", CONFIG_MQTT_APP_TOPIC_PREFIX, g_device_id);
+	snprintf(g_group_topic, sizeof(g_group_topic), "%s/group/%s/led/set", CONFIG_MQTT_APP_TOPIC_PREFIX, CONFIG_MQTT_APP_GROUP);
+	snprintf(g_state_topic, sizeof(g_state_topic), "%s/%s/led/state", CONFIG_MQTT_APP_TOPIC_PREFIX, g_device_id);
+	snprintf(g_status_topic, sizeof(g_status_topic), "%s/%s/status", CONFIG_MQTT_APP_TOPIC_PREFIX, g_device_id);
+
+	esp_mqtt_client_config_t mqtt_cfg = {
+			.broker.address.uri = CONFIG_MQTT_APP_BROKER_URI,
+			.credentials.client_id = g_device_id,
+			.session = {
+					.keepalive = MQTT_APP_KEEPALIVE_S,
+					.last_will = {
+							.topic = g_status_topic,
+							.msg = "offline",
+							.qos = 0,
+							.retain = 1,
+					},
+			},
+			.network.reconnect_timeout_ms = MQTT_APP_RECONNECT_MS,
+			.task.stack_size = MQTT_CLIENT_TASK_STACK_SIZE,
+	};
+
+	g_task_handle = static_alloc_task_create(STATIC_TASK_MQTT_APP, &mqtt_app_task, NULL);
+
+	g_client = esp_mqtt_client_init(&mqtt_cfg);
+	if (g_client == NULL)
+	{
+		ESP_LOGE(TAG, "esp_mqtt_client_init failed");
+		return;
+	}
+
+	io_led_set_change_callback(mqtt_app_led_changed);
+	esp_mqtt_client_register_event(g_client, ESP_EVENT_ANY_ID, mqtt_app_event_handler, NULL);
+	esp_mqtt_client_start(g_client);
+
+	ESP_LOGI(TAG, "Connecting to %s as %s", CONFIG_MQTT_APP_BROKER_URI, g_device_id);
+}
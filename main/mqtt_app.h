@@ -0,0 +1,39 @@
+/*
+ * mqtt_app.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_MQTT_APP_H_
+#define MAIN_MQTT_APP_H_
+
+#include "sdkconfig.h"
+
+/*
+ * Topics, <id> is "esp32-" followed by the last 3 bytes of the STA MAC in hex:
+ *
+ *   <prefix>/<id>/led/set                 command to this device
+ *   <prefix>/group/<group>/led/set        command to every device of the group
+ *   <prefix>/<id>/led/state               retained LED state, published on every change
+ *   <prefix>/<id>/status                  retained "online", "offline" as last will
+ *
+ * Command payload (JSON): {"led": 1..4} or {"mask": n} selects the LEDs (all if absent), then
+ * either {"state": "on"|"off"|"toggle"} or {"value": n} to write the selected bits.
+ * State payload: {"mask": n, "leds": ["on", "off", ...]}.
+ *
+ * Everything is QoS 0: a command is delivered at most once (a toggle is never applied twice)
+ * without the PUBACK round trip, and the retained state is republished on every reconnect.
+ */
+
+#define MQTT_APP_TOPIC_MAX_LEN		96
+#define MQTT_APP_KEEPALIVE_S		15
+#define MQTT_APP_RECONNECT_MS		2000
+
+/**
+ * Starts the MQTT client (once, later calls do nothing), esp-mqtt handles reconnects itself.
+ * Call after the STA got an IP.
+ */
+void mqtt_app_start(void);
+
+#endif /* MAIN_MQTT_APP_H_ */
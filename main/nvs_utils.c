@@ -5,18 +5,80 @@
  *      Author: majorBien
  */
 
-#include "nvs_utils.h"
 #include "nvs_utils.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_log.h"
+#include "esp_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "string.h"
 
 #define TAG "NVS_UTILS"
 
 #define NVS_NAMESPACE "device_storage"
 #define CONST_DATA_KEY "device_config"
-#define USER_DATA_KEY "wifi_config"
+#define USER_DATA_KEY "wifi_config"     // legacy raw nvs_network_data_t blob (layout version 0)
+#define CONFIG_RECORD_KEY "config"
+#define CONFIG_BACKUP_KEY "config_bad"  // last record that failed the magic or CRC check
+
+#define NVS_CONFIG_MAGIC 0x4643         // "CF"
+
+/*
+ * Config record layout:
+ *   nvs_config_header_t, followed by `length` bytes of TLV fields.
+ *   Each field is: tag (1 byte), len (1 byte), value (len bytes).
+ *   Integers are little endian with a fixed width, never a compiler struct layout.
+ * Unknown tags are skipped, so an older firmware can still read a newer record.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t length;
+    uint32_t crc;                       // CRC32 of the TLV payload
+} nvs_config_header_t;
+
+// TLV field tags - never reuse a tag for a different meaning
+typedef enum {
+    CFG_TAG_NET_SSID = 0x01,
+    CFG_TAG_NET_PASSWORD = 0x02,
+    CFG_TAG_STA_BSSID = 0x03,
+    CFG_TAG_STA_CHANNEL = 0x04,
+    CFG_TAG_STATIC_IP_STRUCT = 0x05,    // raw nvs_static_ip_t of older firmware, only read
+    CFG_TAG_AUTH_STRUCT = 0x06,         // raw nvs_auth_t of older firmware, only read
+    CFG_TAG_RATE_LIMITS_STRUCT = 0x07,  // raw nvs_rate_limit_t array of older firmware, only read
+    CFG_TAG_STATIC_IP_ENABLED = 0x08,   // u8
+    CFG_TAG_STATIC_IP_ADDR = 0x09,      // u32, addresses keep their network byte order value
+    CFG_TAG_STATIC_IP_NETMASK = 0x0A,   // u32
+    CFG_TAG_STATIC_IP_GW = 0x0B,        // u32
+    CFG_TAG_STATIC_IP_DNS = 0x0C,       // u32
+    CFG_TAG_AUTH_USER = 0x0D,           // string
+    CFG_TAG_AUTH_ITERATIONS = 0x0E,     // u32
+    CFG_TAG_AUTH_SALT = 0x0F,           // 16 bytes
+    CFG_TAG_AUTH_HASH = 0x10,           // 32 bytes
+    CFG_TAG_RATE_PER_MINUTE = 0x20,     // u16, 0x20 + route class, absent = firmware default
+    CFG_TAG_RATE_BURST = 0x28,          // u16, 0x28 + route class, absent = firmware default
+} nvs_config_tag_e;
+
+// Room for 8 route classes in each rate limit tag range
+_Static_assert(NVS_RATE_LIMIT_ROUTES <= CFG_TAG_RATE_BURST - CFG_TAG_RATE_PER_MINUTE, "Rate limit tag ranges overlap");
+
+// Upgrades the RAM config from layout version N to N+1
+typedef esp_err_t (*nvs_config_migration_fn)(nvs_handle_t handle, nvs_config_t *cfg);
+
+static esp_err_t nvs_config_migrate_v0(nvs_handle_t handle, nvs_config_t *cfg);
+
+// Migration table, indexed by the version being upgraded from
+static const nvs_config_migration_fn config_migrations[NVS_CONFIG_VERSION] = {
+    nvs_config_migrate_v0,
+};
+
+// RAM copy of the config record
+static nvs_config_t config_cache;
+static SemaphoreHandle_t config_mutex;
+static StaticSemaphore_t config_mutex_buffer;
+static uint8_t config_buf[NVS_CONFIG_MAX_SIZE];
 
 esp_err_t nvs_init_storage(void) {
     esp_err_t ret = nvs_flash_init();
@@ -24,14 +86,255 @@ esp_err_t nvs_init_storage(void) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
+    if (ret == ESP_OK) {
+        ret = nvs_config_load();
+    }
     return ret;
 }
 
-esp_err_t nvs_save_network_data(const nvs_network_data_t *data) {
-    if (data == NULL) {
-        ESP_LOGE(TAG, "Invalid data pointer");
-        return ESP_ERR_INVALID_ARG;
+/**
+ * Version 0 -> 1: import the legacy raw wifi_config blob and drop the old key.
+ */
+static esp_err_t nvs_config_migrate_v0(nvs_handle_t handle, nvs_config_t *cfg) {
+    nvs_network_data_t legacy = { 0 };
+    size_t size = sizeof(legacy);
+
+    esp_err_t err = nvs_get_blob(handle, USER_DATA_KEY, &legacy, &size);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    }
+    if (err != ESP_OK || size != sizeof(legacy)) {
+        ESP_LOGW(TAG, "Legacy wifi_config unreadable, dropping it");
+    } else {
+        legacy.ssid[sizeof(legacy.ssid) - 1] = '\0';
+        legacy.password[sizeof(legacy.password) - 1] = '\0';
+        cfg->network = legacy;
+        ESP_LOGI(TAG, "Migrated legacy wifi_config (SSID: %s)", legacy.ssid);
+    }
+
+    nvs_erase_key(handle, USER_DATA_KEY);
+    return ESP_OK;
+}
+
+static bool tlv_put(uint8_t *buf, size_t *off, uint8_t tag, const void *value, size_t len) {
+    if (len > UINT8_MAX || *off + 2 + len > NVS_CONFIG_MAX_SIZE) {
+        return false;
     }
+    buf[(*off)++] = tag;
+    buf[(*off)++] = (uint8_t)len;
+    memcpy(&buf[*off], value, len);
+    *off += len;
+    return true;
+}
+
+static bool tlv_put_str(uint8_t *buf, size_t *off, uint8_t tag, const char *str) {
+    return tlv_put(buf, off, tag, str, strlen(str));
+}
+
+static bool tlv_put_u8(uint8_t *buf, size_t *off, uint8_t tag, uint8_t value) {
+    return tlv_put(buf, off, tag, &value, 1);
+}
+
+static bool tlv_put_u16(uint8_t *buf, size_t *off, uint8_t tag, uint16_t value) {
+    const uint8_t le[2] = { value, value >> 8 };
+    return tlv_put(buf, off, tag, le, sizeof(le));
+}
+
+static bool tlv_put_u32(uint8_t *buf, size_t *off, uint8_t tag, uint32_t value) {
+    const uint8_t le[4] = { value, value >> 8, value >> 16, value >> 24 };
+    return tlv_put(buf, off, tag, le, sizeof(le));
+}
+
+static void tlv_get_str(char *dst, size_t dst_size, const uint8_t *value, uint8_t len) {
+    size_t n = len < dst_size - 1 ? len : dst_size - 1;
+    memcpy(dst, value, n);
+    dst[n] = '\0';
+}
+
+// Fixed-size fields only accept an exact length match, anything else keeps the default
+static void tlv_get_raw(void *dst, size_t dst_size, const uint8_t *value, uint8_t len) {
+    if (len == dst_size) {
+        memcpy(dst, value, len);
+    }
+}
+
+static void tlv_get_u16(uint16_t *dst, const uint8_t *value, uint8_t len) {
+    if (len == 2) {
+        *dst = value[0] | (uint16_t)value[1] << 8;
+    }
+}
+
+static void tlv_get_u32(uint32_t *dst, const uint8_t *value, uint8_t len) {
+    if (len == 4) {
+        *dst = value[0] | (uint32_t)value[1] << 8 | (uint32_t)value[2] << 16 | (uint32_t)value[3] << 24;
+    }
+}
+
+/**
+ * Serializes cfg into config_buf.
+ * @return total record size, or 0 if the record does not fit.
+ */
+static size_t nvs_config_encode(const nvs_config_t *cfg) {
+    nvs_config_header_t *hdr = (nvs_config_header_t *)config_buf;
+    size_t off = sizeof(*hdr);
+    bool ok = true;
+
+    ok &= tlv_put_str(config_buf, &off, CFG_TAG_NET_SSID, cfg->network.ssid);
+    ok &= tlv_put_str(config_buf, &off, CFG_TAG_NET_PASSWORD, cfg->network.password);
+    if (cfg->sta_cache.channel != 0) {
+        ok &= tlv_put(config_buf, &off, CFG_TAG_STA_BSSID, cfg->sta_cache.bssid, sizeof(cfg->sta_cache.bssid));
+        ok &= tlv_put(config_buf, &off, CFG_TAG_STA_CHANNEL, &cfg->sta_cache.channel, 1);
+    }
+    ok &= tlv_put_u8(config_buf, &off, CFG_TAG_STATIC_IP_ENABLED, cfg->static_ip.enabled ? 1 : 0);
+    ok &= tlv_put_u32(config_buf, &off, CFG_TAG_STATIC_IP_ADDR, cfg->static_ip.ip);
+    ok &= tlv_put_u32(config_buf, &off, CFG_TAG_STATIC_IP_NETMASK, cfg->static_ip.netmask);
+    ok &= tlv_put_u32(config_buf, &off, CFG_TAG_STATIC_IP_GW, cfg->static_ip.gw);
+    ok &= tlv_put_u32(config_buf, &off, CFG_TAG_STATIC_IP_DNS, cfg->static_ip.dns);
+    if (cfg->auth.iterations != 0) {
+        ok &= tlv_put_str(config_buf, &off, CFG_TAG_AUTH_USER, cfg->auth.user);
+        ok &= tlv_put_u32(config_buf, &off, CFG_TAG_AUTH_ITERATIONS, cfg->auth.iterations);
+        ok &= tlv_put(config_buf, &off, CFG_TAG_AUTH_SALT, cfg->auth.salt, sizeof(cfg->auth.salt));
+        ok &= tlv_put(config_buf, &off, CFG_TAG_AUTH_HASH, cfg->auth.hash, sizeof(cfg->auth.hash));
+    }
+    for (int i = 0; i < NVS_RATE_LIMIT_ROUTES; i++) {
+        if (cfg->rate_limits[i].per_minute != 0) {
+            ok &= tlv_put_u16(config_buf, &off, CFG_TAG_RATE_PER_MINUTE + i, cfg->rate_limits[i].per_minute);
+        }
+        if (cfg->rate_limits[i].burst != 0) {
+            ok &= tlv_put_u16(config_buf, &off, CFG_TAG_RATE_BURST + i, cfg->rate_limits[i].burst);
+        }
+    }
+
+    if (!ok) {
+        return 0;
+    }
+
+    hdr->magic = NVS_CONFIG_MAGIC;
+    hdr->version = NVS_CONFIG_VERSION;
+    hdr->reserved = 0;
+    hdr->length = off - sizeof(*hdr);
+    hdr->crc = esp_crc32_le(0, config_buf + sizeof(*hdr), hdr->length);
+    return off;
+}
+
+/**
+ * Parses the TLV payload into cfg, skipping tags this firmware does not know.
+ */
+static void nvs_config_decode(const uint8_t *payload, size_t length, nvs_config_t *cfg) {
+    size_t off = 0;
+
+    while (off + 2 <= length) {
+        uint8_t tag = payload[off];
+        uint8_t len = payload[off + 1];
+        const uint8_t *value = &payload[off + 2];
+
+        if (off + 2 + len > length) {
+            ESP_LOGW(TAG, "Truncated config field 0x%02x", tag);
+            break;
+        }
+
+        switch (tag) {
+            case CFG_TAG_NET_SSID:
+                tlv_get_str(cfg->network.ssid, sizeof(cfg->network.ssid), value, len);
+                break;
+            case CFG_TAG_NET_PASSWORD:
+                tlv_get_str(cfg->network.password, sizeof(cfg->network.password), value, len);
+                break;
+            case CFG_TAG_STA_BSSID:
+                tlv_get_raw(cfg->sta_cache.bssid, sizeof(cfg->sta_cache.bssid), value, len);
+                break;
+            case CFG_TAG_STA_CHANNEL:
+                tlv_get_raw(&cfg->sta_cache.channel, 1, value, len);
+                break;
+            case CFG_TAG_STATIC_IP_STRUCT:
+                tlv_get_raw(&cfg->static_ip, sizeof(cfg->static_ip), value, len);
+                break;
+            case CFG_TAG_STATIC_IP_ENABLED:
+                if (len == 1) {
+                    cfg->static_ip.enabled = value[0] != 0;
+                }
+                break;
+            case CFG_TAG_STATIC_IP_ADDR:
+                tlv_get_u32(&cfg->static_ip.ip, value, len);
+                break;
+            case CFG_TAG_STATIC_IP_NETMASK:
+                tlv_get_u32(&cfg->static_ip.netmask, value, len);
+                break;
+            case CFG_TAG_STATIC_IP_GW:
+                tlv_get_u32(&cfg->static_ip.gw, value, len);
+                break;
+            case CFG_TAG_STATIC_IP_DNS:
+                tlv_get_u32(&cfg->static_ip.dns, value, len);
+                break;
+            case CFG_TAG_AUTH_STRUCT:
+                tlv_get_raw(&cfg->auth, sizeof(cfg->auth), value, len);
+                break;
+            case CFG_TAG_AUTH_USER:
+                tlv_get_str(cfg->auth.user, sizeof(cfg->auth.user), value, len);
+                break;
+            case CFG_TAG_AUTH_ITERATIONS:
+                tlv_get_u32(&cfg->auth.iterations, value, len);
+                break;
+            case CFG_TAG_AUTH_SALT:
+                tlv_get_raw(cfg->auth.salt, sizeof(cfg->auth.salt), value, len);
+                break;
+            case CFG_TAG_AUTH_HASH:
+                tlv_get_raw(cfg->auth.hash, sizeof(cfg->auth.hash), value, len);
+                break;
+            case CFG_TAG_RATE_LIMITS_STRUCT:
+                tlv_get_raw(cfg->rate_limits, sizeof(cfg->rate_limits), value, len);
+                break;
+            default:
+                if (tag >= CFG_TAG_RATE_PER_MINUTE && tag < CFG_TAG_RATE_PER_MINUTE + NVS_RATE_LIMIT_ROUTES) {
+                    tlv_get_u16(&cfg->rate_limits[tag - CFG_TAG_RATE_PER_MINUTE].per_minute, value, len);
+                } else if (tag >= CFG_TAG_RATE_BURST && tag < CFG_TAG_RATE_BURST + NVS_RATE_LIMIT_ROUTES) {
+                    tlv_get_u16(&cfg->rate_limits[tag - CFG_TAG_RATE_BURST].burst, value, len);
+                }
+                break;
+        }
+        off += 2 + len;
+    }
+}
+
+/**
+ * Writes the record for cfg using an already opened handle.
+ */
+static esp_err_t nvs_config_write(nvs_handle_t handle, const nvs_config_t *cfg) {
+    size_t size = nvs_config_encode(cfg);
+    if (size == 0) {
+        ESP_LOGE(TAG, "Config record exceeds %d bytes", NVS_CONFIG_MAX_SIZE);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = nvs_set_blob(handle, CONFIG_RECORD_KEY, config_buf, size);
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    return err;
+}
+
+/**
+ * Copies the corrupted record in config_buf to CONFIG_BACKUP_KEY so it can be recovered,
+ * the boot goes on with defaults either way.
+ */
+static void nvs_config_backup(nvs_handle_t handle, size_t size) {
+    esp_err_t err = nvs_set_blob(handle, CONFIG_BACKUP_KEY, config_buf, size);
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error saving the corrupted config record: %s", esp_err_to_name(err));
+    }
+}
+
+esp_err_t nvs_config_load(void) {
+    if (config_mutex == NULL) {
+        config_mutex = xSemaphoreCreateMutexStatic(&config_mutex_buffer);
+    }
+
+    nvs_config_t cfg = { 0 };
+    uint8_t version = 0;
+    bool unreadable = false;
 
     nvs_handle_t handle;
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
@@ -40,31 +343,133 @@ esp_err_t nvs_save_network_data(const nvs_network_data_t *data) {
         return err;
     }
 
-    err = nvs_set_blob(handle, USER_DATA_KEY, data, sizeof(nvs_network_data_t));
+    size_t size = sizeof(config_buf);
+    err = nvs_get_blob(handle, CONFIG_RECORD_KEY, config_buf, &size);
     if (err == ESP_OK) {
-        err = nvs_commit(handle);
+        const nvs_config_header_t *hdr = (const nvs_config_header_t *)config_buf;
+        const uint8_t *payload = config_buf + sizeof(*hdr);
+
+        if (size < sizeof(*hdr) || hdr->magic != NVS_CONFIG_MAGIC
+                || hdr->length > size - sizeof(*hdr)
+                || hdr->crc != esp_crc32_le(0, payload, hdr->length)) {
+            ESP_LOGE(TAG, "Config record corrupted (%u bytes), kept as %s, using defaults",
+                     (unsigned)size, CONFIG_BACKUP_KEY);
+            nvs_config_backup(handle, size);
+            unreadable = true;
+        } else {
+            nvs_config_decode(payload, hdr->length, &cfg);
+            version = hdr->version;
+        }
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGE(TAG, "Error reading config record: %s", esp_err_to_name(err));
+        unreadable = true;
+    }
+
+    // Upgrade older layouts and persist the result once. An unreadable record is not a v0 one:
+    // it stays in flash until the next nvs_config_set, nothing is imported over it.
+    if (unreadable) {
+        err = ESP_OK;
+    } else if (version < NVS_CONFIG_VERSION) {
+        for (uint8_t v = version; v < NVS_CONFIG_VERSION; v++) {
+            ESP_LOGI(TAG, "Migrating config record v%d -> v%d", v, v + 1);
+            err = config_migrations[v](handle, &cfg);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Config migration from v%d failed: %s", v, esp_err_to_name(err));
+                break;
+            }
+        }
+        if (err == ESP_OK) {
+            err = nvs_config_write(handle, &cfg);
+        }
+    } else if (version > NVS_CONFIG_VERSION) {
+        // Written by a newer firmware (e.g. after rollback) - read known fields, leave the record alone
+        ESP_LOGW(TAG, "Config record v%d is newer than v%d", version, NVS_CONFIG_VERSION);
     }
 
     nvs_close(handle);
+
+    xSemaphoreTake(config_mutex, portMAX_DELAY);
+    config_cache = cfg;
+    xSemaphoreGive(config_mutex);
+
+    return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+}
+
+void nvs_config_get(nvs_config_t *cfg) {
+    xSemaphoreTake(config_mutex, portMAX_DELAY);
+    *cfg = config_cache;
+    xSemaphoreGive(config_mutex);
+}
+
+esp_err_t nvs_config_update(nvs_config_update_fn fn, void *ctx) {
+    if (fn == NULL) {
+        ESP_LOGE(TAG, "Invalid update function");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    nvs_config_t cfg;
+
+    xSemaphoreTake(config_mutex, portMAX_DELAY);
+    cfg = config_cache;
+    if (fn(&cfg, ctx)) {
+        nvs_handle_t handle;
+        err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+        if (err == ESP_OK) {
+            err = nvs_config_write(handle, &cfg);
+            nvs_close(handle);
+        } else {
+            ESP_LOGE(TAG, "Error opening NVS: %s", esp_err_to_name(err));
+        }
+        if (err == ESP_OK) {
+            config_cache = cfg;
+        }
+    }
+    xSemaphoreGive(config_mutex);
+
     return err;
 }
 
-esp_err_t nvs_load_network_data(nvs_network_data_t *data) {
+static bool nvs_config_replace(nvs_config_t *cfg, void *ctx) {
+    *cfg = *(const nvs_config_t *)ctx;
+    return true;
+}
+
+esp_err_t nvs_config_set(const nvs_config_t *cfg) {
+    if (cfg == NULL) {
+        ESP_LOGE(TAG, "Invalid data pointer");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return nvs_config_update(nvs_config_replace, (void *)cfg);
+}
+
+static bool nvs_config_replace_network(nvs_config_t *cfg, void *ctx) {
+    cfg->network = *(const nvs_network_data_t *)ctx;
+    return true;
+}
+
+esp_err_t nvs_save_network_data(const nvs_network_data_t *data) {
     if (data == NULL) {
         ESP_LOGE(TAG, "Invalid data pointer");
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error opening NVS: %s", esp_err_to_name(err));
-        return err;
+    return nvs_config_update(nvs_config_replace_network, (void *)data);
+}
+
+esp_err_t nvs_load_network_data(nvs_network_data_t *data) {
+    if (data == NULL) {
+        ESP_LOGE(TAG, "Invalid data pointer");
+        return ESP_ERR_INVALID_ARG;
     }
 
-    size_t required_size = sizeof(nvs_network_data_t);
-    err = nvs_get_blob(handle, USER_DATA_KEY, data, &required_size);
+    nvs_config_t cfg;
+    nvs_config_get(&cfg);
+    if (cfg.network.ssid[0] == '\0') {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
 
-    nvs_close(handle);
-    return err;
+    *data = cfg.network;
+    return ESP_OK;
 }
@@ -10,8 +10,17 @@
 // Max number of IO items we support
 #define IO_CONFIG_MAX 16
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
 
+// Current layout version of the config record.
+// Bump it together with a new entry in the migration table in nvs_utils.c.
+#define NVS_CONFIG_VERSION 1
+
+// Max size of the serialized config record (header + TLV fields)
+#define NVS_CONFIG_MAX_SIZE 1024
+
 
 // User WiFi configuration structure
 typedef struct {
@@ -19,10 +28,64 @@ typedef struct {
     char password[65];        // 64 chars + null
 } nvs_network_data_t;
 
+// Last good STA association, used for a directed connect on boot
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;          // 0 = nothing cached
+} nvs_sta_cache_t;
+
+// Optional static IPv4 setup for the STA (addresses in network byte order)
+typedef struct {
+    bool enabled;
+    uint32_t ip;
+    uint32_t netmask;
+    uint32_t gw;
+    uint32_t dns;
+} nvs_static_ip_t;
+
+// Web API login, the password is only kept as PBKDF2-HMAC-SHA256(password, salt)
+typedef struct {
+    char user[33];            // 32 chars + null
+    uint32_t iterations;      // 0 = no credentials set, the API is open
+    uint8_t salt[16];
+    uint8_t hash[32];
+} nvs_auth_t;
+
+// HTTP admission control limit of one route class (see http_admit.h), 0 = firmware default
+#define NVS_RATE_LIMIT_ROUTES 4
 
-// Initialize NVS storage
+typedef struct {
+    uint16_t per_minute;      // bucket refill rate
+    uint16_t burst;           // bucket size
+} nvs_rate_limit_t;
+
+// Whole device configuration, kept in RAM and stored as one versioned record
+typedef struct {
+    nvs_network_data_t network;
+    nvs_sta_cache_t sta_cache;
+    nvs_static_ip_t static_ip;
+    nvs_auth_t auth;
+    nvs_rate_limit_t rate_limits[NVS_RATE_LIMIT_ROUTES];
+} nvs_config_t;
+
+
+// Initialize NVS storage and load the config record into RAM
 esp_err_t nvs_init_storage(void);
 
+// Config record operations
+// nvs_config_get copies the RAM cache (no flash access),
+// nvs_config_set replaces it and writes the whole record in one atomic blob write.
+esp_err_t nvs_config_load(void);
+void nvs_config_get(nvs_config_t *cfg);
+esp_err_t nvs_config_set(const nvs_config_t *cfg);
+
+// Changes some fields of the config: fn edits a copy of the RAM cache with the config
+// locked and returns true to write it, false to leave the record as it is.
+// Writers that only change their own fields never undo each other, unlike get + set.
+// fn must not call the other nvs_config_* functions.
+typedef bool (*nvs_config_update_fn)(nvs_config_t *cfg, void *ctx);
+esp_err_t nvs_config_update(nvs_config_update_fn fn, void *ctx);
+
 // wifi data operations
 esp_err_t nvs_save_network_data(const nvs_network_data_t *data);
 esp_err_t nvs_load_network_data(nvs_network_data_t *data);
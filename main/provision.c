@@ -0,0 +1,450 @@
+/*
+ * provision.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "auth.h"
+#include "cbor_codec.h"
+#include "http_admit.h"
+#include "provision.h"
+
+#define PROVISION_IP_LEN			4
+
+// Formatted from the limits of auth.h when an import is refused, always the same text
+static char g_iterations_error[48];
+
+/**
+ * Decoding state: the reader and the first error found.
+ */
+typedef struct provision_ctx
+{
+	cbor_reader_t r;
+	const char *error;
+} provision_ctx_t;
+
+static bool provision_fail(provision_ctx_t *ctx, const char *error)
+{
+	if (ctx->error == NULL)
+	{
+		ctx->error = error;
+	}
+	ctx->r.error = true;
+	return false;
+}
+
+static bool provision_key(provision_ctx_t *ctx, const char **key, size_t *len)
+{
+	return cbor_read_text(&ctx->r, key, len) || provision_fail(ctx, "map keys must be text");
+}
+
+static bool provision_key_is(const char *key, size_t len, const char *name)
+{
+	return strlen(name) == len && memcmp(key, name, len) == 0;
+}
+
+/**
+ * Reads a text into a fixed buffer.
+ * @param min shortest length accepted.
+ */
+static bool provision_read_text(provision_ctx_t *ctx, char *dst, size_t size, size_t min, const char *error)
+{
+	const char *str;
+	size_t len;
+
+	if (!cbor_read_text(&ctx->r, &str, &len) || len < min || len >= size || memchr(str, '\0', len) != NULL)
+	{
+		return provision_fail(ctx, error);
+	}
+
+	memcpy(dst, str, len);
+	dst[len] = '\0';
+	return true;
+}
+
+/**
+ * Reads a byte string of an exact length.
+ */
+static bool provision_read_bytes(provision_ctx_t *ctx, void *dst, size_t size, const char *error)
+{
+	const uint8_t *bytes;
+	size_t len;
+
+	if (!cbor_read_bytes(&ctx->r, &bytes, &len) || len != size)
+	{
+		return provision_fail(ctx, error);
+	}
+
+	memcpy(dst, bytes, len);
+	return true;
+}
+
+static bool provision_read_uint(provision_ctx_t *ctx, uint32_t max, uint32_t *value, const char *error)
+{
+	uint64_t v;
+
+	if (!cbor_read_uint(&ctx->r, &v) || v > max)
+	{
+		return provision_fail(ctx, error);
+	}
+
+	*value = v;
+	return true;
+}
+
+static bool provision_read_network(provision_ctx_t *ctx, nvs_network_data_t *network)
+{
+	uint32_t pairs;
+	const char *key;
+	size_t len;
+
+	if (!cbor_read_map(&ctx->r, &pairs))
+	{
+		return provision_fail(ctx, "network must be a map");
+	}
+	for (uint32_t i = 0; i < pairs; i++)
+	{
+		if (!provision_key(ctx, &key, &len))
+		{
+			return false;
+		}
+		if (provision_key_is(key, len, "ssid"))
+		{
+			if (!provision_read_text(ctx, network->ssid, sizeof(network->ssid), 1, "ssid must be 1 to 32 characters"))
+			{
+				return false;
+			}
+		}
+		else if (provision_key_is(key, len, "password"))
+		{
+			if (!provision_read_text(ctx, network->password, sizeof(network->password), 0, "password must be up to 64 characters"))
+			{
+				return false;
+			}
+		}
+		else if (!cbor_skip(&ctx->r))
+		{
+			return provision_fail(ctx, "malformed network");
+		}
+	}
+
+	return true;
+}
+
+static bool provision_read_static_ip(provision_ctx_t *ctx, nvs_static_ip_t *static_ip)
+{
+	nvs_static_ip_t parsed = { .enabled = true };
+	uint32_t pairs;
+	const char *key;
+	size_t len;
+
+	if (cbor_peek(&ctx->r) == CBOR_TYPE_NULL)
+	{
+		cbor_read_null(&ctx->r);
+		static_ip->enabled = false;
+		return true;
+	}
+	if (!cbor_read_map(&ctx->r, &pairs))
+	{
+		return provision_fail(ctx, "static_ip must be a map or null");
+	}
+	for (uint32_t i = 0; i < pairs; i++)
+	{
+		uint32_t *addr = NULL;
+
+		if (!provision_key(ctx, &key, &len))
+		{
+			return false;
+		}
+		if (provision_key_is(key, len, "ip"))
+		{
+			addr = &parsed.ip;
+		}
+		else if (provision_key_is(key, len, "netmask"))
+		{
+			addr = &parsed.netmask;
+		}
+		else if (provision_key_is(key, len, "gw"))
+		{
+			addr = &parsed.gw;
+		}
+		else if (provision_key_is(key, len, "dns"))
+		{
+			addr = &parsed.dns;
+		}
+
+		if (addr == NULL)
+		{
+			if (!cbor_skip(&ctx->r))
+			{
+				return provision_fail(ctx, "malformed static_ip");
+			}
+		}
+		else if (!provision_read_bytes(ctx, addr, PROVISION_IP_LEN, "addresses must be 4 bytes"))
+		{
+			return false;
+		}
+	}
+	if (parsed.ip == 0 || parsed.netmask == 0)
+	{
+		return provision_fail(ctx, "static_ip needs ip and netmask");
+	}
+
+	*static_ip = parsed;
+	return true;
+}
+
+static bool provision_read_auth(provision_ctx_t *ctx, nvs_auth_t *auth)
+{
+	nvs_auth_t parsed = { 0 };
+	uint32_t pairs;
+	const char *key;
+	size_t len;
+	bool ok = true;
+
+	if (!cbor_read_map(&ctx->r, &pairs))
+	{
+		return provision_fail(ctx, "auth must be a map");
+	}
+	for (uint32_t i = 0; i < pairs && ok; i++)
+	{
+		if (!provision_key(ctx, &key, &len))
+		{
+			return false;
+		}
+		if (provision_key_is(key, len, "user"))
+		{
+			ok = provision_read_text(ctx, parsed.user, sizeof(parsed.user), 1, "user must be 1 to 32 characters");
+		}
+		else if (provision_key_is(key, len, "iterations"))
+		{
+			ok = provision_read_uint(ctx, UINT32_MAX, &parsed.iterations, "iterations must be an unsigned integer");
+		}
+		else if (provision_key_is(key, len, "salt"))
+		{
+			ok = provision_read_bytes(ctx, parsed.salt, sizeof(parsed.salt), "salt must be 16 bytes");
+		}
+		else if (provision_key_is(key, len, "hash"))
+		{
+			ok = provision_read_bytes(ctx, parsed.hash, sizeof(parsed.hash), "hash must be 32 bytes");
+		}
+		else
+		{
+			ok = cbor_skip(&ctx->r) || provision_fail(ctx, "malformed auth");
+		}
+	}
+	if (!ok)
+	{
+		return false;
+	}
+
+	// A hash without its salt and cost would lock everyone out
+	static const uint8_t zero[sizeof(parsed.hash)] = { 0 };
+	if (parsed.user[0] == '\0' || parsed.iterations == 0 || memcmp(parsed.hash, zero, sizeof(parsed.hash)) == 0)
+	{
+		return provision_fail(ctx, "auth needs user, iterations, salt and hash");
+	}
+	if (parsed.iterations < AUTH_PBKDF2_ITERATIONS_MIN || parsed.iterations > AUTH_PBKDF2_ITERATIONS_MAX)
+	{
+		snprintf(g_iterations_error, sizeof(g_iterations_error), "iterations must be %u to %u",
+				(unsigned)AUTH_PBKDF2_ITERATIONS_MIN, (unsigned)AUTH_PBKDF2_ITERATIONS_MAX);
+		return provision_fail(ctx, g_iterations_error);
+	}
+
+	*auth = parsed;
+	return true;
+}
+
+static bool provision_read_limits(provision_ctx_t *ctx, nvs_rate_limit_t limits[NVS_RATE_LIMIT_ROUTES])
+{
+	uint32_t pairs;
+	const char *key;
+	size_t len;
+
+	if (!cbor_read_map(&ctx->r, &pairs))
+	{
+		return provision_fail(ctx, "limits must be a map");
+	}
+	for (uint32_t i = 0; i < pairs; i++)
+	{
+		int route = HTTP_ADMIT_ROUTE_COUNT;
+		uint32_t count;
+		uint32_t per_minute;
+		uint32_t burst;
+
+		if (!provision_key(ctx, &key, &len))
+		{
+			return false;
+		}
+		for (int j = 0; j < HTTP_ADMIT_ROUTE_COUNT; j++)
+		{
+			if (provision_key_is(key, len, http_admit_route_name(j)))
+			{
+				route = j;
+			}
+		}
+
+		if (route == HTTP_ADMIT_ROUTE_COUNT)
+		{
+			if (!cbor_skip(&ctx->r))
+			{
+				return provision_fail(ctx, "malformed limits");
+			}
+			continue;
+		}
+		if (!cbor_read_array(&ctx->r, &count) || count != 2)
+		{
+			return provision_fail(ctx, "a limit is [per_minute, burst]");
+		}
+		if (!provision_read_uint(ctx, UINT16_MAX, &per_minute, "per_minute must be 0..65535")
+				|| !provision_read_uint(ctx, UINT16_MAX, &burst, "burst must be 0..65535"))
+		{
+			return false;
+		}
+		limits[route].per_minute = per_minute;
+		limits[route].burst = burst;
+	}
+
+	return true;
+}
+
+esp_err_t provision_export(const nvs_config_t *cfg, uint8_t *buf, size_t size, size_t *len)
+{
+	cbor_writer_t w;
+	bool auth = cfg->auth.iterations != 0;
+
+	cbor_writer_init(&w, buf, size);
+	cbor_put_map(&w, auth ? 5 : 4);
+
+	cbor_put_text(&w, "version");
+	cbor_put_uint(&w, PROVISION_DOC_VERSION);
+
+	cbor_put_text(&w, "network");
+	cbor_put_map(&w, 2);
+	cbor_put_text(&w, "ssid");
+	cbor_put_text(&w, cfg->network.ssid);
+	cbor_put_text(&w, "password");
+	cbor_put_text(&w, cfg->network.password);
+
+	cbor_put_text(&w, "static_ip");
+	if (cfg->static_ip.enabled)
+	{
+		cbor_put_map(&w, 4);
+		cbor_put_text(&w, "ip");
+		cbor_put_bytes(&w, &cfg->static_ip.ip, PROVISION_IP_LEN);
+		cbor_put_text(&w, "netmask");
+		cbor_put_bytes(&w, &cfg->static_ip.netmask, PROVISION_IP_LEN);
+		cbor_put_text(&w, "gw");
+		cbor_put_bytes(&w, &cfg->static_ip.gw, PROVISION_IP_LEN);
+		cbor_put_text(&w, "dns");
+		cbor_put_bytes(&w, &cfg->static_ip.dns, PROVISION_IP_LEN);
+	}
+	else
+	{
+		cbor_put_null(&w);
+	}
+
+	if (auth)
+	{
+		cbor_put_text(&w, "auth");
+		cbor_put_map(&w, 4);
+		cbor_put_text(&w, "user");
+		cbor_put_text(&w, cfg->auth.user);
+		cbor_put_text(&w, "iterations");
+		cbor_put_uint(&w, cfg->auth.iterations);
+		cbor_put_text(&w, "salt");
+		cbor_put_bytes(&w, cfg->auth.salt, sizeof(cfg->auth.salt));
+		cbor_put_text(&w, "hash");
+		cbor_put_bytes(&w, cfg->auth.hash, sizeof(cfg->auth.hash));
+	}
+
+	cbor_put_text(&w, "limits");
+	cbor_put_map(&w, HTTP_ADMIT_ROUTE_COUNT);
+	for (int i = 0; i < HTTP_ADMIT_ROUTE_COUNT; i++)
+	{
+		cbor_put_text(&w, http_admit_route_name(i));
+		cbor_put_array(&w, 2);
+		cbor_put_uint(&w, cfg->rate_limits[i].per_minute);
+		cbor_put_uint(&w, cfg->rate_limits[i].burst);
+	}
+
+	if (w.overflow)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+	*len = w.len;
+	return ESP_OK;
+}
+
+esp_err_t provision_import(const uint8_t *buf, size_t len, nvs_config_t *cfg, const char **error)
+{
+	provision_ctx_t ctx = { .error = NULL };
+	nvs_config_t parsed = *cfg;
+	uint32_t pairs;
+	uint32_t version = 0;
+	const char *key;
+	size_t key_len;
+	bool ok;
+
+	cbor_reader_init(&ctx.r, buf, len);
+
+	ok = cbor_read_map(&ctx.r, &pairs) || provision_fail(&ctx, "document must be a map");
+	for (uint32_t i = 0; i < pairs && ok; i++)
+	{
+		if (!provision_key(&ctx, &key, &key_len))
+		{
+			ok = false;
+		}
+		else if (provision_key_is(key, key_len, "version"))
+		{
+			ok = provision_read_uint(&ctx, UINT32_MAX, &version, "version must be an unsigned integer");
+		}
+		else if (provision_key_is(key, key_len, "network"))
+		{
+			ok = provision_read_network(&ctx, &parsed.network);
+		}
+		else if (provision_key_is(key, key_len, "static_ip"))
+		{
+			ok = provision_read_static_ip(&ctx, &parsed.static_ip);
+		}
+		else if (provision_key_is(key, key_len, "auth"))
+		{
+			ok = provision_read_auth(&ctx, &parsed.auth);
+		}
+		else if (provision_key_is(key, key_len, "limits"))
+		{
+			ok = provision_read_limits(&ctx, parsed.rate_limits);
+		}
+		else
+		{
+			ok = cbor_skip(&ctx.r) || provision_fail(&ctx, "malformed document");
+		}
+	}
+
+	if (ok && !cbor_reader_done(&ctx.r))
+	{
+		ok = provision_fail(&ctx, "data after the document");
+	}
+	if (ok && version != PROVISION_DOC_VERSION)
+	{
+		ok = provision_fail(&ctx, "version must be 1");
+	}
+	if (!ok)
+	{
+		*error = ctx.error != NULL ? ctx.error : "malformed document";
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	// A different network invalidates the cached AP used for the fast reconnect
+	if (strcmp(parsed.network.ssid, cfg->network.ssid) != 0)
+	{
+		memset(&parsed.sta_cache, 0, sizeof(parsed.sta_cache));
+	}
+
+	*cfg = parsed;
+	return ESP_OK;
+}
@@ -0,0 +1,51 @@
+/*
+ * provision.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_PROVISION_H_
+#define MAIN_PROVISION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "nvs_utils.h"
+
+/*
+ * The whole device configuration as one CBOR document, for GET/PUT /api/config.
+ * One request provisions a unit: network, static IP, API login and rate limits.
+ *
+ * { "version": 1,
+ *   "network":   { "ssid": text, "password": text },
+ *   "static_ip": null (DHCP) | { "ip": bytes(4), "netmask": bytes(4), "gw": bytes(4), "dns": bytes(4) },
+ *   "auth":      { "user": text, "iterations": uint, "salt": bytes(16), "hash": bytes(32) },
+ *   "limits":    { "read": [per_minute, burst], "control": [..], "login": [..], "heavy": [..] } }
+ *
+ * Addresses are in network order. "auth" carries the PBKDF2 hash, never a password, and is left
+ * out while no login is set. Its iterations must be within AUTH_PBKDF2_ITERATIONS_MIN..MAX
+ * (auth.h). On import, a key that is present replaces that setting and everything left out keeps
+ * its value, so a document can be as small as one section. Unknown keys are skipped.
+ */
+
+#define PROVISION_DOC_VERSION		1
+#define PROVISION_DOC_MAX_SIZE		512
+
+/**
+ * Encodes a configuration.
+ * @param len set to the document size.
+ * @return ESP_ERR_NO_MEM if buf is too small.
+ */
+esp_err_t provision_export(const nvs_config_t *cfg, uint8_t *buf, size_t size, size_t *len);
+
+/**
+ * Decodes and checks a document onto a configuration, in one pass over the buffer.
+ * @param cfg holds the current configuration, changed only if the whole document is valid.
+ * @param error set to the reason if the document is rejected.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG for a malformed document or an invalid value.
+ */
+esp_err_t provision_import(const uint8_t *buf, size_t len, nvs_config_t *cfg, const char **error);
+
+#endif /* MAIN_PROVISION_H_ */
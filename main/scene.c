@@ -0,0 +1,368 @@
+/*
+ * scene.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+
+#include "io.h"
+#include "io_cmd.h"
+#include "scene.h"
+#include "static_alloc.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "scene";
+
+#define SCENE_NVS_NAMESPACE			"scene"
+
+#define SCENE_LED_ALL				((uint8_t)(BIT(LED_COUNT) - 1))
+
+/**
+ * A stored program and its interpreter.
+ */
+typedef struct scene_slot
+{
+	uint8_t blob[SCENE_VM_BLOB_MAX];
+	uint16_t size;					// 0 = empty slot
+	bool fresh;						// Started since the last tick, its first step gets no elapsed time
+	scene_vm_t vm;
+} scene_slot_t;
+
+static scene_slot_t g_slots[SCENE_SLOTS];
+static scene_stats_t g_stats;
+
+// Taken by the scene task for a tick and by the API for a slot change, never across NVS access
+static SemaphoreHandle_t g_mutex = NULL;
+static StaticSemaphore_t g_mutex_buffer;
+static TaskHandle_t g_task_handle = NULL;
+
+static portMUX_TYPE g_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void scene_nvs_key(int slot, char *key, size_t size)
+{
+	snprintf(key, size, "slot%d", slot);
+}
+
+static bool scene_slot_valid(int slot)
+{
+	return slot >= 0 && slot < SCENE_SLOTS;
+}
+
+static bool scene_any_running(void)
+{
+	bool running = false;
+
+	xSemaphoreTake(g_mutex, portMAX_DELAY);
+	for (int i = 0; i < SCENE_SLOTS; i++)
+	{
+		running |= g_slots[i].vm.state == SCENE_VM_STATE_RUNNING;
+	}
+	xSemaphoreGive(g_mutex);
+
+	return running;
+}
+
+/**
+ * Runs one tick of every running program. Must be called with g_mutex held.
+ * @param leds LED state before the tick, changed by the programs.
+ */
+static void scene_tick_locked(uint32_t elapsed_ms, uint8_t inputs, uint8_t *leds)
+{
+	for (int i = 0; i < SCENE_SLOTS; i++)
+	{
+		scene_slot_t *s = &g_slots[i];
+
+		if (s->vm.state != SCENE_VM_STATE_RUNNING)
+		{
+			continue;
+		}
+
+		scene_vm_step(&s->vm, s->fresh ? 0 : elapsed_ms, inputs, leds, CONFIG_SCENE_STEP_BUDGET);
+		s->fresh = false;
+
+		if (s->vm.state == SCENE_VM_STATE_FAULT)
+		{
+			ESP_LOGW(TAG, "Slot %d stopped at %u: %s", i, s->vm.pc, scene_vm_fault_name((scene_vm_fault_e)s->vm.fault));
+		}
+	}
+}
+
+/**
+ * Scene task: a tick every CONFIG_SCENE_TICK_MS (rounded to the FreeRTOS tick) while a
+ * program runs, asleep otherwise.
+ */
+static void scene_task(void *pvParameters)
+{
+	const TickType_t period = MAX(pdMS_TO_TICKS(CONFIG_SCENE_TICK_MS), 1);
+	TickType_t wake = xTaskGetTickCount();
+	TickType_t last = wake;
+
+	for (;;)
+	{
+		io_cmd_result_t state;
+		uint8_t leds;
+		uint8_t changed;
+		uint8_t inputs = io_button_is_pressed() ? SCENE_VM_INPUT_BUTTON : 0;
+		TickType_t now = xTaskGetTickCount();
+
+		// Commands from HTTP, UDP and MQTT are seen by the programs
+		io_cmd_get_state(&state);
+		leds = state.mask;
+
+		xSemaphoreTake(g_mutex, portMAX_DELAY);
+		scene_tick_locked((now - last) * portTICK_PERIOD_MS, inputs, &leds);
+		xSemaphoreGive(g_mutex);
+		last = now;
+
+		changed = (leds ^ state.mask) & SCENE_LED_ALL;
+		if (changed)
+		{
+			// Waits for the write, the next tick starts from the state it left
+			esp_err_t err = io_cmd_write(IO_CMD_SOURCE_SCENE, changed, leds, &state);
+
+			taskENTER_CRITICAL(&g_stats_lock);
+			if (err == ESP_OK)
+			{
+				g_stats.writes++;
+			}
+			else
+			{
+				g_stats.writes_dropped++;
+			}
+			taskEXIT_CRITICAL(&g_stats_lock);
+		}
+
+		if (!scene_any_running())
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+			wake = last = xTaskGetTickCount();
+			continue;
+		}
+
+		taskENTER_CRITICAL(&g_stats_lock);
+		g_stats.ticks++;
+		taskEXIT_CRITICAL(&g_stats_lock);
+
+		xTaskDelayUntil(&wake, period);
+	}
+}
+
+void scene_init(void)
+{
+	nvs_handle_t handle;
+	char key[8];
+	int loaded = 0;
+
+	if (g_task_handle != NULL)
+	{
+		return;
+	}
+
+	g_mutex = xSemaphoreCreateMutexStatic(&g_mutex_buffer);
+
+	if (nvs_open(SCENE_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK)
+	{
+		for (int i = 0; i < SCENE_SLOTS; i++)
+		{
+			scene_slot_t *s = &g_slots[i];
+			size_t size = sizeof(s->blob);
+			uint16_t fault_pc;
+
+			scene_nvs_key(i, key, sizeof(key));
+			if (nvs_get_blob(handle, key, s->blob, &size) != ESP_OK)
+			{
+				continue;
+			}
+			// Written by a firmware with another instruction set
+			if (scene_vm_verify(s->blob, size, &fault_pc) != SCENE_VM_FAULT_NONE)
+			{
+				ESP_LOGW(TAG, "Slot %d holds no valid program, ignored", i);
+				continue;
+			}
+
+			s->size = (uint16_t)size;
+			loaded++;
+			if (scene_vm_flags(s->blob) & SCENE_VM_FLAG_AUTOSTART)
+			{
+				scene_vm_start(&s->vm, s->blob, s->size);
+				s->fresh = true;
+			}
+		}
+		nvs_close(handle);
+	}
+
+	g_task_handle = static_alloc_task_create(STATIC_TASK_SCENE, &scene_task, NULL);
+
+	ESP_LOGI(TAG, "%d program(s) loaded, tick %d ms, budget %d", loaded, CONFIG_SCENE_TICK_MS, CONFIG_SCENE_STEP_BUDGET);
+}
+
+esp_err_t scene_store(int slot, const uint8_t *blob, size_t size, scene_vm_fault_e *fault, uint16_t *fault_pc)
+{
+	nvs_handle_t handle;
+	char key[8];
+
+	*fault = SCENE_VM_FAULT_NONE;
+	*fault_pc = 0;
+	if (!scene_slot_valid(slot) || g_mutex == NULL)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	*fault = scene_vm_verify(blob, size, fault_pc);
+	if (*fault != SCENE_VM_FAULT_NONE)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	scene_nvs_key(slot, key, sizeof(key));
+	esp_err_t err = nvs_open(SCENE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+	if (err == ESP_OK)
+	{
+		err = nvs_set_blob(handle, key, blob, size);
+		if (err == ESP_OK)
+		{
+			err = nvs_commit(handle);
+		}
+		nvs_close(handle);
+	}
+	if (err != ESP_OK)
+	{
+		ESP_LOGE(TAG, "Slot %d not saved: %s", slot, esp_err_to_name(err));
+		return err;
+	}
+
+	xSemaphoreTake(g_mutex, portMAX_DELAY);
+	scene_vm_stop(&g_slots[slot].vm);
+	memcpy(g_slots[slot].blob, blob, size);
+	g_slots[slot].size = (uint16_t)size;
+	xSemaphoreGive(g_mutex);
+
+	ESP_LOGI(TAG, "Slot %d: %u byte program stored", slot, (unsigned)size);
+	return ESP_OK;
+}
+
+esp_err_t scene_erase(int slot)
+{
+	nvs_handle_t handle;
+	char key[8];
+
+	if (!scene_slot_valid(slot) || g_mutex == NULL)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (g_slots[slot].size == 0)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	xSemaphoreTake(g_mutex, portMAX_DELAY);
+	scene_vm_stop(&g_slots[slot].vm);
+	g_slots[slot].size = 0;
+	xSemaphoreGive(g_mutex);
+
+	scene_nvs_key(slot, key, sizeof(key));
+	esp_err_t err = nvs_open(SCENE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+	if (err == ESP_OK)
+	{
+		err = nvs_erase_key(handle, key);
+		if (err == ESP_OK)
+		{
+			err = nvs_commit(handle);
+		}
+		nvs_close(handle);
+	}
+
+	return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+}
+
+esp_err_t scene_run(int slot)
+{
+	esp_err_t err = ESP_OK;
+
+	if (!scene_slot_valid(slot) || g_mutex == NULL)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	xSemaphoreTake(g_mutex, portMAX_DELAY);
+	if (g_slots[slot].size == 0)
+	{
+		err = ESP_ERR_NOT_FOUND;
+	}
+	else
+	{
+		scene_vm_start(&g_slots[slot].vm, g_slots[slot].blob, g_slots[slot].size);
+		g_slots[slot].fresh = true;
+	}
+	xSemaphoreGive(g_mutex);
+
+	// Wakes the scene task if no program was running
+	if (err == ESP_OK && g_task_handle != NULL)
+	{
+		xTaskNotifyGive(g_task_handle);
+	}
+
+	return err;
+}
+
+esp_err_t scene_stop(int slot)
+{
+	esp_err_t err = ESP_OK;
+
+	if (!scene_slot_valid(slot) || g_mutex == NULL)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	xSemaphoreTake(g_mutex, portMAX_DELAY);
+	if (g_slots[slot].size == 0)
+	{
+		err = ESP_ERR_NOT_FOUND;
+	}
+	else
+	{
+		scene_vm_stop(&g_slots[slot].vm);
+	}
+	xSemaphoreGive(g_mutex);
+
+	return err;
+}
+
+void scene_get_status(int slot, scene_status_t *status)
+{
+	memset(status, 0, sizeof(*status));
+	if (!scene_slot_valid(slot) || g_mutex == NULL)
+	{
+		return;
+	}
+
+	xSemaphoreTake(g_mutex, portMAX_DELAY);
+	const scene_slot_t *s = &g_slots[slot];
+	status->stored = s->size != 0;
+	status->autostart = s->size != 0 && (scene_vm_flags(s->blob) & SCENE_VM_FLAG_AUTOSTART);
+	status->size = s->size;
+	status->state = s->vm.state;
+	status->fault = s->vm.fault;
+	status->pc = s->vm.pc;
+	status->instructions = s->vm.instructions;
+	status->budget_yields = s->vm.budget_yields;
+	xSemaphoreGive(g_mutex);
+}
+
+void scene_get_stats(scene_stats_t *stats)
+{
+	taskENTER_CRITICAL(&g_stats_lock);
+	*stats = g_stats;
+	taskEXIT_CRITICAL(&g_stats_lock);
+}
@@ -0,0 +1,92 @@
+/*
+ * scene.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_SCENE_H_
+#define MAIN_SCENE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "scene_vm.h"
+
+/*
+ * Lighting programs run on the device: a chase, a hold, a fade, without a host sending
+ * every step over WiFi. Up to SCENE_SLOTS programs (scene_vm.h) are stored in NVS and run
+ * cooperatively by one scene task every CONFIG_SCENE_TICK_MS. Each program runs at most
+ * CONFIG_SCENE_STEP_BUDGET instructions per tick, so a program without a WAIT cannot hold
+ * up the others. The programs of a tick change one copy of the LED state in slot order,
+ * the changes go to the IO command queue (io_cmd.h) as one write.
+ */
+
+#define SCENE_SLOTS					4
+
+/**
+ * State of one slot.
+ */
+typedef struct scene_status
+{
+	bool stored;							///> The slot holds a program
+	bool autostart;							///> Started at boot (SCENE_VM_FLAG_AUTOSTART)
+	uint16_t size;							///> Blob size, header included
+	uint8_t state;							///> scene_vm_state_e
+	uint8_t fault;							///> scene_vm_fault_e, in SCENE_VM_STATE_FAULT
+	uint16_t pc;
+	uint32_t instructions;					///> Executed since the last start
+	uint32_t budget_yields;					///> Ticks the program ran out of budget
+} scene_status_t;
+
+/**
+ * Scheduler statistics
+ */
+typedef struct scene_stats
+{
+	uint32_t ticks;							///> Ticks with a program running
+	uint32_t writes;						///> LED writes queued
+	uint32_t writes_dropped;				///> LED writes lost to a full IO command queue
+} scene_stats_t;
+
+/**
+ * Loads the stored programs, starts the scene task and the programs flagged autostart.
+ * Call after nvs_init_storage and io_cmd_start.
+ */
+void scene_init(void);
+
+/**
+ * Verifies a program and stores it in NVS. A program running in the slot is stopped.
+ * @param fault filled with the reason a program is refused, fault_pc with its code offset.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a bad slot or program, or the NVS error.
+ */
+esp_err_t scene_store(int slot, const uint8_t *blob, size_t size, scene_vm_fault_e *fault, uint16_t *fault_pc);
+
+/**
+ * Stops and removes the program of a slot.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND for an empty slot.
+ */
+esp_err_t scene_erase(int slot);
+
+/**
+ * Starts the program of a slot from the beginning, also if it is running.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND for an empty slot.
+ */
+esp_err_t scene_run(int slot);
+
+/**
+ * Stops the program of a slot, the LEDs keep their state.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND for an empty slot.
+ */
+esp_err_t scene_stop(int slot);
+
+void scene_get_status(int slot, scene_status_t *status);
+
+/**
+ * Gets a copy of the scheduler statistics.
+ */
+void scene_get_stats(scene_stats_t *stats);
+
+#endif /* MAIN_SCENE_H_ */
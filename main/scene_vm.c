@@ -0,0 +1,327 @@
+/*
+ * scene_vm.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "scene_vm.h"
+
+// Instruction length by opcode, operands included
+static const uint8_t g_op_length[SCENE_VM_OP_COUNT] = {
+		[SCENE_VM_OP_END] = 1,
+		[SCENE_VM_OP_SET] = 3,
+		[SCENE_VM_OP_TOGGLE] = 2,
+		[SCENE_VM_OP_WAIT] = 3,
+		[SCENE_VM_OP_FADE] = 5,
+		[SCENE_VM_OP_LOOP] = 2,
+		[SCENE_VM_OP_NEXT] = 1,
+		[SCENE_VM_OP_JUMP] = 3,
+		[SCENE_VM_OP_JIF] = 4,
+		[SCENE_VM_OP_JIFN] = 4,
+};
+
+static const char *const g_state_names[SCENE_VM_STATE_COUNT] = {
+		[SCENE_VM_STATE_IDLE] = "idle",
+		[SCENE_VM_STATE_RUNNING] = "running",
+		[SCENE_VM_STATE_DONE] = "done",
+		[SCENE_VM_STATE_FAULT] = "fault",
+};
+
+static const char *const g_fault_names[SCENE_VM_FAULT_COUNT] = {
+		[SCENE_VM_FAULT_NONE] = "none",
+		[SCENE_VM_FAULT_BAD_HEADER] = "bad_header",
+		[SCENE_VM_FAULT_TOO_LARGE] = "too_large",
+		[SCENE_VM_FAULT_BAD_OPCODE] = "bad_opcode",
+		[SCENE_VM_FAULT_TRUNCATED] = "truncated",
+		[SCENE_VM_FAULT_BAD_TARGET] = "bad_target",
+		[SCENE_VM_FAULT_BAD_COUNT] = "bad_count",
+		[SCENE_VM_FAULT_NO_END] = "no_end",
+		[SCENE_VM_FAULT_LOOP_DEPTH] = "loop_depth",
+		[SCENE_VM_FAULT_LOOP_EMPTY] = "loop_empty",
+};
+
+static uint16_t scene_vm_u16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * Jump target of a JUMP, JIF or JIFN at code[pc].
+ */
+static uint16_t scene_vm_target(const uint8_t *code, uint16_t pc)
+{
+	return scene_vm_u16(&code[pc + g_op_length[code[pc]] - 2]);
+}
+
+static bool scene_vm_is_jump(uint8_t op)
+{
+	return op == SCENE_VM_OP_JUMP || op == SCENE_VM_OP_JIF || op == SCENE_VM_OP_JIFN;
+}
+
+scene_vm_fault_e scene_vm_verify(const uint8_t *blob, size_t size, uint16_t *fault_pc)
+{
+	// One bit per code byte, set where an instruction starts
+	uint8_t starts[(SCENE_VM_CODE_MAX + 7) / 8] = { 0 };
+	const uint8_t *code = blob + SCENE_VM_HEADER_SIZE;
+	uint16_t length;
+	uint16_t pc = 0;
+	uint16_t last = 0;
+
+	*fault_pc = 0;
+
+	if (size > SCENE_VM_BLOB_MAX)
+	{
+		return SCENE_VM_FAULT_TOO_LARGE;
+	}
+	if (size <= SCENE_VM_HEADER_SIZE || blob[0] != SCENE_VM_MAGIC_0 || blob[1] != SCENE_VM_MAGIC_1
+			|| blob[2] != SCENE_VM_VERSION)
+	{
+		return SCENE_VM_FAULT_BAD_HEADER;
+	}
+	length = (uint16_t)(size - SCENE_VM_HEADER_SIZE);
+
+	// Decode: opcodes and operands
+	while (pc < length)
+	{
+		*fault_pc = pc;
+		if (code[pc] >= SCENE_VM_OP_COUNT)
+		{
+			return SCENE_VM_FAULT_BAD_OPCODE;
+		}
+		if (pc + g_op_length[code[pc]] > length)
+		{
+			return SCENE_VM_FAULT_TRUNCATED;
+		}
+		if (code[pc] == SCENE_VM_OP_LOOP && code[pc + 1] == 0)
+		{
+			return SCENE_VM_FAULT_BAD_COUNT;
+		}
+		starts[pc / 8] |= 1 << (pc % 8);
+		last = pc;
+		pc += g_op_length[code[pc]];
+	}
+
+	// Jumps land on an instruction
+	for (pc = 0; pc < length; pc += g_op_length[code[pc]])
+	{
+		if (scene_vm_is_jump(code[pc]))
+		{
+			uint16_t target = scene_vm_target(code, pc);
+
+			if (target >= length || !(starts[target / 8] & (1 << (target % 8))))
+			{
+				*fault_pc = pc;
+				return SCENE_VM_FAULT_BAD_TARGET;
+			}
+		}
+	}
+
+	// Every path ends in END or loops back, the program counter never leaves the code
+	if (code[last] != SCENE_VM_OP_END && code[last] != SCENE_VM_OP_JUMP)
+	{
+		*fault_pc = last;
+		return SCENE_VM_FAULT_NO_END;
+	}
+
+	*fault_pc = 0;
+	return SCENE_VM_FAULT_NONE;
+}
+
+uint8_t scene_vm_flags(const uint8_t *blob)
+{
+	return blob[3];
+}
+
+void scene_vm_start(scene_vm_t *vm, const uint8_t *blob, size_t size)
+{
+	memset(vm, 0, sizeof(*vm));
+	vm->code = blob + SCENE_VM_HEADER_SIZE;
+	vm->length = (uint16_t)(size - SCENE_VM_HEADER_SIZE);
+	vm->state = SCENE_VM_STATE_RUNNING;
+}
+
+void scene_vm_stop(scene_vm_t *vm)
+{
+	vm->state = SCENE_VM_STATE_IDLE;
+	vm->fade_mask = 0;
+}
+
+static void scene_vm_fault(scene_vm_t *vm, uint16_t pc, scene_vm_fault_e fault)
+{
+	vm->pc = pc;
+	vm->fault = fault;
+	vm->state = SCENE_VM_STATE_FAULT;
+	vm->fade_mask = 0;
+}
+
+/**
+ * Switches the LEDs of a running FADE that are due.
+ * @return true while the program still waits.
+ */
+static bool scene_vm_waiting(scene_vm_t *vm, uint8_t *leds)
+{
+	while (vm->wait_ms <= 0 && vm->fade_mask != 0)
+	{
+		// Lowest LED first
+		uint8_t bit = vm->fade_mask & (uint8_t)-vm->fade_mask;
+
+		*leds = (*leds & ~bit) | (vm->fade_value & bit);
+		vm->fade_mask &= ~bit;
+		if (vm->fade_mask != 0)
+		{
+			vm->wait_ms += vm->fade_step_ms;
+		}
+	}
+
+	return vm->wait_ms > 0;
+}
+
+void scene_vm_step(scene_vm_t *vm, uint32_t elapsed_ms, uint8_t inputs, uint8_t *leds, int budget)
+{
+	if (vm->state != SCENE_VM_STATE_RUNNING)
+	{
+		return;
+	}
+
+	// Only a wait runs late, a program that ran out of budget keeps what it had
+	if (vm->wait_ms > 0)
+	{
+		vm->wait_ms -= (int32_t)(elapsed_ms < SCENE_VM_CATCHUP_MS ? elapsed_ms : SCENE_VM_CATCHUP_MS);
+	}
+	if (vm->wait_ms < -SCENE_VM_CATCHUP_MS)
+	{
+		vm->wait_ms = -SCENE_VM_CATCHUP_MS;
+	}
+	if (scene_vm_waiting(vm, leds))
+	{
+		return;
+	}
+
+	for (int executed = 0; executed < budget; executed++)
+	{
+		const uint8_t *ins = &vm->code[vm->pc];
+		uint16_t pc = vm->pc;
+		uint8_t in = (*leds & SCENE_VM_INPUT_LEDS) | (inputs & ~SCENE_VM_INPUT_LEDS);
+
+		// Verified code never gets here
+		if (pc >= vm->length || ins[0] >= SCENE_VM_OP_COUNT)
+		{
+			scene_vm_fault(vm, pc, SCENE_VM_FAULT_BAD_OPCODE);
+			return;
+		}
+
+		vm->pc += g_op_length[ins[0]];
+		vm->instructions++;
+
+		switch (ins[0])
+		{
+			case SCENE_VM_OP_END:
+				vm->pc = pc;
+				vm->state = SCENE_VM_STATE_DONE;
+				return;
+
+			case SCENE_VM_OP_SET:
+				*leds = (*leds & ~ins[1]) | (ins[2] & ins[1]);
+				break;
+
+			case SCENE_VM_OP_TOGGLE:
+				*leds ^= ins[1];
+				break;
+
+			case SCENE_VM_OP_WAIT:
+				vm->wait_ms += scene_vm_u16(&ins[1]);
+				if (scene_vm_waiting(vm, leds))
+				{
+					return;
+				}
+				break;
+
+			case SCENE_VM_OP_FADE:
+			{
+				uint16_t ms = scene_vm_u16(&ins[3]);
+				uint8_t pending = ins[1] & (*leds ^ ins[2]) & SCENE_VM_INPUT_LEDS;
+				int count = __builtin_popcount(pending);
+
+				if (count == 0)
+				{
+					// Nothing to switch, the FADE still takes its time
+					vm->wait_ms += ms;
+				}
+				else
+				{
+					// The first interval takes the remainder, the last LED switches at ms
+					vm->fade_step_ms = ms / count;
+					vm->wait_ms += ms - vm->fade_step_ms * (count - 1);
+					vm->fade_mask = pending;
+					vm->fade_value = ins[2];
+				}
+				if (scene_vm_waiting(vm, leds))
+				{
+					return;
+				}
+				break;
+			}
+
+			case SCENE_VM_OP_LOOP:
+				if (vm->loop_depth == SCENE_VM_LOOP_DEPTH)
+				{
+					scene_vm_fault(vm, pc, SCENE_VM_FAULT_LOOP_DEPTH);
+					return;
+				}
+				vm->loops[vm->loop_depth].start = vm->pc;
+				vm->loops[vm->loop_depth].left = ins[1];
+				vm->loop_depth++;
+				break;
+
+			case SCENE_VM_OP_NEXT:
+				if (vm->loop_depth == 0)
+				{
+					scene_vm_fault(vm, pc, SCENE_VM_FAULT_LOOP_EMPTY);
+					return;
+				}
+				if (--vm->loops[vm->loop_depth - 1].left > 0)
+				{
+					vm->pc = vm->loops[vm->loop_depth - 1].start;
+				}
+				else
+				{
+					vm->loop_depth--;
+				}
+				break;
+
+			case SCENE_VM_OP_JUMP:
+				vm->pc = scene_vm_target(vm->code, pc);
+				break;
+
+			case SCENE_VM_OP_JIF:
+				if (in & ins[1])
+				{
+					vm->pc = scene_vm_target(vm->code, pc);
+				}
+				break;
+
+			case SCENE_VM_OP_JIFN:
+				if (!(in & ins[1]))
+				{
+					vm->pc = scene_vm_target(vm->code, pc);
+				}
+				break;
+		}
+	}
+
+	// Out of budget without yielding, the program continues in the next step
+	vm->budget_yields++;
+}
+
+const char* scene_vm_state_name(scene_vm_state_e state)
+{
+	return state < SCENE_VM_STATE_COUNT ? g_state_names[state] : "unknown";
+}
+
+const char* scene_vm_fault_name(scene_vm_fault_e fault)
+{
+	return fault < SCENE_VM_FAULT_COUNT ? g_fault_names[fault] : "unknown";
+}
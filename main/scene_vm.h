@@ -0,0 +1,159 @@
+/*
+ * scene_vm.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_SCENE_VM_H_
+#define MAIN_SCENE_VM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Interpreter of the lighting programs (scene.h). A program is a blob of a 4 byte header
+ * and the code:
+ *
+ *   'S' 'C' version flags code...
+ *
+ * The code is a sequence of instructions, an opcode byte and its operands, 16 bit operands
+ * little-endian. Jump targets are offsets in the code.
+ *
+ *   0x00 END                          program done, the LEDs keep their state
+ *   0x01 SET    mask value            LEDs in mask take the matching bits of value
+ *   0x02 TOGGLE mask                  LEDs in mask are toggled
+ *   0x03 WAIT   ms:u16                yields for ms
+ *   0x04 FADE   mask value ms:u16     LEDs in mask move to value one after the other, evenly
+ *                                     spread over ms (the LEDs are switched, not dimmed)
+ *   0x05 LOOP   count                 runs the code up to the matching NEXT count times (1..255)
+ *   0x06 NEXT
+ *   0x07 JUMP   target:u16
+ *   0x08 JIF    mask target:u16       jumps if any input in mask is set
+ *   0x09 JIFN   mask target:u16       jumps if no input in mask is set
+ *
+ * Inputs: bits 0..3 are the LEDs as the program sees them, bit 7 is the button (held).
+ *
+ * Nothing in here touches FreeRTOS or the drivers: the caller passes the elapsed time, the
+ * inputs and the LED state, so the interpreter runs the same on the linux target.
+ * tools/scene_asm.py assembles and disassembles programs.
+ */
+
+#define SCENE_VM_MAGIC_0			'S'
+#define SCENE_VM_MAGIC_1			'C'
+#define SCENE_VM_VERSION			1
+
+#define SCENE_VM_HEADER_SIZE		4
+#define SCENE_VM_BLOB_MAX			256		///> Header and code, stored as one NVS blob
+#define SCENE_VM_CODE_MAX			(SCENE_VM_BLOB_MAX - SCENE_VM_HEADER_SIZE)
+
+#define SCENE_VM_FLAG_AUTOSTART		0x01	///> Started at boot
+
+#define SCENE_VM_LOOP_DEPTH			4		///> Nested LOOPs at most
+#define SCENE_VM_CATCHUP_MS			1000	///> A program later than this drops the backlog instead of replaying it
+
+#define SCENE_VM_INPUT_LEDS			0x0F
+#define SCENE_VM_INPUT_BUTTON		0x80
+
+typedef enum scene_vm_op
+{
+	SCENE_VM_OP_END = 0x00,
+	SCENE_VM_OP_SET,
+	SCENE_VM_OP_TOGGLE,
+	SCENE_VM_OP_WAIT,
+	SCENE_VM_OP_FADE,
+	SCENE_VM_OP_LOOP,
+	SCENE_VM_OP_NEXT,
+	SCENE_VM_OP_JUMP,
+	SCENE_VM_OP_JIF,
+	SCENE_VM_OP_JIFN,
+	SCENE_VM_OP_COUNT
+} scene_vm_op_e;
+
+typedef enum scene_vm_state
+{
+	SCENE_VM_STATE_IDLE = 0,				///> Not started or stopped
+	SCENE_VM_STATE_RUNNING,
+	SCENE_VM_STATE_DONE,					///> Reached END
+	SCENE_VM_STATE_FAULT,					///> Stopped at a fault, see scene_vm_t.fault
+	SCENE_VM_STATE_COUNT
+} scene_vm_state_e;
+
+typedef enum scene_vm_fault
+{
+	SCENE_VM_FAULT_NONE = 0,
+	SCENE_VM_FAULT_BAD_HEADER,				///> Magic or version mismatch, or no code
+	SCENE_VM_FAULT_TOO_LARGE,				///> Blob over SCENE_VM_BLOB_MAX
+	SCENE_VM_FAULT_BAD_OPCODE,
+	SCENE_VM_FAULT_TRUNCATED,				///> Operands run past the end of the code
+	SCENE_VM_FAULT_BAD_TARGET,				///> Jump into the middle of an instruction or out of the code
+	SCENE_VM_FAULT_BAD_COUNT,				///> LOOP 0
+	SCENE_VM_FAULT_NO_END,					///> The last instruction is no END or JUMP, the code could run off
+	SCENE_VM_FAULT_LOOP_DEPTH,				///> Run time: LOOP nested deeper than SCENE_VM_LOOP_DEPTH
+	SCENE_VM_FAULT_LOOP_EMPTY,				///> Run time: NEXT without LOOP
+	SCENE_VM_FAULT_COUNT
+} scene_vm_fault_e;
+
+/**
+ * Interpreter state of one program.
+ */
+typedef struct scene_vm_loop
+{
+	uint16_t start;							///> Offset after the LOOP
+	uint8_t left;							///> Runs left, the current one included
+} scene_vm_loop_t;
+
+typedef struct scene_vm
+{
+	const uint8_t *code;
+	uint16_t length;
+	uint16_t pc;							///> Next instruction, the faulting one in SCENE_VM_STATE_FAULT
+	int32_t wait_ms;						///> Time left to wait, <= 0 is time overdue, taken off the next wait
+	uint8_t state;							///> scene_vm_state_e
+	uint8_t fault;							///> scene_vm_fault_e
+	uint8_t fade_mask;						///> LEDs the running FADE still has to switch
+	uint8_t fade_value;
+	uint16_t fade_step_ms;
+	uint8_t loop_depth;
+	scene_vm_loop_t loops[SCENE_VM_LOOP_DEPTH];
+	uint32_t instructions;					///> Executed since the start
+	uint32_t budget_yields;					///> Steps that ran out of budget before the program yielded
+} scene_vm_t;
+
+/**
+ * Checks a blob before it is stored or run: header, opcodes, operands and jump targets.
+ * @param fault_pc set to the code offset of the faulty instruction, 0 for a header fault.
+ * @return SCENE_VM_FAULT_NONE if the program can be run.
+ */
+scene_vm_fault_e scene_vm_verify(const uint8_t *blob, size_t size, uint16_t *fault_pc);
+
+/**
+ * @return the header flags (SCENE_VM_FLAG_*) of a verified blob.
+ */
+uint8_t scene_vm_flags(const uint8_t *blob);
+
+/**
+ * Starts a verified blob from its first instruction. The blob must stay in place while it runs.
+ */
+void scene_vm_start(scene_vm_t *vm, const uint8_t *blob, size_t size);
+
+/**
+ * Stops the program, its state becomes SCENE_VM_STATE_IDLE.
+ */
+void scene_vm_stop(scene_vm_t *vm);
+
+/**
+ * Runs the program until it waits, ends or has executed budget instructions.
+ * @param elapsed_ms time since the previous step.
+ * @param inputs SCENE_VM_INPUT_BUTTON, the LED bits are taken from leds.
+ * @param leds LED state as the program sees it, changed by SET, TOGGLE and FADE.
+ * @param budget instructions at most, a program that has not yielded by then continues
+ * in the next step.
+ */
+void scene_vm_step(scene_vm_t *vm, uint32_t elapsed_ms, uint8_t inputs, uint8_t *leds, int budget);
+
+const char* scene_vm_state_name(scene_vm_state_e state);
+const char* scene_vm_fault_name(scene_vm_fault_e fault);
+
+#endif /* MAIN_SCENE_VM_H_ */
@@ -0,0 +1,274 @@
+/*
+ * static_alloc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+#include "http_server.h"
+#include "io_cmd.h"
+#include "static_alloc.h"
+#include "tasks_common.h"
+#include "wifi_app.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "static_alloc";
+
+// Disabled features reserve nothing
+#if CONFIG_UDP_CTRL_ENABLE
+#define UDP_CTRL_STACK_BYTES		UDP_CTRL_TASK_STACK_SIZE
+#else
+#define UDP_CTRL_STACK_BYTES		0
+#endif
+#if CONFIG_MQTT_APP_ENABLE
+#define MQTT_APP_STACK_BYTES		MQTT_APP_TASK_STACK_SIZE
+#else
+#define MQTT_APP_STACK_BYTES		0
+#endif
+
+// Event bus subscriber queues carry one-byte slot indices
+#define EVENT_QUEUE_ITEM_SIZE		sizeof(uint8_t)
+
+#define STATIC_ALLOC_STACK_BYTES	(WIFI_APP_TASK_STACK_SIZE + HTTP_SERVER_MONITOR_STACK_SIZE + UDP_CTRL_STACK_BYTES + MQTT_APP_STACK_BYTES \
+									+ IO_CMD_TASK_STACK_SIZE + SCENE_TASK_STACK_SIZE)
+#define STATIC_ALLOC_QUEUE_BYTES	((WIFI_APP_QUEUE_DEPTH + HTTP_SERVER_MONITOR_QUEUE_DEPTH) * EVENT_QUEUE_ITEM_SIZE \
+									+ IO_CMD_QUEUE_DEPTH * sizeof(io_cmd_t))
+#define STATIC_ALLOC_TOTAL_BYTES	(STATIC_ALLOC_STACK_BYTES + STATIC_TASK_COUNT * sizeof(StaticTask_t) \
+									+ STATIC_ALLOC_QUEUE_BYTES + STATIC_QUEUE_COUNT * sizeof(StaticQueue_t))
+
+_Static_assert(STATIC_ALLOC_TOTAL_BYTES <= CONFIG_STATIC_ALLOC_BUDGET_KB * 1024,
+		"Static task/queue memory exceeds CONFIG_STATIC_ALLOC_BUDGET_KB, see tasks_common.h");
+
+// Stacks (StackType_t is one byte on the ESP32, sizes are in bytes)
+static StackType_t s_wifi_app_stack[WIFI_APP_TASK_STACK_SIZE];
+static StackType_t s_http_server_monitor_stack[HTTP_SERVER_MONITOR_STACK_SIZE];
+static StackType_t s_io_cmd_stack[IO_CMD_TASK_STACK_SIZE];
+static StackType_t s_scene_stack[SCENE_TASK_STACK_SIZE];
+#if CONFIG_UDP_CTRL_ENABLE
+static StackType_t s_udp_ctrl_stack[UDP_CTRL_TASK_STACK_SIZE];
+#endif
+#if CONFIG_MQTT_APP_ENABLE
+static StackType_t s_mqtt_app_stack[MQTT_APP_TASK_STACK_SIZE];
+#endif
+
+// Queue storage
+static uint8_t s_wifi_app_queue_storage[WIFI_APP_QUEUE_DEPTH * EVENT_QUEUE_ITEM_SIZE];
+static uint8_t s_http_server_monitor_queue_storage[HTTP_SERVER_MONITOR_QUEUE_DEPTH * EVENT_QUEUE_ITEM_SIZE];
+static uint8_t s_io_cmd_queue_storage[IO_CMD_QUEUE_DEPTH * sizeof(io_cmd_t)];
+
+/**
+ * Static task descriptor.
+ */
+typedef struct static_task_def
+{
+	const char *name;
+	StackType_t *stack;			// NULL if the feature is disabled
+	uint32_t stack_size;
+	UBaseType_t priority;
+	BaseType_t core_id;
+	StaticTask_t tcb;
+	TaskHandle_t handle;
+} static_task_def_t;
+
+/**
+ * Static queue descriptor.
+ */
+typedef struct static_queue_def
+{
+	const char *name;
+	uint8_t *storage;
+	UBaseType_t depth;
+	UBaseType_t item_size;		// Largest item the storage holds
+	StaticQueue_t queue;
+	QueueHandle_t handle;
+} static_queue_def_t;
+
+static static_task_def_t s_tasks[STATIC_TASK_COUNT] = {
+		[STATIC_TASK_WIFI_APP] = {
+				.name = "wifi_app_task",
+				.stack = s_wifi_app_stack,
+				.stack_size = WIFI_APP_TASK_STACK_SIZE,
+				.priority = WIFI_APP_TASK_PRIORITY,
+				.core_id = WIFI_APP_TASK_CORE_ID,
+		},
+		[STATIC_TASK_HTTP_SERVER_MONITOR] = {
+				.name = "http_server_monitor",
+				.stack = s_http_server_monitor_stack,
+				.stack_size = HTTP_SERVER_MONITOR_STACK_SIZE,
+				.priority = HTTP_SERVER_MONITOR_PRIORITY,
+				.core_id = HTTP_SERVER_MONITOR_CORE_ID,
+		},
+		[STATIC_TASK_UDP_CTRL] = {
+				.name = "udp_ctrl_task",
+#if CONFIG_UDP_CTRL_ENABLE
+				.stack = s_udp_ctrl_stack,
+#endif
+				.stack_size = UDP_CTRL_STACK_BYTES,
+				.priority = UDP_CTRL_TASK_PRIORITY,
+				.core_id = UDP_CTRL_TASK_CORE_ID,
+		},
+		[STATIC_TASK_MQTT_APP] = {
+				.name = "mqtt_app_task",
+#if CONFIG_MQTT_APP_ENABLE
+				.stack = s_mqtt_app_stack,
+#endif
+				.stack_size = MQTT_APP_STACK_BYTES,
+				.priority = MQTT_APP_TASK_PRIORITY,
+				.core_id = MQTT_APP_TASK_CORE_ID,
+		},
+		[STATIC_TASK_IO_CMD] = {
+				.name = "io_cmd_task",
+				.stack = s_io_cmd_stack,
+				.stack_size = IO_CMD_TASK_STACK_SIZE,
+				.priority = IO_CMD_TASK_PRIORITY,
+				.core_id = IO_CMD_TASK_CORE_ID,
+		},
+		[STATIC_TASK_SCENE] = {
+				.name = "scene_task",
+				.stack = s_scene_stack,
+				.stack_size = SCENE_TASK_STACK_SIZE,
+				.priority = SCENE_TASK_PRIORITY,
+				.core_id = SCENE_TASK_CORE_ID,
+		},
+};
+
+static static_queue_def_t s_queues[STATIC_QUEUE_COUNT] = {
+		[STATIC_QUEUE_WIFI_APP] = {
+				.name = "wifi_app",
+				.storage = s_wifi_app_queue_storage,
+				.depth = WIFI_APP_QUEUE_DEPTH,
+				.item_size = EVENT_QUEUE_ITEM_SIZE,
+		},
+		[STATIC_QUEUE_HTTP_SERVER_MONITOR] = {
+				.name = "http_server_monitor",
+				.storage = s_http_server_monitor_queue_storage,
+				.depth = HTTP_SERVER_MONITOR_QUEUE_DEPTH,
+				.item_size = EVENT_QUEUE_ITEM_SIZE,
+		},
+		[STATIC_QUEUE_IO_CMD] = {
+				.name = "io_cmd",
+				.storage = s_io_cmd_queue_storage,
+				.depth = IO_CMD_QUEUE_DEPTH,
+				.item_size = sizeof(io_cmd_t),
+		},
+};
+
+/**
+ * Tasks created by IDF components from the heap, reported for completeness.
+ */
+typedef struct heap_task_def
+{
+	const char *name;
+	uint32_t stack_size;
+} heap_task_def_t;
+
+static const heap_task_def_t s_heap_tasks[] = {
+		{ "httpd", HTTP_SERVER_TASK_STACK_SIZE },
+#if CONFIG_MQTT_APP_ENABLE
+		{ "mqtt_task", MQTT_CLIENT_TASK_STACK_SIZE },
+#endif
+};
+
+#define HEAP_TASK_COUNT		(sizeof(s_heap_tasks) / sizeof(s_heap_tasks[0]))
+
+TaskHandle_t static_alloc_task_create(static_task_e id, TaskFunction_t fn, void *arg)
+{
+	if (id >= STATIC_TASK_COUNT || s_tasks[id].stack == NULL || s_tasks[id].handle != NULL)
+	{
+		return NULL;
+	}
+
+	static_task_def_t *t = &s_tasks[id];
+	t->handle = xTaskCreateStaticPinnedToCore(fn, t->name, t->stack_size, arg, t->priority, t->stack, &t->tcb, t->core_id);
+
+	return t->handle;
+}
+
+QueueHandle_t static_alloc_queue_create(static_queue_e id, UBaseType_t item_size)
+{
+	if (id >= STATIC_QUEUE_COUNT || item_size > s_queues[id].item_size || s_queues[id].handle != NULL)
+	{
+		return NULL;
+	}
+
+	static_queue_def_t *q = &s_queues[id];
+	q->handle = xQueueCreateStatic(q->depth, item_size, q->storage, &q->queue);
+
+	return q->handle;
+}
+
+int static_alloc_task_count(void)
+{
+	return STATIC_TASK_COUNT + HEAP_TASK_COUNT;
+}
+
+void static_alloc_get_task_info(int index, static_alloc_task_info_t *info)
+{
+	TaskHandle_t handle;
+
+	if (index < STATIC_TASK_COUNT)
+	{
+		info->name = s_tasks[index].name;
+		info->stack_size = s_tasks[index].stack_size;
+		info->is_static = true;
+		handle = s_tasks[index].handle;
+	}
+	else if (index < static_alloc_task_count())
+	{
+		info->name = s_heap_tasks[index - STATIC_TASK_COUNT].name;
+		info->stack_size = s_heap_tasks[index - STATIC_TASK_COUNT].stack_size;
+		info->is_static = false;
+		handle = xTaskGetHandle(info->name);
+	}
+	else
+	{
+		return;
+	}
+
+	info->running = handle != NULL;
+	info->high_water = handle != NULL ? uxTaskGetStackHighWaterMark(handle) : 0;
+}
+
+void static_alloc_get_queue_info(static_queue_e id, static_alloc_queue_info_t *info)
+{
+	if (id >= STATIC_QUEUE_COUNT)
+	{
+		return;
+	}
+
+	info->name = s_queues[id].name;
+	info->depth = s_queues[id].depth;
+	info->item_size = s_queues[id].item_size;
+	info->waiting = s_queues[id].handle != NULL ? uxQueueMessagesWaiting(s_queues[id].handle) : 0;
+}
+
+size_t static_alloc_total_bytes(void)
+{
+	return STATIC_ALLOC_TOTAL_BYTES;
+}
+
+void static_alloc_log_report(void)
+{
+	static_alloc_task_info_t info;
+
+	ESP_LOGI(TAG, "%-20s %6s %6s %s", "task", "stack", "free", "alloc");
+	for (int i = 0; i < static_alloc_task_count(); i++)
+	{
+		static_alloc_get_task_info(i, &info);
+		if (info.running)
+		{
+			ESP_LOGI(TAG, "%-20s %6u %6u %s", info.name, (unsigned)info.stack_size, (unsigned)info.high_water, info.is_static ? "static" : "heap");
+		}
+	}
+
+	ESP_LOGI(TAG, "static: %u bytes (budget %u), heap free: %u, min free: %u, largest block: %u",
+			(unsigned)STATIC_ALLOC_TOTAL_BYTES, (unsigned)CONFIG_STATIC_ALLOC_BUDGET_KB * 1024,
+			(unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+			(unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+			(unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
@@ -0,0 +1,114 @@
+/*
+ * static_alloc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_STATIC_ALLOC_H_
+#define MAIN_STATIC_ALLOC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+/*
+ * Stacks, TCBs and queue storage of every long-lived task and queue of the application,
+ * all declared in static_alloc.c. Sizes, priorities and cores come from tasks_common.h.
+ * The total is checked against CONFIG_STATIC_ALLOC_BUDGET_KB at compile time.
+ */
+
+/**
+ * Statically allocated tasks.
+ */
+typedef enum static_task
+{
+	STATIC_TASK_WIFI_APP = 0,
+	STATIC_TASK_HTTP_SERVER_MONITOR,
+	STATIC_TASK_UDP_CTRL,
+	STATIC_TASK_MQTT_APP,
+	STATIC_TASK_IO_CMD,
+	STATIC_TASK_SCENE,
+	STATIC_TASK_COUNT
+} static_task_e;
+
+/**
+ * Statically allocated queues (event bus subscriber queues and the IO command queue).
+ */
+typedef enum static_queue
+{
+	STATIC_QUEUE_WIFI_APP = 0,
+	STATIC_QUEUE_HTTP_SERVER_MONITOR,
+	STATIC_QUEUE_IO_CMD,
+	STATIC_QUEUE_COUNT
+} static_queue_e;
+
+/**
+ * One line of the memory report.
+ */
+typedef struct static_alloc_task_info
+{
+	const char *name;
+	uint32_t stack_size;		///> Bytes
+	uint32_t high_water;		///> Minimum free stack bytes so far, 0 if not running
+	bool running;
+	bool is_static;				///> false for tasks created by IDF components (heap)
+} static_alloc_task_info_t;
+
+typedef struct static_alloc_queue_info
+{
+	const char *name;
+	uint32_t depth;
+	uint32_t item_size;
+	uint32_t waiting;			///> Items in the queue now
+} static_alloc_queue_info_t;
+
+/**
+ * Creates one of the static tasks. A task can only be created once.
+ * @param id task from static_task_e.
+ * @param fn task function.
+ * @param arg task parameter.
+ * @return task handle, or NULL if the task already exists.
+ */
+TaskHandle_t static_alloc_task_create(static_task_e id, TaskFunction_t fn, void *arg);
+
+/**
+ * Creates one of the static queues. A queue can only be created once.
+ * @param id queue from static_queue_e.
+ * @param item_size size of one item, must not exceed the size reserved in static_alloc.c.
+ * @return queue handle, or NULL if the queue already exists or item_size does not fit.
+ */
+QueueHandle_t static_alloc_queue_create(static_queue_e id, UBaseType_t item_size);
+
+/**
+ * @return number of entries of the task report: the static tasks followed by the
+ * heap-allocated tasks of IDF components (httpd, esp-mqtt).
+ */
+int static_alloc_task_count(void);
+
+/**
+ * Fills one entry of the task report.
+ * @param index 0 .. static_alloc_task_count() - 1
+ */
+void static_alloc_get_task_info(int index, static_alloc_task_info_t *info);
+
+/**
+ * Fills the report entry of a static queue.
+ */
+void static_alloc_get_queue_info(static_queue_e id, static_alloc_queue_info_t *info);
+
+/**
+ * @return bytes of stacks, TCBs and queue storage reserved statically.
+ */
+size_t static_alloc_total_bytes(void);
+
+/**
+ * Logs the memory report: stacks against their high-water marks, static and heap totals.
+ */
+void static_alloc_log_report(void);
+
+#endif /* MAIN_STATIC_ALLOC_H_ */
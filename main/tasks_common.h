@@ -8,21 +8,85 @@
 #ifndef MAIN_TASKS_COMMON_H_
 #define MAIN_TASKS_COMMON_H_
 
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+// Affinity profile (menuconfig -> Smart Home Configuration). The WiFi driver runs on core 0.
+// TASK_NET_CORE_ID: tasks that mostly move network traffic (httpd, UDP control)
+// TASK_APP_CORE_ID: application logic, workers and logging
+#if CONFIG_TASK_AFFINITY_SPLIT
+#define TASK_AFFINITY_PROFILE_NAME			"split"
+#define TASK_NET_CORE_ID					0
+#define TASK_APP_CORE_ID					1
+#elif CONFIG_TASK_AFFINITY_FLOAT
+#define TASK_AFFINITY_PROFILE_NAME			"float"
+#define TASK_NET_CORE_ID					tskNO_AFFINITY
+#define TASK_APP_CORE_ID					tskNO_AFFINITY
+#else
+#define TASK_AFFINITY_PROFILE_NAME			"core1"
+#define TASK_NET_CORE_ID					1
+#define TASK_APP_CORE_ID					1
+#endif
+
+// Priority profile: by default the WiFi application task preempts the servers,
+// network-first puts request handling above it
+#if CONFIG_TASK_PRIORITY_NETWORK_FIRST
+#define TASK_PRIORITY_PROFILE_NAME			"network_first"
+#define TASK_NET_PRIORITY					6
+#else
+#define TASK_PRIORITY_PROFILE_NAME			"default"
+#define TASK_NET_PRIORITY					4
+#endif
+
+// Stack sizes are in bytes. The host (linux target) build runs tasks as POSIX threads,
+// which need PTHREAD_STACK_MIN (16 KB) on top of what the code uses
+#if CONFIG_IDF_TARGET_LINUX
+#define TASK_STACK_SIZE(bytes)				((bytes) + 16384)
+#else
+#define TASK_STACK_SIZE(bytes)				(bytes)
+#endif
 
 // WiFi application task
-#define WIFI_APP_TASK_STACK_SIZE			4096
+#define WIFI_APP_TASK_STACK_SIZE			TASK_STACK_SIZE(4096)
 #define WIFI_APP_TASK_PRIORITY				5
-#define WIFI_APP_TASK_CORE_ID				1
+#define WIFI_APP_TASK_CORE_ID				TASK_APP_CORE_ID
 
 // HTTP Server task
-#define HTTP_SERVER_TASK_STACK_SIZE			8192
-#define HTTP_SERVER_TASK_PRIORITY			4
-#define HTTP_SERVER_TASK_CORE_ID			1
+#define HTTP_SERVER_TASK_STACK_SIZE			TASK_STACK_SIZE(8192)
+#define HTTP_SERVER_TASK_PRIORITY			TASK_NET_PRIORITY
+#define HTTP_SERVER_TASK_CORE_ID			TASK_NET_CORE_ID
 
 // HTTP Server Monitor task
-#define HTTP_SERVER_MONITOR_STACK_SIZE		4096
+#define HTTP_SERVER_MONITOR_STACK_SIZE		TASK_STACK_SIZE(4096)
 #define HTTP_SERVER_MONITOR_PRIORITY		3
-#define HTTP_SERVER_MONITOR_CORE_ID			1
+#define HTTP_SERVER_MONITOR_CORE_ID			TASK_APP_CORE_ID
 
-#endif /* MAIN_TASKS_COMMON_H_ */
+// UDP control task
+#define UDP_CTRL_TASK_STACK_SIZE			TASK_STACK_SIZE(3072)
+#define UDP_CTRL_TASK_PRIORITY				(TASK_NET_PRIORITY + 1)
+#define UDP_CTRL_TASK_CORE_ID				TASK_NET_CORE_ID
+
+// IO command task, above the servers so a batch is written as soon as its window closes
+#define IO_CMD_TASK_STACK_SIZE				TASK_STACK_SIZE(3072)
+#define IO_CMD_TASK_PRIORITY				(TASK_NET_PRIORITY + 2)
+#define IO_CMD_TASK_CORE_ID					TASK_APP_CORE_ID
 
+// Scene task (lighting programs), below the servers: a busy server delays a tick, not a command
+#define SCENE_TASK_STACK_SIZE				TASK_STACK_SIZE(2560)
+#define SCENE_TASK_PRIORITY					3
+#define SCENE_TASK_CORE_ID					TASK_APP_CORE_ID
+
+// MQTT state publisher task
+#define MQTT_APP_TASK_STACK_SIZE			TASK_STACK_SIZE(3072)
+#define MQTT_APP_TASK_PRIORITY				4
+#define MQTT_APP_TASK_CORE_ID				TASK_APP_CORE_ID
+
+// esp-mqtt client task (created by esp-mqtt from the heap)
+#define MQTT_CLIENT_TASK_STACK_SIZE			TASK_STACK_SIZE(6144)
+
+// Load generator clients (created on demand from the heap, below every task they measure)
+#define LOADGEN_TASK_STACK_SIZE				TASK_STACK_SIZE(4096)
+#define LOADGEN_TASK_PRIORITY				2
+#define LOADGEN_TASK_CORE_ID				tskNO_AFFINITY
+
+#endif /* MAIN_TASKS_COMMON_H_ */
@@ -0,0 +1,315 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "telemetry.h"
+#include "wifi_app.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "telemetry";
+
+/**
+ * Fixed-size ring of samples, overwrites the oldest one when full.
+ */
+typedef struct telemetry_ring
+{
+	telemetry_sample_t *buf;
+	int len;
+	int head;					// Next write position
+	int count;
+} telemetry_ring_t;
+
+/**
+ * Running sums of the samples folded into the next tier.
+ */
+typedef struct telemetry_acc
+{
+	uint64_t heap_free;
+	uint32_t heap_min;
+	uint32_t largest_block;
+	int32_t rssi;
+	int rssi_n;					// Samples taken while connected, only they count for rssi
+	uint32_t cpu_permille[TELEMETRY_MAX_TASKS];
+	int n;
+} telemetry_acc_t;
+
+static telemetry_sample_t g_seconds[TELEMETRY_SECONDS_LEN];
+static telemetry_sample_t g_minutes[TELEMETRY_MINUTES_LEN];
+static telemetry_sample_t g_hours[TELEMETRY_HOURS_LEN];
+
+static telemetry_ring_t g_rings[TELEMETRY_TIER_COUNT] = {
+		[TELEMETRY_TIER_SECONDS] = { g_seconds, TELEMETRY_SECONDS_LEN, 0, 0 },
+		[TELEMETRY_TIER_MINUTES] = { g_minutes, TELEMETRY_MINUTES_LEN, 0, 0 },
+		[TELEMETRY_TIER_HOURS] = { g_hours, TELEMETRY_HOURS_LEN, 0, 0 },
+};
+
+// Samples per period of the next tier: 60 s per minute, 60 min per hour
+static const int g_tier_fold[TELEMETRY_TIER_COUNT - 1] = { 60, 60 };
+static telemetry_acc_t g_acc[TELEMETRY_TIER_COUNT - 1];
+
+static telemetry_task_info_t g_tasks[TELEMETRY_MAX_TASKS];
+static int g_task_count = 0;
+
+static SemaphoreHandle_t g_telemetry_mutex = NULL;
+static StaticSemaphore_t g_telemetry_mutex_buffer;
+static esp_timer_handle_t g_sample_timer = NULL;
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+static TaskStatus_t g_task_status[TELEMETRY_MAX_SYSTEM_TASKS];
+static uint32_t g_last_task_counter[TELEMETRY_MAX_TASKS];
+static TaskHandle_t g_last_task_handle[TELEMETRY_MAX_TASKS];
+static uint32_t g_last_total = 0;
+#endif
+
+static void telemetry_ring_push(telemetry_ring_t *ring, const telemetry_sample_t *sample)
+{
+	ring->buf[ring->head] = *sample;
+	ring->head = (ring->head + 1) % ring->len;
+	if (ring->count < ring->len)
+	{
+		ring->count++;
+	}
+}
+
+static void telemetry_acc_add(telemetry_acc_t *acc, const telemetry_sample_t *sample)
+{
+	if (acc->n == 0 || sample->heap_min < acc->heap_min)
+	{
+		acc->heap_min = sample->heap_min;
+	}
+	if (acc->n == 0 || sample->largest_block < acc->largest_block)
+	{
+		acc->largest_block = sample->largest_block;
+	}
+	acc->heap_free += sample->heap_free;
+	if (sample->rssi != 0)
+	{
+		acc->rssi += sample->rssi;
+		acc->rssi_n++;
+	}
+	for (int i = 0; i < TELEMETRY_MAX_TASKS; i++)
+	{
+		acc->cpu_permille[i] += sample->cpu_permille[i];
+	}
+	acc->n++;
+}
+
+/**
+ * Turns the sums into an average sample and resets the accumulator.
+ */
+static void telemetry_acc_take(telemetry_acc_t *acc, uint32_t uptime_s, telemetry_sample_t *sample)
+{
+	sample->uptime_s = uptime_s;
+	sample->heap_free = acc->heap_free / acc->n;
+	sample->heap_min = acc->heap_min;
+	sample->largest_block = acc->largest_block;
+	// Connected samples are below 0 dBm and so is their average, 0 still means not connected
+	sample->rssi = acc->rssi_n > 0 ? acc->rssi / acc->rssi_n : 0;
+	for (int i = 0; i < TELEMETRY_MAX_TASKS; i++)
+	{
+		sample->cpu_permille[i] = acc->cpu_permille[i] / acc->n;
+	}
+
+	memset(acc, 0, sizeof(*acc));
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+/**
+ * @return slot of a task, a new one if it is not tracked yet, or -1 if all slots are taken.
+ */
+static int telemetry_task_slot(const char *name)
+{
+	for (int i = 0; i < g_task_count; i++)
+	{
+		if (strncmp(g_tasks[i].name, name, sizeof(g_tasks[i].name)) == 0)
+		{
+			return i;
+		}
+	}
+
+	if (g_task_count == TELEMETRY_MAX_TASKS)
+	{
+		return -1;
+	}
+
+	strlcpy(g_tasks[g_task_count].name, name, sizeof(g_tasks[g_task_count].name));
+	g_last_task_counter[g_task_count] = 0;
+	g_last_task_handle[g_task_count] = NULL;
+	return g_task_count++;
+}
+
+/**
+ * Fills the per-task CPU share of the last period, and the task table.
+ * Run time counters are per task, the total is the elapsed time: 1000 permille is one full core.
+ */
+static void telemetry_sample_tasks(telemetry_sample_t *sample)
+{
+	uint32_t total = 0;
+	UBaseType_t n = uxTaskGetSystemState(g_task_status, TELEMETRY_MAX_SYSTEM_TASKS, &total);
+	uint32_t elapsed = total - g_last_total;
+
+	// 0 if the snapshot array is too small
+	if (n == 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < g_task_count; i++)
+	{
+		g_tasks[i].alive = false;
+	}
+
+	for (UBaseType_t i = 0; i < n; i++)
+	{
+		const TaskStatus_t *st = &g_task_status[i];
+		int slot = telemetry_task_slot(st->pcTaskName);
+		if (slot < 0)
+		{
+			continue;
+		}
+
+		// A new handle means the task was recreated under the same name and counts from 0,
+		// otherwise the unsigned difference also holds across a wrap of the counter
+		uint32_t counter = st->ulRunTimeCounter;
+		uint32_t delta = st->xHandle == g_last_task_handle[slot] ? counter - g_last_task_counter[slot] : counter;
+		g_last_task_counter[slot] = counter;
+		g_last_task_handle[slot] = st->xHandle;
+
+		if (g_last_total != 0 && elapsed > 0)
+		{
+			uint64_t permille = (uint64_t)delta * 1000 / elapsed;
+			sample->cpu_permille[slot] = permille > 1000 ? 1000 : permille;
+		}
+		g_tasks[slot].core = st->xCoreID == tskNO_AFFINITY ? -1 : (int8_t)st->xCoreID;
+		g_tasks[slot].stack_high_water = st->usStackHighWaterMark;
+		g_tasks[slot].alive = true;
+	}
+
+	g_last_total = total;
+}
+#endif
+
+/**
+ * Sample timer callback (esp_timer task).
+ */
+static void telemetry_sample_cb(void *arg)
+{
+	telemetry_sample_t sample = { 0 };
+	uint32_t uptime_s = esp_timer_get_time() / 1000000;
+
+	sample.uptime_s = uptime_s;
+	sample.heap_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+	sample.heap_min = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+	sample.largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+	sample.rssi = wifi_app_get_rssi();
+
+	xSemaphoreTake(g_telemetry_mutex, portMAX_DELAY);
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+	telemetry_sample_tasks(&sample);
+#endif
+
+	// Each tier folds into the next one once it has a full period
+	for (int tier = 0; tier < TELEMETRY_TIER_COUNT; tier++)
+	{
+		telemetry_ring_push(&g_rings[tier], &sample);
+		if (tier == TELEMETRY_TIER_COUNT - 1)
+		{
+			break;
+		}
+
+		telemetry_acc_add(&g_acc[tier], &sample);
+		if (g_acc[tier].n < g_tier_fold[tier])
+		{
+			break;
+		}
+		telemetry_acc_take(&g_acc[tier], uptime_s, &sample);
+	}
+
+	xSemaphoreGive(g_telemetry_mutex);
+}
+
+void telemetry_start(void)
+{
+	if (g_sample_timer != NULL)
+	{
+		return;
+	}
+
+	g_telemetry_mutex = xSemaphoreCreateMutexStatic(&g_telemetry_mutex_buffer);
+
+	const esp_timer_create_args_t sample_timer_args = {
+			.callback = &telemetry_sample_cb,
+			.arg = NULL,
+			.dispatch_method = ESP_TIMER_TASK,
+			.name = "telemetry"
+	};
+	ESP_ERROR_CHECK(esp_timer_create(&sample_timer_args, &g_sample_timer));
+	ESP_ERROR_CHECK(esp_timer_start_periodic(g_sample_timer, TELEMETRY_SAMPLE_PERIOD_MS * 1000));
+
+	ESP_LOGI(TAG, "Sampling every %d ms", TELEMETRY_SAMPLE_PERIOD_MS);
+}
+
+int telemetry_get_task_count(void)
+{
+	return g_task_count;
+}
+
+bool telemetry_get_task(int index, telemetry_task_info_t *info)
+{
+	bool ok = false;
+
+	if (g_telemetry_mutex == NULL)
+	{
+		return false;
+	}
+
+	xSemaphoreTake(g_telemetry_mutex, portMAX_DELAY);
+	if (index >= 0 && index < g_task_count)
+	{
+		*info = g_tasks[index];
+		ok = true;
+	}
+	xSemaphoreGive(g_telemetry_mutex);
+
+	return ok;
+}
+
+int telemetry_get_sample_count(telemetry_tier_e tier)
+{
+	return tier < TELEMETRY_TIER_COUNT ? g_rings[tier].count : 0;
+}
+
+bool telemetry_get_sample(telemetry_tier_e tier, int index, telemetry_sample_t *sample)
+{
+	bool ok = false;
+
+	if (tier >= TELEMETRY_TIER_COUNT || g_telemetry_mutex == NULL)
+	{
+		return false;
+	}
+
+	xSemaphoreTake(g_telemetry_mutex, portMAX_DELAY);
+	const telemetry_ring_t *ring = &g_rings[tier];
+	if (index >= 0 && index < ring->count)
+	{
+		// Oldest sample is at head once the ring has wrapped
+		*sample = ring->buf[(ring->head - ring->count + index + ring->len) % ring->len];
+		ok = true;
+	}
+	xSemaphoreGive(g_telemetry_mutex);
+
+	return ok;
+}
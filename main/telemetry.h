@@ -0,0 +1,90 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_TELEMETRY_H_
+#define MAIN_TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+#define TELEMETRY_SAMPLE_PERIOD_MS	1000
+#define TELEMETRY_MAX_TASKS			16		// Tasks tracked, the ones seen first win
+#define TELEMETRY_MAX_SYSTEM_TASKS	32		// uxTaskGetSystemState snapshot size
+
+// Ring sizes of the downsampling tiers
+#define TELEMETRY_SECONDS_LEN		60		// 1 s samples, last minute
+#define TELEMETRY_MINUTES_LEN		60		// 1 min averages, last hour
+#define TELEMETRY_HOURS_LEN			24		// 1 h averages, last day
+
+/**
+ * Downsampling tiers.
+ */
+typedef enum telemetry_tier
+{
+	TELEMETRY_TIER_SECONDS = 0,
+	TELEMETRY_TIER_MINUTES,
+	TELEMETRY_TIER_HOURS,
+	TELEMETRY_TIER_COUNT
+} telemetry_tier_e;
+
+/**
+ * One sample. In the minute and hour tiers the values are averages over the period,
+ * except heap_min and largest_block which are the minimum over the period, and rssi
+ * which is the average of the samples taken while connected.
+ */
+typedef struct telemetry_sample
+{
+	uint32_t uptime_s;							///> End of the sampled period
+	uint32_t heap_free;
+	uint32_t heap_min;							///> Lowest heap free level since boot
+	uint32_t largest_block;
+	int8_t rssi;								///> dBm, 0 if not connected (during the whole period)
+	uint16_t cpu_permille[TELEMETRY_MAX_TASKS];	///> Share of one core, per tracked task
+} telemetry_sample_t;
+
+/**
+ * A tracked task (index = position in telemetry_sample_t.cpu_permille).
+ */
+typedef struct telemetry_task_info
+{
+	char name[configMAX_TASK_NAME_LEN];
+	int8_t core;								///> -1 = no affinity
+	uint32_t stack_high_water;					///> Minimum free stack bytes, last sample
+	bool alive;									///> Seen in the last sample
+} telemetry_task_info_t;
+
+/**
+ * Starts the periodic sampler. Needs CONFIG_FREERTOS_USE_TRACE_FACILITY and
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS for the per-task data.
+ */
+void telemetry_start(void);
+
+/**
+ * @return number of tracked tasks.
+ */
+int telemetry_get_task_count(void);
+
+/**
+ * Gets a tracked task.
+ * @return false if index is out of range.
+ */
+bool telemetry_get_task(int index, telemetry_task_info_t *info);
+
+/**
+ * @return number of samples held by a tier.
+ */
+int telemetry_get_sample_count(telemetry_tier_e tier);
+
+/**
+ * Gets a sample, index 0 is the oldest.
+ * @return false if index is out of range.
+ */
+bool telemetry_get_sample(telemetry_tier_e tier, int index, telemetry_sample_t *sample);
+
+#endif /* MAIN_TELEMETRY_H_ */
@@ -0,0 +1,234 @@
+/*
+ * trace.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#include "trace.h"
+
+#if CONFIG_TRACE_ENABLE
+
+_Static_assert(sizeof(trace_event_t) == 16, "trace_event_t is part of the dump format");
+_Static_assert((CONFIG_TRACE_EVENTS_PER_CORE & (CONFIG_TRACE_EVENTS_PER_CORE - 1)) == 0,
+		"CONFIG_TRACE_EVENTS_PER_CORE must be a power of two");
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "trace";
+
+#define TRACE_RING_MASK				(CONFIG_TRACE_EVENTS_PER_CORE - 1)
+
+// Task names in a dump, the rest of the tasks appear by handle
+#define TRACE_MAX_TASKS				32
+
+/**
+ * Events of one core, only written by that core.
+ */
+typedef struct trace_ring
+{
+	uint32_t head;							// Events written since the last dump, the next index masked
+	trace_event_t events[CONFIG_TRACE_EVENTS_PER_CORE];
+} trace_ring_t;
+
+static DRAM_ATTR trace_ring_t g_rings[portNUM_PROCESSORS];
+static volatile DRAM_ATTR bool g_recording = false;
+
+// Dump in progress, taken by trace_dump_begin
+static uint32_t g_dump_count[portNUM_PROCESSORS];
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+static TaskStatus_t g_task_status[TRACE_MAX_TASKS];
+#endif
+static int g_task_count = 0;
+
+static vprintf_like_t g_log_vprintf = NULL;
+
+static const char g_event_names[TRACE_EV_COUNT][TRACE_NAME_SIZE] = {
+		[TRACE_EV_TASK_SWITCH] = "task_switch",
+		[TRACE_EV_HTTP_ACCEPT] = "http_accept",
+		[TRACE_EV_HTTP_CLOSE] = "http_close",
+		[TRACE_EV_HTTP_REQUEST] = "http_request",
+		[TRACE_EV_HTTP_MONITOR_SEND] = "monitor_send",
+		[TRACE_EV_HTTP_MONITOR_MSG] = "monitor_msg",
+		[TRACE_EV_LED_TOGGLE] = "led_toggle",
+		[TRACE_EV_IO_CMD_QUEUE] = "io_cmd_queue",
+		[TRACE_EV_IO_CMD_APPLY] = "io_cmd_apply",
+		[TRACE_EV_IO_WRITE] = "io_write",
+		[TRACE_EV_IO_BUTTON] = "io_button",
+		[TRACE_EV_WIFI_MSG] = "wifi_msg",
+		[TRACE_EV_WIFI_EVENT] = "wifi_event",
+		[TRACE_EV_LOG] = "log",
+};
+
+/**
+ * Stores one event of the given task. Interrupts of this core are masked for the copy,
+ * the other core has its own ring.
+ */
+static inline void IRAM_ATTR trace_store(trace_event_id_e id, trace_phase_e phase, uint32_t arg, TaskHandle_t task)
+{
+	UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+	int core = xPortGetCoreID();
+	trace_ring_t *ring = &g_rings[core];
+	trace_event_t *ev = &ring->events[ring->head & TRACE_RING_MASK];
+
+	ev->time_us = (uint32_t)esp_timer_get_time();
+	ev->task = (uint32_t)(uintptr_t)task;
+	ev->arg = arg;
+	ev->id = (uint16_t)id;
+	ev->phase = (uint8_t)phase;
+	ev->core = (uint8_t)core;
+	ring->head++;
+
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+void IRAM_ATTR trace_record(trace_event_id_e id, trace_phase_e phase, uint32_t arg)
+{
+	if (g_recording)
+	{
+		trace_store(id, phase, arg, xTaskGetCurrentTaskHandle());
+	}
+}
+
+/**
+ * Called by the FreeRTOS kernel (traceTASK_SWITCHED_IN, trace_hooks.h) with the new task
+ * already current, from the scheduler: IRAM and no locks.
+ */
+void IRAM_ATTR trace_task_switched_in(void)
+{
+	if (g_recording)
+	{
+		TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+		trace_store(TRACE_EV_TASK_SWITCH, TRACE_PHASE_INSTANT, (uint32_t)(uintptr_t)task, task);
+	}
+}
+
+trace_scope_t trace_scope_begin(trace_event_id_e id, uint32_t arg)
+{
+	trace_scope_t scope = { .id = (uint16_t)id, .arg = arg };
+
+	trace_record(id, TRACE_PHASE_BEGIN, arg);
+	return scope;
+}
+
+void trace_scope_end(trace_scope_t *scope)
+{
+	trace_record((trace_event_id_e)scope->id, TRACE_PHASE_END, scope->arg);
+}
+
+/**
+ * Log output hook: the time spent formatting and printing a log line, the UART blocks
+ * when its FIFO is full.
+ */
+static int trace_log_vprintf(const char *format, va_list args)
+{
+	TRACE_SCOPE(TRACE_EV_LOG, 0);
+
+	return g_log_vprintf(format, args);
+}
+
+void trace_init(void)
+{
+	if (g_log_vprintf != NULL)
+	{
+		return;
+	}
+
+	g_log_vprintf = esp_log_set_vprintf(&trace_log_vprintf);
+	g_recording = true;
+
+	ESP_LOGI(TAG, "Recording, %d events per core%s", CONFIG_TRACE_EVENTS_PER_CORE,
+			CONFIG_TRACE_CONTEXT_SWITCHES ? " with context switches" : "");
+}
+
+void trace_dump_begin(trace_dump_header_t *header)
+{
+	uint32_t lost = 0;
+	uint32_t events = 0;
+
+	g_recording = false;
+	// An event being stored on the other core completes within microseconds
+	vTaskDelay(1);
+
+	for (int core = 0; core < portNUM_PROCESSORS; core++)
+	{
+		uint32_t head = g_rings[core].head;
+
+		g_dump_count[core] = head < CONFIG_TRACE_EVENTS_PER_CORE ? head : CONFIG_TRACE_EVENTS_PER_CORE;
+		lost += head - g_dump_count[core];
+		events += g_dump_count[core];
+	}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+	// 0 if there are more tasks than TRACE_MAX_TASKS
+	g_task_count = (int)uxTaskGetSystemState(g_task_status, TRACE_MAX_TASKS, NULL);
+#endif
+
+	memset(header, 0, sizeof(*header));
+	header->magic = TRACE_DUMP_MAGIC;
+	header->version = TRACE_DUMP_VERSION;
+	header->event_size = sizeof(trace_event_t);
+	header->cores = portNUM_PROCESSORS;
+	header->names = TRACE_EV_COUNT;
+	header->tasks = (uint16_t)g_task_count;
+	header->events = events;
+	header->lost = lost;
+	header->now_us = (uint64_t)esp_timer_get_time();
+}
+
+const char* trace_event_name(trace_event_id_e id)
+{
+	return id < TRACE_EV_COUNT ? g_event_names[id] : "unknown";
+}
+
+void trace_dump_task(int index, trace_dump_task_t *task)
+{
+	memset(task, 0, sizeof(*task));
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+	if (index >= 0 && index < g_task_count)
+	{
+		task->task = (uint32_t)(uintptr_t)g_task_status[index].xHandle;
+		strlcpy(task->name, g_task_status[index].pcTaskName, sizeof(task->name));
+	}
+#endif
+}
+
+void trace_dump_event(uint32_t index, trace_event_t *event)
+{
+	for (int core = 0; core < portNUM_PROCESSORS; core++)
+	{
+		const trace_ring_t *ring = &g_rings[core];
+
+		if (index < g_dump_count[core])
+		{
+			*event = ring->events[(ring->head - g_dump_count[core] + index) & TRACE_RING_MASK];
+			return;
+		}
+		index -= g_dump_count[core];
+	}
+
+	memset(event, 0, sizeof(*event));
+}
+
+void trace_dump_end(void)
+{
+	for (int core = 0; core < portNUM_PROCESSORS; core++)
+	{
+		g_rings[core].head = 0;
+		g_dump_count[core] = 0;
+	}
+	g_task_count = 0;
+
+	g_recording = true;
+}
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_TRACE_H_
+#define MAIN_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+/*
+ * Event trace of requests, handlers, queue hops, LED writes, logging and (with
+ * CONFIG_TRACE_CONTEXT_SWITCHES) FreeRTOS context switches, to see where the time of a
+ * slow command goes. Every event is 16 bytes: esp_timer time, running task, event id and
+ * an argument. Each core writes its own ring with interrupts masked for the copy, no lock
+ * is shared between the cores. GET /api/trace dumps and clears the rings,
+ * tools/trace2chrome.py turns the dump into Chrome trace JSON for Perfetto.
+ *
+ * Without CONFIG_TRACE_ENABLE the trace points compile to nothing.
+ */
+
+/**
+ * Trace points. The names in trace.c go into the dump, append new ones at the end.
+ */
+typedef enum trace_event_id
+{
+	TRACE_EV_TASK_SWITCH = 0,				///> Instant, task switched in
+	TRACE_EV_HTTP_ACCEPT,					///> Instant, arg: socket
+	TRACE_EV_HTTP_CLOSE,					///> Instant, arg: socket
+	TRACE_EV_HTTP_REQUEST,					///> Scope of a generated wrapper, arg: api_operation_e
+	TRACE_EV_HTTP_MONITOR_SEND,				///> Instant, arg: http_server_message_e
+	TRACE_EV_HTTP_MONITOR_MSG,				///> Scope, arg: http_server_message_e
+	TRACE_EV_LED_TOGGLE,					///> Scope of the handler until the IO task answered, arg: LED id
+	TRACE_EV_IO_CMD_QUEUE,					///> Instant, arg: LED mask
+	TRACE_EV_IO_CMD_APPLY,					///> Scope, arg: commands in the batch
+	TRACE_EV_IO_WRITE,						///> Scope of the GPIO write, arg: LED mask
+	TRACE_EV_IO_BUTTON,						///> Instant, from the ISR
+	TRACE_EV_WIFI_MSG,						///> Scope, arg: wifi_app_message_e
+	TRACE_EV_WIFI_EVENT,					///> Scope, arg: event id
+	TRACE_EV_LOG,							///> Scope of a log line
+	TRACE_EV_COUNT
+} trace_event_id_e;
+
+typedef enum trace_phase
+{
+	TRACE_PHASE_BEGIN = 0,
+	TRACE_PHASE_END,
+	TRACE_PHASE_INSTANT,
+} trace_phase_e;
+
+/**
+ * One event (16 bytes), also the layout in the dump.
+ */
+typedef struct trace_event
+{
+	uint32_t time_us;						///> esp_timer, low 32 bits
+	uint32_t task;							///> Handle of the running task, the one switched in for TRACE_EV_TASK_SWITCH
+	uint32_t arg;
+	uint16_t id;							///> trace_event_id_e
+	uint8_t phase;							///> trace_phase_e
+	uint8_t core;
+} trace_event_t;
+
+/**
+ * Dump header, followed by TRACE_EV_COUNT event names (TRACE_NAME_SIZE bytes each),
+ * tasks x trace_dump_task_t and events x trace_event_t, core by core in time order.
+ */
+#define TRACE_DUMP_MAGIC			0x31435254	///> "TRC1"
+#define TRACE_DUMP_VERSION			1
+#define TRACE_NAME_SIZE				16
+
+typedef struct trace_dump_header
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t event_size;					///> sizeof(trace_event_t)
+	uint16_t cores;
+	uint16_t names;							///> TRACE_EV_COUNT
+	uint16_t tasks;
+	uint16_t reserved;
+	uint32_t events;
+	uint32_t lost;							///> Overwritten since the previous dump
+	uint64_t now_us;						///> esp_timer at the dump, to unwrap time_us
+} trace_dump_header_t;
+
+typedef struct trace_dump_task
+{
+	uint32_t task;
+	char name[TRACE_NAME_SIZE];
+} trace_dump_task_t;
+
+#if CONFIG_TRACE_ENABLE
+
+typedef struct trace_scope
+{
+	uint16_t id;
+	uint32_t arg;
+} trace_scope_t;
+
+/**
+ * Starts recording, hooks the log output. Call early in app_main.
+ */
+void trace_init(void);
+
+/**
+ * Records one event on the ring of the calling core. IRAM, callable from an ISR.
+ */
+void trace_record(trace_event_id_e id, trace_phase_e phase, uint32_t arg);
+
+trace_scope_t trace_scope_begin(trace_event_id_e id, uint32_t arg);
+void trace_scope_end(trace_scope_t *scope);
+
+/**
+ * Stops recording until trace_dump_end, so the rings hold still while they are read.
+ * @param header filled in, the task names come from uxTaskGetSystemState.
+ */
+void trace_dump_begin(trace_dump_header_t *header);
+
+const char* trace_event_name(trace_event_id_e id);
+
+/**
+ * Gets a task name of the dump, index < header.tasks.
+ */
+void trace_dump_task(int index, trace_dump_task_t *task);
+
+/**
+ * Gets an event of the dump, index < header.events, core by core from the oldest.
+ */
+void trace_dump_event(uint32_t index, trace_event_t *event);
+
+/**
+ * Clears the rings and resumes recording.
+ */
+void trace_dump_end(void);
+
+#define TRACE_CONCAT_(a, b)				a##b
+#define TRACE_CONCAT(a, b)				TRACE_CONCAT_(a, b)
+
+// Begin now, end when the enclosing block is left (a declaration: not right after a case label)
+#define TRACE_SCOPE(id, arg)			trace_scope_t TRACE_CONCAT(trace_scope_, __LINE__) \
+											__attribute__((cleanup(trace_scope_end), unused)) = trace_scope_begin((id), (uint32_t)(arg))
+#define TRACE_INSTANT(id, arg)			trace_record((id), TRACE_PHASE_INSTANT, (uint32_t)(arg))
+
+#else
+
+#define TRACE_SCOPE(id, arg)			do { } while (0)
+#define TRACE_INSTANT(id, arg)			do { } while (0)
+
+#endif
+
+#endif /* MAIN_TRACE_H_ */
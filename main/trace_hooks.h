@@ -0,0 +1,25 @@
+/*
+ * trace_hooks.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_TRACE_HOOKS_H_
+#define MAIN_TRACE_HOOKS_H_
+
+/*
+ * Included ahead of every FreeRTOS kernel source when CONFIG_TRACE_CONTEXT_SWITCHES is set
+ * (main/CMakeLists.txt), FreeRTOS.h only defines the hooks that are not defined yet.
+ * The kernel also has assembler sources, they get nothing from here.
+ */
+
+#ifndef __ASSEMBLER__
+
+void trace_task_switched_in(void);
+
+#define traceTASK_SWITCHED_IN()			trace_task_switched_in()
+
+#endif
+
+#endif /* MAIN_TRACE_HOOKS_H_ */
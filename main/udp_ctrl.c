@@ -0,0 +1,265 @@
+/*
+ * udp_ctrl.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+
+#include "auth.h"
+#include "io_cmd.h"
+#include "journal.h"
+#include "static_alloc.h"
+#include "udp_ctrl.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "udp_ctrl";
+
+/**
+ * Last acknowledgement sent to a client, replayed when the client retries.
+ */
+typedef struct udp_ctrl_client
+{
+	uint32_t addr;				// Network byte order, 0 = free entry
+	uint16_t port;				// Network byte order
+	uint32_t last_used;			// Packet counter value of the last frame from this client
+	udp_ctrl_frame_t ack;
+} udp_ctrl_client_t;
+
+static int g_sock = -1;
+static TaskHandle_t g_task_handle = NULL;
+static uint32_t g_mcast_if_addr = 0;
+static udp_ctrl_client_t g_clients[UDP_CTRL_CLIENT_CACHE_SIZE];
+static uint32_t g_packets = 0;
+
+/**
+ * Finds the client entry of addr:port, or the least recently used entry to reuse.
+ * @return entry; its addr is 0 or differs from addr when the client is new.
+ */
+static udp_ctrl_client_t* udp_ctrl_client_find(uint32_t addr, uint16_t port)
+{
+	udp_ctrl_client_t *lru = &g_clients[0];
+
+	for (int i = 0; i < UDP_CTRL_CLIENT_CACHE_SIZE; i++)
+	{
+		udp_ctrl_client_t *c = &g_clients[i];
+
+		if (c->addr == addr && c->port == port)
+		{
+			return c;
+		}
+		if (c->addr == 0 || (lru->addr != 0 && (int32_t)(c->last_used - lru->last_used) < 0))
+		{
+			lru = c;
+		}
+	}
+
+	return lru;
+}
+
+/**
+ * Applies a request through the IO command queue and fills in its acknowledgement.
+ */
+static void udp_ctrl_execute(const udp_ctrl_frame_t *req, udp_ctrl_frame_t *ack)
+{
+	io_cmd_result_t state;
+	esp_err_t err = ESP_OK;
+
+	ack->magic = UDP_CTRL_MAGIC;
+	ack->version = UDP_CTRL_VERSION;
+	ack->cmd = req->cmd | UDP_CTRL_ACK_FLAG;
+	ack->seq = req->seq;
+	ack->value = UDP_CTRL_STATUS_OK;
+	ack->reserved = 0;
+
+	// Frames are not authenticated, they would bypass the login of the API
+	if (auth_is_enabled())
+	{
+		ack->value = UDP_CTRL_STATUS_LOCKED;
+		ack->mask = 0;
+		return;
+	}
+
+	if (req->version != UDP_CTRL_VERSION)
+	{
+		ack->value = UDP_CTRL_STATUS_BAD_VERSION;
+		io_cmd_get_state(&state);
+		ack->mask = state.mask;
+		return;
+	}
+
+	switch (req->cmd)
+	{
+		case UDP_CTRL_CMD_GET:
+			io_cmd_get_state(&state);
+			break;
+
+		case UDP_CTRL_CMD_SET:
+			err = io_cmd_write(IO_CMD_SOURCE_UDP, req->mask, 0xFF, &state);
+			break;
+
+		case UDP_CTRL_CMD_CLEAR:
+			err = io_cmd_write(IO_CMD_SOURCE_UDP, req->mask, 0x00, &state);
+			break;
+
+		case UDP_CTRL_CMD_TOGGLE:
+			err = io_cmd_toggle(IO_CMD_SOURCE_UDP, req->mask, &state);
+			break;
+
+		case UDP_CTRL_CMD_WRITE:
+			err = io_cmd_write(IO_CMD_SOURCE_UDP, req->mask, req->value, &state);
+			break;
+
+		default:
+			ack->value = UDP_CTRL_STATUS_BAD_CMD;
+			io_cmd_get_state(&state);
+			break;
+	}
+
+	if (err != ESP_OK)
+	{
+		ack->value = UDP_CTRL_STATUS_BUSY;
+		io_cmd_get_state(&state);
+	}
+	ack->mask = state.mask;
+}
+
+/**
+ * Journal result of an acknowledgement status.
+ */
+static journal_result_e udp_ctrl_journal_result(uint8_t status)
+{
+	switch (status)
+	{
+		case UDP_CTRL_STATUS_OK:
+			return JOURNAL_RESULT_OK;
+		case UDP_CTRL_STATUS_BUSY:
+			return JOURNAL_RESULT_BUSY;
+		case UDP_CTRL_STATUS_LOCKED:
+			return JOURNAL_RESULT_UNAUTHORIZED;
+		default:
+			return JOURNAL_RESULT_BAD_REQUEST;
+	}
+}
+
+/**
+ * UDP control task, answers one frame at a time.
+ */
+static void udp_ctrl_task(void *pvParameters)
+{
+	udp_ctrl_frame_t req;
+	struct sockaddr_in src;
+	socklen_t src_len;
+
+	for (;;)
+	{
+		src_len = sizeof(src);
+		int len = recvfrom(g_sock, &req, sizeof(req), 0, (struct sockaddr *)&src, &src_len);
+
+		if (len < 0)
+		{
+			ESP_LOGE(TAG, "recvfrom failed: errno %d", errno);
+			vTaskDelay(pdMS_TO_TICKS(100));
+			continue;
+		}
+
+		// Silently drop anything that is not ours, don't reflect garbage
+		if (len != sizeof(req) || req.magic != UDP_CTRL_MAGIC || (req.cmd & UDP_CTRL_ACK_FLAG))
+		{
+			continue;
+		}
+
+		journal_record_t rec;
+		journal_begin(&rec, JOURNAL_SOURCE_UDP, req.cmd, src.sin_addr.s_addr);
+		rec.channel = req.mask;
+
+		udp_ctrl_client_t *client = udp_ctrl_client_find(src.sin_addr.s_addr, src.sin_port);
+		// A busy or locked answer is not replayed, the retry gets another chance
+		bool retry = client->addr == src.sin_addr.s_addr && client->port == src.sin_port && client->ack.seq == req.seq
+				&& client->ack.value != UDP_CTRL_STATUS_BUSY && client->ack.value != UDP_CTRL_STATUS_LOCKED;
+
+		if (!retry)
+		{
+			client->addr = src.sin_addr.s_addr;
+			client->port = src.sin_port;
+			udp_ctrl_execute(&req, &client->ack);
+		}
+		client->last_used = ++g_packets;
+
+		sendto(g_sock, &client->ack, sizeof(client->ack), 0, (struct sockaddr *)&src, src_len);
+
+		journal_end(&rec, retry ? JOURNAL_RESULT_REPLAYED : udp_ctrl_journal_result(client->ack.value));
+	}
+}
+
+esp_err_t udp_ctrl_join_multicast(uint32_t if_addr)
+{
+	struct ip_mreq mreq;
+
+	if (g_sock < 0)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	mreq.imr_multiaddr.s_addr = inet_addr(CONFIG_UDP_CTRL_MCAST_ADDR);
+
+	// A new STA address means a new membership, the old one is dropped if it still exists
+	if (g_mcast_if_addr != 0)
+	{
+		mreq.imr_interface.s_addr = g_mcast_if_addr;
+		setsockopt(g_sock, IPPROTO_IP, IP_DROP_MEMBERSHIP, &mreq, sizeof(mreq));
+		g_mcast_if_addr = 0;
+	}
+
+	mreq.imr_interface.s_addr = if_addr;
+	if (setsockopt(g_sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+	{
+		ESP_LOGE(TAG, "Joining %s failed: errno %d", CONFIG_UDP_CTRL_MCAST_ADDR, errno);
+		return ESP_FAIL;
+	}
+
+	g_mcast_if_addr = if_addr;
+	ESP_LOGI(TAG, "Joined multicast group %s", CONFIG_UDP_CTRL_MCAST_ADDR);
+
+	return ESP_OK;
+}
+
+void udp_ctrl_start(void)
+{
+	struct sockaddr_in addr = {
+			.sin_family = AF_INET,
+			.sin_port = htons(CONFIG_UDP_CTRL_PORT),
+			.sin_addr.s_addr = htonl(INADDR_ANY),
+	};
+
+	if (g_task_handle != NULL)
+	{
+		return;
+	}
+
+	g_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (g_sock < 0)
+	{
+		ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+		return;
+	}
+
+	if (bind(g_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		ESP_LOGE(TAG, "Unable to bind port %d: errno %d", CONFIG_UDP_CTRL_PORT, errno);
+		close(g_sock);
+		g_sock = -1;
+		return;
+	}
+
+	g_task_handle = static_alloc_task_create(STATIC_TASK_UDP_CTRL, &udp_ctrl_task, NULL);
+
+	ESP_LOGI(TAG, "Listening on UDP port %d", CONFIG_UDP_CTRL_PORT);
+}
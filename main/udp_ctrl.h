@@ -0,0 +1,89 @@
+/*
+ * udp_ctrl.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_UDP_CTRL_H_
+#define MAIN_UDP_CTRL_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * Binary LED control over UDP, for clients that can't afford an HTTP round trip.
+ *
+ * Every request is one udp_ctrl_frame_t datagram, answered by one udp_ctrl_frame_t
+ * acknowledgement sent back to the source address. All fields are little endian.
+ *
+ * Retries: a client re-sends the same frame (same seq) until it gets the ack. The device
+ * remembers the last seq and ack of the most recent clients, so a retry is answered from
+ * that cache without applying the command again (a retried TOGGLE toggles only once).
+ * A BUSY ack is not cached: nothing was applied, so the retry runs the command.
+ * A client must use a new seq for every new command.
+ *
+ * Multicast: the device also listens on CONFIG_UDP_CTRL_MCAST_ADDR, so one frame can
+ * switch several devices. Each of them acks to the sender.
+ */
+
+#define UDP_CTRL_MAGIC				0x4355		// "UC"
+#define UDP_CTRL_VERSION			1
+#define UDP_CTRL_ACK_FLAG			0x80		// Set in cmd of an acknowledgement
+#define UDP_CTRL_CLIENT_CACHE_SIZE	8			// Clients whose last ack is kept for retries
+
+/**
+ * Commands, mask and value are LED bitmaps (bit 0 is LED1).
+ */
+typedef enum udp_ctrl_cmd
+{
+	UDP_CTRL_CMD_GET = 0,		// Only report the state
+	UDP_CTRL_CMD_SET,			// Turn the LEDs in mask on
+	UDP_CTRL_CMD_CLEAR,			// Turn the LEDs in mask off
+	UDP_CTRL_CMD_TOGGLE,		// Toggle the LEDs in mask
+	UDP_CTRL_CMD_WRITE,			// Set the LEDs in mask to the matching bits of value
+} udp_ctrl_cmd_e;
+
+/**
+ * Status reported in the value field of an acknowledgement.
+ */
+typedef enum udp_ctrl_status
+{
+	UDP_CTRL_STATUS_OK = 0,
+	UDP_CTRL_STATUS_BAD_VERSION,
+	UDP_CTRL_STATUS_BAD_CMD,
+	UDP_CTRL_STATUS_BUSY,		// The IO command queue was full, nothing was applied
+	UDP_CTRL_STATUS_LOCKED,		// An API login is set, frames carry no credentials: refused, mask is 0
+} udp_ctrl_status_e;
+
+/**
+ * Request and acknowledgement frame (12 bytes).
+ * In an acknowledgement, cmd has UDP_CTRL_ACK_FLAG set, mask is the LED state
+ * after the command and value is a udp_ctrl_status_e.
+ */
+typedef struct __attribute__((packed))
+{
+	uint16_t magic;
+	uint8_t version;
+	uint8_t cmd;
+	uint32_t seq;
+	uint8_t mask;
+	uint8_t value;
+	uint16_t reserved;
+} udp_ctrl_frame_t;
+
+/**
+ * Opens the control socket and starts the UDP control task.
+ * Does nothing if it is already running.
+ */
+void udp_ctrl_start(void);
+
+/**
+ * (Re)joins the multicast group on the given interface. Call whenever the STA gets an IP.
+ * @param if_addr interface IPv4 address, network byte order.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the socket is not open, or ESP_FAIL.
+ */
+esp_err_t udp_ctrl_join_multicast(uint32_t if_addr);
+
+#endif /* MAIN_UDP_CTRL_H_ */
@@ -1,4 +1,5 @@
-let API_URL = "http://192.168.0.1"; // AP adress
+const SCHEME = location.protocol === "https:" ? "https" : "http"; // same scheme as the page
+let API_URL = `${SCHEME}://192.168.0.1`; // AP adress
 
 // LED elements
 const led1El = document.getElementById("led1");
@@ -22,6 +23,8 @@ const btnSaveNetwork = document.getElementById("btnSaveNetwork");
 const ssidInput = document.getElementById("ssid");
 const passwordInput = document.getElementById("password");
 const networkStatus = document.getElementById("network_status");
+const btnScanNetwork = document.getElementById("btnScanNetwork");
+const ssidList = document.getElementById("ssid_list");
 
 const otaProgress = document.getElementById("ota_progress");
 
@@ -42,6 +45,42 @@ function updateProgress(event) {
 }
 
 
+// ===== LOGIN =====
+// Session token from POST /api/auth/login, sent as "Authorization: Bearer" while the tab is open
+let authToken = sessionStorage.getItem("authToken");
+
+function authHeaders(headers = {}) {
+  return authToken ? { ...headers, "Authorization": `Bearer ${authToken}` } : headers;
+}
+
+async function login() {
+  const user = prompt("Użytkownik");
+  if (user === null) return false;
+  const password = prompt("Hasło");
+  if (password === null) return false;
+
+  const res = await fetch(`${API_URL}/api/auth/login`, {
+    method: "POST",
+    headers: { "Content-Type": "application/json" },
+    body: JSON.stringify({ user, password })
+  });
+  if (!res.ok) { alert("Błędny użytkownik lub hasło"); return false; }
+
+  authToken = (await res.json()).token;
+  sessionStorage.setItem("authToken", authToken);
+  return true;
+}
+
+// fetch() with the session token, logs in and retries once on 401
+async function apiFetch(url, options = {}) {
+  let res = await fetch(url, { ...options, headers: authHeaders(options.headers) });
+  if (res.status === 401 && await login()) {
+    res = await fetch(url, { ...options, headers: authHeaders(options.headers) });
+  }
+  return res;
+}
+
+
 // ===== TABS =====
 document.querySelectorAll(".tab-btn").forEach(btn => {
   btn.addEventListener("click", () => {
@@ -63,7 +102,7 @@ async function fetchLedState(id) {
 
 async function toggleLed(id) {
   try {
-    const res = await fetch(`${API_URL}/api/leds/${id}/toggle`, { method: 'POST' });
+    const res = await apiFetch(`${API_URL}/api/leds/${id}/toggle`, { method: 'POST' });
     if(res.ok) return (await res.json()).state;
   } catch(e) { console.error(e); }
   return null;
@@ -108,6 +147,8 @@ btnUpdate.addEventListener("click", ()=>{
   const xhr = new XMLHttpRequest();
   xhr.upload.addEventListener("progress", updateProgress);
   xhr.open("POST", `${API_URL}/api/OTA/update`);
+  if (authToken) xhr.setRequestHeader("Authorization", `Bearer ${authToken}`);
+  xhr.onload = () => { if (xhr.status === 401) otaStatus.textContent = "Zaloguj się i spróbuj ponownie"; };
   xhr.responseType="blob";
   xhr.send(formData);
 });
@@ -115,7 +156,7 @@ btnUpdate.addEventListener("click", ()=>{
 
 function getUpdateStatus(){
   const xhr = new XMLHttpRequest();
-  xhr.open("POST", `${API_URL}/api/OTA/status`);
+  xhr.open("GET", `${API_URL}/api/OTA/status`);
 
   xhr.onload = () => {
     if (xhr.status === 200) {
@@ -152,7 +193,7 @@ networkSection.prepend(staIpContainer); // add at the top
 
 btnGetNetwork.addEventListener("click", async () => {
   try{
-    const res = await fetch(`${API_URL}/api/config/network`);
+    const res = await apiFetch(`${API_URL}/api/config/network`);
     if(res.ok){
       const data = await res.json();
       ssidInput.value=data.ssid||"";
@@ -166,7 +207,7 @@ btnSaveNetwork.addEventListener("click", async ()=>{
   const ssid = ssidInput.value;
   const password = passwordInput.value;
   try{
-    const res = await fetch(`${API_URL}/api/config/network`, {
+    const res = await apiFetch(`${API_URL}/api/config/network`, {
       method:"POST",
       headers:{ "Content-Type":"application/json" },
       body: JSON.stringify({ssid,password})
@@ -177,9 +218,35 @@ btnSaveNetwork.addEventListener("click", async ()=>{
 });
 
 
+// Scan results come from the device cache - poll while a background scan is running
+async function scanNetworks(refresh) {
+  try{
+    const res = await fetch(`${API_URL}/api/wifi/scan${refresh ? "?refresh=1" : ""}`);
+    if(!res.ok){ networkStatus.textContent="Błąd skanowania ❌"; return; }
+    const data = await res.json();
+
+    ssidList.innerHTML = "";
+    data.aps.forEach(ap => {
+      const opt = document.createElement("option");
+      opt.value = ap.ssid;
+      opt.label = `${ap.rssi} dBm, kanał ${ap.channel}`;
+      ssidList.appendChild(opt);
+    });
+
+    if(data.scanning){
+      networkStatus.textContent="Skanowanie...";
+      setTimeout(() => scanNetworks(false), 1000);
+    } else {
+      networkStatus.textContent=`Znaleziono sieci: ${data.aps.length}`;
+    }
+  } catch(e){ networkStatus.textContent="Błąd skanowania ❌"; console.error(e); }
+}
+
+btnScanNetwork.addEventListener("click", () => scanNetworks(true));
+
 async function updateStaIpLink() {
   // Only show STA IP link if we're currently on AP IP
-  if (API_URL === "http://192.168.0.1") {
+  if (API_URL === `${SCHEME}://192.168.0.1`) {
     try {
       const res = await fetch(`${API_URL}/api/config/ip_addr`);
       if (res.ok) {
@@ -187,7 +254,7 @@ async function updateStaIpLink() {
         if (data.ip && data.ip !== "0.0.0.0") {
           staIpContainer.innerHTML = `
             <label>Device STA IP: </label>
-            <a href="http://${data.ip}" target="_blank">${data.ip}</a>
+            <a href="${SCHEME}://${data.ip}" target="_blank">${data.ip}</a>
           `;
           return;
         }
@@ -220,7 +287,7 @@ async function discoverStaApiUrl() {
       const controller = new AbortController();
       const timer = setTimeout(() => controller.abort(), timeout);
 
-      const res = await fetch(`http://${testIp}/api/config/ip_addr`, {
+      const res = await fetch(`${SCHEME}://${testIp}/api/config/ip_addr`, {
         signal: controller.signal
       }).catch(() => null);
 
@@ -253,7 +320,7 @@ async function discoverStaApiUrl() {
 
         if (hit) {
           console.log("FOUND STA device at:", hit);
-          API_URL = `http://${hit}`;
+          API_URL = `${SCHEME}://${hit}`;
           return hit;    // END – device found
         }
       }
@@ -7,29 +7,180 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "lwip/netdb.h"
 
+#include "boot_profile.h"
+#include "event_bus.h"
+#include "http_cache.h"
 #include "http_server.h"
-#include "tasks_common.h"
+#include "io.h"
+#include "mqtt_app.h"
+#include "static_alloc.h"
+#include "trace.h"
+#include "udp_ctrl.h"
 #include "wifi_app.h"
+#include "wifi_reconnect.h"
 #include "nvs_utils.h"
 
 
 // Tag used for ESP serial console messages
 static const char TAG [] = "wifi_app";
 
-// Queue handle used to manipulate the main queue of events
+// Event bus queue of the WiFi application task
 static QueueHandle_t wifi_app_queue_handle;
 
 // netif objects for the station and access point
 esp_netif_t* esp_netif_sta = NULL;
 esp_netif_t* esp_netif_ap  = NULL;
 
+// STA credentials were found in NVS
+static bool g_sta_configured = false;
+
+// Directed connect to the cached BSSID/channel is in progress
+static bool g_fast_connect_pending = false;
+
+// Connection metrics
+static wifi_app_metrics_t g_wifi_app_metrics;
+
+// STA connection state machine and its retry timer
+static wifi_reconnect_t g_reconnect;
+static esp_timer_handle_t g_reconnect_timer;
+
+// SoftAP policy: the AP is switched off or moved to the STA channel once the STA is stable
+static esp_timer_handle_t g_ap_policy_timer;
+static bool g_ap_active = true;
+static uint8_t g_ap_channel = WIFI_AP_CHANNEL;
+
+// Scan cache, written by the WiFi application task and read by the HTTP server
+typedef struct wifi_app_scan_entry
+{
+	wifi_app_scan_result_t result;
+	int64_t last_seen_us;
+} wifi_app_scan_entry_t;
+
+static struct
+{
+	wifi_app_scan_entry_t entries[WIFI_SCAN_MAX_RESULTS];
+	uint8_t count;
+	bool scanning;
+	int64_t started_us;				///> START_SCAN accepted at this time
+	int64_t updated_us;				///> 0 = never scanned
+} g_scan_cache;
+static SemaphoreHandle_t g_scan_cache_mutex;
+static StaticSemaphore_t g_scan_cache_mutex_buffer;
+
+// Raw records of the last scan, only touched by the WiFi application task
+#define WIFI_SCAN_MAX_RECORDS		32
+static wifi_ap_record_t g_scan_records[WIFI_SCAN_MAX_RECORDS];
+
+// Control events from the event loop that the task queue refused, sent again by g_control_timer
+typedef struct wifi_app_control
+{
+	wifi_app_message_e msgID;
+	bool has_payload;
+	event_payload_t payload;
+} wifi_app_control_t;
+
+static struct
+{
+	wifi_app_control_t entries[WIFI_CONTROL_PENDING_MAX];
+	uint8_t head;
+	uint8_t count;
+} g_control_pending;
+static portMUX_TYPE g_control_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t g_control_timer;
+
+static const wifi_reconnect_config_t g_reconnect_config = {
+		.base_delay_ms = WIFI_STA_RETRY_BASE_MS,
+		.max_delay_ms = WIFI_STA_RETRY_MAX_MS,
+		.max_retries = MAX_CONNECTION_RETRIES,
+		.breaker_ms = WIFI_STA_CIRCUIT_BREAKER_MS,
+};
+
+/**
+ * Sends the control events that missed the task queue again, oldest first.
+ * Runs from g_control_timer and re-arms it while an event is still refused.
+ */
+static void wifi_app_control_timer_cb(void *arg)
+{
+	for (;;)
+	{
+		// Only this callback removes entries, the head stays put while it is published
+		taskENTER_CRITICAL(&g_control_lock);
+		uint8_t count = g_control_pending.count;
+		const wifi_app_control_t *control = &g_control_pending.entries[g_control_pending.head];
+		taskEXIT_CRITICAL(&g_control_lock);
+
+		if (count == 0)
+		{
+			return;
+		}
+		if (!event_bus_publish_control(EVENT_TOPIC_WIFI_APP, control->msgID, control->has_payload ? &control->payload : NULL))
+		{
+			esp_timer_start_once(g_control_timer, (uint64_t)WIFI_CONTROL_RETRY_MS * 1000);
+			return;
+		}
+
+		taskENTER_CRITICAL(&g_control_lock);
+		g_control_pending.head = (g_control_pending.head + 1) % WIFI_CONTROL_PENDING_MAX;
+		g_control_pending.count--;
+		taskEXIT_CRITICAL(&g_control_lock);
+	}
+}
+
+/**
+ * Publishes an event the WiFi task's state depends on from the event loop task.
+ * An event the task queue refuses is kept and sent again from g_control_timer, so the
+ * event loop never waits. Events queued behind a refused one keep their order.
+ * @return false if the event was lost because WIFI_CONTROL_PENDING_MAX events are already waiting.
+ */
+static bool wifi_app_send_control(wifi_app_message_e msgID, const event_payload_t *payload)
+{
+	taskENTER_CRITICAL(&g_control_lock);
+	uint8_t count = g_control_pending.count;
+	taskEXIT_CRITICAL(&g_control_lock);
+
+	if (count == 0 && event_bus_publish_control(EVENT_TOPIC_WIFI_APP, msgID, payload))
+	{
+		return true;
+	}
+
+	taskENTER_CRITICAL(&g_control_lock);
+	count = g_control_pending.count;
+	if (count < WIFI_CONTROL_PENDING_MAX)
+	{
+		wifi_app_control_t *control = &g_control_pending.entries[(g_control_pending.head + count) % WIFI_CONTROL_PENDING_MAX];
+
+		control->msgID = msgID;
+		control->has_payload = payload != NULL;
+		if (payload)
+		{
+			control->payload = *payload;
+		}
+		g_control_pending.count++;
+	}
+	taskEXIT_CRITICAL(&g_control_lock);
+
+	if (count == WIFI_CONTROL_PENDING_MAX)
+	{
+		ESP_LOGE(TAG, "Message %d lost, %d control events are already waiting for the task queue", msgID, WIFI_CONTROL_PENDING_MAX);
+		return false;
+	}
+
+	// Already armed if an older event is waiting, the start is refused then
+	esp_timer_start_once(g_control_timer, (uint64_t)WIFI_CONTROL_RETRY_MS * 1000);
+	return true;
+}
+
 /**
  * WiFi application event handler
  * @param arg data, aside from event data, that is passed to the handler when it is called
@@ -39,12 +190,15 @@ esp_netif_t* esp_netif_ap  = NULL;
  */
 static void wifi_app_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
 {
+	TRACE_SCOPE(TRACE_EV_WIFI_EVENT, event_id);
+
 	if (event_base == WIFI_EVENT)
 	{
 		switch (event_id)
 		{
 			case WIFI_EVENT_AP_START:
 				ESP_LOGI(TAG, "WIFI_EVENT_AP_START");
+				boot_profile_mark(BOOT_PHASE_AP_STARTED);
 				// Log the AP IP address
 				esp_netif_ip_info_t ip_info;
 				esp_netif_get_ip_info(esp_netif_ap, &ip_info);
@@ -69,6 +223,11 @@ static void wifi_app_event_handler(void *arg, esp_event_base_t event_base, int32
 				}
 				break;
 
+			case WIFI_EVENT_SCAN_DONE:
+				ESP_LOGI(TAG, "WIFI_EVENT_SCAN_DONE");
+				wifi_app_send_control(WIFI_APP_MSG_SCAN_DONE, NULL);
+				break;
+
 			case WIFI_EVENT_STA_START:
 				ESP_LOGI(TAG, "WIFI_EVENT_STA_START");
 				break;
@@ -78,7 +237,13 @@ static void wifi_app_event_handler(void *arg, esp_event_base_t event_base, int32
 				break;
 
 			case WIFI_EVENT_STA_DISCONNECTED:
-				ESP_LOGI(TAG, "WIFI_EVENT_STA_DISCONNECTED");
+				{
+					wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
+					event_payload_t payload = { .sta_disconnected = { .reason = event->reason, .rssi = event->rssi } };
+					ESP_LOGI(TAG, "WIFI_EVENT_STA_DISCONNECTED, reason %d", event->reason);
+					http_cache_invalidate(HTTP_CACHE_SETTINGS_IP);
+					wifi_app_send_control(WIFI_APP_MSG_STA_DISCONNECTED, &payload);
+				}
 				break;
 		}
 	}
@@ -86,11 +251,32 @@ static void wifi_app_event_handler(void *arg, esp_event_base_t event_base, int32
 	{
 		switch (event_id)
 		{
+			case IP_EVENT_STA_LOST_IP:
+				ESP_LOGI(TAG, "IP_EVENT_STA_LOST_IP");
+				http_cache_invalidate(HTTP_CACHE_SETTINGS_IP);
+				break;
+
 			case IP_EVENT_STA_GOT_IP:
 				{
 					ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
 					ESP_LOGI(TAG, "IP_EVENT_STA_GOT_IP");
 					ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
+
+					boot_profile_mark(BOOT_PHASE_STA_GOT_IP);
+					http_cache_invalidate(HTTP_CACHE_SETTINGS_IP);
+					if (g_wifi_app_metrics.time_to_ip_us == 0)
+					{
+						g_wifi_app_metrics.time_to_ip_us = esp_timer_get_time() - g_wifi_app_metrics.app_main_us;
+						ESP_LOGI(TAG, "Time to IP: %d ms", (int)(g_wifi_app_metrics.time_to_ip_us / 1000));
+					}
+					event_payload_t payload = {
+							.ip = {
+									.ip = event->ip_info.ip.addr,
+									.netmask = event->ip_info.netmask.addr,
+									.gw = event->ip_info.gw.addr,
+							},
+					};
+					wifi_app_send_control(WIFI_APP_MSG_STA_CONNECTED_GOT_IP, &payload);
 				}
 				break;
 		}
@@ -101,10 +287,7 @@ static void wifi_app_event_handler(void *arg, esp_event_base_t event_base, int32
  */
 static void wifi_app_event_handler_init(void)
 {
-	// Event loop for the WiFi driver
-	ESP_ERROR_CHECK(esp_event_loop_create_default());
-
-	// Event handler for the connection
+	// Event handler for the connection (the default event loop is created in app_main)
 	esp_event_handler_instance_t instance_wifi_event;
 	esp_event_handler_instance_t instance_ip_event;
 	ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_app_event_handler, NULL, &instance_wifi_event));
@@ -128,24 +311,35 @@ static void wifi_app_default_wifi_init(void)
 }
 
 /**
- * Configures the WiFi access point settings and assigns the static IP to the SoftAP.
+ * Fills the SoftAP configuration.
+ * @param ap_config configuration to fill.
+ * @param channel AP channel.
  */
-static void wifi_app_soft_ap_config(void)
+static void wifi_app_soft_ap_fill_config(wifi_config_t *ap_config, uint8_t channel)
 {
-	// SoftAP - WiFi access point configuration
-	wifi_config_t ap_config =
+	*ap_config = (wifi_config_t)
 	{
 		.ap = {
 				.ssid = WIFI_AP_SSID,
 				.ssid_len = strlen(WIFI_AP_SSID),
 				.password = WIFI_AP_PASSWORD,
-				.channel = WIFI_AP_CHANNEL,
+				.channel = channel,
 				.ssid_hidden = WIFI_AP_SSID_HIDDEN,
 				.authmode = WIFI_AUTH_WPA2_PSK,
 				.max_connection = WIFI_AP_MAX_CONNECTIONS,
 				.beacon_interval = WIFI_AP_BEACON_INTERVAL,
 		},
 	};
+}
+
+/**
+ * Configures the WiFi access point settings and assigns the static IP to the SoftAP.
+ */
+static void wifi_app_soft_ap_config(void)
+{
+	// SoftAP - WiFi access point configuration
+	wifi_config_t ap_config;
+	wifi_app_soft_ap_fill_config(&ap_config, g_ap_channel);
 
 	// Configure DHCP for the AP
 	esp_netif_ip_info_t ap_ip_info;
@@ -165,39 +359,408 @@ static void wifi_app_soft_ap_config(void)
 }
 
 /**
- * Configures the WiFi station settings from NVS data
+ * Applies the optional static IP so the STA skips DHCP entirely.
+ * @param static_ip static IPv4 settings from the config record.
+ */
+static void wifi_app_sta_static_ip_config(const nvs_static_ip_t *static_ip)
+{
+	if (!static_ip->enabled)
+	{
+		return;
+	}
+
+	esp_netif_ip_info_t ip_info = {
+			.ip.addr = static_ip->ip,
+			.netmask.addr = static_ip->netmask,
+			.gw.addr = static_ip->gw,
+	};
+
+	esp_netif_dhcpc_stop(esp_netif_sta);								///> may already be stopped
+	ESP_ERROR_CHECK(esp_netif_set_ip_info(esp_netif_sta, &ip_info));
+	http_cache_invalidate(HTTP_CACHE_SETTINGS_IP);
+
+	if (static_ip->dns != 0)
+	{
+		esp_netif_dns_info_t dns_info = { 0 };
+		dns_info.ip.type = ESP_IPADDR_TYPE_V4;
+		dns_info.ip.u_addr.ip4.addr = static_ip->dns;
+		esp_netif_set_dns_info(esp_netif_sta, ESP_NETIF_DNS_MAIN, &dns_info);
+	}
+
+	g_wifi_app_metrics.static_ip = true;
+	ESP_LOGI(TAG, "STA static IP: " IPSTR, IP2STR(&ip_info.ip));
+}
+
+/**
+ * Configures the WiFi station settings from NVS data.
+ * If the last good BSSID and channel are cached, the STA connects to that AP directly
+ * instead of scanning all channels.
  */
 static void wifi_app_sta_config(void)
 {
-    nvs_network_data_t network_data;
-    
-    // Load network data from NVS
-    esp_err_t ret = nvs_load_network_data(&network_data);
-    if (ret == ESP_OK && strlen(network_data.ssid) > 0)
-    {
-        ESP_LOGI(TAG, "Found STA configuration in NVS - SSID: %s", network_data.ssid);
-        
-        wifi_config_t wifi_config = {0};
-        strncpy((char*)wifi_config.sta.ssid, network_data.ssid, sizeof(wifi_config.sta.ssid)-1);
-        strncpy((char*)wifi_config.sta.password, network_data.password, sizeof(wifi_config.sta.password)-1);
-        
-        // Ensure null termination
-        wifi_config.sta.ssid[sizeof(wifi_config.sta.ssid)-1] = '\0';
-        wifi_config.sta.password[sizeof(wifi_config.sta.password)-1] = '\0';
-        
-        // Set WiFi mode first if not already set
-        esp_wifi_set_mode(WIFI_MODE_APSTA);
-        
-        ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
-        ESP_LOGI(TAG, "STA configuration set from NVS");
-        
-        // Try to connect to the STA
-        esp_wifi_connect();
-    }
-    else
-    {
-        ESP_LOGI(TAG, "No STA configuration found in NVS or error loading: %s", esp_err_to_name(ret));
-    }
+	nvs_config_t cfg;
+
+	// Config record is already cached in RAM by nvs_init_storage
+	nvs_config_get(&cfg);
+	if (strlen(cfg.network.ssid) == 0)
+	{
+		ESP_LOGI(TAG, "No STA configuration found in NVS");
+		return;
+	}
+
+	ESP_LOGI(TAG, "Found STA configuration in NVS - SSID: %s", cfg.network.ssid);
+
+	wifi_config_t wifi_config = {0};
+	strncpy((char*)wifi_config.sta.ssid, cfg.network.ssid, sizeof(wifi_config.sta.ssid));
+	strncpy((char*)wifi_config.sta.password, cfg.network.password, sizeof(wifi_config.sta.password));
+
+	if (cfg.sta_cache.channel != 0)
+	{
+		memcpy(wifi_config.sta.bssid, cfg.sta_cache.bssid, sizeof(wifi_config.sta.bssid));
+		wifi_config.sta.bssid_set = true;
+		wifi_config.sta.channel = cfg.sta_cache.channel;
+		g_fast_connect_pending = true;
+		g_wifi_app_metrics.fast_connect = true;
+		ESP_LOGI(TAG, "Fast connect to " MACSTR " on channel %d", MAC2STR(cfg.sta_cache.bssid), cfg.sta_cache.channel);
+	}
+
+	ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
+	ESP_LOGI(TAG, "STA configuration set from NVS");
+
+	wifi_app_sta_static_ip_config(&cfg.static_ip);
+
+	g_sta_configured = true;
+}
+
+/**
+ * Directed connect failed - drop the cached BSSID/channel so the next attempt does a full scan.
+ */
+static void wifi_app_sta_fast_connect_fallback(void)
+{
+	wifi_config_t wifi_config;
+
+	g_fast_connect_pending = false;
+	ESP_LOGW(TAG, "Fast connect failed, falling back to full scan");
+
+	ESP_ERROR_CHECK(esp_wifi_get_config(ESP_IF_WIFI_STA, &wifi_config));
+	wifi_config.sta.bssid_set = false;
+	wifi_config.sta.channel = 0;
+	ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
+}
+
+/**
+ * nvs_config_update function: sets the cached AP to ctx (wifi_ap_record_t), false if it is the same.
+ */
+static bool wifi_app_sta_cache_store(nvs_config_t *cfg, void *ctx)
+{
+	const wifi_ap_record_t *ap_info = ctx;
+
+	if (cfg->sta_cache.channel == ap_info->primary && memcmp(cfg->sta_cache.bssid, ap_info->bssid, sizeof(cfg->sta_cache.bssid)) == 0)
+	{
+		return false;
+	}
+
+	memcpy(cfg->sta_cache.bssid, ap_info->bssid, sizeof(cfg->sta_cache.bssid));
+	cfg->sta_cache.channel = ap_info->primary;
+	ESP_LOGI(TAG, "Caching AP " MACSTR " on channel %d", MAC2STR(ap_info->bssid), ap_info->primary);
+	return true;
+}
+
+/**
+ * Stores the BSSID and channel of the current AP, if they changed since the last connect.
+ */
+static void wifi_app_sta_cache_update(void)
+{
+	wifi_ap_record_t ap_info;
+
+	if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK)
+	{
+		return;
+	}
+
+	nvs_config_update(wifi_app_sta_cache_store, &ap_info);
+}
+
+/**
+ * SoftAP policy timer callback, the STA has been connected for the whole stable period.
+ */
+static void wifi_app_ap_policy_timer_cb(void *arg)
+{
+	// A lost expiry would leave the SoftAP policy unapplied: try again shortly
+	if (!event_bus_publish_control(EVENT_TOPIC_WIFI_APP, WIFI_APP_MSG_AP_POLICY_TIMER, NULL))
+	{
+		esp_timer_start_once(g_ap_policy_timer, (uint64_t)WIFI_CONTROL_RETRY_MS * 1000);
+	}
+}
+
+/**
+ * Button ISR callback, brings the SoftAP back.
+ */
+static void IRAM_ATTR wifi_app_button_isr_cb(void)
+{
+	BaseType_t higher_prio_woken = pdFALSE;
+
+	event_bus_publish_from_isr(EVENT_TOPIC_WIFI_APP, WIFI_APP_MSG_AP_RESTORE, NULL, &higher_prio_woken);
+	portYIELD_FROM_ISR(higher_prio_woken);
+}
+
+/**
+ * (Re)starts the stable period after which the SoftAP policy applies.
+ */
+static void wifi_app_ap_policy_arm(void)
+{
+#if !CONFIG_WIFI_APP_AP_POLICY_ALWAYS
+	esp_timer_stop(g_ap_policy_timer);
+	esp_timer_start_once(g_ap_policy_timer, (uint64_t)WIFI_AP_STABLE_PERIOD_MS * 1000);
+#endif
+}
+
+/**
+ * Applies the SoftAP policy after the STA has been stable for WIFI_AP_STABLE_PERIOD_MS.
+ */
+static void wifi_app_ap_policy_apply(void)
+{
+	wifi_ap_record_t ap_info;
+
+	if (g_reconnect.state != WIFI_RECONNECT_CONNECTED || esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK)
+	{
+		return;
+	}
+
+#if CONFIG_WIFI_APP_AP_POLICY_DISABLE
+	wifi_sta_list_t sta_list;
+
+	// Don't pull the page from under a user configuring the device - try again later
+	if (g_ap_active && esp_wifi_ap_get_sta_list(&sta_list) == ESP_OK && sta_list.num > 0)
+	{
+		ESP_LOGI(TAG, "SoftAP policy: %d client(s) on the AP, keeping it", sta_list.num);
+		wifi_app_ap_policy_arm();
+		return;
+	}
+	if (g_ap_active)
+	{
+		ESP_LOGI(TAG, "SoftAP policy: STA stable, disabling the SoftAP");
+		ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+		g_ap_active = false;
+	}
+	// Come back on the router's channel, so restoring the AP won't make the radio hop
+	g_ap_channel = ap_info.primary;
+#elif CONFIG_WIFI_APP_AP_POLICY_FOLLOW_STA
+	if (g_ap_active && g_ap_channel != ap_info.primary)
+	{
+		wifi_config_t ap_config;
+
+		ESP_LOGI(TAG, "SoftAP policy: moving the SoftAP to STA channel %d", ap_info.primary);
+		g_ap_channel = ap_info.primary;
+		wifi_app_soft_ap_fill_config(&ap_config, g_ap_channel);
+		ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_AP, &ap_config));
+	}
+#endif
+}
+
+/**
+ * Brings the SoftAP back (STA lost or button pressed).
+ */
+static void wifi_app_ap_restore(void)
+{
+	wifi_config_t ap_config;
+
+	if (g_ap_active)
+	{
+		return;
+	}
+
+	ESP_LOGI(TAG, "Restoring the SoftAP on channel %d", g_ap_channel);
+	ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
+	wifi_app_soft_ap_fill_config(&ap_config, g_ap_channel);
+	ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_AP, &ap_config));
+	g_ap_active = true;
+}
+
+/**
+ * Retry timer callback, hands the expiry over to the WiFi application task.
+ */
+static void wifi_app_reconnect_timer_cb(void *arg)
+{
+	// A lost expiry would leave the state machine in BACKOFF for good: try again shortly
+	if (!event_bus_publish_control(EVENT_TOPIC_WIFI_APP, WIFI_APP_MSG_STA_RECONNECT_TIMER, NULL))
+	{
+		esp_timer_start_once(g_reconnect_timer, (uint64_t)WIFI_CONTROL_RETRY_MS * 1000);
+	}
+}
+
+/**
+ * Runs an event through the connection state machine and executes the resulting actions.
+ * @param event connection event.
+ */
+static void wifi_app_reconnect_event(wifi_reconnect_event_e event)
+{
+	wifi_reconnect_state_e prev_state = g_reconnect.state;
+	wifi_reconnect_action_t action = wifi_reconnect_handle(&g_reconnect, event);
+
+	if (g_reconnect.state != prev_state)
+	{
+		ESP_LOGI(TAG, "STA %s -> %s", wifi_reconnect_state_name(prev_state), wifi_reconnect_state_name(g_reconnect.state));
+
+		// SoftAP policy: arm on a stable STA, undo on STA loss
+		if (g_reconnect.state == WIFI_RECONNECT_CONNECTED)
+		{
+			wifi_app_ap_policy_arm();
+		}
+		else if (prev_state == WIFI_RECONNECT_CONNECTED)
+		{
+			esp_timer_stop(g_ap_policy_timer);
+			wifi_app_ap_restore();
+		}
+	}
+
+	if (esp_timer_is_active(g_reconnect_timer))
+	{
+		esp_timer_stop(g_reconnect_timer);
+	}
+	if (action.timer_ms)
+	{
+		ESP_LOGI(TAG, "STA retry in %d ms", (int)action.timer_ms);
+		esp_timer_start_once(g_reconnect_timer, (uint64_t)action.timer_ms * 1000);
+	}
+
+	if (action.connect)
+	{
+		g_wifi_app_metrics.connect_attempts++;
+		esp_wifi_connect();
+	}
+
+	switch (action.report)
+	{
+		case WIFI_RECONNECT_REPORT_ATTEMPT:
+			http_server_monitor_send_message(HTTP_MSG_WIFI_CONNECT_INIT);
+			break;
+
+		case WIFI_RECONNECT_REPORT_CONNECTED:
+			http_server_monitor_send_message(HTTP_MSG_WIFI_CONNECT_SUCCESS);
+			break;
+
+		case WIFI_RECONNECT_REPORT_FAILED:
+			g_wifi_app_metrics.circuit_breaks++;
+			http_server_monitor_send_message(HTTP_MSG_WIFI_CONNECT_FAIL);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * Starts a non-blocking scan, results arrive with WIFI_EVENT_SCAN_DONE.
+ * Short per-channel dwell and regular returns to the home channel keep SoftAP clients served.
+ */
+static void wifi_app_scan_start(void)
+{
+	wifi_scan_config_t scan_config = {
+			.show_hidden = false,
+			.scan_type = WIFI_SCAN_TYPE_ACTIVE,
+			.scan_time.active.min = 0,
+			.scan_time.active.max = WIFI_SCAN_CHANNEL_MAX_MS,
+			.home_chan_dwell_time = WIFI_SCAN_HOME_DWELL_MS,
+	};
+
+	esp_err_t err = esp_wifi_scan_start(&scan_config, false);
+	if (err != ESP_OK)
+	{
+		// e.g. the STA is in the middle of connecting - keep the old results
+		ESP_LOGW(TAG, "Scan not started: %s", esp_err_to_name(err));
+		xSemaphoreTake(g_scan_cache_mutex, portMAX_DELAY);
+		g_scan_cache.scanning = false;
+		xSemaphoreGive(g_scan_cache_mutex);
+	}
+}
+
+/**
+ * Merges one scan into the cache: networks are deduplicated by SSID keeping the strongest AP,
+ * networks not seen for WIFI_SCAN_ENTRY_TTL_MS are dropped and the result is sorted by RSSI.
+ */
+static void wifi_app_scan_done(void)
+{
+	uint16_t num = WIFI_SCAN_MAX_RECORDS;
+	int64_t now = esp_timer_get_time();
+
+	if (esp_wifi_scan_get_ap_records(&num, g_scan_records) != ESP_OK)
+	{
+		num = 0;
+	}
+
+	xSemaphoreTake(g_scan_cache_mutex, portMAX_DELAY);
+
+	// Age out networks that stopped showing up
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < g_scan_cache.count; i++)
+	{
+		if (now - g_scan_cache.entries[i].last_seen_us < (int64_t)WIFI_SCAN_ENTRY_TTL_MS * 1000)
+		{
+			g_scan_cache.entries[count++] = g_scan_cache.entries[i];
+		}
+	}
+
+	for (uint16_t r = 0; r < num; r++)
+	{
+		const wifi_ap_record_t *rec = &g_scan_records[r];
+		wifi_app_scan_entry_t *entry = NULL;
+
+		if (rec->ssid[0] == '\0')
+		{
+			continue;
+		}
+
+		for (uint8_t i = 0; i < count; i++)
+		{
+			if (strncmp(g_scan_cache.entries[i].result.ssid, (const char*)rec->ssid, MAX_SSID_LENGTH) == 0)
+			{
+				entry = &g_scan_cache.entries[i];
+				break;
+			}
+		}
+
+		if (entry == NULL)
+		{
+			if (count == WIFI_SCAN_MAX_RESULTS)
+			{
+				continue;
+			}
+			entry = &g_scan_cache.entries[count++];
+			strlcpy(entry->result.ssid, (const char*)rec->ssid, sizeof(entry->result.ssid));
+		}
+		else if (entry->last_seen_us == now && entry->result.rssi >= rec->rssi)
+		{
+			// Weaker AP of a network already seen in this scan
+			continue;
+		}
+
+		entry->result.rssi = rec->rssi;
+		entry->result.channel = rec->primary;
+		entry->result.authmode = rec->authmode;
+		entry->last_seen_us = now;
+	}
+
+	// Insertion sort by RSSI, strongest first - the list is short and mostly sorted already
+	for (uint8_t i = 1; i < count; i++)
+	{
+		wifi_app_scan_entry_t tmp = g_scan_cache.entries[i];
+		int j = i - 1;
+		while (j >= 0 && g_scan_cache.entries[j].result.rssi < tmp.result.rssi)
+		{
+			g_scan_cache.entries[j + 1] = g_scan_cache.entries[j];
+			j--;
+		}
+		g_scan_cache.entries[j + 1] = tmp;
+	}
+
+	g_scan_cache.count = count;
+	g_scan_cache.scanning = false;
+	g_scan_cache.updated_us = now;
+
+	xSemaphoreGive(g_scan_cache_mutex);
+
+	ESP_LOGI(TAG, "Scan done: %d records, %d networks cached", num, count);
 }
 
 /**
@@ -206,35 +769,76 @@ static void wifi_app_sta_config(void)
  */
 static void wifi_app_task(void *pvParameters)
 {
-	wifi_app_queue_message_t msg;
+	const event_t *msg;
+
+	// Retry of the control events refused by the task queue, needed before the first event
+	const esp_timer_create_args_t control_timer_args = {
+			.callback = &wifi_app_control_timer_cb,
+			.arg = NULL,
+			.dispatch_method = ESP_TIMER_TASK,
+			.name = "wifi_control"
+	};
+	ESP_ERROR_CHECK(esp_timer_create(&control_timer_args, &g_control_timer));
 
 	// Initialize the event handler
 	wifi_app_event_handler_init();
 
+	// Connection state machine
+	const esp_timer_create_args_t reconnect_timer_args = {
+			.callback = &wifi_app_reconnect_timer_cb,
+			.arg = NULL,
+			.dispatch_method = ESP_TIMER_TASK,
+			.name = "wifi_reconnect"
+	};
+	ESP_ERROR_CHECK(esp_timer_create(&reconnect_timer_args, &g_reconnect_timer));
+	wifi_reconnect_init(&g_reconnect, &g_reconnect_config, esp_random());
+
+	// SoftAP policy
+	const esp_timer_create_args_t ap_policy_timer_args = {
+			.callback = &wifi_app_ap_policy_timer_cb,
+			.arg = NULL,
+			.dispatch_method = ESP_TIMER_TASK,
+			.name = "wifi_ap_policy"
+	};
+	ESP_ERROR_CHECK(esp_timer_create(&ap_policy_timer_args, &g_ap_policy_timer));
+#if CONFIG_WIFI_APP_AP_BUTTON_GPIO >= 0
+	ESP_ERROR_CHECK(io_button_init(CONFIG_WIFI_APP_AP_BUTTON_GPIO, wifi_app_button_isr_cb));
+#endif
+
 	// Initialize the TCP/IP stack and WiFi config
+	boot_profile_begin(BOOT_PHASE_WIFI_INIT);
 	wifi_app_default_wifi_init();
+	boot_profile_end(BOOT_PHASE_WIFI_INIT);
 
 	// SoftAP config
+	boot_profile_begin(BOOT_PHASE_AP_CONFIG);
 	wifi_app_soft_ap_config();
+	boot_profile_end(BOOT_PHASE_AP_CONFIG);
 
 	// Configure STA from NVS if available
+	boot_profile_begin(BOOT_PHASE_STA_CONFIG);
 	wifi_app_sta_config();
+	boot_profile_end(BOOT_PHASE_STA_CONFIG);
 
 	// Start WiFi
+	boot_profile_begin(BOOT_PHASE_WIFI_START);
 	ESP_ERROR_CHECK(esp_wifi_start());
+	boot_profile_end(BOOT_PHASE_WIFI_START);
 
 	// Connect STA after WiFi has started
-	ESP_LOGI(TAG, "Connecting STA if configured...");
-	esp_wifi_connect();
-
-	// Send first event message
-	wifi_app_send_message(WIFI_APP_MSG_START_HTTP_SERVER);
+	if (g_sta_configured)
+	{
+		ESP_LOGI(TAG, "Connecting STA...");
+		wifi_app_reconnect_event(WIFI_RECONNECT_EV_START);
+	}
 
 	for (;;)
 	{
-		if (xQueueReceive(wifi_app_queue_handle, &msg, portMAX_DELAY))
+		if ((msg = event_bus_receive(wifi_app_queue_handle, portMAX_DELAY)) != NULL)
 		{
-			switch (msg.msgID)
+			TRACE_SCOPE(TRACE_EV_WIFI_MSG, msg->id);
+
+			switch (msg->id)
 			{
 				case WIFI_APP_MSG_START_HTTP_SERVER:
 					ESP_LOGI(TAG, "WIFI_APP_MSG_START_HTTP_SERVER");
@@ -247,11 +851,75 @@ static void wifi_app_task(void *pvParameters)
 
 				case WIFI_APP_MSG_STA_CONNECTED_GOT_IP:
 					ESP_LOGI(TAG, "WIFI_APP_MSG_STA_CONNECTED_GOT_IP");
+					if (g_fast_connect_pending)
+					{
+						g_fast_connect_pending = false;
+						g_wifi_app_metrics.fast_connect_ok = true;
+					}
+					wifi_app_sta_cache_update();
+					wifi_app_reconnect_event(WIFI_RECONNECT_EV_GOT_IP);
+#if CONFIG_UDP_CTRL_ENABLE
+					udp_ctrl_join_multicast(msg->data.ip.ip);
+#endif
+#if CONFIG_MQTT_APP_ENABLE
+					mqtt_app_start();
+#endif
+					break;
+
+				case WIFI_APP_MSG_STA_DISCONNECTED:
+					ESP_LOGI(TAG, "WIFI_APP_MSG_STA_DISCONNECTED");
+					if (g_fast_connect_pending && g_reconnect.state == WIFI_RECONNECT_CONNECTING)
+					{
+						// Retry right away with a full scan, without counting it as a failure
+						wifi_app_sta_fast_connect_fallback();
+						wifi_app_reconnect_event(WIFI_RECONNECT_EV_START);
+					}
+					else
+					{
+						wifi_app_reconnect_event(WIFI_RECONNECT_EV_DISCONNECTED);
+					}
+					break;
+
+				case WIFI_APP_MSG_STA_RECONNECT_TIMER:
+					ESP_LOGI(TAG, "WIFI_APP_MSG_STA_RECONNECT_TIMER");
+					wifi_app_reconnect_event(WIFI_RECONNECT_EV_TIMER);
+					break;
+
+				case WIFI_APP_MSG_AP_POLICY_TIMER:
+					ESP_LOGI(TAG, "WIFI_APP_MSG_AP_POLICY_TIMER");
+					wifi_app_ap_policy_apply();
+					break;
+
+				case WIFI_APP_MSG_AP_RESTORE:
+					ESP_LOGI(TAG, "WIFI_APP_MSG_AP_RESTORE");
+					wifi_app_ap_restore();
+					// Keep it up for a full stable period before the policy applies again
+					if (g_reconnect.state == WIFI_RECONNECT_CONNECTED)
+					{
+						wifi_app_ap_policy_arm();
+					}
+					break;
+
+				case WIFI_APP_MSG_START_SCAN:
+					ESP_LOGI(TAG, "WIFI_APP_MSG_START_SCAN");
+					wifi_app_scan_start();
+					break;
+
+				case WIFI_APP_MSG_SCAN_DONE:
+					wifi_app_scan_done();
+					break;
+
+				case WIFI_APP_MSG_USER_REQUESTED_STA_DISCONNECT:
+					ESP_LOGI(TAG, "WIFI_APP_MSG_USER_REQUESTED_STA_DISCONNECT");
+					wifi_app_reconnect_event(WIFI_RECONNECT_EV_STOP);
+					esp_wifi_disconnect();
 					break;
 
 				default:
 					break;
 			}
+
+			event_bus_release(msg);
 		}
 	}
 }
@@ -259,21 +927,83 @@ static void wifi_app_task(void *pvParameters)
 
 BaseType_t wifi_app_send_message(wifi_app_message_e msgID)
 {
-	wifi_app_queue_message_t msg;
-	msg.msgID = msgID;
-	return xQueueSend(wifi_app_queue_handle, &msg, portMAX_DELAY);
+	return event_bus_publish(EVENT_TOPIC_WIFI_APP, msgID, NULL) ? pdTRUE : pdFALSE;
+}
+
+bool wifi_app_scan_refresh(bool force)
+{
+	bool queued = true;
+	int64_t now = esp_timer_get_time();
+
+	xSemaphoreTake(g_scan_cache_mutex, portMAX_DELAY);
+	if (g_scan_cache.scanning && now - g_scan_cache.started_us > (int64_t)WIFI_SCAN_STALL_MS * 1000)
+	{
+		// The scan result never arrived (SCAN_DONE lost), don't report a scan in progress forever
+		ESP_LOGW(TAG, "Scan stalled, starting over");
+		g_scan_cache.scanning = false;
+	}
+	if (!g_scan_cache.scanning
+			&& (force || g_scan_cache.updated_us == 0 || now - g_scan_cache.updated_us > (int64_t)WIFI_SCAN_CACHE_TTL_MS * 1000))
+	{
+		// Never blocks: if the event is dropped, the next read retries
+		queued = event_bus_publish(EVENT_TOPIC_WIFI_APP, WIFI_APP_MSG_START_SCAN, NULL);
+		g_scan_cache.scanning = queued;
+		g_scan_cache.started_us = now;
+	}
+	xSemaphoreGive(g_scan_cache_mutex);
+
+	return queued;
+}
+
+void wifi_app_get_scan_results(wifi_app_scan_result_t *results, wifi_app_scan_info_t *info)
+{
+	xSemaphoreTake(g_scan_cache_mutex, portMAX_DELAY);
+	for (uint8_t i = 0; i < g_scan_cache.count; i++)
+	{
+		results[i] = g_scan_cache.entries[i].result;
+	}
+	info->count = g_scan_cache.count;
+	info->scanning = g_scan_cache.scanning;
+	info->age_ms = g_scan_cache.updated_us ? (esp_timer_get_time() - g_scan_cache.updated_us) / 1000 : -1;
+	xSemaphoreGive(g_scan_cache_mutex);
+}
+
+void wifi_app_get_metrics(wifi_app_metrics_t *metrics)
+{
+	*metrics = g_wifi_app_metrics;
+	metrics->sta_state = wifi_reconnect_state_name(g_reconnect.state);
+	metrics->ap_active = g_ap_active;
+	metrics->ap_channel = g_ap_channel;
+}
+
+int8_t wifi_app_get_rssi(void)
+{
+	wifi_ap_record_t ap_info;
+
+	if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK)
+	{
+		return 0;
+	}
+
+	return ap_info.rssi;
 }
 
 void wifi_app_start(void)
 {
 	ESP_LOGI(TAG, "STARTING WIFI APPLICATION");
 
+	g_wifi_app_metrics.app_main_us = boot_profile_get(BOOT_PHASE_APP_MAIN).begin_us;
+
 	// Disable default WiFi logging messages
 	esp_log_level_set("wifi", ESP_LOG_NONE);
 
-	// Create message queue
-	wifi_app_queue_handle = xQueueCreate(3, sizeof(wifi_app_queue_message_t));
+	// Create message queue and subscribe it to the WiFi application topic
+	wifi_app_queue_handle = event_bus_queue_create(STATIC_QUEUE_WIFI_APP);
+	ESP_ERROR_CHECK(event_bus_subscribe(EVENT_TOPIC_WIFI_APP, wifi_app_queue_handle));
+
+	// Scan cache lock
+	g_scan_cache_mutex = xSemaphoreCreateMutexStatic(&g_scan_cache_mutex_buffer);
 
 	// Start the WiFi application task
-	xTaskCreatePinnedToCore(&wifi_app_task, "wifi_app_task", WIFI_APP_TASK_STACK_SIZE, NULL, WIFI_APP_TASK_PRIORITY, NULL, WIFI_APP_TASK_CORE_ID);
+	static_alloc_task_create(STATIC_TASK_WIFI_APP, &wifi_app_task, NULL);
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #define MAIN_WIFI_APP_H_
 
 
+#include "sdkconfig.h"
 #include "esp_netif.h"
 #include "esp_wifi_types.h"
 #include "freertos/FreeRTOS.h"
@@ -31,7 +32,22 @@ typedef void (*wifi_connected_event_callback_t)(void);
 #define WIFI_STA_POWER_SAVE			WIFI_PS_NONE		// Power save not used
 #define MAX_SSID_LENGTH				32					// IEEE standard maximum
 #define MAX_PASSWORD_LENGTH			64					// IEEE standard maximum
+#define WIFI_APP_QUEUE_DEPTH		8					// Pending events of the WiFi application task
 #define MAX_CONNECTION_RETRIES		5					// Retry number on disconnect
+#define WIFI_STA_RETRY_BASE_MS		500					// First retry delay, doubled on every failure
+#define WIFI_STA_RETRY_MAX_MS		30000				// Backoff cap
+#define WIFI_STA_CIRCUIT_BREAKER_MS	120000				// Rest period after MAX_CONNECTION_RETRIES failures
+#if !CONFIG_WIFI_APP_AP_POLICY_ALWAYS
+#define WIFI_AP_STABLE_PERIOD_MS	(CONFIG_WIFI_APP_AP_STABLE_PERIOD * 1000)	// STA uptime before the SoftAP policy applies
+#endif
+#define WIFI_SCAN_MAX_RESULTS		20					// Networks kept in the scan cache
+#define WIFI_SCAN_CACHE_TTL_MS		15000				// Cache older than this is refreshed on the next read
+#define WIFI_SCAN_ENTRY_TTL_MS		60000				// Networks missing from scans for this long are dropped
+#define WIFI_SCAN_CHANNEL_MAX_MS	60					// Active scan time per channel
+#define WIFI_SCAN_HOME_DWELL_MS		30					// Time back on the SoftAP channel between scanned channels
+#define WIFI_SCAN_STALL_MS			10000				// A scan without a result after this long is given up
+#define WIFI_CONTROL_RETRY_MS		20					// Delay before a control event that missed the task queue is sent again
+#define WIFI_CONTROL_PENDING_MAX	4					// Control events of the event loop waiting for a retry
 
 // netif object for the Station and Access Point
 extern esp_netif_t* esp_netif_sta;
@@ -49,30 +65,86 @@ typedef enum wifi_app_message
 	WIFI_APP_MSG_USER_REQUESTED_STA_DISCONNECT,
 	WIFI_APP_MSG_LOAD_SAVED_CREDENTIALS,
 	WIFI_APP_MSG_STA_DISCONNECTED,
+	WIFI_APP_MSG_STA_RECONNECT_TIMER,
+	WIFI_APP_MSG_START_SCAN,
+	WIFI_APP_MSG_SCAN_DONE,
+	WIFI_APP_MSG_AP_POLICY_TIMER,
+	WIFI_APP_MSG_AP_RESTORE,
 } wifi_app_message_e;
 
+
+/**
+ * STA connection metrics
+ */
+typedef struct wifi_app_metrics
+{
+	int64_t app_main_us;		///> esp_timer timestamp taken at the start of app_main (boot profile)
+	int64_t time_to_ip_us;		///> app_main -> first IP_EVENT_STA_GOT_IP, 0 until connected
+	bool fast_connect;			///> directed connect to the cached BSSID/channel was attempted
+	bool fast_connect_ok;		///> ...and it got an IP without falling back to a full scan
+	bool static_ip;				///> STA uses the static IP from the config record
+	uint32_t connect_attempts;	///> esp_wifi_connect calls made by the connection state machine
+	uint32_t circuit_breaks;	///> times the retries were exhausted
+	const char *sta_state;		///> connection state name
+	bool ap_active;				///> SoftAP running
+	uint8_t ap_channel;			///> SoftAP channel
+} wifi_app_metrics_t;
+
+/**
+ * One network from the scan cache
+ */
+typedef struct wifi_app_scan_result
+{
+	char ssid[MAX_SSID_LENGTH + 1];
+	int8_t rssi;
+	uint8_t channel;
+	uint8_t authmode;			///> wifi_auth_mode_t
+} wifi_app_scan_result_t;
+
 /**
- * Structure for the message queue
- * @note Expand this based on application requirements e.g. add another type and parameter as required
+ * Scan cache state
  */
-typedef struct wifi_app_queue_message
+typedef struct wifi_app_scan_info
 {
-	wifi_app_message_e msgID;
-} wifi_app_queue_message_t;
+	uint8_t count;				///> valid entries in the result array
+	bool scanning;				///> refresh in progress
+	int64_t age_ms;				///> time since the last completed scan, -1 if none yet
+} wifi_app_scan_info_t;
 
 /**
- * Sends a message to the queue
+ * Publishes a message without payload on the WiFi application event bus topic.
+ * Never blocks, a full pool or queue drops the message (see event_bus_get_stats).
  * @param msgID message ID from the wifi_app_message_e enum.
- * @return pdTRUE if an item was successfully sent to the queue, otherwise pdFALSE.
- * @note Expand the parameter list based on your requirements e.g. how you've expanded the wifi_app_queue_message_t.
+ * @return pdTRUE if the WiFi application task got the message, otherwise pdFALSE.
  */
 BaseType_t wifi_app_send_message(wifi_app_message_e msgID);
 
 /**
- * Starts the WiFi RTOS task
+ * Starts the WiFi RTOS task, which brings up WiFi on its own core.
+ * Needs NVS, the TCP stack and the default event loop to be initialized.
  */
 void wifi_app_start(void);
 
+/**
+ * Gets the STA connection metrics.
+ * @param metrics destination for a copy of the metrics.
+ */
+void wifi_app_get_metrics(wifi_app_metrics_t *metrics);
+
+/**
+ * Requests a scan refresh without waiting for the radio.
+ * @param force refresh even if the cache is still fresh.
+ * @return true if a refresh was queued or is already running.
+ */
+bool wifi_app_scan_refresh(bool force);
+
+/**
+ * Copies the scan cache, sorted by RSSI (strongest first) and deduplicated by SSID.
+ * @param results destination array of WIFI_SCAN_MAX_RESULTS entries.
+ * @param info cache count, age and refresh flag.
+ */
+void wifi_app_get_scan_results(wifi_app_scan_result_t *results, wifi_app_scan_info_t *info);
+
 /**
  * Gets the wifi configuration
  */
@@ -90,7 +162,7 @@ void wifi_app_call_callback(void);
 
 /**
  * Gets the RSSI value of the Wifi connection.
- * @return current RSSI level.
+ * @return current RSSI level in dBm, 0 if the STA is not connected.
  */
 int8_t wifi_app_get_rssi(void);
 
@@ -0,0 +1,145 @@
+/*
+ * wifi_reconnect.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stddef.h>
+
+#include "wifi_reconnect.h"
+
+/**
+ * xorshift32 - enough randomness to spread retries of many devices apart.
+ */
+static uint32_t wifi_reconnect_rand(wifi_reconnect_t *rc)
+{
+	uint32_t x = rc->rng;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	rc->rng = x;
+	return x;
+}
+
+/**
+ * "Equal jitter": half of the delay is fixed, the other half is random.
+ * Devices that lost the same router keep a minimum spacing but never retry in lockstep.
+ */
+static uint32_t wifi_reconnect_jitter(wifi_reconnect_t *rc, uint32_t delay_ms)
+{
+	uint32_t half = delay_ms / 2;
+	return half + wifi_reconnect_rand(rc) % (delay_ms - half + 1);
+}
+
+/**
+ * Exponential backoff for the given retry number (1-based), capped at max_delay_ms.
+ */
+static uint32_t wifi_reconnect_backoff(wifi_reconnect_t *rc)
+{
+	uint32_t delay_ms = rc->cfg.base_delay_ms;
+
+	for (uint8_t i = 1; i < rc->retries && delay_ms < rc->cfg.max_delay_ms; i++)
+	{
+		delay_ms *= 2;
+	}
+	if (delay_ms > rc->cfg.max_delay_ms)
+	{
+		delay_ms = rc->cfg.max_delay_ms;
+	}
+
+	return wifi_reconnect_jitter(rc, delay_ms);
+}
+
+void wifi_reconnect_init(wifi_reconnect_t *rc, const wifi_reconnect_config_t *cfg, uint32_t seed)
+{
+	rc->cfg = *cfg;
+	rc->state = WIFI_RECONNECT_IDLE;
+	rc->retries = 0;
+	rc->rng = seed ? seed : 0x2545F491;
+}
+
+wifi_reconnect_action_t wifi_reconnect_handle(wifi_reconnect_t *rc, wifi_reconnect_event_e event)
+{
+	wifi_reconnect_action_t action = { 0 };
+
+	switch (event)
+	{
+		case WIFI_RECONNECT_EV_START:
+			rc->state = WIFI_RECONNECT_CONNECTING;
+			rc->retries = 0;
+			action.connect = true;
+			action.report = WIFI_RECONNECT_REPORT_ATTEMPT;
+			break;
+
+		case WIFI_RECONNECT_EV_GOT_IP:
+			if (rc->state != WIFI_RECONNECT_IDLE)
+			{
+				rc->state = WIFI_RECONNECT_CONNECTED;
+				rc->retries = 0;
+				action.report = WIFI_RECONNECT_REPORT_CONNECTED;
+			}
+			break;
+
+		case WIFI_RECONNECT_EV_DISCONNECTED:
+			// Disconnects while idle or already waiting are echoes of our own actions
+			if (rc->state != WIFI_RECONNECT_CONNECTING && rc->state != WIFI_RECONNECT_CONNECTED)
+			{
+				break;
+			}
+			if (rc->state == WIFI_RECONNECT_CONNECTED)
+			{
+				// Link lost - start a fresh round
+				rc->retries = 0;
+				action.report = WIFI_RECONNECT_REPORT_ATTEMPT;
+			}
+
+			if (++rc->retries > rc->cfg.max_retries)
+			{
+				rc->state = WIFI_RECONNECT_CIRCUIT_OPEN;
+				rc->retries = 0;
+				action.timer_ms = wifi_reconnect_jitter(rc, rc->cfg.breaker_ms);
+				action.report = WIFI_RECONNECT_REPORT_FAILED;
+			}
+			else
+			{
+				rc->state = WIFI_RECONNECT_BACKOFF;
+				action.timer_ms = wifi_reconnect_backoff(rc);
+			}
+			break;
+
+		case WIFI_RECONNECT_EV_TIMER:
+			if (rc->state == WIFI_RECONNECT_BACKOFF)
+			{
+				rc->state = WIFI_RECONNECT_CONNECTING;
+				action.connect = true;
+			}
+			else if (rc->state == WIFI_RECONNECT_CIRCUIT_OPEN)
+			{
+				rc->state = WIFI_RECONNECT_CONNECTING;
+				action.connect = true;
+				action.report = WIFI_RECONNECT_REPORT_ATTEMPT;
+			}
+			break;
+
+		case WIFI_RECONNECT_EV_STOP:
+			rc->state = WIFI_RECONNECT_IDLE;
+			rc->retries = 0;
+			break;
+	}
+
+	return action;
+}
+
+const char* wifi_reconnect_state_name(wifi_reconnect_state_e state)
+{
+	static const char *const names[] = {
+		[WIFI_RECONNECT_IDLE] = "idle",
+		[WIFI_RECONNECT_CONNECTING] = "connecting",
+		[WIFI_RECONNECT_CONNECTED] = "connected",
+		[WIFI_RECONNECT_BACKOFF] = "backoff",
+		[WIFI_RECONNECT_CIRCUIT_OPEN] = "circuit_open",
+	};
+
+	return state < sizeof(names) / sizeof(names[0]) ? names[state] : "unknown";
+}
@@ -0,0 +1,107 @@
+/*
+ * wifi_reconnect.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef MAIN_WIFI_RECONNECT_H_
+#define MAIN_WIFI_RECONNECT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * STA connection state machine.
+ * Pure logic without any ESP-IDF calls: wifi_app.c feeds it events and executes the returned actions.
+ */
+
+/**
+ * Connection states
+ */
+typedef enum wifi_reconnect_state
+{
+	WIFI_RECONNECT_IDLE = 0,			///> no credentials or the user disconnected
+	WIFI_RECONNECT_CONNECTING,			///> esp_wifi_connect issued, waiting for an IP
+	WIFI_RECONNECT_CONNECTED,
+	WIFI_RECONNECT_BACKOFF,				///> waiting for the retry timer
+	WIFI_RECONNECT_CIRCUIT_OPEN,		///> retries exhausted, resting before the next round
+} wifi_reconnect_state_e;
+
+/**
+ * Events fed into the state machine
+ */
+typedef enum wifi_reconnect_event
+{
+	WIFI_RECONNECT_EV_START = 0,		///> credentials available, start connecting
+	WIFI_RECONNECT_EV_GOT_IP,
+	WIFI_RECONNECT_EV_DISCONNECTED,
+	WIFI_RECONNECT_EV_TIMER,			///> retry / circuit-breaker timer expired
+	WIFI_RECONNECT_EV_STOP,				///> user requested disconnect
+} wifi_reconnect_event_e;
+
+/**
+ * Progress reported to the rest of the application
+ */
+typedef enum wifi_reconnect_report
+{
+	WIFI_RECONNECT_REPORT_NONE = 0,
+	WIFI_RECONNECT_REPORT_ATTEMPT,		///> first attempt of a new connection round
+	WIFI_RECONNECT_REPORT_CONNECTED,
+	WIFI_RECONNECT_REPORT_FAILED,		///> retries exhausted, circuit breaker opened
+} wifi_reconnect_report_e;
+
+/**
+ * Tuning parameters
+ */
+typedef struct wifi_reconnect_config
+{
+	uint32_t base_delay_ms;				///> delay before the first retry
+	uint32_t max_delay_ms;				///> cap of the exponential backoff
+	uint8_t max_retries;				///> retries before the circuit breaker opens
+	uint32_t breaker_ms;				///> circuit-breaker rest period
+} wifi_reconnect_config_t;
+
+/**
+ * What the caller has to do after an event
+ */
+typedef struct wifi_reconnect_action
+{
+	bool connect;						///> call esp_wifi_connect now
+	uint32_t timer_ms;					///> start the one-shot retry timer, 0 = no timer
+	wifi_reconnect_report_e report;
+} wifi_reconnect_action_t;
+
+/**
+ * State machine instance
+ */
+typedef struct wifi_reconnect
+{
+	wifi_reconnect_config_t cfg;
+	wifi_reconnect_state_e state;
+	uint8_t retries;
+	uint32_t rng;
+} wifi_reconnect_t;
+
+/**
+ * Initializes the state machine in the IDLE state.
+ * @param rc state machine instance.
+ * @param cfg tuning parameters.
+ * @param seed non-zero seed for the jitter generator, e.g. esp_random().
+ */
+void wifi_reconnect_init(wifi_reconnect_t *rc, const wifi_reconnect_config_t *cfg, uint32_t seed);
+
+/**
+ * Runs one event through the state machine.
+ * @param rc state machine instance.
+ * @param event event to process.
+ * @return actions the caller has to execute.
+ */
+wifi_reconnect_action_t wifi_reconnect_handle(wifi_reconnect_t *rc, wifi_reconnect_event_e event);
+
+/**
+ * Gets the name of a state, for logging.
+ */
+const char* wifi_reconnect_state_name(wifi_reconnect_state_e state);
+
+#endif /* MAIN_WIFI_RECONNECT_H_ */
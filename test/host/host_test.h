@@ -0,0 +1,78 @@
+/*
+ * host_test.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef TEST_HOST_HOST_TEST_H_
+#define TEST_HOST_HOST_TEST_H_
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Asserts of the host tests. A failed assert prints where and why and returns from the
+ * function it is in, RUN_TEST reports the test and goes on with the next one.
+ * main ends with return host_test_finish();
+ */
+
+static int g_host_test_failed = 0;				///> Failed asserts of the running test
+static int g_host_test_count = 0;
+static int g_host_test_failures = 0;
+
+#define TEST_FAIL_MSG(...) do {														\
+		printf("%s:%d: ", __FILE__, __LINE__);										\
+		printf(__VA_ARGS__);														\
+		printf("\n");																\
+		g_host_test_failed++;														\
+		return;																		\
+	} while (0)
+
+#define TEST_ASSERT(cond) do {														\
+		if (!(cond))																\
+			TEST_FAIL_MSG("%s is false", #cond);									\
+	} while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) do {									\
+		long long exp_ = (long long)(expected);										\
+		long long act_ = (long long)(actual);										\
+		if (exp_ != act_)															\
+			TEST_FAIL_MSG("%s is %lld, expected %lld", #actual, act_, exp_);		\
+	} while (0)
+
+#define TEST_ASSERT_IN_RANGE(min, max, actual) do {									\
+		long long act_ = (long long)(actual);										\
+		if (act_ < (long long)(min) || act_ > (long long)(max))						\
+			TEST_FAIL_MSG("%s is %lld, expected %lld..%lld", #actual, act_,			\
+					(long long)(min), (long long)(max));							\
+	} while (0)
+
+#define TEST_ASSERT_EQUAL_STRING(expected, actual) do {								\
+		const char *exp_ = (expected);												\
+		const char *act_ = (actual);												\
+		if (strcmp(exp_, act_) != 0)												\
+			TEST_FAIL_MSG("%s is \"%s\", expected \"%s\"", #actual, act_, exp_);	\
+	} while (0)
+
+#define TEST_ASSERT_EQUAL_MEMORY(expected, actual, len) do {						\
+		if (memcmp((expected), (actual), (len)) != 0)								\
+			TEST_FAIL_MSG("%s differs from %s", #actual, #expected);				\
+	} while (0)
+
+#define RUN_TEST(test) do {															\
+		g_host_test_failed = 0;														\
+		test();																		\
+		g_host_test_count++;														\
+		if (g_host_test_failed)														\
+			g_host_test_failures++;													\
+		printf("%s %s\n", g_host_test_failed ? "FAIL" : "PASS", #test);				\
+	} while (0)
+
+static inline int host_test_finish(void)
+{
+	printf("%d tests, %d failed\n", g_host_test_count, g_host_test_failures);
+	return g_host_test_failures ? 1 : 0;
+}
+
+#endif /* TEST_HOST_HOST_TEST_H_ */
@@ -0,0 +1,16 @@
+/*
+ * esp_attr.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_ESP_ATTR_H_
+#define HOST_TEST_ESP_ATTR_H_
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#endif /* HOST_TEST_ESP_ATTR_H_ */
@@ -0,0 +1,14 @@
+/*
+ * esp_bit_defs.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_ESP_BIT_DEFS_H_
+#define HOST_TEST_ESP_BIT_DEFS_H_
+
+#define BIT(nr)							(1UL << (nr))
+#define BIT64(nr)						(1ULL << (nr))
+
+#endif /* HOST_TEST_ESP_BIT_DEFS_H_ */
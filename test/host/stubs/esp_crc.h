@@ -0,0 +1,19 @@
+/*
+ * esp_crc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_ESP_CRC_H_
+#define HOST_TEST_ESP_CRC_H_
+
+#include <stdint.h>
+
+/**
+ * CRC32 (IEEE 802.3, reflected) like the ROM function: crc is the result of the previous
+ * block, 0 to start.
+ */
+uint32_t esp_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#endif /* HOST_TEST_ESP_CRC_H_ */
@@ -0,0 +1,30 @@
+/*
+ * esp_event.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_ESP_EVENT_H_
+#define HOST_TEST_ESP_EVENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/*
+ * Event base declarations for the headers of components/host_mocks, no event loop runs in the tests.
+ */
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *handler_arg, esp_event_base_t base, int32_t id, void *event_data);
+
+#define ESP_EVENT_DECLARE_BASE(id)		extern esp_event_base_t const id
+#define ESP_EVENT_DEFINE_BASE(id)		esp_event_base_t const id = #id
+#define ESP_EVENT_ANY_ID				-1
+
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data, size_t size, TickType_t wait);
+
+#endif /* HOST_TEST_ESP_EVENT_H_ */
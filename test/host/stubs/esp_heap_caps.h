@@ -0,0 +1,24 @@
+/*
+ * esp_heap_caps.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_ESP_HEAP_CAPS_H_
+#define HOST_TEST_ESP_HEAP_CAPS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Heap statistics, defined by the tests that use them.
+ */
+
+#define MALLOC_CAP_8BIT				(1 << 2)
+
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#endif /* HOST_TEST_ESP_HEAP_CAPS_H_ */
@@ -0,0 +1,93 @@
+/*
+ * esp_http_server.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_ESP_HTTP_SERVER_H_
+#define HOST_TEST_ESP_HTTP_SERVER_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "esp_err.h"
+
+/*
+ * Requests are built by the tests. The response functions record what a handler answered
+ * in the request itself (httpd_stub.c), nothing is sent.
+ */
+
+#define HTTPD_MAX_URI_LEN				512
+#define HTTPD_RESP_USE_STRLEN			-1
+#define HTTPD_STUB_HEADERS_SIZE			256
+#define HTTPD_STUB_BODY_SIZE			2048
+
+#define HTTPD_SOCK_ERR_FAIL				-1
+#define HTTPD_SOCK_ERR_INVALID			-2
+#define HTTPD_SOCK_ERR_TIMEOUT			-3
+
+#define ESP_ERR_HTTPD_BASE				0xb000
+#define ESP_ERR_HTTPD_RESULT_TRUNC		(ESP_ERR_HTTPD_BASE + 4)
+
+typedef enum http_method
+{
+	HTTP_DELETE = 0,
+	HTTP_GET,
+	HTTP_HEAD,
+	HTTP_POST,
+	HTTP_PUT
+} httpd_method_t;
+
+// The codes main uses, with the values of ESP-IDF
+typedef enum
+{
+	HTTPD_500_INTERNAL_SERVER_ERROR = 0,
+	HTTPD_400_BAD_REQUEST = 3,
+	HTTPD_401_UNAUTHORIZED = 4,
+	HTTPD_404_NOT_FOUND = 6
+} httpd_err_code_t;
+
+typedef void *httpd_handle_t;
+typedef struct httpd_config httpd_config_t;
+
+typedef struct httpd_req
+{
+	httpd_handle_t handle;
+	int method;
+	char uri[HTTPD_MAX_URI_LEN + 1];
+	size_t content_len;
+	void *user_ctx;
+
+	// Host test fields
+	int sockfd;								///> httpd_req_to_sockfd
+	const char *content;					///> Body httpd_req_recv returns, content_len bytes
+	size_t received;						///> Bytes of content returned so far
+	const char *status;						///> Set by httpd_resp_set_status, NULL for 200 OK
+	const char *type;						///> Set by httpd_resp_set_type
+	char headers[HTTPD_STUB_HEADERS_SIZE];	///> "field: value\n" per httpd_resp_set_hdr
+	char body[HTTPD_STUB_BODY_SIZE];		///> Last httpd_resp_send, cut to fit
+	ssize_t body_len;						///> Length passed to httpd_resp_send, -1 if none
+} httpd_req_t;
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char *msg);
+int httpd_req_to_sockfd(httpd_req_t *r);
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len);
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len);
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size);
+
+/**
+ * Prepares a request of the tests, without a response yet.
+ */
+void httpd_stub_req_init(httpd_req_t *r, const char *uri, void *user_ctx);
+
+/**
+ * Gives a request of the tests a body, content must outlive the request.
+ */
+void httpd_stub_req_body(httpd_req_t *r, const char *content);
+
+#endif /* HOST_TEST_ESP_HTTP_SERVER_H_ */
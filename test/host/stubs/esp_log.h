@@ -0,0 +1,24 @@
+/*
+ * esp_log.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_ESP_LOG_H_
+#define HOST_TEST_ESP_LOG_H_
+
+/*
+ * Log lines of the modules under test go to stderr when HOST_TEST_VERBOSE is set in the
+ * environment, the test output stays readable otherwise.
+ */
+
+void host_stub_log(char level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, format, ...)		host_stub_log('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)		host_stub_log('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)		host_stub_log('I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)		host_stub_log('D', tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)		host_stub_log('V', tag, format, ##__VA_ARGS__)
+
+#endif /* HOST_TEST_ESP_LOG_H_ */
@@ -0,0 +1,48 @@
+/*
+ * esp_timer.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_ESP_TIMER_H_
+#define HOST_TEST_ESP_TIMER_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/*
+ * Timers never fire by themselves, a test fires them with host_stub_timer_fire (host_stubs.h).
+ */
+
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum
+{
+	ESP_TIMER_TASK,
+	ESP_TIMER_ISR,
+} esp_timer_dispatch_t;
+
+typedef struct
+{
+	esp_timer_cb_t callback;
+	void *arg;
+	esp_timer_dispatch_t dispatch_method;
+	const char *name;
+	bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+bool esp_timer_is_active(esp_timer_handle_t timer);
+
+/**
+ * Time of the tests, only moved by host_stub_set_time_us and host_stub_advance_us (host_stubs.h).
+ */
+int64_t esp_timer_get_time(void);
+
+#endif /* HOST_TEST_ESP_TIMER_H_ */
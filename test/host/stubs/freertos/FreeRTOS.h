@@ -0,0 +1,58 @@
+/*
+ * FreeRTOS.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_FREERTOS_H_
+#define HOST_TEST_FREERTOS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+/*
+ * The FreeRTOS subset used by the modules under test. Tests run on pthreads: every
+ * critical section takes one process-wide recursive mutex.
+ */
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE							1
+#define pdFALSE							0
+#define pdPASS							pdTRUE
+#define pdFAIL							pdFALSE
+#define portMAX_DELAY					((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ				CONFIG_FREERTOS_HZ
+#define portTICK_PERIOD_MS				(1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)				((TickType_t)((uint64_t)(ms) * configTICK_RATE_HZ / 1000))
+#define portNUM_PROCESSORS				2
+#define configMAX_TASK_NAME_LEN			16
+
+typedef struct
+{
+	int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED	{ 0 }
+
+void host_stub_critical_enter(portMUX_TYPE *mux);
+void host_stub_critical_exit(portMUX_TYPE *mux);
+
+#define taskENTER_CRITICAL(mux)			host_stub_critical_enter(mux)
+#define taskEXIT_CRITICAL(mux)			host_stub_critical_exit(mux)
+#define taskENTER_CRITICAL_ISR(mux)		host_stub_critical_enter(mux)
+#define taskEXIT_CRITICAL_ISR(mux)		host_stub_critical_exit(mux)
+#define portENTER_CRITICAL(mux)			host_stub_critical_enter(mux)
+#define portEXIT_CRITICAL(mux)			host_stub_critical_exit(mux)
+#define portENTER_CRITICAL_ISR(mux)		host_stub_critical_enter(mux)
+#define portEXIT_CRITICAL_ISR(mux)		host_stub_critical_exit(mux)
+#define taskENTER_CRITICAL_SAFE(mux)	host_stub_critical_enter(mux)
+#define taskEXIT_CRITICAL_SAFE(mux)		host_stub_critical_exit(mux)
+
+#endif /* HOST_TEST_FREERTOS_H_ */
@@ -0,0 +1,29 @@
+/*
+ * queue.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_FREERTOS_QUEUE_H_
+#define HOST_TEST_FREERTOS_QUEUE_H_
+
+#include "freertos/FreeRTOS.h"
+
+/*
+ * Copying FIFO queues on a pthread mutex and condition variable. Waits are real time:
+ * one tick is 1 / CONFIG_FREERTOS_HZ s.
+ */
+
+typedef struct host_stub_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t depth, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higher_prio_woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define xQueueSendToBack(queue, item, wait)		xQueueSend(queue, item, wait)
+
+#endif /* HOST_TEST_FREERTOS_QUEUE_H_ */
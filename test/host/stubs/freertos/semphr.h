@@ -0,0 +1,31 @@
+/*
+ * semphr.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_FREERTOS_SEMPHR_H_
+#define HOST_TEST_FREERTOS_SEMPHR_H_
+
+#include <pthread.h>
+
+#include "freertos/FreeRTOS.h"
+
+/*
+ * Mutexes only, on pthread mutexes.
+ */
+
+typedef struct
+{
+	pthread_mutex_t mutex;
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+#endif /* HOST_TEST_FREERTOS_SEMPHR_H_ */
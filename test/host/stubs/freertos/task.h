@@ -0,0 +1,65 @@
+/*
+ * task.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_FREERTOS_TASK_H_
+#define HOST_TEST_FREERTOS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+/*
+ * Tasks are pthreads, started by the tests with host_stub_task_start. Any thread gets a
+ * task handle with a notification value on its first xTaskGetCurrentTaskHandle.
+ */
+
+typedef struct host_stub_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+/**
+ * Sleeps for real, the test clock of esp_timer_get_time does not move.
+ */
+void vTaskDelay(TickType_t ticks);
+
+/**
+ * Ticks of the real monotonic clock, the time base of the queue and notification waits.
+ */
+TickType_t xTaskGetTickCount(void);
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+/*
+ * Every task has CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES notification values,
+ * the calls without an index use the first one.
+ */
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t task, UBaseType_t index);
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear_on_exit, TickType_t wait);
+
+#define xTaskNotifyGive(task)					xTaskNotifyGiveIndexed((task), 0)
+#define ulTaskNotifyTake(clear_on_exit, wait)	ulTaskNotifyTakeIndexed(0, (clear_on_exit), (wait))
+
+#define tskNO_AFFINITY			((BaseType_t)0x7FFFFFFF)
+
+typedef struct
+{
+	TaskHandle_t xHandle;
+	const char *pcTaskName;
+	uint32_t ulRunTimeCounter;
+	BaseType_t xCoreID;
+	uint32_t usStackHighWaterMark;
+} TaskStatus_t;
+
+/**
+ * Not implemented by the stubs, a test of a module that takes the snapshot provides it.
+ */
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t size, uint32_t *total_run_time);
+
+/**
+ * Runs fn(arg) on a new thread as a task.
+ * @return the handle of the task, NULL if the thread could not be started.
+ */
+TaskHandle_t host_stub_task_start(TaskFunction_t fn, void *arg);
+
+#endif /* HOST_TEST_FREERTOS_TASK_H_ */
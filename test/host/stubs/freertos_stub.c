@@ -0,0 +1,310 @@
+/*
+ * freertos_stub.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct host_stub_queue
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;
+	UBaseType_t depth;
+	UBaseType_t item_size;
+	UBaseType_t head;
+	UBaseType_t count;
+	uint8_t *items;
+};
+
+struct host_stub_task
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t notified;
+	uint32_t notify_value[CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES];
+	TaskFunction_t fn;
+	void *arg;
+};
+
+// Handles are never freed, threads that ended keep theirs
+#define HOST_STUB_TASKS				32
+
+static struct host_stub_task g_tasks[HOST_STUB_TASKS];
+static int g_task_count;
+static __thread TaskHandle_t t_current_task;
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer)
+{
+	pthread_mutex_init(&buffer->mutex, NULL);
+	return buffer;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+	StaticSemaphore_t *buffer = malloc(sizeof(*buffer));
+
+	return buffer != NULL ? xSemaphoreCreateMutexStatic(buffer) : NULL;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+	// Any timeout other than 0 waits without a limit
+	if (ticks == 0)
+	{
+		return pthread_mutex_trylock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+	}
+	return pthread_mutex_lock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+	return pthread_mutex_unlock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t depth, UBaseType_t item_size)
+{
+	QueueHandle_t queue = calloc(1, sizeof(*queue));
+
+	if (queue == NULL)
+	{
+		return NULL;
+	}
+	queue->items = malloc((size_t)depth * item_size);
+	if (queue->items == NULL)
+	{
+		free(queue);
+		return NULL;
+	}
+	pthread_mutex_init(&queue->mutex, NULL);
+	pthread_cond_init(&queue->changed, NULL);
+	queue->depth = depth;
+	queue->item_size = item_size;
+	return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+	pthread_cond_destroy(&queue->changed);
+	pthread_mutex_destroy(&queue->mutex);
+	free(queue->items);
+	free(queue);
+}
+
+/**
+ * Deadline for pthread_cond_timedwait, wait ticks from now.
+ */
+static void deadline_after(TickType_t wait, struct timespec *deadline)
+{
+	uint64_t ns;
+
+	clock_gettime(CLOCK_REALTIME, deadline);
+	ns = (uint64_t)deadline->tv_nsec + (uint64_t)wait * 1000000000ULL / configTICK_RATE_HZ;
+	deadline->tv_sec += ns / 1000000000ULL;
+	deadline->tv_nsec = ns % 1000000000ULL;
+}
+
+/**
+ * Waits on the queue condition until done() or the timeout, with the queue mutex held.
+ */
+static bool queue_wait(QueueHandle_t queue, TickType_t wait, bool (*done)(QueueHandle_t queue))
+{
+	struct timespec deadline;
+
+	if (wait != portMAX_DELAY)
+	{
+		deadline_after(wait, &deadline);
+	}
+
+	while (!done(queue))
+	{
+		if (wait == 0)
+		{
+			return false;
+		}
+		if (wait == portMAX_DELAY)
+		{
+			pthread_cond_wait(&queue->changed, &queue->mutex);
+		}
+		else if (pthread_cond_timedwait(&queue->changed, &queue->mutex, &deadline) == ETIMEDOUT)
+		{
+			return done(queue);
+		}
+	}
+	return true;
+}
+
+static bool queue_has_space(QueueHandle_t queue)
+{
+	return queue->count < queue->depth;
+}
+
+static bool queue_has_item(QueueHandle_t queue)
+{
+	return queue->count > 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait)
+{
+	BaseType_t sent = pdFALSE;
+
+	pthread_mutex_lock(&queue->mutex);
+	if (queue_wait(queue, wait, queue_has_space))
+	{
+		UBaseType_t tail = (queue->head + queue->count) % queue->depth;
+
+		memcpy(&queue->items[(size_t)tail * queue->item_size], item, queue->item_size);
+		queue->count++;
+		pthread_cond_broadcast(&queue->changed);
+		sent = pdTRUE;
+	}
+	pthread_mutex_unlock(&queue->mutex);
+
+	return sent;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higher_prio_woken)
+{
+	return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+	BaseType_t received = pdFALSE;
+
+	pthread_mutex_lock(&queue->mutex);
+	if (queue_wait(queue, wait, queue_has_item))
+	{
+		memcpy(item, &queue->items[(size_t)queue->head * queue->item_size], queue->item_size);
+		queue->head = (queue->head + 1) % queue->depth;
+		queue->count--;
+		pthread_cond_broadcast(&queue->changed);
+		received = pdTRUE;
+	}
+	pthread_mutex_unlock(&queue->mutex);
+
+	return received;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+	UBaseType_t count;
+
+	pthread_mutex_lock(&queue->mutex);
+	count = queue->count;
+	pthread_mutex_unlock(&queue->mutex);
+
+	return count;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+	usleep((useconds_t)((uint64_t)ticks * 1000000 / configTICK_RATE_HZ));
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (TickType_t)(((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec) * configTICK_RATE_HZ / 1000000000ULL);
+}
+
+static TaskHandle_t task_alloc(void)
+{
+	int index = __atomic_fetch_add(&g_task_count, 1, __ATOMIC_RELAXED);
+
+	if (index >= HOST_STUB_TASKS)
+	{
+		abort();
+	}
+	pthread_mutex_init(&g_tasks[index].mutex, NULL);
+	pthread_cond_init(&g_tasks[index].notified, NULL);
+	return &g_tasks[index];
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	if (t_current_task == NULL)
+	{
+		t_current_task = task_alloc();
+	}
+	return t_current_task;
+}
+
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t task, UBaseType_t index)
+{
+	pthread_mutex_lock(&task->mutex);
+	task->notify_value[index]++;
+	pthread_cond_broadcast(&task->notified);
+	pthread_mutex_unlock(&task->mutex);
+
+	return pdPASS;
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear_on_exit, TickType_t wait)
+{
+	TaskHandle_t task = xTaskGetCurrentTaskHandle();
+	struct timespec deadline;
+	uint32_t value;
+
+	if (wait != portMAX_DELAY)
+	{
+		deadline_after(wait, &deadline);
+	}
+
+	pthread_mutex_lock(&task->mutex);
+	while (task->notify_value[index] == 0 && wait != 0)
+	{
+		if (wait == portMAX_DELAY)
+		{
+			pthread_cond_wait(&task->notified, &task->mutex);
+		}
+		else if (pthread_cond_timedwait(&task->notified, &task->mutex, &deadline) == ETIMEDOUT)
+		{
+			break;
+		}
+	}
+	value = task->notify_value[index];
+	if (value > 0)
+	{
+		task->notify_value[index] = clear_on_exit ? 0 : value - 1;
+	}
+	pthread_mutex_unlock(&task->mutex);
+
+	return value;
+}
+
+static void *task_thread(void *arg)
+{
+	TaskHandle_t task = arg;
+
+	t_current_task = task;
+	task->fn(task->arg);
+	return NULL;
+}
+
+TaskHandle_t host_stub_task_start(TaskFunction_t fn, void *arg)
+{
+	TaskHandle_t task = task_alloc();
+	pthread_t thread;
+
+	task->fn = fn;
+	task->arg = arg;
+	if (pthread_create(&thread, NULL, task_thread, task) != 0)
+	{
+		return NULL;
+	}
+	pthread_detach(thread);
+	return task;
+}
@@ -0,0 +1,222 @@
+/*
+ * host_stubs.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_crc.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "host_stubs.h"
+
+#define HOST_STUB_MAX_TIMERS		16
+
+struct esp_timer
+{
+	esp_timer_create_args_t args;
+	uint64_t period_us;				// 0 for a one-shot timer
+	bool active;
+};
+
+static int64_t g_time_us = 0;
+static struct esp_timer g_timers[HOST_STUB_MAX_TIMERS];
+static int g_timer_count = 0;
+static pthread_mutex_t g_critical;
+static pthread_once_t g_critical_once = PTHREAD_ONCE_INIT;
+
+#if HOST_STUB_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+	size_t len = strlen(src);
+
+	if (size > 0)
+	{
+		size_t n = len < size - 1 ? len : size - 1;
+
+		memcpy(dst, src, n);
+		dst[n] = '\0';
+	}
+	return len;
+}
+#endif
+
+const char* esp_err_to_name(esp_err_t code)
+{
+	switch (code)
+	{
+		case ESP_OK:					return "ESP_OK";
+		case ESP_FAIL:					return "ESP_FAIL";
+		case ESP_ERR_NO_MEM:			return "ESP_ERR_NO_MEM";
+		case ESP_ERR_INVALID_ARG:		return "ESP_ERR_INVALID_ARG";
+		case ESP_ERR_INVALID_STATE:		return "ESP_ERR_INVALID_STATE";
+		case ESP_ERR_INVALID_SIZE:		return "ESP_ERR_INVALID_SIZE";
+		case ESP_ERR_NOT_FOUND:			return "ESP_ERR_NOT_FOUND";
+		case ESP_ERR_NOT_SUPPORTED:		return "ESP_ERR_NOT_SUPPORTED";
+		case ESP_ERR_TIMEOUT:			return "ESP_ERR_TIMEOUT";
+		case ESP_ERR_INVALID_RESPONSE:	return "ESP_ERR_INVALID_RESPONSE";
+		case ESP_ERR_INVALID_CRC:		return "ESP_ERR_INVALID_CRC";
+		case ESP_ERR_INVALID_VERSION:	return "ESP_ERR_INVALID_VERSION";
+		default:						return "ERROR";
+	}
+}
+
+void host_stub_log(char level, const char *tag, const char *format, ...)
+{
+	static int verbose = -1;
+
+	if (verbose < 0)
+	{
+		verbose = getenv("HOST_TEST_VERBOSE") != NULL;
+	}
+	if (!verbose)
+	{
+		return;
+	}
+
+	va_list args;
+	va_start(args, format);
+	fprintf(stderr, "%c (%s) ", level, tag);
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+	va_end(args);
+}
+
+int64_t esp_timer_get_time(void)
+{
+	return __atomic_load_n(&g_time_us, __ATOMIC_RELAXED);
+}
+
+void host_stub_set_time_us(int64_t time_us)
+{
+	__atomic_store_n(&g_time_us, time_us, __ATOMIC_RELAXED);
+}
+
+void host_stub_advance_us(int64_t delta_us)
+{
+	__atomic_fetch_add(&g_time_us, delta_us, __ATOMIC_RELAXED);
+}
+
+static void host_stub_critical_init(void)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&g_critical, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+void host_stub_critical_enter(portMUX_TYPE *mux)
+{
+	pthread_once(&g_critical_once, host_stub_critical_init);
+	pthread_mutex_lock(&g_critical);
+}
+
+void host_stub_critical_exit(portMUX_TYPE *mux)
+{
+	pthread_mutex_unlock(&g_critical);
+}
+
+uint32_t esp_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+	crc = ~crc;
+	for (uint32_t i = 0; i < len; i++)
+	{
+		crc ^= buf[i];
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+	if (create_args == NULL || create_args->callback == NULL || out_handle == NULL)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (g_timer_count == HOST_STUB_MAX_TIMERS)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	struct esp_timer *timer = &g_timers[g_timer_count++];
+	timer->args = *create_args;
+	*out_handle = timer;
+	return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+	if (timer->active)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->period_us = 0;
+	timer->active = true;
+	return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+	if (timer->active)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->period_us = period;
+	timer->active = true;
+	return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+	if (!timer->active)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->active = false;
+	return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+	return timer->active;
+}
+
+esp_timer_handle_t host_stub_timer_find(const char *name)
+{
+	for (int i = 0; i < g_timer_count; i++)
+	{
+		if (g_timers[i].args.name != NULL && strcmp(g_timers[i].args.name, name) == 0)
+		{
+			return &g_timers[i];
+		}
+	}
+	return NULL;
+}
+
+bool host_stub_timer_fire(esp_timer_handle_t timer)
+{
+	if (timer == NULL || !timer->active)
+	{
+		return false;
+	}
+	if (timer->period_us == 0)
+	{
+		timer->active = false;
+	}
+	timer->args.callback(timer->args.arg);
+	return true;
+}
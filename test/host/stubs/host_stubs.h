@@ -0,0 +1,43 @@
+/*
+ * host_stubs.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_HOST_STUBS_H_
+#define HOST_TEST_HOST_STUBS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_timer.h"
+
+/*
+ * Controls of the ESP-IDF stand-ins for the tests.
+ */
+
+/**
+ * Sets the time returned by esp_timer_get_time.
+ */
+void host_stub_set_time_us(int64_t time_us);
+
+/**
+ * Moves the time returned by esp_timer_get_time forward.
+ */
+void host_stub_advance_us(int64_t delta_us);
+
+/**
+ * Finds a timer by the name given to esp_timer_create.
+ * @return timer, or NULL if none has the name.
+ */
+esp_timer_handle_t host_stub_timer_find(const char *name);
+
+/**
+ * Runs the callback of a timer as if it expired. A one-shot timer stops, a periodic one
+ * stays armed.
+ * @return false if the timer was not started.
+ */
+bool host_stub_timer_fire(esp_timer_handle_t timer);
+
+#endif /* HOST_TEST_HOST_STUBS_H_ */
@@ -0,0 +1,148 @@
+/*
+ * httpd_stub.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_http_server.h"
+
+void httpd_stub_req_init(httpd_req_t *r, const char *uri, void *user_ctx)
+{
+	memset(r, 0, sizeof(*r));
+	snprintf(r->uri, sizeof(r->uri), "%s", uri);
+	r->user_ctx = user_ctx;
+	r->sockfd = -1;
+	r->body_len = -1;
+}
+
+void httpd_stub_req_body(httpd_req_t *r, const char *content)
+{
+	r->content = content;
+	r->content_len = strlen(content);
+	r->received = 0;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+	r->status = status;
+	return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+	r->type = type;
+	return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+	size_t used = strlen(r->headers);
+
+	snprintf(r->headers + used, sizeof(r->headers) - used, "%s: %s\n", field, value);
+	return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+	if (buf_len == HTTPD_RESP_USE_STRLEN)
+	{
+		buf_len = buf != NULL ? (ssize_t)strlen(buf) : 0;
+	}
+
+	r->body_len = buf_len;
+	r->body[0] = '\0';
+	if (buf != NULL)
+	{
+		size_t copy = (size_t)buf_len < sizeof(r->body) - 1 ? (size_t)buf_len : sizeof(r->body) - 1;
+
+		memcpy(r->body, buf, copy);
+		r->body[copy] = '\0';
+	}
+	return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char *msg)
+{
+	switch (error)
+	{
+	case HTTPD_400_BAD_REQUEST:
+		r->status = "400 Bad Request";
+		break;
+	case HTTPD_401_UNAUTHORIZED:
+		r->status = "401 Unauthorized";
+		break;
+	case HTTPD_404_NOT_FOUND:
+		r->status = "404 Not Found";
+		break;
+	default:
+		r->status = "500 Internal Server Error";
+		break;
+	}
+	r->type = "text/html";
+	return httpd_resp_send(r, msg, HTTPD_RESP_USE_STRLEN);
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r)
+{
+	return r->sockfd;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len)
+{
+	size_t left = r->content != NULL ? r->content_len - r->received : 0;
+	size_t n = buf_len < left ? buf_len : left;
+
+	if (n == 0)
+	{
+		return HTTPD_SOCK_ERR_FAIL;
+	}
+	memcpy(buf, r->content + r->received, n);
+	r->received += n;
+	return (int)n;
+}
+
+/**
+ * Copies up to size - 1 characters and a null.
+ * @return ESP_ERR_HTTPD_RESULT_TRUNC if the text did not fit.
+ */
+static esp_err_t httpd_stub_copy(char *dst, size_t size, const char *src, size_t len)
+{
+	size_t copy = len < size - 1 ? len : size - 1;
+
+	memcpy(dst, src, copy);
+	dst[copy] = '\0';
+	return copy < len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+	const char *query = strchr(r->uri, '?');
+
+	if (query == NULL)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+	return httpd_stub_copy(buf, buf_len, query + 1, strlen(query + 1));
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size)
+{
+	size_t key_len = strlen(key);
+
+	while (qry != NULL && *qry != '\0')
+	{
+		const char *end = strchr(qry, '&');
+		size_t len = end != NULL ? (size_t)(end - qry) : strlen(qry);
+
+		if (len > key_len && strncmp(qry, key, key_len) == 0 && qry[key_len] == '=')
+		{
+			return httpd_stub_copy(val, val_size, qry + key_len + 1, len - key_len - 1);
+		}
+		qry = end != NULL ? end + 1 : NULL;
+	}
+	return ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,20 @@
+/*
+ * sockets.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_LWIP_SOCKETS_H_
+#define HOST_TEST_LWIP_SOCKETS_H_
+
+/*
+ * lwIP's BSD socket API is the host's own.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif /* HOST_TEST_LWIP_SOCKETS_H_ */
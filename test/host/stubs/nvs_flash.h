@@ -0,0 +1,16 @@
+/*
+ * nvs_flash.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_NVS_FLASH_H_
+#define HOST_TEST_NVS_FLASH_H_
+
+#include "esp_err.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+#endif /* HOST_TEST_NVS_FLASH_H_ */
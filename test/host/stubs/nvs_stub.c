@@ -0,0 +1,158 @@
+/*
+ * nvs_stub.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#define NVS_STUB_MAX_ENTRIES			32
+#define NVS_STUB_MAX_NAMESPACES			8
+#define NVS_STUB_KEY_SIZE				16
+
+typedef struct nvs_stub_entry
+{
+	nvs_handle_t ns;						///> Namespace index + 1, 0 = free entry
+	char key[NVS_STUB_KEY_SIZE];
+	void *value;
+	size_t length;
+} nvs_stub_entry_t;
+
+static char g_namespaces[NVS_STUB_MAX_NAMESPACES][NVS_STUB_KEY_SIZE];
+static nvs_stub_entry_t g_entries[NVS_STUB_MAX_ENTRIES];
+
+static nvs_stub_entry_t* nvs_stub_find(nvs_handle_t handle, const char *key)
+{
+	for (int i = 0; i < NVS_STUB_MAX_ENTRIES; i++)
+	{
+		if (g_entries[i].ns == handle && strcmp(g_entries[i].key, key) == 0)
+		{
+			return &g_entries[i];
+		}
+	}
+	return NULL;
+}
+
+esp_err_t nvs_flash_init(void)
+{
+	return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+	host_stub_nvs_clear();
+	return ESP_OK;
+}
+
+void host_stub_nvs_clear(void)
+{
+	for (int i = 0; i < NVS_STUB_MAX_ENTRIES; i++)
+	{
+		free(g_entries[i].value);
+	}
+	memset(g_entries, 0, sizeof(g_entries));
+	memset(g_namespaces, 0, sizeof(g_namespaces));
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+	if (strlen(namespace_name) >= NVS_STUB_KEY_SIZE)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	for (int i = 0; i < NVS_STUB_MAX_NAMESPACES; i++)
+	{
+		if (g_namespaces[i][0] == '\0')
+		{
+			strcpy(g_namespaces[i], namespace_name);
+		}
+		if (strcmp(g_namespaces[i], namespace_name) == 0)
+		{
+			*out_handle = (nvs_handle_t)(i + 1);
+			return ESP_OK;
+		}
+	}
+	return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+	const nvs_stub_entry_t *entry = nvs_stub_find(handle, key);
+
+	if (entry == NULL)
+	{
+		return ESP_ERR_NVS_NOT_FOUND;
+	}
+	if (out_value == NULL)
+	{
+		*length = entry->length;
+		return ESP_OK;
+	}
+	if (*length < entry->length)
+	{
+		*length = entry->length;
+		return ESP_ERR_NVS_INVALID_LENGTH;
+	}
+
+	memcpy(out_value, entry->value, entry->length);
+	*length = entry->length;
+	return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+	if (handle == 0 || handle > NVS_STUB_MAX_NAMESPACES)
+	{
+		return ESP_ERR_NVS_INVALID_HANDLE;
+	}
+	if (strlen(key) >= NVS_STUB_KEY_SIZE)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	nvs_stub_entry_t *entry = nvs_stub_find(handle, key);
+	if (entry == NULL)
+	{
+		entry = nvs_stub_find(0, "");
+		if (entry == NULL)
+		{
+			return ESP_ERR_NVS_NO_FREE_PAGES;
+		}
+		entry->ns = handle;
+		strcpy(entry->key, key);
+	}
+
+	free(entry->value);
+	entry->value = malloc(length ? length : 1);
+	memcpy(entry->value, value, length);
+	entry->length = length;
+	return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+	nvs_stub_entry_t *entry = nvs_stub_find(handle, key);
+
+	if (entry == NULL)
+	{
+		return ESP_ERR_NVS_NOT_FOUND;
+	}
+	free(entry->value);
+	memset(entry, 0, sizeof(*entry));
+	return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+	return ESP_OK;
+}
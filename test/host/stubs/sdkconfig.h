@@ -0,0 +1,26 @@
+/*
+ * sdkconfig.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_SDKCONFIG_H_
+#define HOST_TEST_SDKCONFIG_H_
+
+/*
+ * Configuration of the host tests: the Kconfig.projbuild defaults of the linux target.
+ * The event trace is off, its macros compile to nothing.
+ */
+
+#define CONFIG_IDF_TARGET_LINUX					1
+#define CONFIG_FREERTOS_HZ						1000
+#define CONFIG_FREERTOS_USE_TRACE_FACILITY		1
+#define CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS	1
+#define CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES	2
+
+#define CONFIG_AUTH_PBKDF2_ITERATIONS			10000
+
+#define CONFIG_IO_CMD_COALESCE_MS				10
+
+#endif /* HOST_TEST_SDKCONFIG_H_ */
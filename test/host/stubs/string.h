@@ -0,0 +1,21 @@
+/*
+ * string.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#ifndef HOST_TEST_STRING_H_
+#define HOST_TEST_STRING_H_
+
+#include_next <string.h>
+
+/*
+ * newlib of ESP-IDF has strlcpy, glibc only from 2.38 on: host_stubs.c provides it for older ones.
+ */
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+#define HOST_STUB_STRLCPY		1
+size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
+
+#endif /* HOST_TEST_STRING_H_ */
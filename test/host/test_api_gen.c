@@ -0,0 +1,676 @@
+/*
+ * test_api_gen.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "esp_event.h"
+
+#include "api_gen.h"
+#include "host_test.h"
+#include "http_conn.h"
+#include "http_server.h"
+#include "journal.h"
+
+/*
+ * The generated parsers, writers and route wrappers of api_gen.c over json_codec.c. The
+ * operation handlers and the modules the wrappers call are stand-ins that record the call.
+ */
+
+static int g_handler_calls;
+static esp_err_t g_handler_err;
+static journal_result_e g_handler_answer;		///> Result a handler sets, for an error it answered itself
+static api_led_toggle_in_t g_led_toggle_in;
+static api_settings_net_post_in_t g_net_in;
+static api_journal_get_in_t g_journal_in;
+static api_telemetry_get_in_t g_telemetry_in;
+static api_limits_post_in_t g_limits_in;
+
+static int g_journal_records;
+static uint16_t g_journal_route;
+static journal_result_e g_journal_result;
+
+#define HANDLER(name)																	\
+	esp_err_t name(httpd_req_t *req)													\
+	{																					\
+		g_handler_calls++;																\
+		if (g_handler_answer != JOURNAL_RESULT_OK)										\
+			api_journal_result(g_handler_answer);										\
+		return g_handler_err;															\
+	}
+
+#define HANDLER_IN(name, type, copy)													\
+	esp_err_t name(httpd_req_t *req, const type *in)									\
+	{																					\
+		g_handler_calls++;																\
+		copy;																			\
+		if (g_handler_answer != JOURNAL_RESULT_OK)										\
+			api_journal_result(g_handler_answer);										\
+		return g_handler_err;															\
+	}
+
+HANDLER(http_server_index_html_handler)
+HANDLER(http_server_app_css_handler)
+HANDLER(http_server_app_js_handler)
+HANDLER(http_server_jquery_handler)
+HANDLER(http_server_favicon_ico_handler)
+HANDLER(assets_file_get_handler)
+HANDLER(assets_get_handler)
+HANDLER(assets_update_post_handler)
+HANDLER_IN(led_get_handler, api_led_get_in_t, (void)in)
+HANDLER_IN(led_toggle_handler, api_led_toggle_in_t, g_led_toggle_in = *in)
+HANDLER(scenes_get_handler)
+HANDLER_IN(scene_put_handler, api_scene_put_in_t, (void)in)
+HANDLER_IN(scene_delete_handler, api_scene_delete_in_t, (void)in)
+HANDLER_IN(scene_run_post_handler, api_scene_run_post_in_t, (void)in)
+HANDLER_IN(scene_stop_post_handler, api_scene_stop_post_in_t, (void)in)
+HANDLER(http_server_OTA_update_handler)
+HANDLER(http_server_OTA_status_handler)
+HANDLER(config_get_handler)
+HANDLER(config_put_handler)
+HANDLER(settings_net_get_handler)
+HANDLER_IN(settings_net_post_handler, api_settings_net_post_in_t, g_net_in = *in)
+HANDLER(settings_ip_get_handler)
+HANDLER(metrics_get_handler)
+HANDLER_IN(journal_get_handler, api_journal_get_in_t, g_journal_in = *in)
+HANDLER(boot_get_handler)
+HANDLER(memory_get_handler)
+HANDLER_IN(telemetry_get_handler, api_telemetry_get_in_t, g_telemetry_in = *in)
+HANDLER(trace_get_handler)
+HANDLER(loadgen_get_handler)
+HANDLER_IN(loadgen_post_handler, api_loadgen_post_in_t, (void)in)
+HANDLER(loadgen_sink_post_handler)
+HANDLER_IN(wifi_scan_get_handler, api_wifi_scan_get_in_t, (void)in)
+HANDLER_IN(auth_login_post_handler, api_auth_login_post_in_t, (void)in)
+HANDLER(auth_logout_post_handler)
+HANDLER_IN(auth_credentials_post_handler, api_auth_credentials_post_in_t, (void)in)
+HANDLER(limits_get_handler)
+HANDLER_IN(limits_post_handler, api_limits_post_in_t, g_limits_in = *in)
+
+// wifi_mock.c is linked for esp_netif_str_to_ip4 only
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data, size_t size, TickType_t wait)
+{
+	return ESP_OK;
+}
+
+void set_cors_headers(httpd_req_t *req)
+{
+}
+
+bool http_server_authorize(httpd_req_t *req)
+{
+	return true;
+}
+
+bool http_admit(httpd_req_t *req)
+{
+	return true;
+}
+
+uint32_t http_conn_client(httpd_req_t *req)
+{
+	return 0;
+}
+
+void journal_begin(journal_record_t *rec, journal_source_e source, uint16_t route, uint32_t client)
+{
+	memset(rec, 0, sizeof(*rec));
+	rec->route = route;
+	rec->source = source;
+}
+
+void journal_end(journal_record_t *rec, journal_result_e result)
+{
+	g_journal_records++;
+	g_journal_route = rec->route;
+	g_journal_result = result;
+}
+
+static void reset(void)
+{
+	g_handler_calls = 0;
+	g_handler_err = ESP_OK;
+	g_handler_answer = JOURNAL_RESULT_OK;
+	g_journal_records = 0;
+	g_journal_result = JOURNAL_RESULT_COUNT;
+}
+
+/**
+ * Runs the wrapper registered for uri and method on a request with the given URI and body.
+ */
+static esp_err_t call_route(httpd_req_t *req, const char *route_uri, httpd_method_t method, const char *uri, const char *body)
+{
+	for (size_t i = 0; i < api_route_count; i++)
+	{
+		if (strcmp(api_routes[i].uri, route_uri) == 0 && api_routes[i].method == method)
+		{
+			httpd_stub_req_init(req, uri, (void *)(intptr_t)api_routes[i].admit);
+			if (body != NULL)
+			{
+				httpd_stub_req_body(req, body);
+			}
+			return api_routes[i].handler(req);
+		}
+	}
+
+	// A mistake of the test itself
+	printf("no route %s\n", route_uri);
+	abort();
+}
+
+/**
+ * Parses text with a generated parser, which must consume all of it.
+ */
+#define PARSE(type, text, v, error)														\
+	({																					\
+		json_reader_t r_;																\
+		json_reader_init(&r_, (text), strlen(text));									\
+		*(error) = NULL;																\
+		api_parse_##type(&r_, (v), (error)) && json_reader_done(&r_);					\
+	})
+
+/**
+ * Skips one value of text.
+ * @return true if it was well-formed JSON and nothing followed it.
+ */
+static bool skip_all(const char *text)
+{
+	json_reader_t r;
+
+	json_reader_init(&r, text, strlen(text));
+	return json_skip(&r) && json_reader_done(&r);
+}
+
+static void test_json_reader_values(void)
+{
+	const char *text = " { \"s\" : \"a\\\"b\\\\c\\/\\n\\u00e9\\u20ac\", \"n\":-42 ,\"t\":true,\"f\":false,\"z\":null,"
+			"\"skip\":[1,{\"x\":[2.5e3,\"y\"]},null] } ";
+	json_reader_t r;
+	const char *key;
+	size_t len;
+	char s[16];
+	int64_t n;
+	bool flag;
+
+	json_reader_init(&r, text, strlen(text));
+	TEST_ASSERT(json_read_object(&r));
+
+	TEST_ASSERT(json_next_key(&r, &key, &len));
+	TEST_ASSERT(json_key_is(key, len, "s"));
+	TEST_ASSERT(json_read_string(&r, s, sizeof(s)));
+	TEST_ASSERT_EQUAL_STRING("a\"b\\c/\n\xc3\xa9\xe2\x82\xac", s);
+
+	TEST_ASSERT(json_next_key(&r, &key, &len));
+	TEST_ASSERT(json_key_is(key, len, "n"));
+	TEST_ASSERT_EQUAL(JSON_TYPE_NUMBER, json_peek(&r));
+	TEST_ASSERT(json_read_int(&r, &n));
+	TEST_ASSERT_EQUAL(-42, n);
+
+	TEST_ASSERT(json_next_key(&r, &key, &len));
+	TEST_ASSERT(json_read_bool(&r, &flag));
+	TEST_ASSERT(flag);
+	TEST_ASSERT(json_next_key(&r, &key, &len));
+	TEST_ASSERT(json_read_bool(&r, &flag));
+	TEST_ASSERT(!flag);
+	TEST_ASSERT(json_next_key(&r, &key, &len));
+	TEST_ASSERT_EQUAL(JSON_TYPE_NULL, json_peek(&r));
+	TEST_ASSERT(json_read_null(&r));
+
+	TEST_ASSERT(json_next_key(&r, &key, &len));
+	TEST_ASSERT(json_key_is(key, len, "skip"));
+	TEST_ASSERT(json_skip(&r));
+
+	TEST_ASSERT(!json_next_key(&r, &key, &len));
+	TEST_ASSERT(!r.error);
+	TEST_ASSERT(json_reader_done(&r));
+}
+
+static void test_json_reader_malformed(void)
+{
+	static const char *const bad[] = {
+			"",
+			"{",
+			"{\"a\"}",
+			"{\"a\":}",
+			"{\"a\":1,}",
+			"{\"a\":1 \"b\":2}",
+			"{a:1}",
+			"[1,2",
+			"[1 2]",
+			"tru",
+			"nul",
+			"\"open",
+			"\"bad \\x escape\"",
+			"\"short \\u12\"",
+			"\"nul \\u0000\"",
+			"\"surrogate \\ud83d\\ude00\"",
+			"\"control \x01\"",
+			"{} {}",
+			"-",
+			"1.",
+			"1e",
+			"-.5",
+			"[1-2]",
+			"{\"a\":1.2.3}",
+	};
+
+	for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+	{
+		if (skip_all(bad[i]))
+		{
+			TEST_FAIL_MSG("accepted malformed '%s'", bad[i]);
+		}
+	}
+
+	TEST_ASSERT(skip_all("{\"a\":[1,-2.5e+3,\"x\",true,false,null,{}],\"b\":{}}"));
+}
+
+static void test_json_reader_depth(void)
+{
+	char text[2 * (JSON_MAX_DEPTH + 2) + 1];
+	int levels;
+
+	// json_skip follows JSON_MAX_DEPTH levels below the outermost value
+	levels = JSON_MAX_DEPTH + 1;
+	memset(text, '[', levels);
+	memset(text + levels, ']', levels);
+	text[2 * levels] = '\0';
+	TEST_ASSERT(skip_all(text));
+
+	levels = JSON_MAX_DEPTH + 2;
+	memset(text, '[', levels);
+	memset(text + levels, ']', levels);
+	text[2 * levels] = '\0';
+	TEST_ASSERT(!skip_all(text));
+}
+
+static void test_json_read_int_limits(void)
+{
+	static const char *const bad[] = { "1.5", "1e3", "99999999999999999999", "-", "+1", "\"1\"" };
+	json_reader_t r;
+	int64_t n;
+
+	json_reader_init(&r, "922337203685477579", 18);
+	TEST_ASSERT(json_read_int(&r, &n));
+	TEST_ASSERT_EQUAL(922337203685477579LL, n);
+
+	for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+	{
+		json_reader_init(&r, bad[i], strlen(bad[i]));
+		if (json_read_int(&r, &n))
+		{
+			TEST_FAIL_MSG("read '%s' as %lld", bad[i], (long long)n);
+		}
+	}
+}
+
+static void test_json_string_fits(void)
+{
+	json_reader_t r;
+	char s[4];
+
+	json_reader_init(&r, "\"abc\"", 5);
+	TEST_ASSERT(json_read_string(&r, s, sizeof(s)));
+	TEST_ASSERT_EQUAL_STRING("abc", s);
+
+	// The null must fit as well, a multibyte code point is not cut
+	json_reader_init(&r, "\"abcd\"", 6);
+	TEST_ASSERT(!json_read_string(&r, s, sizeof(s)));
+	TEST_ASSERT(r.error);
+	json_reader_init(&r, "\"ab\\u00e9\"", 10);
+	TEST_ASSERT(!json_read_string(&r, s, sizeof(s)));
+}
+
+static void test_json_writer(void)
+{
+	char buf[64];
+	json_writer_t w;
+
+	json_writer_init(&w, buf, sizeof(buf));
+	json_put_raw(&w, "[");
+	json_put_string(&w, "q\"b\\c\n\x01");
+	json_put_raw(&w, ",");
+	json_put_int(&w, -9000000000LL);
+	json_put_raw(&w, ",");
+	json_put_bool(&w, true);
+	json_put_raw(&w, ",");
+	json_put_null(&w);
+	json_put_raw(&w, "]");
+	TEST_ASSERT(json_writer_finish(&w));
+	TEST_ASSERT_EQUAL_STRING("[\"q\\\"b\\\\c\\u000a\\u0001\",-9000000000,true,null]", buf);
+	TEST_ASSERT(skip_all(buf));
+
+	// "12345" and its null need 6 bytes
+	json_writer_init(&w, buf, 5);
+	json_put_raw(&w, "12345");
+	TEST_ASSERT(!json_writer_finish(&w));
+	TEST_ASSERT_EQUAL_STRING("", buf);
+	json_writer_init(&w, buf, 6);
+	json_put_raw(&w, "12345");
+	TEST_ASSERT(json_writer_finish(&w));
+}
+
+static void test_parse_led(void)
+{
+	api_led_t led;
+	const char *error;
+
+	TEST_ASSERT(PARSE(led, "{\"id\":3,\"state\":\"off\",\"version\":7,\"extra\":{\"x\":[1]}}", &led, &error));
+	TEST_ASSERT_EQUAL(3, led.id);
+	TEST_ASSERT_EQUAL(API_LED_STATE_OFF, led.state);
+	TEST_ASSERT_EQUAL(7, led.version);
+
+	// Out of range
+	TEST_ASSERT(!PARSE(led, "{\"id\":5,\"state\":\"on\",\"version\":0}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("id: integer 1..4 expected", error);
+	TEST_ASSERT(!PARSE(led, "{\"id\":0,\"state\":\"on\",\"version\":0}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("id: integer 1..4 expected", error);
+	TEST_ASSERT(!PARSE(led, "{\"id\":1,\"state\":\"dim\",\"version\":0}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("state: \"on\" or \"off\" expected", error);
+	TEST_ASSERT(!PARSE(led, "{\"id\":1,\"state\":\"on\",\"version\":-1}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("version: integer >= 0 expected", error);
+	TEST_ASSERT(!PARSE(led, "{\"id\":1,\"state\":\"on\",\"version\":2147483648}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("version: integer >= 0 expected", error);
+
+	// Wrong type
+	TEST_ASSERT(!PARSE(led, "{\"id\":\"1\",\"state\":\"on\",\"version\":0}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("id: integer 1..4 expected", error);
+	TEST_ASSERT(!PARSE(led, "[1]", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("LED object expected", error);
+
+	// Missing field
+	TEST_ASSERT(!PARSE(led, "{\"state\":\"on\",\"version\":0}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("id is required", error);
+	TEST_ASSERT(!PARSE(led, "{\"id\":1,\"version\":0}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("state is required", error);
+	TEST_ASSERT(!PARSE(led, "{}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("id is required", error);
+
+	// Malformed
+	TEST_ASSERT(!PARSE(led, "{\"id\":1,\"state\":\"on\",\"version\":0", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("Invalid JSON", error);
+	TEST_ASSERT(!PARSE(led, "{\"id\":1,\"state\":\"on\",\"version\":0,\"extra\":[1,}", &led, &error));
+	TEST_ASSERT_EQUAL_STRING("Invalid JSON", error);
+	// Trailing text is left to json_reader_done
+	TEST_ASSERT(!PARSE(led, "{\"id\":1,\"state\":\"on\",\"version\":0} x", &led, &error));
+	TEST_ASSERT(error == NULL);
+}
+
+static void test_parse_network_config(void)
+{
+	api_network_config_t net;
+	const char *error;
+
+	TEST_ASSERT(PARSE(network_config, "{\"ssid\":\"home\",\"password\":\"secret\"}", &net, &error));
+	TEST_ASSERT_EQUAL_STRING("home", net.ssid);
+	TEST_ASSERT_EQUAL_STRING("secret", net.password);
+	TEST_ASSERT(!net.has_static_ip);
+
+	TEST_ASSERT(PARSE(network_config, "{\"ssid\":\"home\",\"password\":\"\",\"static_ip\":null}", &net, &error));
+	TEST_ASSERT(net.has_static_ip);
+	TEST_ASSERT(net.static_ip_is_null);
+
+	TEST_ASSERT(PARSE(network_config, "{\"ssid\":\"home\",\"password\":\"secret\",\"static_ip\":"
+			"{\"ip\":\"192.168.0.50\",\"netmask\":\"255.255.255.0\",\"dns\":\"8.8.8.8\"}}", &net, &error));
+	TEST_ASSERT(net.has_static_ip);
+	TEST_ASSERT(!net.static_ip_is_null);
+	TEST_ASSERT_EQUAL(0x3200A8C0u, net.static_ip.ip);
+	TEST_ASSERT_EQUAL(0x00FFFFFFu, net.static_ip.netmask);
+	TEST_ASSERT(!net.static_ip.has_gw);
+	TEST_ASSERT(net.static_ip.has_dns);
+	TEST_ASSERT_EQUAL(0x08080808u, net.static_ip.dns);
+
+	// Out of range: lengths and addresses
+	TEST_ASSERT(!PARSE(network_config, "{\"ssid\":\"123456789012345678901234567890123\",\"password\":\"\"}", &net, &error));
+	TEST_ASSERT_EQUAL_STRING("ssid: string of at most 32 characters expected", error);
+	TEST_ASSERT(PARSE(network_config, "{\"ssid\":\"12345678901234567890123456789012\",\"password\":\"\"}", &net, &error));
+	TEST_ASSERT(!PARSE(network_config, "{\"ssid\":\"home\",\"password\":\"\",\"static_ip\":"
+			"{\"ip\":\"192.168.0.256\",\"netmask\":\"255.255.255.0\"}}", &net, &error));
+	TEST_ASSERT_EQUAL_STRING("ip: IPv4 address expected", error);
+	TEST_ASSERT(!PARSE(network_config, "{\"ssid\":\"home\",\"password\":\"\",\"static_ip\":"
+			"{\"ip\":\"192.168.0.1\",\"netmask\":\"255.255.255.0\",\"gw\":\"192.168.0\"}}", &net, &error));
+	TEST_ASSERT_EQUAL_STRING("gw: IPv4 address expected", error);
+
+	// Missing fields, nested ones with the message of the nested schema
+	TEST_ASSERT(!PARSE(network_config, "{\"ssid\":\"home\"}", &net, &error));
+	TEST_ASSERT_EQUAL_STRING("password is required", error);
+	TEST_ASSERT(!PARSE(network_config, "{\"ssid\":\"home\",\"password\":\"\",\"static_ip\":{\"ip\":\"192.168.0.1\"}}", &net, &error));
+	TEST_ASSERT_EQUAL_STRING("netmask is required", error);
+	TEST_ASSERT(!PARSE(network_config, "{\"ssid\":\"home\",\"password\":\"\",\"static_ip\":\"dhcp\"}", &net, &error));
+	TEST_ASSERT_EQUAL_STRING("StaticIP object expected", error);
+}
+
+static void test_parse_rate_limits(void)
+{
+	api_rate_limits_t limits;
+	const char *error;
+
+	TEST_ASSERT(PARSE(rate_limits, "{\"control\":{\"per_minute\":120,\"burst\":5}}", &limits, &error));
+	TEST_ASSERT(!limits.has_read);
+	TEST_ASSERT(limits.has_control);
+	TEST_ASSERT_EQUAL(120, limits.control.per_minute);
+	TEST_ASSERT_EQUAL(5, limits.control.burst);
+	TEST_ASSERT(PARSE(rate_limits, "{}", &limits, &error));
+
+	TEST_ASSERT(!PARSE(rate_limits, "{\"read\":{\"per_minute\":65536,\"burst\":5}}", &limits, &error));
+	TEST_ASSERT_EQUAL_STRING("per_minute: integer 0..65535 expected", error);
+	TEST_ASSERT(!PARSE(rate_limits, "{\"read\":{\"per_minute\":60,\"burst\":-1}}", &limits, &error));
+	TEST_ASSERT_EQUAL_STRING("burst: integer 0..65535 expected", error);
+	TEST_ASSERT(!PARSE(rate_limits, "{\"heavy\":{\"per_minute\":60}}", &limits, &error));
+	TEST_ASSERT_EQUAL_STRING("burst is required", error);
+	TEST_ASSERT(!PARSE(rate_limits, "{\"heavy\":{\"per_minute\":60,\"burst\":1}", &limits, &error));
+	TEST_ASSERT_EQUAL_STRING("Invalid JSON", error);
+}
+
+static void test_parse_credentials(void)
+{
+	api_credentials_t cred;
+	const char *error;
+
+	TEST_ASSERT(PARSE(credentials, "{\"user\":\"admin\",\"password\":\"correct horse\"}", &cred, &error));
+	TEST_ASSERT_EQUAL_STRING("admin", cred.user);
+	TEST_ASSERT_EQUAL_STRING("correct horse", cred.password);
+
+	TEST_ASSERT(!PARSE(credentials, "{\"user\":\"\",\"password\":\"x\"}", &cred, &error));
+	TEST_ASSERT_EQUAL_STRING("user: string of 1..32 characters expected", error);
+	TEST_ASSERT(!PARSE(credentials, "{\"user\":\"admin\"}", &cred, &error));
+	TEST_ASSERT_EQUAL_STRING("password is required", error);
+}
+
+static void test_write_round_trip(void)
+{
+	api_network_config_t net = { 0 }, back;
+	api_led_t led = { .id = 4, .state = API_LED_STATE_ON, .version = 2147483647 }, led_back;
+	char buf[API_NETWORK_CONFIG_JSON_MAX];
+	const char *error;
+
+	TEST_ASSERT(api_format_led(buf, API_LED_JSON_MAX, &led));
+	TEST_ASSERT(PARSE(led, buf, &led_back, &error));
+	TEST_ASSERT_EQUAL(led.id, led_back.id);
+	TEST_ASSERT_EQUAL(led.state, led_back.state);
+	TEST_ASSERT_EQUAL(led.version, led_back.version);
+
+	// The longest text: full length strings of characters that are escaped as \u00XX
+	memset(net.ssid, '\x1f', sizeof(net.ssid) - 1);
+	memset(net.password, '\x01', sizeof(net.password) - 1);
+	net.has_static_ip = true;
+	net.static_ip.ip = 0xFFFFFFFF;
+	net.static_ip.netmask = 0xFFFFFFFF;
+	net.static_ip.has_gw = true;
+	net.static_ip.gw = 0xFFFFFFFF;
+	net.static_ip.has_dns = true;
+	net.static_ip.dns = 0xFFFFFFFF;
+	TEST_ASSERT(api_format_network_config(buf, sizeof(buf), &net));
+	TEST_ASSERT(PARSE(network_config, buf, &back, &error));
+	TEST_ASSERT_EQUAL_STRING(net.ssid, back.ssid);
+	TEST_ASSERT_EQUAL_STRING(net.password, back.password);
+	TEST_ASSERT(back.has_static_ip);
+	TEST_ASSERT_EQUAL(net.static_ip.gw, back.static_ip.gw);
+	TEST_ASSERT_EQUAL(net.static_ip.dns, back.static_ip.dns);
+
+	TEST_ASSERT(!api_format_network_config(buf, 16, &net));
+}
+
+static void test_route_body(void)
+{
+	httpd_req_t req;
+	char large[API_NETWORK_CONFIG_JSON_MAX + 200];
+
+	reset();
+	TEST_ASSERT_EQUAL(ESP_OK, call_route(&req, "/api/config/network", HTTP_POST, "/api/config/network",
+			"{\"ssid\":\"home\",\"password\":\"secret\",\"static_ip\":null}"));
+	TEST_ASSERT_EQUAL(1, g_handler_calls);
+	TEST_ASSERT_EQUAL_STRING("home", g_net_in.body.ssid);
+	TEST_ASSERT(g_net_in.body.static_ip_is_null);
+	TEST_ASSERT_EQUAL(API_OP_SETTINGS_NET_POST, g_journal_route);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_OK, g_journal_result);
+
+	reset();
+	call_route(&req, "/api/config/network", HTTP_POST, "/api/config/network", "{\"ssid\":\"home\"}");
+	TEST_ASSERT_EQUAL(0, g_handler_calls);
+	TEST_ASSERT_EQUAL_STRING("400 Bad Request", req.status);
+	TEST_ASSERT_EQUAL_STRING("password is required", req.body);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_BAD_REQUEST, g_journal_result);
+
+	reset();
+	call_route(&req, "/api/config/network", HTTP_POST, "/api/config/network", "{\"ssid\":\"home\",\"password\":\"\"} {}");
+	TEST_ASSERT_EQUAL(0, g_handler_calls);
+	TEST_ASSERT_EQUAL_STRING("Invalid JSON", req.body);
+
+	reset();
+	call_route(&req, "/api/config/network", HTTP_POST, "/api/config/network", NULL);
+	TEST_ASSERT_EQUAL(0, g_handler_calls);
+	TEST_ASSERT_EQUAL_STRING("Request body required", req.body);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_BAD_REQUEST, g_journal_result);
+
+	reset();
+	memset(large, ' ', sizeof(large) - 1);
+	large[0] = '{';
+	large[sizeof(large) - 2] = '}';
+	large[sizeof(large) - 1] = '\0';
+	call_route(&req, "/api/config/network", HTTP_POST, "/api/config/network", large);
+	TEST_ASSERT_EQUAL(0, g_handler_calls);
+	TEST_ASSERT_EQUAL_STRING("Request body too large", req.body);
+
+	reset();
+	call_route(&req, "/api/config/limits", HTTP_POST, "/api/config/limits", "{\"login\":{\"per_minute\":6,\"burst\":100000}}");
+	TEST_ASSERT_EQUAL(0, g_handler_calls);
+	TEST_ASSERT_EQUAL_STRING("burst: integer 0..65535 expected", req.body);
+	call_route(&req, "/api/config/limits", HTTP_POST, "/api/config/limits", "{\"login\":{\"per_minute\":6,\"burst\":3}}");
+	TEST_ASSERT_EQUAL(1, g_handler_calls);
+	TEST_ASSERT(g_limits_in.body.has_login);
+	TEST_ASSERT_EQUAL(3, g_limits_in.body.login.burst);
+}
+
+static void test_route_query_and_path(void)
+{
+	httpd_req_t req;
+
+	reset();
+	call_route(&req, "/api/journal", HTTP_GET, "/api/journal", NULL);
+	TEST_ASSERT_EQUAL(1, g_handler_calls);
+	TEST_ASSERT_EQUAL(0, g_journal_in.since);
+	TEST_ASSERT_EQUAL(32, g_journal_in.limit);
+	call_route(&req, "/api/journal", HTTP_GET, "/api/journal?since=17&limit=64", NULL);
+	TEST_ASSERT_EQUAL(2, g_handler_calls);
+	TEST_ASSERT_EQUAL(17, g_journal_in.since);
+	TEST_ASSERT_EQUAL(64, g_journal_in.limit);
+
+	reset();
+	call_route(&req, "/api/journal", HTTP_GET, "/api/journal?limit=65", NULL);
+	TEST_ASSERT_EQUAL_STRING("limit: integer 1..64 expected", req.body);
+	call_route(&req, "/api/journal", HTTP_GET, "/api/journal?since=12x", NULL);
+	TEST_ASSERT_EQUAL_STRING("since: integer >= 0 expected", req.body);
+	call_route(&req, "/api/journal", HTTP_GET, "/api/journal?since=", NULL);
+	TEST_ASSERT_EQUAL_STRING("since: integer >= 0 expected", req.body);
+	call_route(&req, "/api/journal", HTTP_GET, "/api/journal?since=99999999999999", NULL);
+	TEST_ASSERT_EQUAL_STRING("since: integer >= 0 expected", req.body);
+	TEST_ASSERT_EQUAL(0, g_handler_calls);
+
+	reset();
+	call_route(&req, "/api/telemetry", HTTP_GET, "/api/telemetry?tier=h", NULL);
+	TEST_ASSERT_EQUAL(1, g_handler_calls);
+	TEST_ASSERT_EQUAL(API_TELEMETRY_GET_TIER_H, g_telemetry_in.tier);
+	call_route(&req, "/api/telemetry", HTTP_GET, "/api/telemetry?tier=d", NULL);
+	TEST_ASSERT_EQUAL(1, g_handler_calls);
+	TEST_ASSERT_EQUAL_STRING("400 Bad Request", req.status);
+
+	reset();
+	call_route(&req, "/api/leds/2/toggle", HTTP_POST, "/api/leds/2/toggle", NULL);
+	TEST_ASSERT_EQUAL(1, g_handler_calls);
+	TEST_ASSERT_EQUAL(2, g_led_toggle_in.id);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_OK, g_journal_result);
+	call_route(&req, "/api/leds/2/toggle", HTTP_POST, "/api/leds/9/toggle", NULL);
+	TEST_ASSERT_EQUAL(1, g_handler_calls);
+	TEST_ASSERT_EQUAL_STRING("id: integer 1..4 expected", req.body);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_BAD_REQUEST, g_journal_result);
+
+	reset();
+	g_handler_err = ESP_FAIL;
+	TEST_ASSERT_EQUAL(ESP_FAIL, call_route(&req, "/api/leds/2/toggle", HTTP_POST, "/api/leds/2/toggle", NULL));
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_FAILED, g_journal_result);
+}
+
+static void test_route_handler_result(void)
+{
+	httpd_req_t req;
+
+	// The 503 of a full IO command queue
+	reset();
+	g_handler_answer = JOURNAL_RESULT_BUSY;
+	TEST_ASSERT_EQUAL(ESP_OK, call_route(&req, "/api/leds/3/toggle", HTTP_POST, "/api/leds/3/toggle", NULL));
+	TEST_ASSERT_EQUAL(1, g_journal_records);
+	TEST_ASSERT_EQUAL(API_OP_LED_TOGGLE, g_journal_route);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_BUSY, g_journal_result);
+
+	// Not carried over to the next request
+	g_handler_answer = JOURNAL_RESULT_OK;
+	call_route(&req, "/api/leds/3/toggle", HTTP_POST, "/api/leds/3/toggle", NULL);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_OK, g_journal_result);
+	g_handler_answer = JOURNAL_RESULT_BAD_REQUEST;
+	call_route(&req, "/api/leds/3", HTTP_GET, "/api/leds/3", NULL);
+	g_handler_answer = JOURNAL_RESULT_OK;
+	call_route(&req, "/api/scenes/1/run", HTTP_POST, "/api/scenes/1/run", NULL);
+	TEST_ASSERT_EQUAL(API_OP_SCENE_RUN_POST, g_journal_route);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_OK, g_journal_result);
+
+	// An error return is a failure whatever the handler set
+	reset();
+	g_handler_answer = JOURNAL_RESULT_BAD_REQUEST;
+	g_handler_err = ESP_FAIL;
+	call_route(&req, "/api/scenes/1/run", HTTP_POST, "/api/scenes/1/run", NULL);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_FAILED, g_journal_result);
+
+	reset();
+	g_handler_answer = JOURNAL_RESULT_UNAUTHORIZED;
+	call_route(&req, "/api/auth/login", HTTP_POST, "/api/auth/login", "{\"user\":\"admin\",\"password\":\"wrong\"}");
+	TEST_ASSERT_EQUAL(1, g_handler_calls);
+	TEST_ASSERT_EQUAL(JOURNAL_RESULT_UNAUTHORIZED, g_journal_result);
+}
+
+int main(void)
+{
+	RUN_TEST(test_json_reader_values);
+	RUN_TEST(test_json_reader_malformed);
+	RUN_TEST(test_json_reader_depth);
+	RUN_TEST(test_json_read_int_limits);
+	RUN_TEST(test_json_string_fits);
+	RUN_TEST(test_json_writer);
+	RUN_TEST(test_parse_led);
+	RUN_TEST(test_parse_network_config);
+	RUN_TEST(test_parse_rate_limits);
+	RUN_TEST(test_parse_credentials);
+	RUN_TEST(test_write_round_trip);
+	RUN_TEST(test_route_body);
+	RUN_TEST(test_route_query_and_path);
+	RUN_TEST(test_route_handler_result);
+
+	return host_test_finish();
+}
@@ -0,0 +1,193 @@
+/*
+ * test_event_bus.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include "event_bus.h"
+#include "host_stubs.h"
+#include "host_test.h"
+
+// Subscriptions cannot be undone: the tests run in order on the same bus
+
+#define WIFI_QUEUE_DEPTH			32
+#define MONITOR_QUEUE_DEPTH			2
+
+static UBaseType_t g_queue_depth;
+
+/**
+ * static_alloc.c is not linked, subscriber queues get the depth the test sets.
+ */
+QueueHandle_t static_alloc_queue_create(static_queue_e id, UBaseType_t item_size)
+{
+	return xQueueCreate(g_queue_depth, item_size);
+}
+
+static QueueHandle_t subscribe(event_topic_e topic, static_queue_e id, UBaseType_t depth)
+{
+	QueueHandle_t queue;
+
+	g_queue_depth = depth;
+	queue = event_bus_queue_create(id);
+	if (queue != NULL && event_bus_subscribe(topic, queue) != ESP_OK)
+	{
+		return NULL;
+	}
+	return queue;
+}
+
+/**
+ * Receives and releases everything waiting on the queue.
+ * @return events drained.
+ */
+static int drain(QueueHandle_t queue)
+{
+	const event_t *event;
+	int count = 0;
+
+	while ((event = event_bus_receive(queue, 0)) != NULL)
+	{
+		event_bus_release(event);
+		count++;
+	}
+	return count;
+}
+
+static QueueHandle_t g_wifi_queue;
+static QueueHandle_t g_monitor_queue;
+
+static void test_no_subscriber(void)
+{
+	event_bus_stats_t before, after;
+
+	event_bus_get_stats(&before);
+	TEST_ASSERT(!event_bus_publish(EVENT_TOPIC_WIFI_APP, 1, NULL));
+	TEST_ASSERT(!event_bus_publish_control(EVENT_TOPIC_WIFI_APP, 2, NULL));
+	TEST_ASSERT(!event_bus_publish(EVENT_TOPIC_COUNT, 3, NULL));
+	event_bus_get_stats(&after);
+
+	TEST_ASSERT_EQUAL(before.dropped_no_subscriber + 2, after.dropped_no_subscriber);
+	TEST_ASSERT_EQUAL(before.dropped_control + 1, after.dropped_control);
+	TEST_ASSERT_EQUAL(before.published, after.published);
+	TEST_ASSERT_EQUAL(0, after.pool_in_use);
+}
+
+static void test_delivery_in_order(void)
+{
+	event_payload_t payload = { .sta_disconnected = { .reason = 15, .rssi = -70 } };
+	const event_t *event;
+
+	host_stub_set_time_us(5000);
+	TEST_ASSERT(event_bus_publish(EVENT_TOPIC_WIFI_APP, 7, &payload));
+	TEST_ASSERT(event_bus_publish_control(EVENT_TOPIC_WIFI_APP, 8, NULL));
+
+	event = event_bus_receive(g_wifi_queue, 0);
+	TEST_ASSERT(event != NULL);
+	TEST_ASSERT_EQUAL(EVENT_TOPIC_WIFI_APP, event->topic);
+	TEST_ASSERT_EQUAL(7, event->id);
+	TEST_ASSERT_EQUAL(5000, event->timestamp_us);
+	TEST_ASSERT_EQUAL(15, event->data.sta_disconnected.reason);
+	TEST_ASSERT_EQUAL(-70, event->data.sta_disconnected.rssi);
+	event_bus_release(event);
+
+	event = event_bus_receive(g_wifi_queue, 0);
+	TEST_ASSERT(event != NULL);
+	TEST_ASSERT_EQUAL(8, event->id);
+	TEST_ASSERT_EQUAL(0, event->data.u32);
+	event_bus_release(event);
+
+	TEST_ASSERT(event_bus_receive(g_wifi_queue, 0) == NULL);
+}
+
+static void test_reserve_left_to_control(void)
+{
+	event_bus_stats_t before, after;
+	int accepted = 0;
+
+	event_bus_get_stats(&before);
+	while (event_bus_publish(EVENT_TOPIC_WIFI_APP, 1, NULL))
+	{
+		accepted++;
+	}
+	TEST_ASSERT_EQUAL(EVENT_BUS_POOL_SIZE - EVENT_BUS_CONTROL_RESERVE, accepted);
+
+	for (int i = 0; i < EVENT_BUS_CONTROL_RESERVE; i++)
+	{
+		TEST_ASSERT(event_bus_publish_control(EVENT_TOPIC_WIFI_APP, 2, NULL));
+	}
+	TEST_ASSERT(!event_bus_publish_control(EVENT_TOPIC_WIFI_APP, 2, NULL));
+
+	event_bus_get_stats(&after);
+	TEST_ASSERT_EQUAL(EVENT_BUS_POOL_SIZE, after.pool_in_use);
+	TEST_ASSERT_EQUAL(EVENT_BUS_POOL_SIZE, after.pool_high_water);
+	TEST_ASSERT_EQUAL(before.dropped_pool_full + 2, after.dropped_pool_full);
+	TEST_ASSERT_EQUAL(before.dropped_control + 1, after.dropped_control);
+
+	TEST_ASSERT_EQUAL(EVENT_BUS_POOL_SIZE, drain(g_wifi_queue));
+	event_bus_get_stats(&after);
+	TEST_ASSERT_EQUAL(0, after.pool_in_use);
+}
+
+static void test_control_needs_every_subscriber(void)
+{
+	event_bus_stats_t before, after;
+
+	// The WiFi queue listens on the monitor topic too, the monitor queue fills first
+	TEST_ASSERT_EQUAL(ESP_OK, event_bus_subscribe(EVENT_TOPIC_HTTP_MONITOR, g_wifi_queue));
+	for (int i = 0; i < MONITOR_QUEUE_DEPTH; i++)
+	{
+		TEST_ASSERT(event_bus_publish_control(EVENT_TOPIC_HTTP_MONITOR, 1, NULL));
+	}
+
+	event_bus_get_stats(&before);
+	TEST_ASSERT(!event_bus_publish_control(EVENT_TOPIC_HTTP_MONITOR, 2, NULL));
+	TEST_ASSERT(event_bus_publish(EVENT_TOPIC_HTTP_MONITOR, 3, NULL));
+	event_bus_get_stats(&after);
+
+	TEST_ASSERT_EQUAL(before.published + 2, after.published);
+	TEST_ASSERT_EQUAL(before.delivered + 2, after.delivered);
+	TEST_ASSERT_EQUAL(before.dropped_queue_full + 2, after.dropped_queue_full);
+	TEST_ASSERT_EQUAL(before.dropped_control + 1, after.dropped_control);
+
+	// The retry of the caller reaches the monitor queue once it has room
+	TEST_ASSERT_EQUAL(MONITOR_QUEUE_DEPTH, drain(g_monitor_queue));
+	TEST_ASSERT(event_bus_publish_control(EVENT_TOPIC_HTTP_MONITOR, 2, NULL));
+	TEST_ASSERT_EQUAL(1, drain(g_monitor_queue));
+	TEST_ASSERT_EQUAL(MONITOR_QUEUE_DEPTH + 3, drain(g_wifi_queue));
+
+	event_bus_get_stats(&after);
+	TEST_ASSERT_EQUAL(0, after.pool_in_use);
+}
+
+static void test_subscriber_limit(void)
+{
+	for (int i = 1; i < EVENT_BUS_MAX_SUBSCRIBERS; i++)
+	{
+		TEST_ASSERT_EQUAL(ESP_OK, event_bus_subscribe(EVENT_TOPIC_WIFI_APP, g_monitor_queue));
+	}
+	TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, event_bus_subscribe(EVENT_TOPIC_WIFI_APP, g_monitor_queue));
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, event_bus_subscribe(EVENT_TOPIC_COUNT, g_monitor_queue));
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, event_bus_subscribe(EVENT_TOPIC_WIFI_APP, NULL));
+}
+
+int main(void)
+{
+	event_bus_init();
+
+	RUN_TEST(test_no_subscriber);
+
+	g_wifi_queue = subscribe(EVENT_TOPIC_WIFI_APP, STATIC_QUEUE_WIFI_APP, WIFI_QUEUE_DEPTH);
+	g_monitor_queue = subscribe(EVENT_TOPIC_HTTP_MONITOR, STATIC_QUEUE_HTTP_SERVER_MONITOR, MONITOR_QUEUE_DEPTH);
+	if (g_wifi_queue == NULL || g_monitor_queue == NULL)
+	{
+		return 1;
+	}
+
+	RUN_TEST(test_delivery_in_order);
+	RUN_TEST(test_reserve_left_to_control);
+	RUN_TEST(test_control_needs_every_subscriber);
+	RUN_TEST(test_subscriber_limit);
+
+	return host_test_finish();
+}
@@ -0,0 +1,195 @@
+/*
+ * test_event_bus_stress.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "event_bus.h"
+#include "host_test.h"
+
+/*
+ * Publishers on several threads against one slow subscriber, as the WiFi task sees the
+ * event loop, timers and HTTP handlers. Prints the publish rate and the worst publish
+ * latency. On the host the critical section is a mutex, not the spinlock of the target:
+ * compare the figures between runs, not with the device.
+ */
+
+#define PUBLISHERS					4
+#define PUBLISHES_PER_THREAD		50000
+#define QUEUE_DEPTH					8			// WIFI_APP_QUEUE_DEPTH
+#define PUBLISH_BURST				16			// Publishes between yields of a publisher
+#define CONSUMER_PAUSE_EVERY		256			// The subscriber stalls now and then, the pool and queue fill up
+#define CONSUMER_PAUSE_US			200
+// A publish never waits, only scheduling delays it. Generous for loaded CI machines.
+#define MAX_PUBLISH_LATENCY_US		100000
+
+typedef struct publisher
+{
+	pthread_t thread;
+	unsigned int seed;
+	uint32_t attempts;
+	uint32_t accepted;				///> publish returned true
+	int64_t worst_us;
+} publisher_t;
+
+static QueueHandle_t g_queue;
+static volatile bool g_publishing;
+static uint32_t g_received;
+
+QueueHandle_t static_alloc_queue_create(static_queue_e id, UBaseType_t item_size)
+{
+	return xQueueCreate(QUEUE_DEPTH, item_size);
+}
+
+static int64_t monotonic_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Mostly ordinary events, every fourth one a control event and every eighth one on the
+ * topic without subscriber.
+ */
+static void* publisher_run(void *arg)
+{
+	publisher_t *pub = arg;
+
+	for (int i = 0; i < PUBLISHES_PER_THREAD; i++)
+	{
+		int kind = rand_r(&pub->seed) % 8;
+		event_payload_t payload = { .u32 = (uint32_t)i };
+		int64_t start = monotonic_us();
+		bool ok;
+
+		if (kind == 0)
+		{
+			ok = event_bus_publish(EVENT_TOPIC_HTTP_MONITOR, i, &payload);
+		}
+		else if (kind <= 2)
+		{
+			ok = event_bus_publish_control(EVENT_TOPIC_WIFI_APP, i, &payload);
+		}
+		else
+		{
+			ok = event_bus_publish(EVENT_TOPIC_WIFI_APP, i, &payload);
+		}
+
+		int64_t latency = monotonic_us() - start;
+		if (latency > pub->worst_us)
+		{
+			pub->worst_us = latency;
+		}
+		pub->attempts++;
+		pub->accepted += ok;
+		if (i % PUBLISH_BURST == PUBLISH_BURST - 1)
+		{
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void* consumer_run(void *arg)
+{
+	for (;;)
+	{
+		const event_t *event = event_bus_receive(g_queue, pdMS_TO_TICKS(10));
+
+		if (event == NULL)
+		{
+			if (!g_publishing)
+			{
+				return NULL;
+			}
+			continue;
+		}
+		event_bus_release(event);
+		if (++g_received % CONSUMER_PAUSE_EVERY == 0)
+		{
+			usleep(CONSUMER_PAUSE_US);
+		}
+	}
+}
+
+static void test_stress(void)
+{
+	publisher_t pubs[PUBLISHERS] = { 0 };
+	event_bus_stats_t before, after;
+	pthread_t consumer;
+	uint32_t attempts = 0;
+	uint32_t accepted = 0;
+	int64_t worst_us = 0;
+	int64_t start, elapsed_us;
+
+	event_bus_get_stats(&before);
+	g_publishing = true;
+	TEST_ASSERT_EQUAL(0, pthread_create(&consumer, NULL, consumer_run, NULL));
+
+	start = monotonic_us();
+	for (int i = 0; i < PUBLISHERS; i++)
+	{
+		pubs[i].seed = (unsigned int)i + 1;
+		TEST_ASSERT_EQUAL(0, pthread_create(&pubs[i].thread, NULL, publisher_run, &pubs[i]));
+	}
+	for (int i = 0; i < PUBLISHERS; i++)
+	{
+		pthread_join(pubs[i].thread, NULL);
+		attempts += pubs[i].attempts;
+		accepted += pubs[i].accepted;
+		if (pubs[i].worst_us > worst_us)
+		{
+			worst_us = pubs[i].worst_us;
+		}
+	}
+	elapsed_us = monotonic_us() - start;
+	g_publishing = false;
+	pthread_join(consumer, NULL);
+	event_bus_get_stats(&after);
+
+	uint32_t no_subscriber = after.dropped_no_subscriber - before.dropped_no_subscriber;
+	uint32_t pool_full = after.dropped_pool_full - before.dropped_pool_full;
+	uint32_t queue_full = after.dropped_queue_full - before.dropped_queue_full;
+
+	printf("%u publishes on %d threads in %lld ms: %.0f events/s, worst publish %lld us\n",
+			attempts, PUBLISHERS, (long long)(elapsed_us / 1000), attempts * 1e6 / (elapsed_us ? elapsed_us : 1),
+			(long long)worst_us);
+	printf("received %u, dropped: no subscriber %u, pool full %u, queue full %u, control %u, pool high water %u\n",
+			g_received, no_subscriber, pool_full, queue_full, after.dropped_control - before.dropped_control,
+			after.pool_high_water);
+
+	// Every publish is received once or counted in exactly one drop counter
+	TEST_ASSERT_EQUAL(PUBLISHERS * PUBLISHES_PER_THREAD, attempts);
+	TEST_ASSERT_EQUAL(attempts - g_received, no_subscriber + pool_full + queue_full);
+	TEST_ASSERT_EQUAL(after.published - before.published, attempts - no_subscriber - pool_full);
+	TEST_ASSERT_EQUAL(after.delivered - before.delivered, g_received);
+	// One subscriber: a publish reports success exactly when it was delivered
+	TEST_ASSERT_EQUAL(g_received, accepted);
+	TEST_ASSERT(no_subscriber > 0);
+	TEST_ASSERT(pool_full + queue_full > 0);
+	TEST_ASSERT_EQUAL(0, after.pool_in_use);
+	TEST_ASSERT(worst_us < MAX_PUBLISH_LATENCY_US);
+}
+
+int main(void)
+{
+	event_bus_init();
+	g_queue = event_bus_queue_create(STATIC_QUEUE_WIFI_APP);
+	if (g_queue == NULL || event_bus_subscribe(EVENT_TOPIC_WIFI_APP, g_queue) != ESP_OK)
+	{
+		return 1;
+	}
+
+	RUN_TEST(test_stress);
+
+	return host_test_finish();
+}
@@ -0,0 +1,169 @@
+/*
+ * test_http_admit.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "host_stubs.h"
+#include "host_test.h"
+#include "http_admit.h"
+#include "http_conn.h"
+#include "lwip/sockets.h"
+
+#define CLIENT_A					0x0A04A8C0		// 192.168.4.10, network order
+#define CLIENT_B					0x0B04A8C0		// 192.168.4.11
+#define MINUTE_US					60000000LL
+
+static nvs_config_t g_cfg;
+static uint32_t g_client;
+
+void nvs_config_get(nvs_config_t *cfg)
+{
+	*cfg = g_cfg;
+}
+
+uint32_t http_conn_client(httpd_req_t *req)
+{
+	return g_client;
+}
+
+void http_conn_request(httpd_req_t *req)
+{
+}
+
+/**
+ * One request of a client on a route class.
+ * @return HTTP status of the answer, 200 if the request was admitted.
+ */
+static int request(uint32_t client, http_admit_route_e route)
+{
+	httpd_req_t req;
+
+	g_client = client;
+	httpd_stub_req_init(&req, "/api/test", (void *)(intptr_t)route);
+	if (http_admit(&req))
+	{
+		return 200;
+	}
+	return req.status != NULL ? atoi(req.status) : 0;
+}
+
+/**
+ * Sets one route class, the others keep the firmware defaults.
+ */
+static void set_limit(http_admit_route_e route, uint16_t per_minute, uint16_t burst)
+{
+	memset(&g_cfg, 0, sizeof(g_cfg));
+	g_cfg.rate_limits[route].per_minute = per_minute;
+	g_cfg.rate_limits[route].burst = burst;
+	http_admit_load_limits();
+}
+
+static void test_burst_then_limited(void)
+{
+	httpd_req_t req;
+
+	set_limit(HTTP_ADMIT_CONTROL, 60, 3);
+	host_stub_set_time_us(MINUTE_US);
+
+	for (int i = 0; i < 3; i++)
+	{
+		TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	}
+	TEST_ASSERT_EQUAL(429, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+
+	// Another class and another client have their own buckets
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_READ));
+	TEST_ASSERT_EQUAL(200, request(CLIENT_B, HTTP_ADMIT_CONTROL));
+
+	// One token per second: the empty bucket asks for a retry after a second
+	g_client = CLIENT_A;
+	httpd_stub_req_init(&req, "/api/test", (void *)(intptr_t)HTTP_ADMIT_CONTROL);
+	TEST_ASSERT(!http_admit(&req));
+	TEST_ASSERT_EQUAL(0, req.body_len);
+	TEST_ASSERT(strstr(req.headers, "Retry-After: 2\n") != NULL);
+}
+
+static void test_refill_rate(void)
+{
+	set_limit(HTTP_ADMIT_CONTROL, 60, 2);
+	host_stub_set_time_us(MINUTE_US);
+
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	TEST_ASSERT_EQUAL(429, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+
+	host_stub_advance_us(999000);
+	TEST_ASSERT_EQUAL(429, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	host_stub_advance_us(1000);
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+
+	// Refilled up to the burst, not beyond
+	host_stub_advance_us(10 * MINUTE_US);
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	TEST_ASSERT_EQUAL(429, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+}
+
+static void test_long_idle_refills(void)
+{
+	// elapsed * per_minute * 1000 passes 2^64 by less than one token after this idle time
+	const int64_t wrap_us = 281479271744LL;
+
+	set_limit(HTTP_ADMIT_CONTROL, 65535, 2);
+	host_stub_set_time_us(MINUTE_US);
+
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	TEST_ASSERT_EQUAL(429, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+
+	host_stub_advance_us(wrap_us);
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+	TEST_ASSERT_EQUAL(429, request(CLIENT_A, HTTP_ADMIT_CONTROL));
+
+	// A year idle at the slowest rate
+	set_limit(HTTP_ADMIT_HEAVY, 1, 1);
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_HEAVY));
+	TEST_ASSERT_EQUAL(429, request(CLIENT_A, HTTP_ADMIT_HEAVY));
+	host_stub_advance_us(365LL * 24 * 60 * MINUTE_US);
+	TEST_ASSERT_EQUAL(200, request(CLIENT_A, HTTP_ADMIT_HEAVY));
+	TEST_ASSERT_EQUAL(429, request(CLIENT_A, HTTP_ADMIT_HEAVY));
+}
+
+static void test_loopback_and_heavy_hold(void)
+{
+	http_admit_stats_t before, after;
+
+	set_limit(HTTP_ADMIT_HEAVY, 1, 1);
+	http_admit_get_stats(&before);
+
+	for (int i = 0; i < 10; i++)
+	{
+		TEST_ASSERT_EQUAL(200, request(htonl(INADDR_LOOPBACK), HTTP_ADMIT_HEAVY));
+	}
+
+	http_admit_hold_heavy(true);
+	TEST_ASSERT_EQUAL(503, request(CLIENT_B, HTTP_ADMIT_HEAVY));
+	TEST_ASSERT_EQUAL(503, request(htonl(INADDR_LOOPBACK), HTTP_ADMIT_HEAVY));
+	TEST_ASSERT_EQUAL(200, request(CLIENT_B, HTTP_ADMIT_READ));
+	http_admit_hold_heavy(false);
+	TEST_ASSERT_EQUAL(200, request(CLIENT_B, HTTP_ADMIT_HEAVY));
+
+	http_admit_get_stats(&after);
+	TEST_ASSERT_EQUAL(before.admitted + 12, after.admitted);
+	TEST_ASSERT_EQUAL(before.busy + 2, after.busy);
+}
+
+int main(void)
+{
+	RUN_TEST(test_burst_then_limited);
+	RUN_TEST(test_refill_rate);
+	RUN_TEST(test_long_idle_refills);
+	RUN_TEST(test_loopback_and_heavy_hold);
+
+	return host_test_finish();
+}
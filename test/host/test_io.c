@@ -0,0 +1,155 @@
+/*
+ * test_io.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include "driver/gpio.h"
+#include "host_stubs.h"
+#include "host_test.h"
+#include "io.h"
+
+static const gpio_num_t g_led_pins[LED_COUNT] = { LED1_GPIO, LED2_GPIO, LED3_GPIO, LED4_GPIO };
+
+static int g_change_calls = 0;
+static uint8_t g_change_mask = 0;
+static int g_button_presses = 0;
+
+static void on_change(uint8_t mask)
+{
+	g_change_calls++;
+	g_change_mask = mask;
+}
+
+static void on_button(void)
+{
+	g_button_presses++;
+}
+
+static void reset(void)
+{
+	io_init();
+	io_led_set_change_callback(on_change);
+	g_change_calls = 0;
+	g_change_mask = 0;
+}
+
+/**
+ * The pins must always follow the LED states.
+ */
+static uint8_t pin_mask(void)
+{
+	uint8_t mask = 0;
+
+	for (int i = 0; i < LED_COUNT; i++)
+	{
+		if (gpio_get_level(g_led_pins[i]))
+		{
+			mask |= BIT(i);
+		}
+	}
+	return mask;
+}
+
+static void test_init_turns_all_off(void)
+{
+	reset();
+	io_led_write_mask(0x0F, 0x0F);
+	io_init();
+
+	TEST_ASSERT_EQUAL(0, io_led_get_mask());
+	TEST_ASSERT_EQUAL(0, pin_mask());
+}
+
+static void test_write_mask_changes_selected_leds(void)
+{
+	reset();
+
+	TEST_ASSERT_EQUAL(0x05, io_led_write_mask(0x05, 0x0F));
+	TEST_ASSERT_EQUAL(0x05, pin_mask());
+	// LED1 off, LED2 on, LED3 and LED4 untouched
+	TEST_ASSERT_EQUAL(0x06, io_led_write_mask(0x03, 0x02));
+	TEST_ASSERT_EQUAL(0x06, pin_mask());
+	TEST_ASSERT_EQUAL(LED_OFF, io_led_get_state(1));
+	TEST_ASSERT_EQUAL(LED_ON, io_led_get_state(2));
+	TEST_ASSERT_EQUAL(LED_ON, io_led_get_state(3));
+}
+
+static void test_toggle_mask(void)
+{
+	reset();
+
+	TEST_ASSERT_EQUAL(0x09, io_led_toggle_mask(0x09));
+	TEST_ASSERT_EQUAL(0x0A, io_led_toggle_mask(0x03));
+	TEST_ASSERT_EQUAL(0x0A, pin_mask());
+}
+
+static void test_change_callback(void)
+{
+	reset();
+
+	io_led_toggle_mask(0x02);
+	TEST_ASSERT_EQUAL(1, g_change_calls);
+	TEST_ASSERT_EQUAL(0x02, g_change_mask);
+
+	// Bits above LED_COUNT select no LED: no change, no callback
+	TEST_ASSERT_EQUAL(0x02, io_led_write_mask(0xF0, 0xF0));
+	TEST_ASSERT_EQUAL(1, g_change_calls);
+
+	io_led_set_change_callback(NULL);
+	io_led_toggle_mask(0x01);
+	TEST_ASSERT_EQUAL(1, g_change_calls);
+}
+
+static void test_single_led_api(void)
+{
+	reset();
+
+	TEST_ASSERT_EQUAL(ESP_OK, io_led_set(4, LED_ON));
+	TEST_ASSERT_EQUAL(ESP_OK, io_led_toggle(1));
+	TEST_ASSERT_EQUAL(0x09, io_led_get_mask());
+	TEST_ASSERT_EQUAL(0x09, pin_mask());
+
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, io_led_set(0, LED_ON));
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, io_led_toggle(LED_COUNT + 1));
+	TEST_ASSERT_EQUAL(-1, io_led_get_state(LED_COUNT + 1));
+	TEST_ASSERT_EQUAL(0x09, io_led_get_mask());
+}
+
+static void test_button_debounce(void)
+{
+	host_stub_set_time_us(1000000);
+	TEST_ASSERT_EQUAL(ESP_OK, io_button_init(GPIO_NUM_0, on_button));
+	TEST_ASSERT(!io_button_is_pressed());
+
+	gpio_mock_set_input(GPIO_NUM_0, 0);
+	TEST_ASSERT_EQUAL(1, g_button_presses);
+	TEST_ASSERT(io_button_is_pressed());
+
+	// Contact bounce within the debounce time
+	host_stub_advance_us(5000);
+	gpio_mock_set_input(GPIO_NUM_0, 1);
+	gpio_mock_set_input(GPIO_NUM_0, 0);
+	TEST_ASSERT_EQUAL(1, g_button_presses);
+
+	// Releasing does not press
+	host_stub_advance_us(IO_BUTTON_DEBOUNCE_US);
+	gpio_mock_set_input(GPIO_NUM_0, 1);
+	TEST_ASSERT_EQUAL(1, g_button_presses);
+	TEST_ASSERT(!io_button_is_pressed());
+
+	gpio_mock_set_input(GPIO_NUM_0, 0);
+	TEST_ASSERT_EQUAL(2, g_button_presses);
+}
+
+int main(void)
+{
+	RUN_TEST(test_init_turns_all_off);
+	RUN_TEST(test_write_mask_changes_selected_leds);
+	RUN_TEST(test_toggle_mask);
+	RUN_TEST(test_change_callback);
+	RUN_TEST(test_single_led_api);
+	RUN_TEST(test_button_debounce);
+	return host_test_finish();
+}
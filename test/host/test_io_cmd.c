@@ -0,0 +1,370 @@
+/*
+ * test_io_cmd.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "driver/gpio.h"
+#include "host_stubs.h"
+#include "host_test.h"
+#include "io.h"
+#include "io_cmd.h"
+#include "static_alloc.h"
+
+/*
+ * The IO task runs on its own thread. A test holds it in the change callback of a write,
+ * queues the commands it wants in one batch, then lets it go: everything queued by then
+ * is waiting when the task takes the next batch, whatever the timing of the machine.
+ */
+
+// Deeper than a batch, so a burst waiting at once has to be split
+#define QUEUE_DEPTH					(2 * IO_CMD_BATCH_MAX)
+#define SETTLE_LIMIT_MS				2000
+
+static const gpio_num_t g_led_pins[LED_COUNT] = { LED1_GPIO, LED2_GPIO, LED3_GPIO, LED4_GPIO };
+
+static pthread_mutex_t g_hold_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_hold_changed = PTHREAD_COND_INITIALIZER;
+static bool g_hold = false;
+static bool g_held = false;					///> the IO task waits in the change callback
+static int g_change_calls = 0;
+
+/**
+ * static_alloc.c is not linked: the queue gets QUEUE_DEPTH, the task a thread.
+ */
+QueueHandle_t static_alloc_queue_create(static_queue_e id, UBaseType_t item_size)
+{
+	return xQueueCreate(QUEUE_DEPTH, item_size);
+}
+
+TaskHandle_t static_alloc_task_create(static_task_e id, TaskFunction_t fn, void *arg)
+{
+	return host_stub_task_start(fn, arg);
+}
+
+static void on_change(uint8_t mask)
+{
+	pthread_mutex_lock(&g_hold_mutex);
+	g_change_calls++;
+	g_held = g_hold;
+	pthread_cond_broadcast(&g_hold_changed);
+	while (g_hold)
+	{
+		pthread_cond_wait(&g_hold_changed, &g_hold_mutex);
+	}
+	g_held = false;
+	pthread_mutex_unlock(&g_hold_mutex);
+}
+
+static int change_calls(void)
+{
+	int calls;
+
+	pthread_mutex_lock(&g_hold_mutex);
+	calls = g_change_calls;
+	pthread_mutex_unlock(&g_hold_mutex);
+	return calls;
+}
+
+/**
+ * Toggles LED4 and keeps the IO task in the change callback of that write.
+ */
+static void hold_io_task(void)
+{
+	pthread_mutex_lock(&g_hold_mutex);
+	g_hold = true;
+	pthread_mutex_unlock(&g_hold_mutex);
+
+	io_cmd_toggle(IO_CMD_SOURCE_HTTP, 0x08, NULL);
+
+	pthread_mutex_lock(&g_hold_mutex);
+	while (!g_held)
+	{
+		pthread_cond_wait(&g_hold_changed, &g_hold_mutex);
+	}
+	pthread_mutex_unlock(&g_hold_mutex);
+}
+
+static void release_io_task(void)
+{
+	pthread_mutex_lock(&g_hold_mutex);
+	g_hold = false;
+	pthread_cond_broadcast(&g_hold_changed);
+	pthread_mutex_unlock(&g_hold_mutex);
+}
+
+/**
+ * Waits until the IO task has applied `batches` batches in total.
+ */
+static bool wait_for_batches(uint32_t batches)
+{
+	io_cmd_stats_t stats;
+
+	for (int ms = 0; ms < SETTLE_LIMIT_MS; ms++)
+	{
+		io_cmd_get_stats(&stats);
+		if (stats.batches >= batches)
+		{
+			return stats.batches == batches;
+		}
+		usleep(1000);
+	}
+	return false;
+}
+
+static uint32_t commands_queued(void)
+{
+	io_cmd_stats_t stats;
+	uint32_t total = 0;
+
+	io_cmd_get_stats(&stats);
+	for (int i = 0; i < IO_CMD_SOURCE_COUNT; i++)
+	{
+		total += stats.commands[i];
+	}
+	return total;
+}
+
+static uint8_t pin_mask(void)
+{
+	uint8_t mask = 0;
+
+	for (int i = 0; i < LED_COUNT; i++)
+	{
+		if (gpio_get_level(g_led_pins[i]))
+		{
+			mask |= BIT(i);
+		}
+	}
+	return mask;
+}
+
+static void test_not_started(void)
+{
+	io_cmd_result_t result;
+
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, io_cmd_write(IO_CMD_SOURCE_HTTP, 0x01, 0x01, &result));
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, io_cmd_toggle(IO_CMD_SOURCE_HTTP, 0x01, NULL));
+}
+
+static void test_write_waits_for_result(void)
+{
+	io_cmd_result_t result;
+	io_cmd_result_t state;
+
+	TEST_ASSERT_EQUAL(ESP_OK, io_cmd_write(IO_CMD_SOURCE_HTTP, 0x03, 0x01, &result));
+	TEST_ASSERT_EQUAL(0x01, result.mask);
+	TEST_ASSERT_EQUAL(1, result.version);
+	TEST_ASSERT_EQUAL(0x01, pin_mask());
+
+	// A write that changes nothing keeps the version
+	TEST_ASSERT_EQUAL(ESP_OK, io_cmd_write(IO_CMD_SOURCE_UDP, 0x01, 0x01, &result));
+	TEST_ASSERT_EQUAL(0x01, result.mask);
+	TEST_ASSERT_EQUAL(1, result.version);
+
+	TEST_ASSERT_EQUAL(ESP_OK, io_cmd_toggle(IO_CMD_SOURCE_HTTP, 0x05, &result));
+	TEST_ASSERT_EQUAL(0x04, result.mask);
+	TEST_ASSERT_EQUAL(2, result.version);
+
+	io_cmd_get_state(&state);
+	TEST_ASSERT_EQUAL(result.mask, state.mask);
+	TEST_ASSERT_EQUAL(result.version, state.version);
+
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, io_cmd_toggle(IO_CMD_SOURCE_COUNT, 0x01, NULL));
+}
+
+static void test_window_merges_burst(void)
+{
+	io_cmd_stats_t before;
+	io_cmd_stats_t after;
+	io_cmd_result_t state;
+	int calls;
+
+	io_cmd_write(IO_CMD_SOURCE_HTTP, 0x0F, 0x00, &state);
+	io_cmd_get_stats(&before);
+	calls = change_calls();
+
+	hold_io_task();
+	io_cmd_write(IO_CMD_SOURCE_UDP, 0x07, 0x07, NULL);
+	io_cmd_toggle(IO_CMD_SOURCE_MQTT, 0x04, NULL);
+	io_cmd_write(IO_CMD_SOURCE_UDP, 0x02, 0x00, NULL);
+	io_cmd_toggle(IO_CMD_SOURCE_MQTT, 0x02, NULL);
+	release_io_task();
+
+	// The held write, then the four commands applied in order in one write
+	TEST_ASSERT(wait_for_batches(before.batches + 2));
+	io_cmd_get_stats(&after);
+	TEST_ASSERT_EQUAL(2, after.commands[IO_CMD_SOURCE_UDP] - before.commands[IO_CMD_SOURCE_UDP]);
+	TEST_ASSERT_EQUAL(2, after.commands[IO_CMD_SOURCE_MQTT] - before.commands[IO_CMD_SOURCE_MQTT]);
+	TEST_ASSERT(after.batch_high_water >= 4);
+	TEST_ASSERT_EQUAL(calls + 2, change_calls());
+
+	io_cmd_get_state(&state);
+	TEST_ASSERT_EQUAL(0x0B, state.mask);
+	TEST_ASSERT_EQUAL(0x0B, pin_mask());
+}
+
+static void test_toggles_cancel_out(void)
+{
+	io_cmd_stats_t before;
+	io_cmd_result_t state_before;
+	io_cmd_result_t state;
+	int calls;
+
+	io_cmd_get_stats(&before);
+	io_cmd_get_state(&state_before);
+	calls = change_calls();
+
+	hold_io_task();
+	io_cmd_toggle(IO_CMD_SOURCE_HTTP, 0x03, NULL);
+	io_cmd_toggle(IO_CMD_SOURCE_UDP, 0x03, NULL);
+	release_io_task();
+
+	// Only the held write reaches the pins and the version
+	TEST_ASSERT(wait_for_batches(before.batches + 2));
+	TEST_ASSERT_EQUAL(calls + 1, change_calls());
+	io_cmd_get_state(&state);
+	TEST_ASSERT_EQUAL(state_before.mask ^ 0x08, state.mask);
+	TEST_ASSERT_EQUAL(state_before.version + 1, state.version);
+	TEST_ASSERT_EQUAL(state.mask, pin_mask());
+}
+
+static void test_burst_split_at_batch_max(void)
+{
+	io_cmd_stats_t before;
+	io_cmd_stats_t after;
+	io_cmd_result_t state_before;
+	io_cmd_result_t state;
+	int calls;
+
+	io_cmd_get_stats(&before);
+	io_cmd_get_state(&state_before);
+	calls = change_calls();
+
+	// An even number of toggles in the first batch cancels out, the odd rest toggles LED1
+	hold_io_task();
+	for (int i = 0; i < IO_CMD_BATCH_MAX + 3; i++)
+	{
+		TEST_ASSERT_EQUAL(ESP_OK, io_cmd_toggle(IO_CMD_SOURCE_MQTT, 0x01, NULL));
+	}
+	release_io_task();
+
+	TEST_ASSERT(wait_for_batches(before.batches + 3));
+	io_cmd_get_stats(&after);
+	TEST_ASSERT_EQUAL(IO_CMD_BATCH_MAX, after.batch_high_water);
+	TEST_ASSERT_EQUAL(calls + 2, change_calls());
+
+	io_cmd_get_state(&state);
+	TEST_ASSERT_EQUAL(state_before.mask ^ 0x09, state.mask);
+	TEST_ASSERT_EQUAL(state_before.version + 2, state.version);
+}
+
+static void test_queue_full_refused(void)
+{
+	io_cmd_stats_t before;
+	io_cmd_stats_t after;
+
+	io_cmd_get_stats(&before);
+
+	hold_io_task();
+	for (int i = 0; i < QUEUE_DEPTH; i++)
+	{
+		TEST_ASSERT_EQUAL(ESP_OK, io_cmd_write(IO_CMD_SOURCE_HTTP, 0x01, 0x01, NULL));
+	}
+	// Refused after IO_CMD_SUBMIT_WAIT_MS
+	TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, io_cmd_write(IO_CMD_SOURCE_HTTP, 0x01, 0x01, NULL));
+	io_cmd_get_stats(&after);
+	TEST_ASSERT_EQUAL(before.queue_full + 1, after.queue_full);
+	release_io_task();
+
+	TEST_ASSERT(wait_for_batches(before.batches + 3));
+}
+
+typedef struct waiter_arg
+{
+	pthread_t thread;
+	uint8_t mask;
+	io_cmd_result_t result;
+	esp_err_t err;
+} waiter_arg_t;
+
+static void *waiter_thread(void *arg)
+{
+	waiter_arg_t *waiter = arg;
+
+	waiter->err = io_cmd_write(IO_CMD_SOURCE_UDP, waiter->mask, waiter->mask, &waiter->result);
+	return NULL;
+}
+
+static void test_waiters_get_their_batch(void)
+{
+	waiter_arg_t waiters[2] = { { .mask = 0x01 }, { .mask = 0x02 } };
+	io_cmd_result_t state;
+	uint32_t queued;
+
+	io_cmd_write(IO_CMD_SOURCE_HTTP, 0x0F, 0x00, &state);
+
+	hold_io_task();
+	queued = commands_queued();
+	for (int i = 0; i < 2; i++)
+	{
+		pthread_create(&waiters[i].thread, NULL, waiter_thread, &waiters[i]);
+	}
+	for (int ms = 0; ms < SETTLE_LIMIT_MS && commands_queued() < queued + 2; ms++)
+	{
+		usleep(1000);
+	}
+	release_io_task();
+
+	// Both callers wake up with the state after the batch they were in
+	for (int i = 0; i < 2; i++)
+	{
+		pthread_join(waiters[i].thread, NULL);
+		TEST_ASSERT_EQUAL(ESP_OK, waiters[i].err);
+		TEST_ASSERT_EQUAL(0x0B, waiters[i].result.mask);
+	}
+	TEST_ASSERT_EQUAL(waiters[0].result.version, waiters[1].result.version);
+
+	io_cmd_get_state(&state);
+	TEST_ASSERT_EQUAL(state.version, waiters[0].result.version);
+}
+
+static void test_caller_notification_kept(void)
+{
+	io_cmd_result_t result;
+	io_cmd_result_t state;
+
+	// A scene_run for the caller's own task arrives before its write is answered
+	xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+	io_cmd_get_state(&state);
+	TEST_ASSERT_EQUAL(ESP_OK, io_cmd_toggle(IO_CMD_SOURCE_SCENE, 0x04, &result));
+	TEST_ASSERT_EQUAL(state.mask ^ 0x04, result.mask);
+
+	// The write neither took it nor left its own answer there
+	TEST_ASSERT_EQUAL(1, ulTaskNotifyTake(pdTRUE, 0));
+	TEST_ASSERT_EQUAL(0, ulTaskNotifyTake(pdTRUE, 0));
+}
+
+int main(void)
+{
+	io_init();
+	io_led_set_change_callback(on_change);
+
+	RUN_TEST(test_not_started);
+
+	io_cmd_start();
+
+	RUN_TEST(test_write_waits_for_result);
+	RUN_TEST(test_window_merges_burst);
+	RUN_TEST(test_toggles_cancel_out);
+	RUN_TEST(test_burst_split_at_batch_max);
+	RUN_TEST(test_queue_full_refused);
+	RUN_TEST(test_waiters_get_their_batch);
+	RUN_TEST(test_caller_notification_kept);
+
+	return host_test_finish();
+}
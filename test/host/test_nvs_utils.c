@@ -0,0 +1,564 @@
+/*
+ * test_nvs_utils.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <pthread.h>
+
+#include "esp_crc.h"
+#include "host_test.h"
+#include "nvs.h"
+#include "nvs_utils.h"
+
+#define NAMESPACE					"device_storage"
+#define HEADER_SIZE					10
+
+static nvs_handle_t storage(void)
+{
+	nvs_handle_t handle = 0;
+
+	nvs_open(NAMESPACE, NVS_READWRITE, &handle);
+	return handle;
+}
+
+static size_t blob_size(const char *key)
+{
+	size_t size = 0;
+
+	return nvs_get_blob(storage(), key, NULL, &size) == ESP_OK ? size : 0;
+}
+
+static void sample_config(nvs_config_t *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	strcpy(cfg->network.ssid, "home");
+	strcpy(cfg->network.password, "secret123");
+	memcpy(cfg->sta_cache.bssid, "\x10\x20\x30\x40\x50\x60", 6);
+	cfg->sta_cache.channel = 11;
+	cfg->static_ip.enabled = true;
+	cfg->static_ip.ip = 0x3200A8C0;
+	cfg->static_ip.netmask = 0x00FFFFFF;
+	cfg->static_ip.gw = 0x0100A8C0;
+	cfg->static_ip.dns = 0x08080808;
+	strcpy(cfg->auth.user, "admin");
+	cfg->auth.iterations = 10000;
+	memset(cfg->auth.salt, 0x5A, sizeof(cfg->auth.salt));
+	memset(cfg->auth.hash, 0xA5, sizeof(cfg->auth.hash));
+	cfg->rate_limits[1].per_minute = 30;
+	cfg->rate_limits[1].burst = 5;
+}
+
+/**
+ * Saves a good record of sample_config, returns it with the last payload byte flipped.
+ */
+static size_t corrupt_record(uint8_t *record, size_t record_size)
+{
+	nvs_config_t cfg;
+	size_t size = record_size;
+
+	sample_config(&cfg);
+	nvs_config_set(&cfg);
+	nvs_get_blob(storage(), "config", record, &size);
+	record[size - 1] ^= 0xFF;
+	nvs_set_blob(storage(), "config", record, size);
+	return size;
+}
+
+/**
+ * Value of a field in the stored record, NULL if it has no such tag.
+ */
+static const uint8_t* record_field(const uint8_t *record, size_t size, uint8_t tag, uint8_t *len)
+{
+	for (size_t off = HEADER_SIZE; off + 2 <= size; off += 2 + record[off + 1])
+	{
+		if (record[off] == tag)
+		{
+			*len = record[off + 1];
+			return &record[off + 2];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Stores a version 1 record with the given TLV payload.
+ */
+static void write_record(const uint8_t *payload, uint16_t length)
+{
+	uint8_t record[NVS_CONFIG_MAX_SIZE];
+	uint32_t crc = esp_crc32_le(0, payload, length);
+
+	record[0] = 0x43;
+	record[1] = 0x46;
+	record[2] = 1;
+	record[3] = 0;
+	memcpy(&record[4], &length, 2);
+	memcpy(&record[6], &crc, 4);
+	memcpy(&record[HEADER_SIZE], payload, length);
+	nvs_set_blob(storage(), "config", record, HEADER_SIZE + length);
+}
+
+static void reset(void)
+{
+	host_stub_nvs_clear();
+	nvs_config_load();
+}
+
+static void test_empty_storage_uses_defaults(void)
+{
+	nvs_config_t cfg;
+
+	host_stub_nvs_clear();
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_init_storage());
+
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL_STRING("", cfg.network.ssid);
+	TEST_ASSERT_EQUAL(0, cfg.static_ip.enabled);
+	TEST_ASSERT_EQUAL(0, cfg.auth.iterations);
+	// The migration from v0 writes the first record
+	TEST_ASSERT(blob_size("config") > 0);
+}
+
+static void test_record_round_trip(void)
+{
+	nvs_config_t cfg;
+	nvs_config_t loaded;
+
+	reset();
+	sample_config(&cfg);
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_set(&cfg));
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+
+	nvs_config_get(&loaded);
+	TEST_ASSERT_EQUAL_STRING("home", loaded.network.ssid);
+	TEST_ASSERT_EQUAL_STRING("secret123", loaded.network.password);
+	TEST_ASSERT_EQUAL_MEMORY(cfg.sta_cache.bssid, loaded.sta_cache.bssid, 6);
+	TEST_ASSERT_EQUAL(11, loaded.sta_cache.channel);
+	TEST_ASSERT_EQUAL(1, loaded.static_ip.enabled);
+	TEST_ASSERT_EQUAL(cfg.static_ip.ip, loaded.static_ip.ip);
+	TEST_ASSERT_EQUAL(cfg.static_ip.netmask, loaded.static_ip.netmask);
+	TEST_ASSERT_EQUAL(cfg.static_ip.gw, loaded.static_ip.gw);
+	TEST_ASSERT_EQUAL(cfg.static_ip.dns, loaded.static_ip.dns);
+	TEST_ASSERT_EQUAL_STRING("admin", loaded.auth.user);
+	TEST_ASSERT_EQUAL(10000, loaded.auth.iterations);
+	TEST_ASSERT_EQUAL_MEMORY(cfg.auth.hash, loaded.auth.hash, sizeof(cfg.auth.hash));
+	TEST_ASSERT_EQUAL(30, loaded.rate_limits[1].per_minute);
+	TEST_ASSERT_EQUAL(5, loaded.rate_limits[1].burst);
+}
+
+static void test_legacy_record_migrated(void)
+{
+	nvs_network_data_t legacy = { .ssid = "old_ap", .password = "old_pass" };
+	nvs_network_data_t network;
+
+	host_stub_nvs_clear();
+	nvs_set_blob(storage(), "wifi_config", &legacy, sizeof(legacy));
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_load_network_data(&network));
+	TEST_ASSERT_EQUAL_STRING("old_ap", network.ssid);
+	TEST_ASSERT_EQUAL_STRING("old_pass", network.password);
+	TEST_ASSERT_EQUAL(0, blob_size("wifi_config"));
+	TEST_ASSERT(blob_size("config") > 0);
+}
+
+static void test_corrupted_record_kept_not_migrated(void)
+{
+	nvs_network_data_t legacy = { .ssid = "old_ap", .password = "old_pass" };
+	uint8_t corrupt[NVS_CONFIG_MAX_SIZE];
+	uint8_t stored[NVS_CONFIG_MAX_SIZE];
+	size_t size;
+	nvs_config_t cfg;
+
+	reset();
+	size = corrupt_record(corrupt, sizeof(corrupt));
+	nvs_set_blob(storage(), "wifi_config", &legacy, sizeof(legacy));
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL_STRING("", cfg.network.ssid);
+	TEST_ASSERT_EQUAL(0, cfg.auth.iterations);
+
+	// Backup copy, the record itself untouched, the legacy key not imported
+	TEST_ASSERT_EQUAL(size, blob_size("config_bad"));
+	nvs_get_blob(storage(), "config_bad", stored, &size);
+	TEST_ASSERT_EQUAL_MEMORY(corrupt, stored, size);
+	nvs_get_blob(storage(), "config", stored, &size);
+	TEST_ASSERT_EQUAL_MEMORY(corrupt, stored, size);
+	TEST_ASSERT_EQUAL(sizeof(legacy), blob_size("wifi_config"));
+
+	// Loading again finds the same record and changes nothing
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_get_blob(storage(), "config", stored, &size);
+	TEST_ASSERT_EQUAL_MEMORY(corrupt, stored, size);
+}
+
+static void test_short_record_kept(void)
+{
+	const uint8_t garbage[3] = { 0x43, 0x46, 0x01 };
+	nvs_config_t cfg;
+
+	reset();
+	nvs_set_blob(storage(), "config", garbage, sizeof(garbage));
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL_STRING("", cfg.network.ssid);
+	TEST_ASSERT_EQUAL(sizeof(garbage), blob_size("config"));
+	TEST_ASSERT_EQUAL(sizeof(garbage), blob_size("config_bad"));
+}
+
+static void test_set_replaces_corrupted_record(void)
+{
+	uint8_t corrupt[NVS_CONFIG_MAX_SIZE];
+	nvs_config_t cfg;
+
+	reset();
+	corrupt_record(corrupt, sizeof(corrupt));
+	nvs_config_load();
+
+	sample_config(&cfg);
+	strcpy(cfg.network.ssid, "fresh");
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_set(&cfg));
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL_STRING("fresh", cfg.network.ssid);
+	TEST_ASSERT(blob_size("config_bad") > 0);
+}
+
+static void test_static_ip_fixed_width_fields(void)
+{
+	static const struct
+	{
+		uint8_t tag;
+		uint8_t len;
+		const char *value;
+	} fields[] = {
+		{ 0x08, 1, "\x01" },
+		{ 0x09, 4, "\xC0\xA8\x00\x32" },
+		{ 0x0A, 4, "\xFF\xFF\xFF\x00" },
+		{ 0x0B, 4, "\xC0\xA8\x00\x01" },
+		{ 0x0C, 4, "\x08\x08\x08\x08" },
+	};
+	uint8_t record[NVS_CONFIG_MAX_SIZE];
+	size_t size = sizeof(record);
+	nvs_config_t cfg;
+	uint8_t len;
+
+	reset();
+	sample_config(&cfg);
+	nvs_config_set(&cfg);
+	nvs_get_blob(storage(), "config", record, &size);
+
+	TEST_ASSERT(record_field(record, size, 0x05, &len) == NULL);
+	for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+	{
+		const uint8_t *value = record_field(record, size, fields[i].tag, &len);
+
+		TEST_ASSERT(value != NULL);
+		TEST_ASSERT_EQUAL(fields[i].len, len);
+		TEST_ASSERT_EQUAL_MEMORY(fields[i].value, value, len);
+	}
+}
+
+static void test_static_ip_struct_of_older_firmware(void)
+{
+	nvs_static_ip_t old = { .enabled = true, .ip = 0x3200A8C0, .netmask = 0x00FFFFFF, .gw = 0x0100A8C0, .dns = 0x01010101 };
+	uint8_t payload[2 + sizeof(old) + 6];
+	nvs_config_t cfg;
+
+	reset();
+	payload[0] = 0x01;
+	payload[1] = 4;
+	memcpy(&payload[2], "home", 4);
+	payload[6] = 0x05;
+	payload[7] = sizeof(old);
+	memcpy(&payload[8], &old, sizeof(old));
+	write_record(payload, sizeof(payload));
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL_STRING("home", cfg.network.ssid);
+	TEST_ASSERT_EQUAL(1, cfg.static_ip.enabled);
+	TEST_ASSERT_EQUAL(old.ip, cfg.static_ip.ip);
+	TEST_ASSERT_EQUAL(old.netmask, cfg.static_ip.netmask);
+	TEST_ASSERT_EQUAL(old.gw, cfg.static_ip.gw);
+	TEST_ASSERT_EQUAL(old.dns, cfg.static_ip.dns);
+}
+
+static void test_static_ip_wrong_width_ignored(void)
+{
+	static const uint8_t payload[] = {
+		0x08, 1, 0x01,
+		0x09, 4, 0xC0, 0xA8, 0x00, 0x32,
+		0x0A, 2, 0xFF, 0xFF,
+	};
+	nvs_config_t cfg;
+
+	reset();
+	write_record(payload, sizeof(payload));
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL(1, cfg.static_ip.enabled);
+	TEST_ASSERT_EQUAL(0x3200A8C0, cfg.static_ip.ip);
+	TEST_ASSERT_EQUAL(0, cfg.static_ip.netmask);
+}
+
+static void test_auth_fixed_width_fields(void)
+{
+	uint8_t record[NVS_CONFIG_MAX_SIZE];
+	size_t size = sizeof(record);
+	nvs_config_t cfg;
+	const uint8_t *value;
+	uint8_t len;
+
+	reset();
+	sample_config(&cfg);
+	nvs_config_set(&cfg);
+	nvs_get_blob(storage(), "config", record, &size);
+
+	TEST_ASSERT(record_field(record, size, 0x06, &len) == NULL);
+	value = record_field(record, size, 0x0D, &len);
+	TEST_ASSERT(value != NULL);
+	TEST_ASSERT_EQUAL(5, len);
+	TEST_ASSERT_EQUAL_MEMORY("admin", value, len);
+	value = record_field(record, size, 0x0E, &len);
+	TEST_ASSERT(value != NULL);
+	TEST_ASSERT_EQUAL(4, len);
+	TEST_ASSERT_EQUAL_MEMORY("\x10\x27\x00\x00", value, len);
+	value = record_field(record, size, 0x0F, &len);
+	TEST_ASSERT(value != NULL);
+	TEST_ASSERT_EQUAL(sizeof(cfg.auth.salt), len);
+	TEST_ASSERT_EQUAL_MEMORY(cfg.auth.salt, value, len);
+	value = record_field(record, size, 0x10, &len);
+	TEST_ASSERT(value != NULL);
+	TEST_ASSERT_EQUAL(sizeof(cfg.auth.hash), len);
+	TEST_ASSERT_EQUAL_MEMORY(cfg.auth.hash, value, len);
+}
+
+static void test_auth_cleared_writes_no_fields(void)
+{
+	uint8_t record[NVS_CONFIG_MAX_SIZE];
+	size_t size = sizeof(record);
+	nvs_config_t cfg;
+	uint8_t len;
+
+	reset();
+	sample_config(&cfg);
+	memset(&cfg.auth, 0, sizeof(cfg.auth));
+	nvs_config_set(&cfg);
+	nvs_get_blob(storage(), "config", record, &size);
+
+	for (uint8_t tag = 0x0D; tag <= 0x10; tag++)
+	{
+		TEST_ASSERT(record_field(record, size, tag, &len) == NULL);
+	}
+}
+
+static void test_auth_struct_of_older_firmware(void)
+{
+	nvs_auth_t old = { .user = "admin", .iterations = 20000 };
+	uint8_t payload[2 + sizeof(old)];
+	nvs_config_t cfg;
+
+	reset();
+	memset(old.salt, 0x11, sizeof(old.salt));
+	memset(old.hash, 0x22, sizeof(old.hash));
+	payload[0] = 0x06;
+	payload[1] = sizeof(old);
+	memcpy(&payload[2], &old, sizeof(old));
+	write_record(payload, sizeof(payload));
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL_STRING("admin", cfg.auth.user);
+	TEST_ASSERT_EQUAL(20000, cfg.auth.iterations);
+	TEST_ASSERT_EQUAL_MEMORY(old.salt, cfg.auth.salt, sizeof(old.salt));
+	TEST_ASSERT_EQUAL_MEMORY(old.hash, cfg.auth.hash, sizeof(old.hash));
+}
+
+static void test_auth_wrong_width_ignored(void)
+{
+	static const uint8_t payload[] = {
+		0x0D, 5, 'a', 'd', 'm', 'i', 'n',
+		0x0E, 2, 0x10, 0x27,
+		0x0F, 4, 0x11, 0x11, 0x11, 0x11,
+	};
+	static const uint8_t no_salt[16] = { 0 };
+	nvs_config_t cfg;
+
+	reset();
+	write_record(payload, sizeof(payload));
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL_STRING("admin", cfg.auth.user);
+	TEST_ASSERT_EQUAL(0, cfg.auth.iterations);
+	TEST_ASSERT_EQUAL_MEMORY(no_salt, cfg.auth.salt, sizeof(no_salt));
+}
+
+static void test_rate_limits_fixed_width_fields(void)
+{
+	uint8_t record[NVS_CONFIG_MAX_SIZE];
+	size_t size = sizeof(record);
+	nvs_config_t cfg;
+	const uint8_t *value;
+	uint8_t len;
+
+	reset();
+	sample_config(&cfg);
+	cfg.rate_limits[3].per_minute = 600;
+	nvs_config_set(&cfg);
+	nvs_get_blob(storage(), "config", record, &size);
+
+	TEST_ASSERT(record_field(record, size, 0x07, &len) == NULL);
+	value = record_field(record, size, 0x21, &len);
+	TEST_ASSERT(value != NULL);
+	TEST_ASSERT_EQUAL(2, len);
+	TEST_ASSERT_EQUAL_MEMORY("\x1E\x00", value, len);
+	value = record_field(record, size, 0x29, &len);
+	TEST_ASSERT(value != NULL);
+	TEST_ASSERT_EQUAL(2, len);
+	TEST_ASSERT_EQUAL_MEMORY("\x05\x00", value, len);
+	value = record_field(record, size, 0x23, &len);
+	TEST_ASSERT(value != NULL);
+	TEST_ASSERT_EQUAL_MEMORY("\x58\x02", value, len);
+
+	// Firmware defaults are not stored
+	TEST_ASSERT(record_field(record, size, 0x20, &len) == NULL);
+	TEST_ASSERT(record_field(record, size, 0x28, &len) == NULL);
+	TEST_ASSERT(record_field(record, size, 0x2B, &len) == NULL);
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL(600, cfg.rate_limits[3].per_minute);
+	TEST_ASSERT_EQUAL(0, cfg.rate_limits[3].burst);
+}
+
+static void test_rate_limits_struct_of_older_firmware(void)
+{
+	nvs_rate_limit_t old[NVS_RATE_LIMIT_ROUTES] = { [0] = { 120, 20 }, [2] = { 6, 2 } };
+	uint8_t payload[2 + sizeof(old)];
+	nvs_config_t cfg;
+
+	reset();
+	payload[0] = 0x07;
+	payload[1] = sizeof(old);
+	memcpy(&payload[2], old, sizeof(old));
+	write_record(payload, sizeof(payload));
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL(120, cfg.rate_limits[0].per_minute);
+	TEST_ASSERT_EQUAL(20, cfg.rate_limits[0].burst);
+	TEST_ASSERT_EQUAL(6, cfg.rate_limits[2].per_minute);
+	TEST_ASSERT_EQUAL(2, cfg.rate_limits[2].burst);
+}
+
+static void test_rate_limits_unknown_class_and_width_ignored(void)
+{
+	static const uint8_t payload[] = {
+		0x20, 2, 0x3C, 0x00,
+		0x28, 4, 0x0A, 0x00, 0x00, 0x00,
+		0x27, 2, 0xFF, 0xFF,
+	};
+	nvs_config_t cfg;
+
+	reset();
+	write_record(payload, sizeof(payload));
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL(60, cfg.rate_limits[0].per_minute);
+	TEST_ASSERT_EQUAL(0, cfg.rate_limits[0].burst);
+	for (int i = 1; i < NVS_RATE_LIMIT_ROUTES; i++)
+	{
+		TEST_ASSERT_EQUAL(0, cfg.rate_limits[i].per_minute);
+	}
+}
+
+#define UPDATES_PER_WRITER			500
+
+static bool bump_route(nvs_config_t *cfg, void *ctx)
+{
+	cfg->rate_limits[(intptr_t)ctx].per_minute++;
+	return true;
+}
+
+static void* update_writer(void *arg)
+{
+	for (int i = 0; i < UPDATES_PER_WRITER; i++)
+	{
+		nvs_config_update(bump_route, arg);
+	}
+	return NULL;
+}
+
+static bool keep_record(nvs_config_t *cfg, void *ctx)
+{
+	strcpy(cfg->network.ssid, "not saved");
+	return false;
+}
+
+static void test_update_writers_keep_each_others_fields(void)
+{
+	pthread_t writers[NVS_RATE_LIMIT_ROUTES];
+	nvs_config_t cfg;
+
+	reset();
+	for (intptr_t i = 0; i < NVS_RATE_LIMIT_ROUTES; i++)
+	{
+		pthread_create(&writers[i], NULL, update_writer, (void *)i);
+	}
+	for (int i = 0; i < NVS_RATE_LIMIT_ROUTES; i++)
+	{
+		pthread_join(writers[i], NULL);
+	}
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_load());
+	nvs_config_get(&cfg);
+	for (int i = 0; i < NVS_RATE_LIMIT_ROUTES; i++)
+	{
+		TEST_ASSERT_EQUAL(UPDATES_PER_WRITER, cfg.rate_limits[i].per_minute);
+	}
+}
+
+static void test_update_false_writes_nothing(void)
+{
+	nvs_config_t cfg;
+
+	reset();
+	nvs_erase_key(storage(), "config");
+
+	TEST_ASSERT_EQUAL(ESP_OK, nvs_config_update(keep_record, NULL));
+	TEST_ASSERT_EQUAL(0, blob_size("config"));
+	nvs_config_get(&cfg);
+	TEST_ASSERT_EQUAL_STRING("", cfg.network.ssid);
+}
+
+int main(void)
+{
+	RUN_TEST(test_empty_storage_uses_defaults);
+	RUN_TEST(test_record_round_trip);
+	RUN_TEST(test_legacy_record_migrated);
+	RUN_TEST(test_corrupted_record_kept_not_migrated);
+	RUN_TEST(test_short_record_kept);
+	RUN_TEST(test_set_replaces_corrupted_record);
+	RUN_TEST(test_static_ip_fixed_width_fields);
+	RUN_TEST(test_static_ip_struct_of_older_firmware);
+	RUN_TEST(test_static_ip_wrong_width_ignored);
+	RUN_TEST(test_auth_fixed_width_fields);
+	RUN_TEST(test_auth_cleared_writes_no_fields);
+	RUN_TEST(test_auth_struct_of_older_firmware);
+	RUN_TEST(test_auth_wrong_width_ignored);
+	RUN_TEST(test_rate_limits_fixed_width_fields);
+	RUN_TEST(test_rate_limits_struct_of_older_firmware);
+	RUN_TEST(test_rate_limits_unknown_class_and_width_ignored);
+	RUN_TEST(test_update_writers_keep_each_others_fields);
+	RUN_TEST(test_update_false_writes_nothing);
+	return host_test_finish();
+}
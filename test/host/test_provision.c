@@ -0,0 +1,178 @@
+/*
+ * test_provision.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <string.h>
+
+#include "auth.h"
+#include "cbor_codec.h"
+#include "host_test.h"
+#include "http_conn.h"
+#include "provision.h"
+
+// http_admit.c is linked for the route names only
+
+void nvs_config_get(nvs_config_t *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+}
+
+uint32_t http_conn_client(httpd_req_t *req)
+{
+	return 0;
+}
+
+void http_conn_request(httpd_req_t *req)
+{
+}
+
+static nvs_config_t sample_config(void)
+{
+	nvs_config_t cfg = { 0 };
+
+	strcpy(cfg.network.ssid, "home");
+	strcpy(cfg.network.password, "secret");
+	cfg.static_ip.enabled = true;
+	cfg.static_ip.ip = 0x3200A8C0;
+	cfg.static_ip.netmask = 0x00FFFFFF;
+	cfg.static_ip.gw = 0x0100A8C0;
+	cfg.static_ip.dns = 0x08080808;
+	strcpy(cfg.auth.user, "admin");
+	cfg.auth.iterations = CONFIG_AUTH_PBKDF2_ITERATIONS;
+	memset(cfg.auth.salt, 0x5A, sizeof(cfg.auth.salt));
+	memset(cfg.auth.hash, 0xA5, sizeof(cfg.auth.hash));
+	cfg.rate_limits[1].per_minute = 120;
+	cfg.rate_limits[1].burst = 5;
+	return cfg;
+}
+
+/**
+ * Document with only an auth section.
+ */
+static size_t auth_document(uint8_t *buf, size_t size, uint32_t iterations)
+{
+	nvs_config_t cfg = sample_config();
+	cbor_writer_t w;
+
+	cbor_writer_init(&w, buf, size);
+	cbor_put_map(&w, 2);
+	cbor_put_text(&w, "version");
+	cbor_put_uint(&w, PROVISION_DOC_VERSION);
+	cbor_put_text(&w, "auth");
+	cbor_put_map(&w, 4);
+	cbor_put_text(&w, "user");
+	cbor_put_text(&w, cfg.auth.user);
+	cbor_put_text(&w, "iterations");
+	cbor_put_uint(&w, iterations);
+	cbor_put_text(&w, "salt");
+	cbor_put_bytes(&w, cfg.auth.salt, sizeof(cfg.auth.salt));
+	cbor_put_text(&w, "hash");
+	cbor_put_bytes(&w, cfg.auth.hash, sizeof(cfg.auth.hash));
+	return w.overflow ? 0 : w.len;
+}
+
+/**
+ * Imports an auth section onto an empty configuration.
+ * @return the import result, cfg gets the configuration after it.
+ */
+static esp_err_t import_iterations(uint64_t iterations, nvs_config_t *cfg, const char **error)
+{
+	uint8_t buf[PROVISION_DOC_MAX_SIZE];
+	size_t len = auth_document(buf, sizeof(buf), iterations);
+
+	memset(cfg, 0, sizeof(*cfg));
+	*error = NULL;
+	return provision_import(buf, len, cfg, error);
+}
+
+static void test_round_trip(void)
+{
+	nvs_config_t cfg = sample_config();
+	nvs_config_t imported = { 0 };
+	uint8_t buf[PROVISION_DOC_MAX_SIZE];
+	const char *error = NULL;
+	size_t len;
+
+	TEST_ASSERT_EQUAL(ESP_OK, provision_export(&cfg, buf, sizeof(buf), &len));
+	TEST_ASSERT_EQUAL(ESP_OK, provision_import(buf, len, &imported, &error));
+	TEST_ASSERT_EQUAL_STRING(cfg.network.ssid, imported.network.ssid);
+	TEST_ASSERT_EQUAL_STRING(cfg.network.password, imported.network.password);
+	TEST_ASSERT(imported.static_ip.enabled);
+	TEST_ASSERT_EQUAL(cfg.static_ip.ip, imported.static_ip.ip);
+	TEST_ASSERT_EQUAL(cfg.static_ip.netmask, imported.static_ip.netmask);
+	TEST_ASSERT_EQUAL(cfg.static_ip.gw, imported.static_ip.gw);
+	TEST_ASSERT_EQUAL(cfg.static_ip.dns, imported.static_ip.dns);
+	TEST_ASSERT_EQUAL_STRING(cfg.auth.user, imported.auth.user);
+	TEST_ASSERT_EQUAL(cfg.auth.iterations, imported.auth.iterations);
+	TEST_ASSERT_EQUAL_MEMORY(cfg.auth.salt, imported.auth.salt, sizeof(cfg.auth.salt));
+	TEST_ASSERT_EQUAL_MEMORY(cfg.auth.hash, imported.auth.hash, sizeof(cfg.auth.hash));
+	TEST_ASSERT_EQUAL_MEMORY(cfg.rate_limits, imported.rate_limits, sizeof(cfg.rate_limits));
+}
+
+static void test_iterations_in_range(void)
+{
+	nvs_config_t cfg;
+	const char *error;
+
+	TEST_ASSERT_EQUAL(ESP_OK, import_iterations(AUTH_PBKDF2_ITERATIONS_MIN, &cfg, &error));
+	TEST_ASSERT_EQUAL(AUTH_PBKDF2_ITERATIONS_MIN, cfg.auth.iterations);
+	TEST_ASSERT_EQUAL_STRING("admin", cfg.auth.user);
+
+	TEST_ASSERT_EQUAL(ESP_OK, import_iterations(AUTH_PBKDF2_ITERATIONS_MAX, &cfg, &error));
+	TEST_ASSERT_EQUAL(AUTH_PBKDF2_ITERATIONS_MAX, cfg.auth.iterations);
+}
+
+static void test_iterations_out_of_range(void)
+{
+	const uint64_t rejected[] = { 1, AUTH_PBKDF2_ITERATIONS_MIN - 1, AUTH_PBKDF2_ITERATIONS_MAX + 1, UINT32_MAX, (uint64_t)UINT32_MAX + 1 };
+	nvs_config_t cfg;
+	const char *error;
+
+	for (size_t i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++)
+	{
+		TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, import_iterations(rejected[i], &cfg, &error));
+		TEST_ASSERT(error != NULL);
+		// The whole document is refused, nothing of it is applied
+		TEST_ASSERT_EQUAL(0, cfg.auth.iterations);
+		TEST_ASSERT_EQUAL_STRING("", cfg.auth.user);
+	}
+
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, import_iterations(AUTH_PBKDF2_ITERATIONS_MAX + 1, &cfg, &error));
+	// CONFIG_AUTH_PBKDF2_ITERATIONS is 10000 in the host sdkconfig.h
+	TEST_ASSERT_EQUAL_STRING("iterations must be 1000 to 100000", error);
+}
+
+static void test_auth_needs_every_field(void)
+{
+	uint8_t buf[PROVISION_DOC_MAX_SIZE];
+	nvs_config_t cfg = { 0 };
+	const char *error = NULL;
+	cbor_writer_t w;
+
+	cbor_writer_init(&w, buf, sizeof(buf));
+	cbor_put_map(&w, 2);
+	cbor_put_text(&w, "version");
+	cbor_put_uint(&w, PROVISION_DOC_VERSION);
+	cbor_put_text(&w, "auth");
+	cbor_put_map(&w, 2);
+	cbor_put_text(&w, "user");
+	cbor_put_text(&w, "admin");
+	cbor_put_text(&w, "iterations");
+	cbor_put_uint(&w, CONFIG_AUTH_PBKDF2_ITERATIONS);
+
+	TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, provision_import(buf, w.len, &cfg, &error));
+	TEST_ASSERT_EQUAL_STRING("auth needs user, iterations, salt and hash", error);
+}
+
+int main(void)
+{
+	RUN_TEST(test_round_trip);
+	RUN_TEST(test_iterations_in_range);
+	RUN_TEST(test_iterations_out_of_range);
+	RUN_TEST(test_auth_needs_every_field);
+
+	return host_test_finish();
+}
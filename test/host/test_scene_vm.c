@@ -0,0 +1,380 @@
+/*
+ * test_scene_vm.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "scene_vm.h"
+
+/*
+ * Without arguments the unit tests of the verifier and the interpreter. With arguments each
+ * is a blob of tools/scene_asm.py (CMakeLists.txt assembles test/host/scenes), which must
+ * verify and run without a fault.
+ */
+
+#define TICK_MS						20
+#define BUDGET						32
+
+// A blob of the given code bytes, stays valid until the end of the enclosing block
+#define BLOB(...)					((const uint8_t[]){ 'S', 'C', SCENE_VM_VERSION, 0, __VA_ARGS__ })
+#define BLOB_SIZE(...)				(SCENE_VM_HEADER_SIZE + sizeof((const uint8_t[]){ __VA_ARGS__ }))
+#define VERIFY(pc, ...)				scene_vm_verify(BLOB(__VA_ARGS__), BLOB_SIZE(__VA_ARGS__), (pc))
+#define START(vm, ...)				scene_vm_start((vm), BLOB(__VA_ARGS__), BLOB_SIZE(__VA_ARGS__))
+
+static void test_verify_accepts(void)
+{
+	uint16_t pc = 0xFFFF;
+
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_NONE, VERIFY(&pc, SCENE_VM_OP_END));
+	TEST_ASSERT_EQUAL(0, pc);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_NONE, VERIFY(&pc,
+			SCENE_VM_OP_SET, 0x0F, 0x05,			// 0
+			SCENE_VM_OP_LOOP, 255,					// 3
+			SCENE_VM_OP_TOGGLE, 0x01,				// 5
+			SCENE_VM_OP_FADE, 0x0F, 0x00, 0xE8, 0x03,	// 7
+			SCENE_VM_OP_NEXT,						// 12
+			SCENE_VM_OP_JIF, 0x80, 21, 0,			// 13
+			SCENE_VM_OP_JIFN, 0x01, 0, 0,			// 17
+			SCENE_VM_OP_WAIT, 0xFF, 0xFF,			// 21
+			SCENE_VM_OP_JUMP, 3, 0));				// 24
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_NONE, VERIFY(&pc, SCENE_VM_OP_WAIT, 100, 0, SCENE_VM_OP_JUMP, 0, 0));
+}
+
+static void test_verify_header(void)
+{
+	uint8_t big[SCENE_VM_BLOB_MAX + 1];
+	uint16_t pc;
+
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_HEADER, scene_vm_verify((const uint8_t[]){ 'S', 'C', SCENE_VM_VERSION, 0 }, 4, &pc));
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_HEADER, scene_vm_verify((const uint8_t[]){ 'S', 'X', SCENE_VM_VERSION, 0, 0 }, 5, &pc));
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_HEADER, scene_vm_verify((const uint8_t[]){ 'S', 'C', SCENE_VM_VERSION + 1, 0, 0 }, 5, &pc));
+	TEST_ASSERT_EQUAL(0, pc);
+
+	memset(big, SCENE_VM_OP_NEXT, sizeof(big));
+	memcpy(big, BLOB(SCENE_VM_OP_END), SCENE_VM_HEADER_SIZE);
+	big[sizeof(big) - 1] = SCENE_VM_OP_END;
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_TOO_LARGE, scene_vm_verify(big, sizeof(big), &pc));
+	memcpy(big + 1, BLOB(SCENE_VM_OP_END), SCENE_VM_HEADER_SIZE);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_NONE, scene_vm_verify(big + 1, SCENE_VM_BLOB_MAX, &pc));
+}
+
+static void test_verify_rejects(void)
+{
+	uint16_t pc;
+
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_OPCODE, VERIFY(&pc, SCENE_VM_OP_SET, 1, 1, SCENE_VM_OP_COUNT, SCENE_VM_OP_END));
+	TEST_ASSERT_EQUAL(3, pc);
+
+	// Operands past the end of the code
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_TRUNCATED, VERIFY(&pc, SCENE_VM_OP_END, SCENE_VM_OP_WAIT, 100));
+	TEST_ASSERT_EQUAL(1, pc);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_TRUNCATED, VERIFY(&pc, SCENE_VM_OP_END, SCENE_VM_OP_FADE, 0x0F, 0x0F, 100));
+	TEST_ASSERT_EQUAL(1, pc);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_TRUNCATED, VERIFY(&pc, SCENE_VM_OP_JUMP, 0));
+	TEST_ASSERT_EQUAL(0, pc);
+
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_COUNT, VERIFY(&pc, SCENE_VM_OP_SET, 1, 1, SCENE_VM_OP_LOOP, 0, SCENE_VM_OP_NEXT, SCENE_VM_OP_END));
+	TEST_ASSERT_EQUAL(3, pc);
+
+	// Into the operands of an instruction, past the code, to the end of the code
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_TARGET, VERIFY(&pc, SCENE_VM_OP_WAIT, 10, 0, SCENE_VM_OP_JUMP, 1, 0));
+	TEST_ASSERT_EQUAL(3, pc);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_TARGET, VERIFY(&pc, SCENE_VM_OP_JIF, 0x80, 0, 1, SCENE_VM_OP_END));
+	TEST_ASSERT_EQUAL(0, pc);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_TARGET, VERIFY(&pc, SCENE_VM_OP_END, SCENE_VM_OP_JIFN, 0x01, 9, 0, SCENE_VM_OP_END));
+	TEST_ASSERT_EQUAL(1, pc);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_BAD_TARGET, VERIFY(&pc, SCENE_VM_OP_JUMP, 3, 0));
+	TEST_ASSERT_EQUAL(0, pc);
+
+	// The code could run off its end
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_NO_END, VERIFY(&pc, SCENE_VM_OP_END, SCENE_VM_OP_SET, 1, 1, SCENE_VM_OP_WAIT, 10, 0));
+	TEST_ASSERT_EQUAL(4, pc);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_NO_END, VERIFY(&pc, SCENE_VM_OP_JIF, 0x80, 0, 0));
+	TEST_ASSERT_EQUAL(0, pc);
+}
+
+static void test_loop_nesting(void)
+{
+	scene_vm_t vm;
+	uint8_t leds = 0;
+
+	// SCENE_VM_LOOP_DEPTH levels run, the body 2^4 times
+	START(&vm, SCENE_VM_OP_LOOP, 2, SCENE_VM_OP_LOOP, 2, SCENE_VM_OP_LOOP, 2, SCENE_VM_OP_LOOP, 2,
+			SCENE_VM_OP_TOGGLE, 0x01, SCENE_VM_OP_WAIT, 1, 0,
+			SCENE_VM_OP_NEXT, SCENE_VM_OP_NEXT, SCENE_VM_OP_NEXT, SCENE_VM_OP_NEXT, SCENE_VM_OP_END);
+	for (int i = 0; i < 16; i++)
+	{
+		scene_vm_step(&vm, 1, 0, &leds, BUDGET);
+		TEST_ASSERT_EQUAL(SCENE_VM_STATE_RUNNING, vm.state);
+		TEST_ASSERT_EQUAL((i + 1) % 2, leds);
+	}
+	scene_vm_step(&vm, 1, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_DONE, vm.state);
+	TEST_ASSERT_EQUAL(0, vm.loop_depth);
+	TEST_ASSERT_EQUAL(0, leds);
+
+	// One level deeper faults at the fifth LOOP
+	START(&vm, SCENE_VM_OP_LOOP, 1, SCENE_VM_OP_LOOP, 1, SCENE_VM_OP_LOOP, 1, SCENE_VM_OP_LOOP, 1, SCENE_VM_OP_LOOP, 1,
+			SCENE_VM_OP_NEXT, SCENE_VM_OP_NEXT, SCENE_VM_OP_NEXT, SCENE_VM_OP_NEXT, SCENE_VM_OP_NEXT, SCENE_VM_OP_END);
+	scene_vm_step(&vm, TICK_MS, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_FAULT, vm.state);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_LOOP_DEPTH, vm.fault);
+	TEST_ASSERT_EQUAL(8, vm.pc);
+
+	// A LOOP jumped back to without its NEXT nests once per pass
+	START(&vm, SCENE_VM_OP_LOOP, 2, SCENE_VM_OP_JUMP, 0, 0);
+	scene_vm_step(&vm, TICK_MS, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_LOOP_DEPTH, vm.fault);
+	TEST_ASSERT_EQUAL(0, vm.pc);
+	TEST_ASSERT_EQUAL(SCENE_VM_LOOP_DEPTH * 2 + 1, vm.instructions);
+
+	// NEXT without LOOP, also one NEXT too many after a loop ended
+	START(&vm, SCENE_VM_OP_SET, 1, 1, SCENE_VM_OP_NEXT, SCENE_VM_OP_END);
+	scene_vm_step(&vm, TICK_MS, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_FAULT, vm.state);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_LOOP_EMPTY, vm.fault);
+	TEST_ASSERT_EQUAL(3, vm.pc);
+
+	START(&vm, SCENE_VM_OP_LOOP, 3, SCENE_VM_OP_NEXT, SCENE_VM_OP_NEXT, SCENE_VM_OP_END);
+	scene_vm_step(&vm, TICK_MS, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(SCENE_VM_FAULT_LOOP_EMPTY, vm.fault);
+	TEST_ASSERT_EQUAL(3, vm.pc);
+
+	// A fault ends the program, later steps do nothing
+	scene_vm_step(&vm, TICK_MS, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_FAULT, vm.state);
+	TEST_ASSERT_EQUAL(3, vm.pc);
+}
+
+/**
+ * Steps 1 ms at a time until the LEDs change.
+ * @return the ms it took, -1 if they did not within limit.
+ */
+static int ms_until_change(scene_vm_t *vm, uint8_t *leds, int limit)
+{
+	uint8_t before = *leds;
+
+	for (int ms = 1; ms <= limit; ms++)
+	{
+		scene_vm_step(vm, 1, 0, leds, BUDGET);
+		if (*leds != before)
+		{
+			return ms;
+		}
+	}
+	return -1;
+}
+
+static void test_fade_timing(void)
+{
+	scene_vm_t vm;
+	uint8_t leds = 0x00;
+
+	// 1003 ms over 4 LEDs: the first takes the remainder, 253 + 3 * 250, lowest LED first
+	START(&vm, SCENE_VM_OP_FADE, 0x0F, 0x0F, 0xEB, 0x03, SCENE_VM_OP_SET, 0x80, 0x80, SCENE_VM_OP_END);
+	scene_vm_step(&vm, 0, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(0x00, leds);
+	TEST_ASSERT_EQUAL(253, ms_until_change(&vm, &leds, 2000));
+	TEST_ASSERT_EQUAL(0x01, leds);
+	TEST_ASSERT_EQUAL(250, ms_until_change(&vm, &leds, 2000));
+	TEST_ASSERT_EQUAL(0x03, leds);
+	TEST_ASSERT_EQUAL(250, ms_until_change(&vm, &leds, 2000));
+	TEST_ASSERT_EQUAL(0x07, leds);
+	// The last LED switches at 1003 ms and the program goes on in the same step
+	TEST_ASSERT_EQUAL(250, ms_until_change(&vm, &leds, 2000));
+	TEST_ASSERT_EQUAL(0x8F, leds);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_DONE, vm.state);
+
+	// Only the LEDs that differ take a share: two LEDs over 301 ms
+	leds = 0x05;
+	START(&vm, SCENE_VM_OP_FADE, 0x0F, 0x0F, 0x2D, 0x01, SCENE_VM_OP_END);
+	scene_vm_step(&vm, 0, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(151, ms_until_change(&vm, &leds, 2000));
+	TEST_ASSERT_EQUAL(0x07, leds);
+	TEST_ASSERT_EQUAL(150, ms_until_change(&vm, &leds, 2000));
+	TEST_ASSERT_EQUAL(0x0F, leds);
+
+	// Nothing to switch still takes the time
+	START(&vm, SCENE_VM_OP_FADE, 0x0F, 0x0F, 100, 0, SCENE_VM_OP_TOGGLE, 0x01, SCENE_VM_OP_END);
+	scene_vm_step(&vm, 0, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(100, ms_until_change(&vm, &leds, 2000));
+	TEST_ASSERT_EQUAL(0x0E, leds);
+
+	// One step late by several intervals switches the LEDs that are due at once
+	leds = 0x00;
+	START(&vm, SCENE_VM_OP_FADE, 0x0F, 0x0F, 0x90, 0x01, SCENE_VM_OP_WAIT, 100, 0, SCENE_VM_OP_END);
+	scene_vm_step(&vm, 0, 0, &leds, BUDGET);
+	scene_vm_step(&vm, 250, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(0x03, leds);
+	TEST_ASSERT_EQUAL(50, vm.wait_ms);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_RUNNING, vm.state);
+}
+
+static void test_wait_overshoot(void)
+{
+	scene_vm_t vm;
+	uint8_t leds = 0;
+
+	// Ticks of 30 ms against waits of 100 ms: the overshoot is taken off the next wait
+	START(&vm, SCENE_VM_OP_WAIT, 100, 0, SCENE_VM_OP_TOGGLE, 0x01, SCENE_VM_OP_JUMP, 0, 0);
+	scene_vm_step(&vm, 0, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(100, vm.wait_ms);
+	for (int t = 30, toggles = 0; t <= 3000; t += 30)
+	{
+		scene_vm_step(&vm, 30, 0, &leds, BUDGET);
+		if (t / 100 != toggles)
+		{
+			toggles = t / 100;
+			TEST_ASSERT_EQUAL(toggles % 2, leds);
+			TEST_ASSERT_EQUAL(100 - t % 100, vm.wait_ms);
+		}
+	}
+	TEST_ASSERT_EQUAL(0, leds);
+
+	// A WAIT shorter than the overshoot is over at once
+	START(&vm, SCENE_VM_OP_WAIT, 50, 0, SCENE_VM_OP_WAIT, 20, 0, SCENE_VM_OP_TOGGLE, 0x02, SCENE_VM_OP_WAIT, 100, 0, SCENE_VM_OP_END);
+	scene_vm_step(&vm, 0, 0, &leds, BUDGET);
+	scene_vm_step(&vm, 90, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(0x02, leds);
+	TEST_ASSERT_EQUAL(80, vm.wait_ms);
+
+	// More than SCENE_VM_CATCHUP_MS late drops the rest of the backlog
+	leds = 0;
+	START(&vm, SCENE_VM_OP_WAIT, 10, 0, SCENE_VM_OP_TOGGLE, 0x01, SCENE_VM_OP_JUMP, 0, 0);
+	scene_vm_step(&vm, 0, 0, &leds, BUDGET);
+	scene_vm_step(&vm, 60000, 0, &leds, 10000);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_RUNNING, vm.state);
+	TEST_ASSERT(vm.wait_ms > 0);
+	TEST_ASSERT(vm.instructions <= 2 + 3 * (SCENE_VM_CATCHUP_MS / 10 + 1));
+}
+
+static void test_budget_yields(void)
+{
+	scene_vm_t vm;
+	uint8_t leds = 0;
+
+	// A loop that never waits runs BUDGET instructions per step and keeps its place
+	START(&vm, SCENE_VM_OP_TOGGLE, 0x01, SCENE_VM_OP_JUMP, 0, 0);
+	scene_vm_step(&vm, TICK_MS, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(BUDGET, vm.instructions);
+	TEST_ASSERT_EQUAL(1, vm.budget_yields);
+	TEST_ASSERT_EQUAL(0, leds);
+	scene_vm_step(&vm, TICK_MS, 0, &leds, 5);
+	TEST_ASSERT_EQUAL(BUDGET + 5, vm.instructions);
+	TEST_ASSERT_EQUAL(2, vm.budget_yields);
+	TEST_ASSERT_EQUAL(2, vm.pc);
+	TEST_ASSERT_EQUAL(1, leds);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_RUNNING, vm.state);
+
+	// Yielding at a WAIT or ending on the last instruction of the budget is no budget yield
+	START(&vm, SCENE_VM_OP_TOGGLE, 0x01, SCENE_VM_OP_WAIT, 10, 0, SCENE_VM_OP_JUMP, 0, 0);
+	for (int i = 0; i < 10; i++)
+	{
+		scene_vm_step(&vm, 10, 0, &leds, 3);
+	}
+	TEST_ASSERT_EQUAL(0, vm.budget_yields);
+	START(&vm, SCENE_VM_OP_TOGGLE, 0x01, SCENE_VM_OP_END);
+	scene_vm_step(&vm, TICK_MS, 0, &leds, 2);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_DONE, vm.state);
+	TEST_ASSERT_EQUAL(0, vm.budget_yields);
+
+	// The button jump is taken on the input of the step
+	leds = 0;
+	START(&vm, SCENE_VM_OP_JIFN, SCENE_VM_INPUT_BUTTON, 0, 0, SCENE_VM_OP_SET, 0x0F, 0x0F, SCENE_VM_OP_END);
+	scene_vm_step(&vm, TICK_MS, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(1, vm.budget_yields);
+	TEST_ASSERT_EQUAL(0, leds);
+	scene_vm_step(&vm, TICK_MS, SCENE_VM_INPUT_BUTTON, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_DONE, vm.state);
+	TEST_ASSERT_EQUAL(0x0F, leds);
+}
+
+static void test_stop(void)
+{
+	scene_vm_t vm;
+	uint8_t leds = 0;
+
+	START(&vm, SCENE_VM_OP_FADE, 0x0F, 0x0F, 100, 0, SCENE_VM_OP_END);
+	scene_vm_step(&vm, 0, 0, &leds, BUDGET);
+	scene_vm_step(&vm, 30, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(0x01, leds);
+	scene_vm_stop(&vm);
+	TEST_ASSERT_EQUAL(SCENE_VM_STATE_IDLE, vm.state);
+	scene_vm_step(&vm, 1000, 0, &leds, BUDGET);
+	TEST_ASSERT_EQUAL(0x01, leds);
+}
+
+/**
+ * Verifies and runs an assembled blob for a minute of ticks, the button pressed in the second half.
+ * @return false on a fault.
+ */
+static bool run_blob(const char *path)
+{
+	uint8_t blob[SCENE_VM_BLOB_MAX + 1];
+	scene_vm_t vm;
+	uint8_t leds = 0;
+	uint16_t pc;
+	scene_vm_fault_e fault;
+	FILE *f = fopen(path, "rb");
+	size_t size;
+
+	if (f == NULL)
+	{
+		printf("FAIL %s: cannot open\n", path);
+		return false;
+	}
+	size = fread(blob, 1, sizeof(blob), f);
+	fclose(f);
+
+	fault = scene_vm_verify(blob, size, &pc);
+	if (fault != SCENE_VM_FAULT_NONE)
+	{
+		printf("FAIL %s: %s at %u\n", path, scene_vm_fault_name(fault), pc);
+		return false;
+	}
+
+	scene_vm_start(&vm, blob, size);
+	for (int t = 0; t < 60000 && vm.state == SCENE_VM_STATE_RUNNING; t += TICK_MS)
+	{
+		scene_vm_step(&vm, TICK_MS, t >= 30000 ? SCENE_VM_INPUT_BUTTON : 0, &leds, BUDGET);
+	}
+	if (vm.state == SCENE_VM_STATE_FAULT)
+	{
+		printf("FAIL %s: %s at %u at run time\n", path, scene_vm_fault_name(vm.fault), vm.pc);
+		return false;
+	}
+
+	printf("PASS %s: %u bytes, %s after %u instructions, LEDs 0x%02x\n", path, (unsigned)size,
+			scene_vm_state_name(vm.state), (unsigned)vm.instructions, leds);
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc > 1)
+	{
+		int failed = 0;
+
+		for (int i = 1; i < argc; i++)
+		{
+			failed += !run_blob(argv[i]);
+		}
+		return failed ? 1 : 0;
+	}
+
+	RUN_TEST(test_verify_accepts);
+	RUN_TEST(test_verify_header);
+	RUN_TEST(test_verify_rejects);
+	RUN_TEST(test_loop_nesting);
+	RUN_TEST(test_fade_timing);
+	RUN_TEST(test_wait_overshoot);
+	RUN_TEST(test_budget_yields);
+	RUN_TEST(test_stop);
+
+	return host_test_finish();
+}
@@ -0,0 +1,220 @@
+/*
+ * test_telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include "host_stubs.h"
+#include "host_test.h"
+#include "esp_heap_caps.h"
+#include "freertos/task.h"
+#include "telemetry.h"
+#include "wifi_app.h"
+
+// The tiers keep their state: the tests run in order, each one on whole periods
+
+#define SECONDS_PER_MINUTE			60
+#define MINUTES_PER_HOUR			60
+
+static int8_t g_rssi;
+static size_t g_heap_free = 100000;
+static esp_timer_handle_t g_timer;
+
+// Snapshot returned by uxTaskGetSystemState, empty until the task tests fill it
+static TaskStatus_t g_task_status;
+static UBaseType_t g_task_status_count;
+static uint32_t g_total_run_time;
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+	return g_heap_free;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+	return 50000;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+	return 40000;
+}
+
+int8_t wifi_app_get_rssi(void)
+{
+	return g_rssi;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t size, uint32_t *total_run_time)
+{
+	if (size < g_task_status_count)
+	{
+		return 0;
+	}
+	if (g_task_status_count)
+	{
+		status[0] = g_task_status;
+	}
+	*total_run_time = g_total_run_time;
+	return g_task_status_count;
+}
+
+/**
+ * Takes `count` one second samples at the given RSSI.
+ */
+static void sample(int count, int8_t rssi)
+{
+	g_rssi = rssi;
+	for (int i = 0; i < count; i++)
+	{
+		host_stub_advance_us(TELEMETRY_SAMPLE_PERIOD_MS * 1000);
+		host_stub_timer_fire(g_timer);
+	}
+}
+
+static telemetry_sample_t newest(telemetry_tier_e tier)
+{
+	telemetry_sample_t s = { 0 };
+
+	telemetry_get_sample(tier, telemetry_get_sample_count(tier) - 1, &s);
+	return s;
+}
+
+static void test_seconds_keep_raw_rssi(void)
+{
+	sample(1, -55);
+	TEST_ASSERT_EQUAL(1, telemetry_get_sample_count(TELEMETRY_TIER_SECONDS));
+	TEST_ASSERT_EQUAL(-55, newest(TELEMETRY_TIER_SECONDS).rssi);
+	TEST_ASSERT_EQUAL(100000, newest(TELEMETRY_TIER_SECONDS).heap_free);
+
+	sample(SECONDS_PER_MINUTE - 1, 0);
+	TEST_ASSERT_EQUAL(0, newest(TELEMETRY_TIER_SECONDS).rssi);
+}
+
+static void test_minute_averages_connected_samples(void)
+{
+	int minutes = telemetry_get_sample_count(TELEMETRY_TIER_MINUTES);
+
+	// The first minute had one connected sample, the disconnected ones do not dilute it
+	TEST_ASSERT_EQUAL(1, minutes);
+	TEST_ASSERT_EQUAL(-55, newest(TELEMETRY_TIER_MINUTES).rssi);
+
+	sample(SECONDS_PER_MINUTE / 2, 0);
+	sample(SECONDS_PER_MINUTE / 2, -60);
+	TEST_ASSERT_EQUAL(minutes + 1, telemetry_get_sample_count(TELEMETRY_TIER_MINUTES));
+	TEST_ASSERT_EQUAL(-60, newest(TELEMETRY_TIER_MINUTES).rssi);
+
+	sample(SECONDS_PER_MINUTE / 2, -70);
+	sample(SECONDS_PER_MINUTE / 2, -80);
+	TEST_ASSERT_EQUAL(-75, newest(TELEMETRY_TIER_MINUTES).rssi);
+}
+
+static void test_minute_without_connection_is_zero(void)
+{
+	sample(SECONDS_PER_MINUTE, 0);
+	TEST_ASSERT_EQUAL(0, newest(TELEMETRY_TIER_MINUTES).rssi);
+}
+
+static void test_weak_signal_is_not_zero(void)
+{
+	// -1 and -2 average to -1.5, which truncates to -1, not to "not connected"
+	for (int i = 0; i < SECONDS_PER_MINUTE / 2; i++)
+	{
+		sample(1, -1);
+		sample(1, -2);
+	}
+	TEST_ASSERT_EQUAL(-1, newest(TELEMETRY_TIER_MINUTES).rssi);
+}
+
+static void test_hour_skips_disconnected_minutes(void)
+{
+	int minutes = telemetry_get_sample_count(TELEMETRY_TIER_MINUTES);
+
+	// The hour started with the minutes of the tests above, finish it disconnected but one
+	TEST_ASSERT_EQUAL(0, telemetry_get_sample_count(TELEMETRY_TIER_HOURS));
+	for (int i = minutes; i < MINUTES_PER_HOUR - 1; i++)
+	{
+		sample(SECONDS_PER_MINUTE, 0);
+	}
+	g_heap_free = 80000;
+	sample(SECONDS_PER_MINUTE, -90);
+
+	TEST_ASSERT_EQUAL(1, telemetry_get_sample_count(TELEMETRY_TIER_HOURS));
+	// -55, -60, -75, -1 and -90 over the five connected minutes
+	TEST_ASSERT_EQUAL((-55 - 60 - 75 - 1 - 90) / 5, newest(TELEMETRY_TIER_HOURS).rssi);
+	// Other averages still cover every sample
+	TEST_ASSERT_EQUAL((100000 * (MINUTES_PER_HOUR - 1) + 80000) / MINUTES_PER_HOUR,
+			newest(TELEMETRY_TIER_HOURS).heap_free);
+	TEST_ASSERT_EQUAL(50000, newest(TELEMETRY_TIER_HOURS).heap_min);
+}
+
+/**
+ * Takes one sample after `task` ran for `run` of the `elapsed` run time ticks.
+ * @return CPU share of the task in the new sample.
+ */
+static int sample_task(TaskHandle_t task, uint32_t run, uint32_t elapsed)
+{
+	g_task_status.xHandle = task;
+	g_task_status.ulRunTimeCounter += run;
+	g_total_run_time += elapsed;
+	sample(1, 0);
+	return newest(TELEMETRY_TIER_SECONDS).cpu_permille[0];
+}
+
+static void test_task_counter_wrap_is_not_a_restart(void)
+{
+	TaskHandle_t task = (TaskHandle_t)0x1000;
+	telemetry_task_info_t info;
+
+	g_task_status.pcTaskName = "busy";
+	g_task_status.ulRunTimeCounter = UINT32_MAX - 99;
+	g_task_status.xCoreID = 1;
+	g_task_status_count = 1;
+
+	// The first sample only sets the counters, the share needs a full period
+	sample_task(task, 0, 0xFFFFFF00);
+	TEST_ASSERT_EQUAL(1, telemetry_get_task_count());
+	TEST_ASSERT(telemetry_get_task(0, &info));
+	TEST_ASSERT_EQUAL_STRING("busy", info.name);
+	TEST_ASSERT_EQUAL(1, info.core);
+
+	TEST_ASSERT_EQUAL(250, sample_task(task, 250, 1000));
+	// Both the task counter and the total pass UINT32_MAX
+	TEST_ASSERT_EQUAL(500, sample_task(task, 500, 1000));
+	TEST_ASSERT_EQUAL(100, sample_task(task, 100, 1000));
+}
+
+static void test_recreated_task_counts_from_zero(void)
+{
+	TaskHandle_t task = (TaskHandle_t)0x2000;
+
+	// Same name, new handle: the counter restarts below or above the old one alike
+	g_task_status.ulRunTimeCounter = 0;
+	TEST_ASSERT_EQUAL(300, sample_task(task, 300, 1000));
+	TEST_ASSERT_EQUAL(1, telemetry_get_task_count());
+
+	g_task_status.ulRunTimeCounter = 0;
+	TEST_ASSERT_EQUAL(900, sample_task((TaskHandle_t)0x3000, 900, 1000));
+	TEST_ASSERT_EQUAL(50, sample_task((TaskHandle_t)0x3000, 50, 1000));
+}
+
+int main(void)
+{
+	telemetry_start();
+	g_timer = host_stub_timer_find("telemetry");
+	if (g_timer == NULL)
+	{
+		return 1;
+	}
+
+	RUN_TEST(test_seconds_keep_raw_rssi);
+	RUN_TEST(test_minute_averages_connected_samples);
+	RUN_TEST(test_minute_without_connection_is_zero);
+	RUN_TEST(test_weak_signal_is_not_zero);
+	RUN_TEST(test_hour_skips_disconnected_minutes);
+	RUN_TEST(test_task_counter_wrap_is_not_a_restart);
+	RUN_TEST(test_recreated_task_counts_from_zero);
+
+	return host_test_finish();
+}
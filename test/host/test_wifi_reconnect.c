@@ -0,0 +1,256 @@
+/*
+ * test_wifi_reconnect.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: majorBien
+ */
+
+#include "host_test.h"
+#include "wifi_reconnect.h"
+
+#define SEEDS						1000
+
+static const wifi_reconnect_config_t g_cfg = {
+	.base_delay_ms = 1000,
+	.max_delay_ms = 30000,
+	.max_retries = 8,
+	.breaker_ms = 60000,
+};
+
+/**
+ * Backoff delay before the jitter of retry n (1-based).
+ */
+static uint32_t nominal_delay(uint8_t retry)
+{
+	uint64_t delay = (uint64_t)g_cfg.base_delay_ms << (retry - 1);
+
+	return delay < g_cfg.max_delay_ms ? (uint32_t)delay : g_cfg.max_delay_ms;
+}
+
+/**
+ * Started and failed `failures` times, in BACKOFF.
+ */
+static wifi_reconnect_action_t start_and_fail(wifi_reconnect_t *rc, uint32_t seed, int failures)
+{
+	wifi_reconnect_action_t action = { 0 };
+
+	wifi_reconnect_init(rc, &g_cfg, seed);
+	wifi_reconnect_handle(rc, WIFI_RECONNECT_EV_START);
+	for (int i = 0; i < failures; i++)
+	{
+		if (i > 0)
+		{
+			wifi_reconnect_handle(rc, WIFI_RECONNECT_EV_TIMER);
+		}
+		action = wifi_reconnect_handle(rc, WIFI_RECONNECT_EV_DISCONNECTED);
+	}
+	return action;
+}
+
+static void test_start_connects(void)
+{
+	wifi_reconnect_t rc;
+
+	wifi_reconnect_init(&rc, &g_cfg, 1);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_IDLE, rc.state);
+
+	wifi_reconnect_action_t action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_START);
+	TEST_ASSERT(action.connect);
+	TEST_ASSERT_EQUAL(0, action.timer_ms);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_ATTEMPT, action.report);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_CONNECTING, rc.state);
+}
+
+static void test_backoff_doubles_within_jitter(void)
+{
+	for (uint32_t seed = 1; seed <= SEEDS; seed++)
+	{
+		wifi_reconnect_t rc;
+
+		for (uint8_t retry = 1; retry <= g_cfg.max_retries; retry++)
+		{
+			wifi_reconnect_action_t action = start_and_fail(&rc, seed, retry);
+			uint32_t nominal = nominal_delay(retry);
+
+			TEST_ASSERT_EQUAL(WIFI_RECONNECT_BACKOFF, rc.state);
+			TEST_ASSERT(!action.connect);
+			TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_NONE, action.report);
+			TEST_ASSERT_IN_RANGE(nominal / 2, nominal, action.timer_ms);
+		}
+	}
+}
+
+static void test_backoff_capped(void)
+{
+	wifi_reconnect_t rc;
+
+	// Retries 6 to 8 would be 32 s, 64 s and 128 s without the cap
+	for (uint8_t retry = 6; retry <= g_cfg.max_retries; retry++)
+	{
+		wifi_reconnect_action_t action = start_and_fail(&rc, 7, retry);
+
+		TEST_ASSERT_IN_RANGE(g_cfg.max_delay_ms / 2, g_cfg.max_delay_ms, action.timer_ms);
+	}
+
+	// A base delay above the cap is capped as well
+	wifi_reconnect_config_t cfg = g_cfg;
+	cfg.base_delay_ms = 100000;
+	wifi_reconnect_init(&rc, &cfg, 7);
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_START);
+	TEST_ASSERT_IN_RANGE(cfg.max_delay_ms / 2, cfg.max_delay_ms, wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_DISCONNECTED).timer_ms);
+}
+
+static void test_equal_jitter_spreads_over_upper_half(void)
+{
+	uint32_t min = UINT32_MAX;
+	uint32_t max = 0;
+	int upper_quarter = 0;
+
+	for (uint32_t seed = 1; seed <= SEEDS; seed++)
+	{
+		wifi_reconnect_t rc;
+		uint32_t delay = start_and_fail(&rc, seed, 1).timer_ms;
+
+		TEST_ASSERT_IN_RANGE(500, 1000, delay);
+		min = delay < min ? delay : min;
+		max = delay > max ? delay : max;
+		upper_quarter += delay > 750;
+	}
+
+	// Devices that lost the same AP must not retry in lockstep
+	TEST_ASSERT(min < 550);
+	TEST_ASSERT(max > 950);
+	TEST_ASSERT_IN_RANGE(SEEDS * 4 / 10, SEEDS * 6 / 10, upper_quarter);
+}
+
+static void test_zero_seed_still_random(void)
+{
+	wifi_reconnect_t a;
+	wifi_reconnect_t b;
+
+	start_and_fail(&a, 0, 1);
+	start_and_fail(&b, 0, 1);
+	TEST_ASSERT(a.rng != 0);
+	TEST_ASSERT_EQUAL(a.rng, b.rng);
+}
+
+static void test_circuit_opens_after_max_retries(void)
+{
+	wifi_reconnect_t rc;
+	wifi_reconnect_action_t action = start_and_fail(&rc, 3, g_cfg.max_retries);
+
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_BACKOFF, rc.state);
+
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_TIMER);
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_DISCONNECTED);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_CIRCUIT_OPEN, rc.state);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_FAILED, action.report);
+	TEST_ASSERT(!action.connect);
+	TEST_ASSERT_IN_RANGE(g_cfg.breaker_ms / 2, g_cfg.breaker_ms, action.timer_ms);
+
+	// Late disconnect events while open change nothing
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_DISCONNECTED);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_CIRCUIT_OPEN, rc.state);
+	TEST_ASSERT_EQUAL(0, action.timer_ms);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_NONE, action.report);
+}
+
+static void test_half_open_probe(void)
+{
+	wifi_reconnect_t rc;
+
+	start_and_fail(&rc, 5, g_cfg.max_retries);
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_TIMER);
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_DISCONNECTED);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_CIRCUIT_OPEN, rc.state);
+
+	// Rest over: one new attempt, reported as the start of a round
+	wifi_reconnect_action_t action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_TIMER);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_CONNECTING, rc.state);
+	TEST_ASSERT(action.connect);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_ATTEMPT, action.report);
+
+	// The probe fails: the round starts over from the base delay
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_DISCONNECTED);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_BACKOFF, rc.state);
+	TEST_ASSERT_EQUAL(1, rc.retries);
+	TEST_ASSERT_IN_RANGE(g_cfg.base_delay_ms / 2, g_cfg.base_delay_ms, action.timer_ms);
+
+	// The next probe succeeds
+	start_and_fail(&rc, 5, g_cfg.max_retries);
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_TIMER);
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_DISCONNECTED);
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_TIMER);
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_GOT_IP);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_CONNECTED, rc.state);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_CONNECTED, action.report);
+}
+
+static void test_got_ip_resets_retries(void)
+{
+	wifi_reconnect_t rc;
+
+	start_and_fail(&rc, 9, 5);
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_TIMER);
+
+	wifi_reconnect_action_t action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_GOT_IP);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_CONNECTED, rc.state);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_CONNECTED, action.report);
+	TEST_ASSERT_EQUAL(0, rc.retries);
+
+	// Losing the link later is a new round at the base delay
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_DISCONNECTED);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_BACKOFF, rc.state);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_ATTEMPT, action.report);
+	TEST_ASSERT_EQUAL(1, rc.retries);
+	TEST_ASSERT_IN_RANGE(g_cfg.base_delay_ms / 2, g_cfg.base_delay_ms, action.timer_ms);
+}
+
+static void test_stray_events_ignored(void)
+{
+	wifi_reconnect_t rc;
+	wifi_reconnect_action_t action;
+
+	wifi_reconnect_init(&rc, &g_cfg, 11);
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_GOT_IP);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_IDLE, rc.state);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_REPORT_NONE, action.report);
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_TIMER);
+	TEST_ASSERT(!action.connect);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_IDLE, rc.state);
+
+	// A retry timer firing after the connect succeeded
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_START);
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_GOT_IP);
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_TIMER);
+	TEST_ASSERT(!action.connect);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_CONNECTED, rc.state);
+
+	// The disconnect caused by a user stop
+	wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_STOP);
+	action = wifi_reconnect_handle(&rc, WIFI_RECONNECT_EV_DISCONNECTED);
+	TEST_ASSERT_EQUAL(WIFI_RECONNECT_IDLE, rc.state);
+	TEST_ASSERT_EQUAL(0, action.timer_ms);
+}
+
+static void test_state_names(void)
+{
+	TEST_ASSERT_EQUAL_STRING("idle", wifi_reconnect_state_name(WIFI_RECONNECT_IDLE));
+	TEST_ASSERT_EQUAL_STRING("circuit_open", wifi_reconnect_state_name(WIFI_RECONNECT_CIRCUIT_OPEN));
+	TEST_ASSERT_EQUAL_STRING("unknown", wifi_reconnect_state_name((wifi_reconnect_state_e)42));
+}
+
+int main(void)
+{
+	RUN_TEST(test_start_connects);
+	RUN_TEST(test_backoff_doubles_within_jitter);
+	RUN_TEST(test_backoff_capped);
+	RUN_TEST(test_equal_jitter_spreads_over_upper_half);
+	RUN_TEST(test_zero_seed_still_random);
+	RUN_TEST(test_circuit_opens_after_max_retries);
+	RUN_TEST(test_half_open_probe);
+	RUN_TEST(test_got_ip_resets_retries);
+	RUN_TEST(test_stray_events_ignored);
+	RUN_TEST(test_state_names);
+	return host_test_finish();
+}
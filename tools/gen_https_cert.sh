@@ -0,0 +1,26 @@
+#!/bin/sh
+# Generates the HTTPS server key and self-signed certificate embedded by CONFIG_HTTP_SERVER_HTTPS.
+# Run once per device; main/certs is not committed.
+#
+#   tools/gen_https_cert.sh [ip or hostname ...]
+#
+# The certificate always covers the SoftAP address 192.168.0.1. Add the STA address or a
+# hostname so the browser accepts it there too. P-256 keeps the handshake cheap on the ESP32.
+
+set -e
+
+DIR="$(cd "$(dirname "$0")/.." && pwd)/main/certs"
+SAN="IP:192.168.0.1"
+for name in "$@"; do
+    case "$name" in
+        *[!0-9.]*) SAN="$SAN,DNS:$name" ;;
+        *)         SAN="$SAN,IP:$name" ;;
+    esac
+done
+
+mkdir -p "$DIR"
+openssl ecparam -name prime256v1 -genkey -noout -out "$DIR/prvtkey.pem"
+openssl req -new -x509 -sha256 -days 3650 -key "$DIR/prvtkey.pem" -out "$DIR/servercert.pem" \
+    -subj "/CN=smart-home" -addext "subjectAltName=$SAN"
+
+echo "Wrote $DIR/servercert.pem and $DIR/prvtkey.pem ($SAN)"
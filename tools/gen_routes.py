@@ -0,0 +1,1004 @@
+#!/usr/bin/env python3
+"""
+Generates the route table and the JSON request and response code of the HTTP API from swagger.yaml.
+
+    gen_routes.py swagger.yaml main/api_gen.h main/api_gen.c
+
+The build runs it when swagger.yaml changes (main/CMakeLists.txt). The output is committed, so
+the sources read and diff without a build. swagger.yaml is the one description of the API:
+
+  operationId           every operation has one, its handler is <operationId>_handler (http_server.c)
+  x-admit               rate limit class: control, login or heavy, read if left out (http_admit.h)
+  x-if                  Kconfig option the operation is built with
+  x-journal             false keeps a command out of the journal (journal.h), every operation
+                        but GET is recorded with its client, latency and result. A handler
+                        that answers an error itself sets the result with api_journal_result
+  security              the session is checked before the handler runs (http_server_authorize)
+  path parameters       an integer with minimum and maximum registers one URI per value, a string
+                        becomes the wildcard "/*", registered last
+  query parameters      integers and string enums, parsed and range checked, default when missing
+  JSON request body     a $ref to a component schema, parsed into fixed buffers and validated
+  component schemas     a struct, a parser and a writer each, unless marked x-codegen: false.
+                        Strings need maxLength, objects nest by $ref only.
+
+Bad input is answered with 400 and the reason before the handler runs, the handler gets
+api_<operationId>_in_t with the parsed parameters and body. Nothing is allocated.
+"""
+
+import re
+import sys
+
+import yaml
+
+METHODS = ("get", "post", "put", "delete")
+ADMIT = {"read": "HTTP_ADMIT_READ", "control": "HTTP_ADMIT_CONTROL", "login": "HTTP_ADMIT_LOGIN",
+         "heavy": "HTTP_ADMIT_HEAVY"}
+INT32_MIN, INT32_MAX = -2 ** 31, 2 ** 31 - 1
+MAX_EXPANDED_URIS = 16
+BODY_SLACK = 128            # Whitespace and unknown keys a request body may have on top of the schema
+QUERY_MAX = 96
+ERROR_INVALID_JSON = "Invalid JSON"
+
+
+class GenError(Exception):
+    pass
+
+
+def snake(name):
+    name = re.sub(r"([A-Z]+)([A-Z][a-z])", r"\1_\2", name)
+    return re.sub(r"([a-z0-9])([A-Z])", r"\1_\2", name).lower()
+
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def range_text(lo, hi):
+    if lo == INT32_MIN and hi == INT32_MAX:
+        return "integer"
+    if hi == INT32_MAX:
+        return "integer >= %d" % lo
+    if lo == INT32_MIN:
+        return "integer <= %d" % hi
+    return "integer %d..%d" % (lo, hi)
+
+
+class Field:
+    """One property of a component schema, or one parameter of an operation."""
+
+    def __init__(self, spec, name, schema, required, where):
+        self.name = name
+        self.c_name = snake(name)
+        self.required = required
+        self.nullable = False
+        self.description = schema.get("description", "").strip().split("\n")[0]
+        where = "%s.%s" % (where, name)
+
+        if "$ref" in schema:
+            ref = schema["$ref"].split("/")[-1]
+            target = spec["components"]["schemas"][ref]
+            if target.get("type") != "object":
+                raise GenError("%s: $ref to a non-object schema" % where)
+            self.kind = "object"
+            self.ref = ref
+            self.nullable = bool(target.get("nullable"))
+            return
+
+        self.nullable = bool(schema.get("nullable"))
+        kind = schema.get("type")
+        if kind == "string" and "enum" in schema:
+            values = schema["enum"]
+            if not all(isinstance(v, str) for v in values):
+                raise GenError("%s: enum values must be quoted strings" % where)
+            if max(len(v) for v in values) > 15:
+                raise GenError("%s: enum values are limited to 15 characters" % where)
+            self.kind = "enum"
+            self.values = values
+        elif kind == "string" and schema.get("format") == "ipv4":
+            self.kind = "ipv4"
+        elif kind == "string":
+            if "maxLength" not in schema:
+                raise GenError("%s: strings need maxLength" % where)
+            self.kind = "string"
+            self.min_len = schema.get("minLength", 0)
+            self.max_len = schema["maxLength"]
+        elif kind == "integer":
+            self.kind = "int"
+            self.values = schema.get("enum")
+            if self.values is not None:
+                self.lo, self.hi = min(self.values), max(self.values)
+            else:
+                self.lo = schema.get("minimum", INT32_MIN)
+                self.hi = schema.get("maximum", INT32_MAX)
+        elif kind == "boolean":
+            self.kind = "bool"
+        else:
+            raise GenError("%s: type %r is not supported by the generator" % (where, kind))
+
+    def c_decl(self, prefix):
+        if self.kind == "object":
+            return "api_%s_t %s;" % (snake(self.ref), self.c_name)
+        if self.kind == "enum":
+            return "%s %s;" % (self.enum_type(prefix), self.c_name)
+        if self.kind == "string":
+            return "char %s[%d];" % (self.c_name, self.max_len + 1)
+        if self.kind == "ipv4":
+            return "uint32_t %s;" % self.c_name
+        if self.kind == "int":
+            return "int32_t %s;" % self.c_name
+        return "bool %s;" % self.c_name
+
+    def enum_type(self, prefix):
+        return "api_%s_%s_e" % (prefix, self.c_name)
+
+    def enum_const(self, prefix, value):
+        return ("API_%s_%s_%s" % (prefix, self.c_name, re.sub(r"\W", "_", value))).upper()
+
+    def int_text(self):
+        if self.values is not None and len(self.values) != self.hi - self.lo + 1:
+            return "one of " + ", ".join(str(v) for v in self.values)
+        return range_text(self.lo, self.hi)
+
+    def int_check(self, var):
+        if self.values is not None and len(self.values) != self.hi - self.lo + 1:
+            return "(" + " && ".join("%s != %d" % (var, v) for v in self.values) + ")"
+        return "%s < %d || %s > %d" % (var, self.lo, var, self.hi)
+
+    def json_max(self, schemas):
+        """Longest text the writer can produce for the value."""
+        if self.kind == "object":
+            size = schemas[self.ref].json_max(schemas)
+            return max(size, 4) if self.nullable else size
+        if self.kind == "enum":
+            return max(len(v) for v in self.values) + 2
+        if self.kind == "string":
+            return self.max_len * 6 + 2
+        if self.kind == "ipv4":
+            return 17
+        if self.kind == "int":
+            return 11
+        return 5
+
+
+class Schema:
+    def __init__(self, spec, name, schema):
+        self.name = name
+        self.c_name = snake(name)
+        self.description = schema.get("description", "").strip().split("\n")[0]
+        if schema.get("type") != "object" or "properties" not in schema:
+            raise GenError("%s: only objects with properties are generated" % name)
+        required = schema.get("required", [])
+        self.fields = [Field(spec, key, prop, key in required, name) for key, prop in schema["properties"].items()]
+        self.deps = [f.ref for f in self.fields if f.kind == "object"]
+
+    def json_max(self, schemas):
+        # "{", then per member a separator, the quoted key and ':', then "}"
+        return 2 + sum(1 + len(f.name) + 3 + f.json_max(schemas) for f in self.fields)
+
+
+class Operation:
+    def __init__(self, spec, path, method, op):
+        self.path = path
+        self.method = method
+        if "operationId" not in op:
+            raise GenError("%s %s: operationId missing" % (method.upper(), path))
+        self.op_id = op["operationId"]
+        self.handler = self.op_id + "_handler"
+        self.admit = op.get("x-admit", "read")
+        if self.admit not in ADMIT:
+            raise GenError("%s: unknown x-admit %r" % (self.op_id, self.admit))
+        self.cond = op.get("x-if")
+        self.secure = bool(op.get("security", spec.get("security")))
+        self.summary = op.get("summary", "")
+        self.journal = op.get("x-journal", method != "get")
+        self.op_const = "API_OP_" + snake(self.op_id).upper()
+
+        self.path_params = []
+        self.query_params = []
+        for param in op.get("parameters", []):
+            if "$ref" in param:
+                param = spec["components"]["parameters"][param["$ref"].split("/")[-1]]
+            if param["in"] == "path":
+                self.path_params.append(param)
+            elif param["in"] == "query":
+                field = Field(spec, param["name"], param["schema"], param.get("required", False), self.op_id)
+                if field.kind not in ("int", "enum"):
+                    raise GenError("%s: query parameter %s is no integer or enum" % (self.op_id, field.name))
+                if not field.required and "default" not in param["schema"]:
+                    raise GenError("%s: optional query parameter %s needs a default" % (self.op_id, field.name))
+                field.default = param["schema"].get("default")
+                # Always filled in, from the query or the default
+                field.required = True
+                self.query_params.append(field)
+
+        self.body = None
+        body = op.get("requestBody", {}).get("content", {}).get("application/json")
+        if body is not None:
+            if "$ref" not in body.get("schema", {}):
+                raise GenError("%s: a JSON request body needs a $ref schema" % self.op_id)
+            self.body = body["schema"]["$ref"].split("/")[-1]
+            self.body_required = op["requestBody"].get("required", False)
+
+        self.wildcard = False
+        self.uris = [path]
+        self.path_fields = []
+        for param in self.path_params:
+            schema = param["schema"]
+            if schema.get("type") == "string":
+                if not path.endswith("{%s}" % param["name"]) or path.count("{") != 1:
+                    raise GenError("%s: a string path parameter must be the whole last segment" % self.op_id)
+                self.wildcard = True
+                self.uris = [path[:path.index("{")] + "*"]
+            elif schema.get("type") == "integer" and "minimum" in schema and "maximum" in schema:
+                if schema["maximum"] - schema["minimum"] >= MAX_EXPANDED_URIS:
+                    raise GenError("%s: path parameter %s spans too many URIs" % (self.op_id, param["name"]))
+                token = "{%s}" % param["name"]
+                self.uris = [uri.replace(token, str(v)) for uri in self.uris
+                             for v in range(schema["minimum"], schema["maximum"] + 1)]
+                self.path_fields.append(Field(spec, param["name"], schema, True, self.op_id))
+            else:
+                raise GenError("%s: path parameter %s needs a string or a bounded integer" % (self.op_id, param["name"]))
+
+    @property
+    def has_input(self):
+        return bool(self.path_fields or self.query_params or self.body)
+
+    @property
+    def in_type(self):
+        return "api_%s_in_t" % snake(self.op_id)
+
+
+def load(path):
+    with open(path) as f:
+        spec = yaml.safe_load(f)
+
+    schemas = {}
+    for name, schema in spec.get("components", {}).get("schemas", {}).items():
+        if schema.get("x-codegen", True):
+            schemas[name] = Schema(spec, name, schema)
+
+    # Nested schemas first, the structs are declared in this order
+    ordered = []
+
+    def visit(name, stack=()):
+        if name in stack:
+            raise GenError("%s: schemas must not nest recursively" % name)
+        if name not in schemas:
+            raise GenError("%s: referenced by a generated schema, but marked x-codegen: false" % name)
+        if schemas[name] in ordered:
+            return
+        for dep in schemas[name].deps:
+            visit(dep, stack + (name,))
+        ordered.append(schemas[name])
+
+    for name in schemas:
+        visit(name)
+
+    ops = []
+    for path, item in spec["paths"].items():
+        for method in METHODS:
+            if method in item:
+                ops.append(Operation(spec, path, method, item[method]))
+    ids = [op.op_id for op in ops]
+    if len(ids) != len(set(ids)):
+        raise GenError("operationIds must be unique")
+    for op in ops:
+        if op.body is not None and op.body not in schemas:
+            raise GenError("%s: request body schema %s is marked x-codegen: false" % (op.op_id, op.body))
+
+    return spec, schemas, ordered, ops
+
+
+HEADER_START = """\
+/*
+ * api_gen.h
+ *
+ * Generated by tools/gen_routes.py from swagger.yaml, do not edit.
+ */
+
+#ifndef MAIN_API_GEN_H_
+#define MAIN_API_GEN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_http_server.h"
+#include "http_admit.h"
+#include "journal.h"
+#include "json_codec.h"
+
+/**
+ * One registration of a URI with httpd, the admission class goes to user_ctx.
+ */
+typedef struct api_route
+{
+	const char *uri;
+	httpd_method_t method;
+	esp_err_t (*handler)(httpd_req_t *req);	///> Generated wrapper, validates and calls the operation handler
+	http_admit_route_e admit;
+} api_route_t;
+
+// Routes in registration order, the wildcard last
+extern const api_route_t api_routes[];
+extern const size_t api_route_count;
+
+/**
+ * Sets the journal result of the running operation, for a handler that answers an error
+ * itself and returns ESP_OK. Its record is OK otherwise. Only from the operation handlers.
+ */
+void api_journal_result(journal_result_e result);
+"""
+
+SOURCE_START = """\
+/*
+ * api_gen.c
+ *
+ * Generated by tools/gen_routes.py from swagger.yaml, do not edit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_netif.h"
+
+#include "api_gen.h"
+#include "http_conn.h"
+#include "http_server.h"
+#include "journal.h"
+#include "trace.h"
+
+#define API_RECV_ANSWERED			-1		///> A 400 was sent
+#define API_RECV_FAILED				-2		///> The connection broke
+
+/**
+ * Receives a JSON body of at most size - 1 bytes.
+ * @return its length, or API_RECV_ANSWERED or API_RECV_FAILED.
+ */
+static int api_recv_body(httpd_req_t *req, char *buf, size_t size, bool required)
+{
+	int total_length = 0;
+	int ret;
+
+	if (req->content_len == 0 && !required)
+	{
+		return 0;
+	}
+	if (req->content_len == 0 || req->content_len >= size)
+	{
+		httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, req->content_len ? "Request body too large" : "Request body required");
+		return API_RECV_ANSWERED;
+	}
+
+	while (total_length < req->content_len)
+	{
+		ret = httpd_req_recv(req, buf + total_length, req->content_len - total_length);
+		if (ret == HTTPD_SOCK_ERR_TIMEOUT)
+		{
+			continue;
+		}
+		if (ret <= 0)
+		{
+			return API_RECV_FAILED;
+		}
+		total_length += ret;
+	}
+	buf[total_length] = '\\0';
+
+	return total_length;
+}
+
+/**
+ * Gets the query string, empty if there is none.
+ * @return false if it does not fit.
+ */
+static bool api_get_query(httpd_req_t *req, char *query, size_t size)
+{
+	esp_err_t err = httpd_req_get_url_query_str(req, query, size);
+
+	if (err != ESP_OK)
+	{
+		query[0] = '\\0';
+	}
+	return err != ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+/**
+ * Parses a decimal integer that fills the whole text.
+ */
+static bool api_parse_int(const char *text, int32_t lo, int32_t hi, int32_t *value)
+{
+	char *end;
+	long n = strtol(text, &end, 10);
+
+	if (end == text || *end != '\\0' || n < lo || n > hi)
+	{
+		return false;
+	}
+	*value = n;
+	return true;
+}
+
+/**
+ * Reads an integer query parameter.
+ * @return false if it is present but no integer in lo..hi.
+ */
+static bool api_query_int(const char *query, const char *key, int32_t lo, int32_t hi, int32_t def, int32_t *value)
+{
+	char text[12];
+	esp_err_t err = httpd_query_key_value(query, key, text, sizeof(text));
+
+	if (err == ESP_ERR_NOT_FOUND)
+	{
+		*value = def;
+		return true;
+	}
+	return err == ESP_OK && api_parse_int(text, lo, hi, value);
+}
+
+/**
+ * @return index of text in names, -1 if it is none of them.
+ */
+static int api_enum_index(const char *text, const char *const *names, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp(text, names[i]) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Reads a string enum query parameter.
+ * @return false if it is present but none of names.
+ */
+static bool api_query_enum(const char *query, const char *key, const char *const *names, int count, int def, int *value)
+{
+	char text[16];
+	esp_err_t err = httpd_query_key_value(query, key, text, sizeof(text));
+
+	if (err == ESP_ERR_NOT_FOUND)
+	{
+		*value = def;
+		return true;
+	}
+	return err == ESP_OK && (*value = api_enum_index(text, names, count)) >= 0;
+}
+
+/**
+ * Reads an integer path parameter from the URI, fmt has one %d.
+ */
+static bool api_path_int(httpd_req_t *req, const char *fmt, int32_t lo, int32_t hi, int32_t *value)
+{
+	int n;
+
+	if (sscanf(req->uri, fmt, &n) != 1 || n < lo || n > hi)
+	{
+		return false;
+	}
+	*value = n;
+	return true;
+}
+
+static bool api_read_enum(json_reader_t *r, const char *const *names, int count, int *value)
+{
+	char text[16];
+
+	return json_read_string(r, text, sizeof(text)) && (*value = api_enum_index(text, names, count)) >= 0;
+}
+
+static bool api_read_ipv4(json_reader_t *r, uint32_t *addr)
+{
+	char text[16];
+	esp_ip4_addr_t ip;
+
+	if (!json_read_string(r, text, sizeof(text)) || esp_netif_str_to_ip4(text, &ip) != ESP_OK)
+	{
+		return false;
+	}
+	*addr = ip.addr;
+	return true;
+}
+
+static void api_put_ipv4(json_writer_t *w, uint32_t addr)
+{
+	esp_ip4_addr_t ip = { .addr = addr };
+	char text[18];
+
+	snprintf(text, sizeof(text), "\\"" IPSTR "\\"", IP2STR(&ip));
+	json_put_raw(w, text);
+}
+
+// Only used from the httpd task, which runs one handler at a time
+static journal_result_e g_api_result;
+
+void api_journal_result(journal_result_e result)
+{
+	g_api_result = result;
+}
+"""
+
+
+def gen_enum(out, prefix, field):
+    out.append("typedef enum %s" % field.enum_type(prefix)[:-2])
+    out.append("{")
+    for i, value in enumerate(field.values):
+        out.append("\t%s%s," % (field.enum_const(prefix, value), " = 0" if i == 0 else ""))
+    out.append("\t%s" % field.enum_const(prefix, "COUNT"))
+    out.append("} %s;" % field.enum_type(prefix))
+    out.append("")
+
+
+def gen_struct_fields(out, prefix, fields):
+    for f in fields:
+        comment = f.description
+        if f.kind == "ipv4":
+            comment = (comment + ", " if comment else "") + "IPv4 in network order"
+        if not f.required:
+            out.append("\tbool has_%s;" % f.c_name)
+        if f.nullable:
+            out.append("\tbool %s_is_null;" % f.c_name)
+        decl = "\t" + f.c_decl(prefix)
+        out.append(decl + ("\t\t\t\t///> " + comment if comment else ""))
+
+
+def gen_header(schemas, ordered, ops):
+    out = [HEADER_START]
+    routes = sum(len(op.uris) for op in ops)
+    out.append("// For max_uri_handlers, with every x-if option enabled")
+    out.append("#define API_ROUTE_COUNT\t\t\t\t%d" % routes)
+    out.append("")
+    out.append("/**")
+    out.append(" * Operations in swagger.yaml order, the route of an HTTP journal record.")
+    out.append(" */")
+    out.append("typedef enum api_operation")
+    out.append("{")
+    for i, op in enumerate(ops):
+        out.append("\t%s%s," % (op.op_const, " = 0" if i == 0 else ""))
+    out.append("\tAPI_OP_COUNT")
+    out.append("} api_operation_e;")
+    out.append("")
+    out.append("extern const char *const api_operation_names[API_OP_COUNT];")
+    out.append("")
+    out.append("/*")
+    out.append(" * Component schemas. API_<NAME>_JSON_MAX is the longest text of the writer, null included.")
+    out.append(" */")
+    out.append("")
+
+    for s in ordered:
+        for f in s.fields:
+            if f.kind == "enum":
+                gen_enum(out, s.c_name, f)
+        out.append("#define API_%s_JSON_MAX\t\t\t%d" % (s.c_name.upper(), s.json_max(schemas) + 1))
+        out.append("")
+        if s.description:
+            out.append("/**")
+            out.append(" * %s" % s.description)
+            out.append(" */")
+        out.append("typedef struct api_%s" % s.c_name)
+        out.append("{")
+        gen_struct_fields(out, s.c_name, s.fields)
+        out.append("} api_%s_t;" % s.c_name)
+        out.append("")
+        out.append("bool api_parse_%s(json_reader_t *r, api_%s_t *v, const char **error);" % (s.c_name, s.c_name))
+        out.append("bool api_write_%s(json_writer_t *w, const api_%s_t *v);" % (s.c_name, s.c_name))
+        out.append("bool api_format_%s(char *buf, size_t size, const api_%s_t *v);" % (s.c_name, s.c_name))
+        out.append("esp_err_t api_send_%s(httpd_req_t *req, const api_%s_t *v);" % (s.c_name, s.c_name))
+        out.append("")
+
+    out.append("/*")
+    out.append(" * Operation inputs, parsed and validated before the handler runs.")
+    out.append(" */")
+    out.append("")
+    for op in ops:
+        if not op.has_input:
+            continue
+        prefix = snake(op.op_id)
+        for f in op.query_params:
+            if f.kind == "enum":
+                gen_enum(out, prefix, f)
+        out.append("typedef struct api_%s_in" % prefix)
+        out.append("{")
+        gen_struct_fields(out, prefix, op.path_fields + op.query_params)
+        if op.body:
+            if not op.body_required:
+                out.append("\tbool has_body;")
+            out.append("\tapi_%s_t body;" % snake(op.body))
+        out.append("} %s;" % op.in_type)
+        out.append("")
+
+    out.append("/*")
+    out.append(" * Operation handlers, implemented in http_server.c.")
+    out.append(" */")
+    out.append("")
+    for op in ops:
+        line = "esp_err_t %s(httpd_req_t *req%s);" % (
+            op.handler, ", const %s *in" % op.in_type if op.has_input else "")
+        out.append("// %s %s" % (op.method.upper(), op.path))
+        out.append(line)
+    out.append("")
+    out.append("#endif /* MAIN_API_GEN_H_ */")
+    return "\n".join(out) + "\n"
+
+
+def gen_read_field(out, prefix, f, target, indent):
+    """Code reading one JSON value into target, setting *error on failure."""
+    t = "\t" * indent
+    if f.kind == "object":
+        name = snake(f.ref)
+        if f.nullable:
+            out.append(t + "if (json_peek(r) == JSON_TYPE_NULL)")
+            out.append(t + "{")
+            out.append(t + "\tjson_read_null(r);")
+            out.append(t + "\tv->%s_is_null = true;" % f.c_name)
+            out.append(t + "}")
+            out.append(t + "else if (!api_parse_%s(r, &%s, error))" % (name, target))
+        else:
+            out.append(t + "if (!api_parse_%s(r, &%s, error))" % (name, target))
+        out.append(t + "{")
+        out.append(t + "\treturn false;")
+        out.append(t + "}")
+        return
+
+    if f.kind == "string":
+        if f.min_len:
+            cond = "!json_read_string(r, %s, sizeof(%s)) || strlen(%s) < %d" % (target, target, target, f.min_len)
+            what = "string of %d..%d characters" % (f.min_len, f.max_len)
+        else:
+            cond = "!json_read_string(r, %s, sizeof(%s))" % (target, target)
+            what = "string of at most %d characters" % f.max_len
+    elif f.kind == "enum":
+        out.append(t + "int n;")
+        out.append("")
+        cond = "!api_read_enum(r, api_%s_%s_names, %s, &n)" % (prefix, f.c_name, f.enum_const(prefix, "COUNT"))
+        what = " or ".join('"%s"' % v for v in f.values)
+    elif f.kind == "ipv4":
+        cond = "!api_read_ipv4(r, &%s)" % target
+        what = "IPv4 address"
+    elif f.kind == "int":
+        out.append(t + "int64_t n;")
+        out.append("")
+        cond = "!json_read_int(r, &n) || " + f.int_check("n")
+        what = f.int_text()
+    else:
+        cond = "!json_read_bool(r, &%s)" % target
+        what = "true or false"
+
+    out.append(t + "if (%s)" % cond)
+    out.append(t + "{")
+    out.append(t + "\t*error = %s;" % c_string("%s: %s expected" % (f.name, what)))
+    out.append(t + "\treturn false;")
+    out.append(t + "}")
+    if f.kind == "enum":
+        out.append(t + "%s = n;" % target)
+    elif f.kind == "int":
+        out.append(t + "%s = n;" % target)
+
+
+def gen_write_field(out, prefix, f, source, indent):
+    t = "\t" * indent
+    if f.kind == "object":
+        call = "api_write_%s(w, &%s);" % (snake(f.ref), source)
+        if f.nullable:
+            out.append(t + "if (v->%s_is_null)" % f.c_name)
+            out.append(t + "{")
+            out.append(t + "\tjson_put_null(w);")
+            out.append(t + "}")
+            out.append(t + "else")
+            out.append(t + "{")
+            out.append(t + "\t" + call)
+            out.append(t + "}")
+        else:
+            out.append(t + call)
+    elif f.kind == "enum":
+        out.append(t + "json_put_string(w, api_%s_%s_names[%s]);" % (prefix, f.c_name, source))
+    elif f.kind == "string":
+        out.append(t + "json_put_string(w, %s);" % source)
+    elif f.kind == "ipv4":
+        out.append(t + "api_put_ipv4(w, %s);" % source)
+    elif f.kind == "int":
+        out.append(t + "json_put_int(w, %s);" % source)
+    else:
+        out.append(t + "json_put_bool(w, %s);" % source)
+
+
+def gen_enum_names(out, prefix, f):
+    out.append("static const char *const api_%s_%s_names[%s] = {" % (prefix, f.c_name, f.enum_const(prefix, "COUNT")))
+    for value in f.values:
+        out.append("\t\t[%s] = %s," % (f.enum_const(prefix, value), c_string(value)))
+    out.append("};")
+    out.append("")
+
+
+def gen_schema_code(out, s):
+    n = s.c_name
+    for f in s.fields:
+        if f.kind == "enum":
+            gen_enum_names(out, n, f)
+
+    required = [f for f in s.fields if f.required]
+
+    # Parser
+    out.append("bool api_parse_%s(json_reader_t *r, api_%s_t *v, const char **error)" % (n, n))
+    out.append("{")
+    out.append("\tconst char *key;")
+    out.append("\tsize_t len;")
+    if required:
+        out.append("\tuint32_t seen = 0;")
+    out.append("")
+    out.append("\tmemset(v, 0, sizeof(*v));")
+    out.append("\tif (!json_read_object(r))")
+    out.append("\t{")
+    out.append("\t\t*error = %s;" % c_string("%s object expected" % s.name))
+    out.append("\t\treturn false;")
+    out.append("\t}")
+    out.append("")
+    out.append("\twhile (json_next_key(r, &key, &len))")
+    out.append("\t{")
+    for i, f in enumerate(s.fields):
+        out.append("\t\t%sif (json_key_is(key, len, %s))" % ("else " if i else "", c_string(f.name)))
+        out.append("\t\t{")
+        gen_read_field(out, n, f, "v->" + f.c_name, 3)
+        if f.required:
+            out.append("\t\t\tseen |= 1u << %d;" % required.index(f))
+        else:
+            out.append("\t\t\tv->has_%s = true;" % f.c_name)
+        out.append("\t\t}")
+    out.append("\t\telse if (!json_skip(r))")
+    out.append("\t\t{")
+    out.append("\t\t\tbreak;")
+    out.append("\t\t}")
+    out.append("\t}")
+    out.append("\tif (r->error)")
+    out.append("\t{")
+    out.append("\t\t*error = %s;" % c_string(ERROR_INVALID_JSON))
+    out.append("\t\treturn false;")
+    out.append("\t}")
+    for i, f in enumerate(required):
+        out.append("\tif (!(seen & (1u << %d)))" % i)
+        out.append("\t{")
+        out.append("\t\t*error = %s;" % c_string("%s is required" % f.name))
+        out.append("\t\treturn false;")
+        out.append("\t}")
+    out.append("")
+    out.append("\treturn true;")
+    out.append("}")
+    out.append("")
+
+    # Writer
+    out.append("bool api_write_%s(json_writer_t *w, const api_%s_t *v)" % (n, n))
+    out.append("{")
+    out.append("\tconst char *sep = \"{\";")
+    out.append("")
+    for f in s.fields:
+        indent = 1
+        if not f.required:
+            out.append("\tif (v->has_%s)" % f.c_name)
+            out.append("\t{")
+            indent = 2
+        t = "\t" * indent
+        out.append(t + "json_put_raw(w, sep);")
+        out.append(t + "json_put_raw(w, %s);" % c_string('"%s":' % f.name))
+        gen_write_field(out, n, f, "v->" + f.c_name, indent)
+        out.append(t + "sep = \",\";")
+        if not f.required:
+            out.append("\t}")
+    out.append("\tjson_put_raw(w, *sep == '{' ? \"{}\" : \"}\");")
+    out.append("")
+    out.append("\treturn !w->overflow;")
+    out.append("}")
+    out.append("")
+
+    out.append("bool api_format_%s(char *buf, size_t size, const api_%s_t *v)" % (n, n))
+    out.append("{")
+    out.append("\tjson_writer_t w;")
+    out.append("")
+    out.append("\tjson_writer_init(&w, buf, size);")
+    out.append("\tapi_write_%s(&w, v);" % n)
+    out.append("")
+    out.append("\treturn json_writer_finish(&w);")
+    out.append("}")
+    out.append("")
+
+    out.append("esp_err_t api_send_%s(httpd_req_t *req, const api_%s_t *v)" % (n, n))
+    out.append("{")
+    out.append("\tchar buf[API_%s_JSON_MAX];" % n.upper())
+    out.append("")
+    out.append("\tapi_format_%s(buf, sizeof(buf), v);" % n)
+    out.append("\thttpd_resp_set_type(req, \"application/json\");")
+    out.append("")
+    out.append("\treturn httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);")
+    out.append("}")
+    out.append("")
+
+
+def gen_return(out, op, result, indent, value="ESP_OK"):
+    t = "\t" * indent
+    if op.journal:
+        out.append(t + "journal_end(&rec, %s);" % result)
+    out.append(t + "return %s;" % value)
+
+
+def gen_bad_request(out, op, message, indent=1):
+    t = "\t" * indent
+    out.append(t + "{")
+    out.append(t + "\thttpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, %s);" % c_string(message))
+    gen_return(out, op, "JOURNAL_RESULT_BAD_REQUEST", indent + 1)
+    out.append(t + "}")
+
+
+def gen_wrapper(out, op):
+    prefix = snake(op.op_id)
+    for f in op.query_params:
+        if f.kind == "enum":
+            gen_enum_names(out, prefix, f)
+
+    out.append("/**")
+    out.append(" * %s %s%s" % (op.method.upper(), op.path, ": " + op.summary if op.summary else ""))
+    out.append(" */")
+    out.append("static esp_err_t api_%s(httpd_req_t *req)" % op.op_id)
+    out.append("{")
+    if op.has_input:
+        out.append("\t%s in = { 0 };" % op.in_type)
+    if op.query_params:
+        out.append("\tchar query[%d];" % QUERY_MAX)
+    if any(f.kind == "enum" for f in op.query_params):
+        out.append("\tint n;")
+    if op.body:
+        out.append("\tchar body[API_%s_JSON_MAX + %d];" % (snake(op.body).upper(), BODY_SLACK))
+        out.append("\tconst char *error = %s;" % c_string(ERROR_INVALID_JSON))
+        out.append("\tjson_reader_t r;")
+        out.append("\tint len;")
+    if op.journal:
+        out.append("\tjournal_record_t rec;")
+        out.append("\tesp_err_t err;")
+    # Until the wrapper returns: admission, parsing, the handler and its response
+    out.append("\tTRACE_SCOPE(TRACE_EV_HTTP_REQUEST, %s);" % op.op_const)
+    out.append("")
+
+    if op.journal:
+        out.append("\tjournal_begin(&rec, JOURNAL_SOURCE_HTTP, %s, http_conn_client(req));" % op.op_const)
+    if op.path.startswith("/api/"):
+        out.append("\tset_cors_headers(req);")
+    out.append("\tif (!http_admit(req))")
+    out.append("\t{")
+    gen_return(out, op, "JOURNAL_RESULT_LIMITED", 2)
+    out.append("\t}")
+    if op.secure:
+        out.append("\tif (!http_server_authorize(req))")
+        out.append("\t{")
+        gen_return(out, op, "JOURNAL_RESULT_UNAUTHORIZED", 2)
+        out.append("\t}")
+
+    for f in op.path_fields:
+        fmt = op.path.replace("{%s}" % f.name, "%d")
+        out.append("\tif (!api_path_int(req, %s, %d, %d, &in.%s))" % (c_string(fmt), f.lo, f.hi, f.c_name))
+        gen_bad_request(out, op, "%s: %s expected" % (f.name, f.int_text()))
+    if op.journal and op.path_fields:
+        out.append("\trec.channel = in.%s;" % op.path_fields[0].c_name)
+
+    if op.query_params:
+        out.append("\tif (!api_get_query(req, query, sizeof(query)))")
+        gen_bad_request(out, op, "Query string too long")
+        for f in op.query_params:
+            if f.kind == "int":
+                default = f.default if f.default is not None else 0
+                out.append("\tif (!api_query_int(query, %s, %d, %d, %d, &in.%s))"
+                           % (c_string(f.name), f.lo, f.hi, default, f.c_name))
+                gen_bad_request(out, op, "%s: %s expected" % (f.name, f.int_text()))
+            else:
+                default = f.enum_const(prefix, f.default) if f.default is not None else 0
+                out.append("\tif (!api_query_enum(query, %s, api_%s_%s_names, %s, %s, &n))"
+                           % (c_string(f.name), prefix, f.c_name, f.enum_const(prefix, "COUNT"), default))
+                gen_bad_request(out, op, "%s: %s expected" % (f.name, " or ".join('"%s"' % v for v in f.values)))
+                out.append("\tin.%s = n;" % f.c_name)
+
+    if op.body:
+        body = snake(op.body)
+        out.append("")
+        out.append("\tlen = api_recv_body(req, body, sizeof(body), %s);" % ("true" if op.body_required else "false"))
+        out.append("\tif (len < 0)")
+        out.append("\t{")
+        gen_return(out, op, "len == API_RECV_FAILED ? JOURNAL_RESULT_FAILED : JOURNAL_RESULT_BAD_REQUEST", 2,
+                   "len == API_RECV_FAILED ? ESP_FAIL : ESP_OK")
+        out.append("\t}")
+        indent = 1
+        if not op.body_required:
+            out.append("\tif (len > 0)")
+            out.append("\t{")
+            indent = 2
+        t = "\t" * indent
+        out.append(t + "json_reader_init(&r, body, len);")
+        out.append(t + "if (!api_parse_%s(&r, &in.body, &error) || !json_reader_done(&r))" % body)
+        out.append(t + "{")
+        out.append(t + "\thttpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);")
+        gen_return(out, op, "JOURNAL_RESULT_BAD_REQUEST", indent + 1)
+        out.append(t + "}")
+        if not op.body_required:
+            out.append(t + "in.has_body = true;")
+            out.append("\t}")
+
+    out.append("")
+    call = "%s(req%s)" % (op.handler, ", &in" if op.has_input else "")
+    if op.journal:
+        out.append("\tg_api_result = JOURNAL_RESULT_OK;")
+        out.append("\terr = %s;" % call)
+        out.append("\tjournal_end(&rec, err == ESP_OK ? g_api_result : JOURNAL_RESULT_FAILED);")
+        out.append("\treturn err;")
+    else:
+        out.append("\treturn %s;" % call)
+    out.append("}")
+    out.append("")
+
+
+def gen_source(schemas, ordered, ops):
+    out = [SOURCE_START]
+    for s in ordered:
+        gen_schema_code(out, s)
+
+    out.append("const char *const api_operation_names[API_OP_COUNT] = {")
+    for op in ops:
+        out.append("\t\t[%s] = %s," % (op.op_const, c_string(op.op_id)))
+    out.append("};")
+    out.append("")
+
+    # Registration order: as in swagger.yaml, the wildcard after everything it could shadow
+    routes = [op for op in ops if not op.wildcard] + [op for op in ops if op.wildcard]
+
+    cond = None
+    for op in routes:
+        if op.cond != cond:
+            if cond:
+                out.append("#endif")
+                out.append("")
+            if op.cond:
+                out.append("#if %s" % op.cond)
+            cond = op.cond
+        gen_wrapper(out, op)
+    if cond:
+        out.append("#endif")
+        out.append("")
+
+    out.append("const api_route_t api_routes[] = {")
+    cond = None
+    for op in routes:
+        if op.cond != cond:
+            if cond:
+                out.append("#endif")
+            if op.cond:
+                out.append("#if %s" % op.cond)
+            cond = op.cond
+        for uri in op.uris:
+            out.append("\t\t{ %s, HTTP_%s, api_%s, %s }," % (c_string(uri), op.method.upper(), op.op_id, ADMIT[op.admit]))
+    if cond:
+        out.append("#endif")
+    out.append("};")
+    out.append("")
+    out.append("const size_t api_route_count = sizeof(api_routes) / sizeof(api_routes[0]);")
+    return "\n".join(out) + "\n"
+
+
+def write(path, text):
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit("usage: gen_routes.py swagger.yaml api_gen.h api_gen.c")
+    try:
+        _, schemas, ordered, ops = load(sys.argv[1])
+        header = gen_header(schemas, ordered, ops)
+        source = gen_source(schemas, ordered, ops)
+    except GenError as e:
+        sys.exit("%s: %s" % (sys.argv[1], e))
+    write(sys.argv[2], header)
+    write(sys.argv[3], source)
+
+
+if __name__ == "__main__":
+    main()
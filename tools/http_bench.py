@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+wrk-style load test of the REST API, against the device or the host build.
+
+Examples:
+    http_bench.py 127.0.0.1:8080                          # host build, default endpoint mix
+    http_bench.py 192.168.0.50 -c 4 -d 20 /api/leds/1
+    http_bench.py 127.0.0.1:8080 --etag /api/config/network
+    http_bench.py 127.0.0.1:8080 -c 24 --sources 6 --idle 4     # host build, 6 clients + 4 idle sockets
+
+Every connection is kept alive and sends requests back to back for the whole duration,
+cycling through the given paths (GET, or POST for paths ending in /toggle).
+With --etag the ETag of each response is sent back in If-None-Match, like a polling browser.
+Prints requests/s and latency percentiles per path and overall.
+
+On the host build, --sources N spreads the connections over the source addresses 127.0.0.2 .. 127.0.0.N+1,
+so the server sees N clients and applies its per-client connection cap. --idle opens sockets that never
+send a request, like a browser's spare connections. The connection counters of /api/metrics are
+printed at the end.
+"""
+
+import argparse
+import http.client
+import json
+import socket
+import threading
+import time
+
+DEFAULT_PATHS = ["/api/leds/1", "/api/config/network", "/api/config/ip_addr", "/api/metrics"]
+POST_SUFFIXES = ("/toggle",)
+
+
+def percentile(samples, p):
+    samples = sorted(samples)
+    return samples[min(len(samples) - 1, int(round(p / 100.0 * (len(samples) - 1))))]
+
+
+class Worker(threading.Thread):
+    def __init__(self, host, port, paths, deadline, etag, offset, source=None):
+        super().__init__(daemon=True)
+        self.host = host
+        self.port = port
+        self.source = (source, 0) if source else None
+        self.paths = paths
+        self.deadline = deadline
+        self.etag = etag
+        self.offset = offset
+        self.latencies = {path: [] for path in paths}
+        self.status = {}
+        self.errors = 0
+
+    def connect(self):
+        return http.client.HTTPConnection(self.host, self.port, timeout=5, source_address=self.source)
+
+    def run(self):
+        conn = self.connect()
+        etags = {}
+        i = self.offset
+
+        while time.monotonic() < self.deadline:
+            path = self.paths[i % len(self.paths)]
+            i += 1
+            method = "POST" if path.endswith(POST_SUFFIXES) else "GET"
+            headers = {}
+            if self.etag and path in etags:
+                headers["If-None-Match"] = etags[path]
+
+            start = time.perf_counter()
+            try:
+                conn.request(method, path, headers=headers)
+                resp = conn.getresponse()
+                resp.read()
+            except (OSError, http.client.HTTPException):
+                self.errors += 1
+                conn.close()
+                conn = self.connect()
+                continue
+            self.latencies[path].append((time.perf_counter() - start) * 1000.0)
+            self.status[resp.status] = self.status.get(resp.status, 0) + 1
+
+            if resp.getheader("ETag"):
+                etags[path] = resp.getheader("ETag")
+            if resp.getheader("Connection", "").lower() == "close":
+                conn.close()
+                conn = self.connect()
+
+        conn.close()
+
+
+def report(name, samples, duration):
+    if not samples:
+        print("%-24s no responses" % name)
+        return
+    print("%-24s n=%-6d %8.1f req/s  p50=%6.2f ms  p90=%6.2f ms  p99=%6.2f ms  max=%6.2f ms" % (
+        name, len(samples), len(samples) / duration, percentile(samples, 50),
+        percentile(samples, 90), percentile(samples, 99), max(samples)))
+
+
+def print_connection_stats(host, port):
+    try:
+        conn = http.client.HTTPConnection(host, port, timeout=5)
+        conn.request("GET", "/api/metrics")
+        stats = json.loads(conn.getresponse().read()).get("connections")
+        conn.close()
+    except (OSError, http.client.HTTPException, ValueError):
+        return
+    if stats:
+        print("server: %s" % ", ".join("%s %s" % (k, v) for k, v in stats.items()))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("target", help="host[:port], port 80 by default")
+    parser.add_argument("paths", nargs="*", default=DEFAULT_PATHS)
+    parser.add_argument("-c", "--connections", type=int, default=4)
+    parser.add_argument("-d", "--duration", type=float, default=10.0, help="seconds")
+    parser.add_argument("--etag", action="store_true", help="revalidate with If-None-Match")
+    parser.add_argument("--sources", type=int, default=0, help="loopback source addresses (host build)")
+    parser.add_argument("--idle", type=int, default=0, help="extra sockets that never send a request")
+    args = parser.parse_args()
+
+    host, _, port = args.target.partition(":")
+    port = int(port) if port else 80
+
+    sources = ["127.0.0.%d" % (2 + i) for i in range(args.sources)]
+    idle = []
+    for i in range(args.idle):
+        try:
+            idle.append(socket.create_connection((host, port), timeout=5,
+                                                 source_address=(sources[i % len(sources)], 0) if sources else None))
+        except OSError:
+            pass
+
+    start = time.monotonic()
+    workers = [Worker(host, port, args.paths, start + args.duration, args.etag, i,
+                      sources[i % len(sources)] if sources else None)
+               for i in range(args.connections)]
+    for w in workers:
+        w.start()
+    for w in workers:
+        w.join()
+    duration = time.monotonic() - start
+    for sock in idle:
+        sock.close()
+
+    print("%s:%d, %d connections from %d clients, %d idle, %.1f s%s" % (
+        host, port, args.connections, max(1, args.sources), len(idle), duration,
+        ", If-None-Match" if args.etag else ""))
+    everything = []
+    for path in args.paths:
+        samples = [x for w in workers for x in w.latencies[path]]
+        everything += samples
+        report(path, samples, duration)
+    report("total", everything, duration)
+
+    status = {}
+    for w in workers:
+        for code, n in w.status.items():
+            status[code] = status.get(code, 0) + n
+    print("status: %s, errors: %d" % (", ".join("%d x %d" % (n, code) for code, n in sorted(status.items())),
+                                       sum(w.errors for w in workers)))
+    print_connection_stats(host, port)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""
+Scripted test of the HTTP connection manager (main/http_conn.c) against the host build.
+
+Examples:
+    http_conn_test.py 127.0.0.1:8080                                  # host build already running
+    http_conn_test.py --elf build_linux/smart_home_system.elf         # start it, test, stop it
+    http_conn_test.py 127.0.0.1:8080 --skip-idle                      # without the idle wait
+
+The clients connect from the loopback addresses 127.0.0.2 and up, so the server sees one
+client per address. 127.0.0.1 is not capped (the load generator) and only reads /api/metrics
+over one kept-alive connection. Each check compares the "connections" counters of
+/api/metrics before and after:
+    cap      a client opens CONFIG_HTTP_CONN_PER_CLIENT sockets, one more is refused
+    purge    the last free socket is taken, the oldest socket of the client holding the
+             most is closed and the other clients keep theirs
+    idle     a socket without a request is closed by the sweep after
+             CONFIG_HTTP_CONN_IDLE_TIMEOUT_S (plus up to 5 s of sweep period)
+
+The limits are read from the sdkconfig of the build (--sdkconfig), the Kconfig defaults
+apply to anything missing. Exits with 1 if a check fails.
+"""
+
+import argparse
+import http.client
+import json
+import os
+import socket
+import subprocess
+import sys
+import time
+
+DEFAULTS = {"HTTP_CONN_MAX_SOCKETS": 7, "HTTP_CONN_PER_CLIENT": 3, "HTTP_CONN_IDLE_TIMEOUT_S": 30}
+SWEEP_PERIOD_S = 5
+SETTLE_S = 2.0
+
+
+class CheckFailed(Exception):
+    pass
+
+
+def read_sdkconfig(path):
+    config = dict(DEFAULTS)
+    if path and os.path.exists(path):
+        with open(path) as f:
+            for line in f:
+                name, _, value = line.strip().partition("=")
+                if name.startswith("CONFIG_") and name[7:] in config:
+                    config[name[7:]] = int(value)
+    return config
+
+
+class Client:
+    """One kept-alive connection from a given loopback source address."""
+
+    def __init__(self, host, port, source):
+        self.source = source
+        self.conn = http.client.HTTPConnection(host, port, timeout=5, source_address=(source, 0))
+        self.conn.connect()
+
+    def get(self, path="/api/leds/1"):
+        """The response body, or None once the server closed the connection."""
+        try:
+            self.conn.request("GET", path)
+            resp = self.conn.getresponse()
+            body = resp.read()
+        except (OSError, http.client.HTTPException):
+            self.conn.close()
+            return None
+        if resp.getheader("Connection", "").lower() == "close":
+            self.conn.close()
+        return body
+
+    def close(self):
+        self.conn.close()
+
+
+class Monitor:
+    """Reads the connection counters from 127.0.0.1, which keeps one socket of its own."""
+
+    def __init__(self, host, port):
+        self.client = Client(host, port, "127.0.0.1")
+
+    def stats(self):
+        body = self.client.get("/api/metrics")
+        if body is None:
+            raise CheckFailed("the metrics connection from 127.0.0.1 was closed")
+        return json.loads(body)["connections"]
+
+    def wait_for(self, what, timeout=SETTLE_S * 3):
+        """Polls the counters until what(stats) holds, the close of a socket is asynchronous."""
+        deadline = time.monotonic() + timeout
+        while True:
+            stats = self.stats()
+            if what(stats) or time.monotonic() > deadline:
+                return stats
+            time.sleep(0.1)
+
+
+def expect(condition, message):
+    if not condition:
+        raise CheckFailed(message)
+
+
+def check_cap(host, port, monitor, config, opened):
+    per_client = config["HTTP_CONN_PER_CLIENT"]
+    before = monitor.stats()
+
+    for _ in range(per_client):
+        client = Client(host, port, "127.0.0.2")
+        expect(client.get() is not None, "socket %d of 127.0.0.2 not served" % (len(opened) + 1))
+        opened.append(client)
+
+    extra = Client(host, port, "127.0.0.2")
+    expect(extra.get() is None, "socket %d of 127.0.0.2 served over the cap of %d" % (per_client + 1, per_client))
+    extra.close()
+
+    after = monitor.wait_for(lambda s: s["refused"] > before["refused"])
+    expect(after["refused"] == before["refused"] + 1, "refused %d -> %d, expected +1" % (before["refused"], after["refused"]))
+    expect(after["accepted"] == before["accepted"] + per_client, "accepted %d -> %d, expected +%d"
+           % (before["accepted"], after["accepted"], per_client))
+    expect(all(c.get() is not None for c in opened), "a capped client lost a socket it had")
+    return "%d sockets of 127.0.0.2 served, the next one refused" % per_client
+
+
+def check_purge(host, port, monitor, config, opened):
+    max_sockets = config["HTTP_CONN_MAX_SOCKETS"]
+    if config["HTTP_CONN_PER_CLIENT"] < 2 or max_sockets < config["HTTP_CONN_PER_CLIENT"] + 2:
+        return None
+
+    # 127.0.0.2 holds the most sockets, its first one was used longest ago
+    for client in opened:
+        client.get()
+    before = monitor.stats()
+
+    others = []
+    source = 3
+    while before["active"] + len(others) < max_sockets - 1:
+        client = Client(host, port, "127.0.0.%d" % source)
+        expect(client.get() is not None, "127.0.0.%d not served" % source)
+        others.append(client)
+        source += 1
+
+    newcomer = Client(host, port, "127.0.0.%d" % source)
+    expect(newcomer.get() is not None, "the client taking the last socket was not served")
+    after = monitor.wait_for(lambda s: s["purged"] > before["purged"] and s["active"] < max_sockets)
+
+    expect(after["purged"] == before["purged"] + 1, "purged %d -> %d, expected +1" % (before["purged"], after["purged"]))
+    expect(after["active"] == max_sockets - 1, "%d sockets open after the purge, expected %d" % (after["active"], max_sockets - 1))
+    expect(opened[0].get() is None, "the oldest socket of 127.0.0.2 is still open")
+    expect(all(c.get() is not None for c in opened[1:]), "127.0.0.2 lost more than one socket")
+    expect(all(c.get() is not None for c in others + [newcomer]), "a client with one socket lost it")
+
+    for client in others + [newcomer]:
+        client.close()
+    return "%d sockets open, the oldest of 127.0.0.2 (%d sockets) purged for 127.0.0.%d" % (
+        max_sockets, config["HTTP_CONN_PER_CLIENT"], source)
+
+
+def check_idle(host, port, monitor, config):
+    timeout = config["HTTP_CONN_IDLE_TIMEOUT_S"]
+    if timeout == 0:
+        return None
+
+    before = monitor.stats()
+    idle = Client(host, port, "127.0.0.20")
+    expect(idle.get() is not None, "127.0.0.20 not served")
+
+    # The monitor connection must not look idle itself
+    deadline = time.monotonic() + timeout + SWEEP_PERIOD_S + SETTLE_S
+    while time.monotonic() < deadline:
+        time.sleep(1.0)
+        after = monitor.stats()
+
+    expect(after["idle_closed"] >= before["idle_closed"] + 1, "idle_closed %d -> %d, expected +1"
+           % (before["idle_closed"], after["idle_closed"]))
+    expect(idle.get() is None, "the idle socket is still open after %d s" % (timeout + SWEEP_PERIOD_S))
+    return "closed within %d s without a request" % (timeout + SWEEP_PERIOD_S)
+
+
+def wait_for_server(host, port, proc, timeout=20):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        if proc.poll() is not None:
+            sys.exit("the host build exited with %d" % proc.returncode)
+        try:
+            socket.create_connection((host, port), timeout=1).close()
+            return
+        except OSError:
+            time.sleep(0.2)
+    sys.exit("no server on %s:%d after %d s" % (host, port, timeout))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("target", nargs="?", default="127.0.0.1:8080", help="host[:port] of the host build")
+    parser.add_argument("--elf", help="start this host build for the test and stop it afterwards")
+    parser.add_argument("--sdkconfig", help="sdkconfig of the build, next to --elf by default")
+    parser.add_argument("--skip-idle", action="store_true", help="skip the idle timeout check")
+    args = parser.parse_args()
+
+    host, _, port = args.target.partition(":")
+    port = int(port) if port else 8080
+    sdkconfig = args.sdkconfig or (os.path.join(os.path.dirname(args.elf), "sdkconfig") if args.elf else None)
+    config = read_sdkconfig(sdkconfig)
+
+    proc = None
+    if args.elf:
+        proc = subprocess.Popen([args.elf], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        wait_for_server(host, port, proc)
+
+    failed = 0
+    opened = []
+    try:
+        monitor = Monitor(host, port)
+        print("%s:%d, %d sockets, %d per client, idle timeout %d s" % (
+            host, port, config["HTTP_CONN_MAX_SOCKETS"], config["HTTP_CONN_PER_CLIENT"],
+            config["HTTP_CONN_IDLE_TIMEOUT_S"]))
+
+        checks = [
+            ("cap", lambda: check_cap(host, port, monitor, config, opened)),
+            ("purge", lambda: check_purge(host, port, monitor, config, opened)),
+            ("idle", lambda: None if args.skip_idle else check_idle(host, port, monitor, config)),
+        ]
+        for name, check in checks:
+            try:
+                result = check()
+                print("%-6s %s" % (name, "skipped" if result is None else "ok, " + result))
+            except CheckFailed as e:
+                print("%-6s FAILED: %s" % (name, e))
+                failed += 1
+            if name == "purge":
+                for client in opened:
+                    client.close()
+                monitor.wait_for(lambda s: s["active"] == 1)
+
+        print("server: %s" % ", ".join("%s %s" % (k, v) for k, v in monitor.stats().items()))
+    finally:
+        if proc is not None:
+            proc.terminate()
+            proc.wait()
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+TLS handshake and request latency of the HTTPS control API (CONFIG_HTTP_SERVER_HTTPS).
+
+Examples:
+    https_bench.py 192.168.0.1
+    https_bench.py 192.168.0.50:443 -n 50 /api/config/network
+
+Times three ways of sending GET <path>, n times each:
+    full       new connection, full handshake
+    resumed    new connection, resuming the TLS session of the previous one (session ticket)
+    keepalive  request on an already open connection, no handshake
+and prints p50/p99 of handshake and total time, and how many handshakes actually resumed.
+The certificate is not verified; the device uses a self-signed one.
+
+The same check with openssl, "Reused" lines after the first connection mean resumption works:
+    openssl s_client -connect 192.168.0.1:443 -tls1_2 -reconnect < /dev/null | grep -E "^(New|Reused)"
+"""
+
+import argparse
+import http.client
+import socket
+import ssl
+import time
+
+
+def percentile(samples, p):
+    samples = sorted(samples)
+    return samples[min(len(samples) - 1, int(round(p / 100.0 * (len(samples) - 1))))]
+
+
+def make_context():
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    ctx.check_hostname = False
+    ctx.verify_mode = ssl.CERT_NONE
+    # Session tickets are a TLS 1.2 feature on the device side
+    ctx.maximum_version = ssl.TLSVersion.TLSv1_2
+    return ctx
+
+
+def request(sock, host, path):
+    conn = http.client.HTTPConnection(host)
+    conn.sock = sock
+    conn.request("GET", path)
+    resp = conn.getresponse()
+    resp.read()
+    return resp.status
+
+
+def connect(ctx, host, port, session):
+    start = time.perf_counter()
+    raw = socket.create_connection((host, port), timeout=10)
+    sock = ctx.wrap_socket(raw, server_hostname=host, session=session)
+    return sock, (time.perf_counter() - start) * 1000.0
+
+
+def run_handshakes(ctx, host, port, path, n, resume):
+    handshake, total = [], []
+    session = None
+    reused = 0
+
+    for _ in range(n):
+        start = time.perf_counter()
+        sock, ms = connect(ctx, host, port, session if resume else None)
+        # Read before the request: the socket is closed if the response says Connection: close
+        reused += sock.session_reused
+        session = sock.session
+        request(sock, host, path)
+        total.append((time.perf_counter() - start) * 1000.0)
+        handshake.append(ms)
+        sock.close()
+
+    return handshake, total, reused
+
+
+def run_keepalive(ctx, host, port, path, n):
+    sock, _ = connect(ctx, host, port, None)
+    total = []
+    for _ in range(n):
+        start = time.perf_counter()
+        request(sock, host, path)
+        total.append((time.perf_counter() - start) * 1000.0)
+    sock.close()
+    return total
+
+
+def report(name, samples):
+    print("%-10s p50=%7.2f ms  p99=%7.2f ms  max=%7.2f ms" % (
+        name, percentile(samples, 50), percentile(samples, 99), max(samples)), end="")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("target", help="host[:port], port 443 by default")
+    parser.add_argument("path", nargs="?", default="/api/leds/1")
+    parser.add_argument("-n", type=int, default=20, help="requests per mode")
+    args = parser.parse_args()
+
+    host, _, port = args.target.partition(":")
+    port = int(port) if port else 443
+    ctx = make_context()
+
+    print("%s:%d GET %s, %d per mode" % (host, port, args.path, args.n))
+    for name, resume in (("full", False), ("resumed", True)):
+        handshake, total, reused = run_handshakes(ctx, host, port, args.path, args.n, resume)
+        report(name, total)
+        print("  handshake p50=%7.2f ms  reused %d/%d" % (percentile(handshake, 50), reused, args.n))
+    report("keepalive", run_keepalive(ctx, host, port, args.path, args.n))
+    print()
+
+
+if __name__ == "__main__":
+    main()
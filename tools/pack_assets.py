@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Packs the web page into an image for the "assets" partition and optionally uploads it.
+
+Examples:
+    pack_assets.py                                          # main/webpage -> build/assets.bin
+    pack_assets.py --upload 192.168.0.50 --user admin       # pack and deploy, asks for the password
+    pack_assets.py --upload 127.0.0.1:8080                  # host build, no login set
+    parttool.py write_partition --partition-name=assets --input build/assets.bin   # over USB
+
+Every file of the directory becomes /<relative path>. Files are gzip compressed unless that
+makes them larger; the device sends them with Content-Encoding: gzip and an ETag, so a UI
+deploy is some 70 KB instead of a 1.5 MB firmware OTA.
+
+Image layout (little endian, must match main/assets.h):
+    header  magic "WAS1", u16 version, u16 count, u32 image size, u32 CRC32 of the rest
+    index   count x (char path[40], u32 offset, u32 size, u32 CRC32, u32 flags)
+    data    the files
+"""
+
+import argparse
+import getpass
+import gzip
+import http.client
+import json
+import os
+import ssl
+import struct
+import sys
+import zlib
+
+MAGIC = 0x31534157
+VERSION = 1
+MAX_FILES = 24
+PATH_SIZE = 40
+FLAG_GZIP = 0x01
+PARTITION_SIZE = 192 * 1024
+
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<%dsIIII" % PATH_SIZE)
+
+
+def collect(directory):
+    files = []
+    for root, dirs, names in os.walk(directory):
+        dirs[:] = sorted(d for d in dirs if not d.startswith("."))
+        for name in sorted(names):
+            if name.startswith("."):
+                continue
+            full = os.path.join(root, name)
+            files.append(("/" + os.path.relpath(full, directory).replace(os.sep, "/"), full))
+    return files
+
+
+def pack(directory, compress):
+    files = collect(directory)
+    if not files:
+        sys.exit("%s has no files" % directory)
+    if len(files) > MAX_FILES:
+        sys.exit("%d files, the device takes %d" % (len(files), MAX_FILES))
+
+    index = []
+    data = b""
+    offset = HEADER.size + ENTRY.size * len(files)
+    for path, full in files:
+        if len(path.encode()) >= PATH_SIZE:
+            sys.exit("%s: path longer than %d bytes" % (path, PATH_SIZE - 1))
+        with open(full, "rb") as f:
+            raw = f.read()
+        stored, flags = raw, 0
+        if compress:
+            packed = gzip.compress(raw, 9, mtime=0)
+            if len(packed) < len(raw):
+                stored, flags = packed, FLAG_GZIP
+        index.append((path, offset, stored, flags, len(raw)))
+        data += stored
+        offset += len(stored)
+
+    body = b"".join(ENTRY.pack(path.encode(), off, len(stored), zlib.crc32(stored), flags)
+                    for path, off, stored, flags, _ in index) + data
+    image = HEADER.pack(MAGIC, VERSION, len(index), HEADER.size + len(body), zlib.crc32(body)) + body
+
+    for path, _, stored, flags, raw_len in index:
+        print("%-32s %7d -> %7d%s" % (path, raw_len, len(stored), " gzip" if flags & FLAG_GZIP else ""))
+    print("%d files, %d bytes, crc %08x, %d%% of the partition"
+          % (len(index), len(image), zlib.crc32(body), 100 * len(image) // PARTITION_SIZE))
+    if len(image) > PARTITION_SIZE:
+        sys.exit("image exceeds the %d KB assets partition" % (PARTITION_SIZE // 1024))
+    return image
+
+
+def connect(target, https):
+    host, _, port = target.partition(":")
+    if https:
+        # The device certificate is self-signed (tools/gen_https_cert.sh)
+        ctx = ssl.create_default_context()
+        ctx.check_hostname = False
+        ctx.verify_mode = ssl.CERT_NONE
+        return http.client.HTTPSConnection(host, int(port) if port else 443, timeout=30, context=ctx)
+    return http.client.HTTPConnection(host, int(port) if port else 80, timeout=30)
+
+
+def upload(args, image):
+    conn = connect(args.upload, args.https)
+    headers = {"Content-Type": "application/octet-stream"}
+
+    if args.user:
+        password = os.environ.get("SMARTHOME_PASSWORD") or getpass.getpass("Password of %s: " % args.user)
+        conn.request("POST", "/api/auth/login", json.dumps({"user": args.user, "password": password}),
+                     {"Content-Type": "application/json"})
+        resp = conn.getresponse()
+        body = resp.read()
+        if resp.status != 200:
+            sys.exit("login: %d %s" % (resp.status, body.decode(errors="replace")))
+        headers["Authorization"] = "Bearer " + json.loads(body)["token"]
+
+    conn.request("POST", "/api/assets/update", image, headers)
+    resp = conn.getresponse()
+    body = resp.read()
+    if resp.status != 200:
+        sys.exit("upload: %d %s" % (resp.status, body.decode(errors="replace")))
+    info = json.loads(body)
+    print("device: %d bytes of %d, crc %s, %d files"
+          % (info["size"], info["capacity"], info["crc"], len(info["files"])))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser.add_argument("directory", nargs="?", default=os.path.join(here, "..", "main", "webpage"))
+    parser.add_argument("-o", "--output", default=os.path.join(here, "..", "build", "assets.bin"))
+    parser.add_argument("--no-gzip", action="store_true", help="store the files uncompressed")
+    parser.add_argument("--upload", metavar="HOST[:PORT]", help="POST the image to /api/assets/update")
+    parser.add_argument("--https", action="store_true", help="upload over HTTPS")
+    parser.add_argument("--user", help="login before the upload (password from SMARTHOME_PASSWORD or a prompt)")
+    args = parser.parse_args()
+
+    image = pack(args.directory, not args.no_gzip)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "wb") as f:
+        f.write(image)
+    print("wrote %s" % os.path.normpath(args.output))
+
+    if args.upload:
+        upload(args, image)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""
+Exports and imports the whole device configuration (GET/PUT /api/config) as one CBOR document.
+
+Examples:
+    provision.py get 192.168.0.50 --user admin -o unit.cbor     # save a configured unit
+    provision.py put 192.168.4.1 unit.cbor                      # provision a new unit on its SoftAP
+    provision.py put 192.168.4.1 unit.json                      # the same from a JSON file
+    provision.py show unit.cbor > unit.json                     # CBOR -> editable JSON
+
+The JSON form writes addresses as "a.b.c.d" and the salt and hash as hex, the tool converts them
+to the byte strings of the document (see main/provision.h). A document only needs the sections
+to change, plus "version": 1. The password of --user comes from SMARTHOME_PASSWORD or a prompt.
+"""
+
+import argparse
+import getpass
+import http.client
+import json
+import os
+import socket
+import ssl
+import struct
+import sys
+
+ADDRESS_KEYS = ("ip", "netmask", "gw", "dns")
+HEX_KEYS = ("salt", "hash")
+
+
+def encode(value):
+    def head(major, arg):
+        if arg < 24:
+            return bytes([major << 5 | arg])
+        for ai, fmt in ((24, ">B"), (25, ">H"), (26, ">I"), (27, ">Q")):
+            if arg < 1 << (8 * struct.calcsize(fmt)):
+                return bytes([major << 5 | ai]) + struct.pack(fmt, arg)
+        raise ValueError("integer too large")
+
+    if value is None:
+        return b"\xf6"
+    if isinstance(value, bool):
+        return b"\xf5" if value else b"\xf4"
+    if isinstance(value, int):
+        if value < 0:
+            raise ValueError("negative integers are not used")
+        return head(0, value)
+    if isinstance(value, bytes):
+        return head(2, len(value)) + value
+    if isinstance(value, str):
+        data = value.encode()
+        return head(3, len(data)) + data
+    if isinstance(value, (list, tuple)):
+        return head(4, len(value)) + b"".join(encode(v) for v in value)
+    if isinstance(value, dict):
+        return head(5, len(value)) + b"".join(encode(k) + encode(v) for k, v in value.items())
+    raise ValueError("cannot encode %r" % (value,))
+
+
+def decode(data):
+    def item(pos):
+        ib = data[pos]
+        major, ai = ib >> 5, ib & 0x1f
+        pos += 1
+        if major == 7:
+            return {20: False, 21: True, 22: None}[ai], pos
+        if ai < 24:
+            arg = ai
+        else:
+            size = 1 << (ai - 24)
+            arg = int.from_bytes(data[pos:pos + size], "big")
+            pos += size
+        if major == 0:
+            return arg, pos
+        if major in (2, 3):
+            raw = data[pos:pos + arg]
+            return (raw if major == 2 else raw.decode()), pos + arg
+        if major == 4:
+            out = []
+            for _ in range(arg):
+                v, pos = item(pos)
+                out.append(v)
+            return out, pos
+        if major == 5:
+            out = {}
+            for _ in range(arg):
+                k, pos = item(pos)
+                out[k], pos = item(pos)
+            return out, pos
+        raise ValueError("unsupported CBOR major type %d" % major)
+
+    value, end = item(0)
+    if end != len(data):
+        raise ValueError("data after the document")
+    return value
+
+
+def to_json(value, key=None):
+    if isinstance(value, dict):
+        return {k: to_json(v, k) for k, v in value.items()}
+    if isinstance(value, bytes):
+        return socket.inet_ntoa(value) if key in ADDRESS_KEYS else value.hex()
+    return value
+
+
+def from_json(value, key=None):
+    if isinstance(value, dict):
+        return {k: from_json(v, k) for k, v in value.items()}
+    if isinstance(value, str) and key in ADDRESS_KEYS:
+        return socket.inet_aton(value)
+    if isinstance(value, str) and key in HEX_KEYS:
+        return bytes.fromhex(value)
+    return value
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if path.endswith(".json"):
+        data = encode(from_json(json.loads(data)))
+    else:
+        decode(data)
+    return data
+
+
+def connect(args):
+    host, _, port = args.target.partition(":")
+    if args.https:
+        # The device certificate is self-signed (tools/gen_https_cert.sh)
+        ctx = ssl.create_default_context()
+        ctx.check_hostname = False
+        ctx.verify_mode = ssl.CERT_NONE
+        conn = http.client.HTTPSConnection(host, int(port) if port else 443, timeout=10, context=ctx)
+    else:
+        conn = http.client.HTTPConnection(host, int(port) if port else 80, timeout=10)
+
+    headers = {}
+    if args.user:
+        password = os.environ.get("SMARTHOME_PASSWORD") or getpass.getpass("Password of %s: " % args.user)
+        conn.request("POST", "/api/auth/login", json.dumps({"user": args.user, "password": password}),
+                     {"Content-Type": "application/json"})
+        resp = conn.getresponse()
+        body = resp.read()
+        if resp.status != 200:
+            sys.exit("login: %d %s" % (resp.status, body.decode(errors="replace")))
+        headers["Authorization"] = "Bearer " + json.loads(body)["token"]
+    return conn, headers
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    for name in ("get", "put"):
+        p = sub.add_parser(name)
+        p.add_argument("target", help="host[:port]")
+        p.add_argument("--https", action="store_true")
+        p.add_argument("--user", help="login first")
+    sub.choices["get"].add_argument("-o", "--output", help="save the CBOR document")
+    sub.choices["put"].add_argument("file", help=".cbor, or .json to convert")
+    sub.add_parser("show").add_argument("file")
+    args = parser.parse_args()
+
+    if args.command == "show":
+        print(json.dumps(to_json(decode(load(args.file))), indent=2))
+        return
+
+    data = load(args.file) if args.command == "put" else None
+    conn, headers = connect(args)
+    if args.command == "get":
+        conn.request("GET", "/api/config", headers=headers)
+    else:
+        headers["Content-Type"] = "application/cbor"
+        conn.request("PUT", "/api/config", data, headers)
+    resp = conn.getresponse()
+    body = resp.read()
+    if resp.status not in (200, 204):
+        sys.exit("%s: %d %s" % (args.command, resp.status, body.decode(errors="replace")))
+
+    if args.command == "get":
+        if args.output:
+            with open(args.output, "wb") as f:
+                f.write(body)
+        print(json.dumps(to_json(decode(body)), indent=2))
+    else:
+        print("provisioned, %d bytes" % len(data))
+
+
+if __name__ == "__main__":
+    main()
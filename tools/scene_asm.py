@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+"""
+Assembles a lighting program for the scene interpreter (main/scene_vm.h) and optionally uploads it.
+
+Examples:
+    scene_asm.py chase.scn                                       # -> chase.bin
+    scene_asm.py chase.scn --upload 192.168.0.50 --slot 0 --run --user admin
+    scene_asm.py --disasm chase.bin
+
+Source: one instruction per line, operands separated by spaces or commas, ';' starts a comment.
+"name:" defines a label, ".autostart" starts the program at boot. Numbers are decimal, 0x hex or
+0b binary; led1..led4, all and button name the bits, "|" combines them.
+
+    .autostart
+    start:  loop 3                  ; chase across the four LEDs, three times
+                set all, led1
+                wait 150
+                set all, led2
+                wait 150
+                set all, led3
+                wait 150
+                set all, led4
+                wait 150
+            next
+            set all, 0
+            fade all, all, 800      ; one LED after the other over 0.8 s
+    hold:   wait 20                 ; until the button is pressed
+            jifn button, hold
+            fade all, 0, 800
+            jump start
+
+Blob layout (must match main/scene_vm.h):
+    header  'S' 'C', u8 version, u8 flags
+    code    opcode byte and operands, u16 little endian, jump targets are code offsets
+"""
+
+import argparse
+import getpass
+import http.client
+import json
+import os
+import re
+import ssl
+import struct
+import sys
+
+VERSION = 1
+FLAG_AUTOSTART = 0x01
+BLOB_MAX = 256
+HEADER_SIZE = 4
+
+# name: (opcode, operand kinds), "b" is a byte, "w" a u16, "t" a jump target (u16)
+OPS = {
+    "end": (0x00, ""),
+    "set": (0x01, "bb"),
+    "toggle": (0x02, "b"),
+    "wait": (0x03, "w"),
+    "fade": (0x04, "bbw"),
+    "loop": (0x05, "b"),
+    "next": (0x06, ""),
+    "jump": (0x07, "t"),
+    "jif": (0x08, "bt"),
+    "jifn": (0x09, "bt"),
+}
+OPS_BY_CODE = {code: (name, kinds) for name, (code, kinds) in OPS.items()}
+SIZE = {"b": 1, "w": 2, "t": 2}
+
+NAMES = {"led1": 0x01, "led2": 0x02, "led3": 0x04, "led4": 0x08, "all": 0x0F, "button": 0x80}
+
+LABEL = re.compile(r"^([A-Za-z_]\w*):")
+
+
+class AsmError(Exception):
+    pass
+
+
+def value(text, limit):
+    total = 0
+    for part in text.split("|"):
+        part = part.strip().lower()
+        if part in NAMES:
+            total |= NAMES[part]
+            continue
+        try:
+            total |= int(part, 0)
+        except ValueError:
+            raise AsmError("%r is no number or name" % part)
+    if not 0 <= total <= limit:
+        raise AsmError("%s out of range 0..%d" % (text, limit))
+    return total
+
+
+def parse(source):
+    """Lines of (line number, mnemonic, operands), labels with their code offsets, flags."""
+    lines, labels, flags, offset = [], {}, 0, 0
+    for number, line in enumerate(source.splitlines(), 1):
+        line = line.split(";", 1)[0].strip()
+        while True:
+            m = LABEL.match(line)
+            if not m:
+                break
+            if m.group(1) in labels:
+                raise AsmError("line %d: label %s defined twice" % (number, m.group(1)))
+            labels[m.group(1)] = offset
+            line = line[m.end():].strip()
+        if not line:
+            continue
+        if line == ".autostart":
+            flags |= FLAG_AUTOSTART
+            continue
+        words = line.replace(",", " ").split()
+        name, operands = words[0].lower(), words[1:]
+        if name not in OPS:
+            raise AsmError("line %d: unknown instruction %s" % (number, words[0]))
+        kinds = OPS[name][1]
+        if len(operands) != len(kinds):
+            raise AsmError("line %d: %s takes %d operand(s)" % (number, name, len(kinds)))
+        lines.append((number, name, operands))
+        offset += 1 + sum(SIZE[k] for k in kinds)
+    return lines, labels, flags
+
+
+def assemble(source):
+    lines, labels, flags = parse(source)
+    code = b""
+    for number, name, operands in lines:
+        opcode, kinds = OPS[name]
+        code += bytes([opcode])
+        try:
+            for kind, operand in zip(kinds, operands):
+                if kind == "t":
+                    if operand not in labels:
+                        raise AsmError("unknown label %s" % operand)
+                    code += struct.pack("<H", labels[operand])
+                elif kind == "w":
+                    code += struct.pack("<H", value(operand, 0xFFFF))
+                else:
+                    code += bytes([value(operand, 0xFF)])
+            if name == "loop" and code[-1] == 0:
+                raise AsmError("loop count must be 1..255")
+        except AsmError as e:
+            raise AsmError("line %d: %s" % (number, e))
+
+    if not lines:
+        raise AsmError("no instructions")
+    if lines[-1][1] not in ("end", "jump"):
+        raise AsmError("line %d: the program must end with end or jump" % lines[-1][0])
+    blob = b"SC" + bytes([VERSION, flags]) + code
+    if len(blob) > BLOB_MAX:
+        raise AsmError("%d bytes, the device takes %d" % (len(blob), BLOB_MAX))
+    return blob
+
+
+def disassemble(blob):
+    if len(blob) <= HEADER_SIZE or blob[:2] != b"SC" or blob[2] != VERSION:
+        raise AsmError("no program of version %d" % VERSION)
+    out = [".autostart"] if blob[3] & FLAG_AUTOSTART else []
+    code, pc = blob[HEADER_SIZE:], 0
+    while pc < len(code):
+        if code[pc] not in OPS_BY_CODE:
+            raise AsmError("%04d: bad opcode 0x%02x" % (pc, code[pc]))
+        name, kinds = OPS_BY_CODE[code[pc]]
+        at, pc, operands = pc, pc + 1, []
+        for kind in kinds:
+            if pc + SIZE[kind] > len(code):
+                raise AsmError("%04d: %s truncated" % (at, name))
+            if kind == "b":
+                operands.append("0x%02x" % code[pc])
+            else:
+                operands.append(str(struct.unpack_from("<H", code, pc)[0]))
+            pc += SIZE[kind]
+        out.append("%04d  %-6s %s" % (at, name, ", ".join(operands)))
+    return "\n".join(out)
+
+
+def connect(target, https):
+    host, _, port = target.partition(":")
+    if https:
+        # The device certificate is self-signed (tools/gen_https_cert.sh)
+        ctx = ssl.create_default_context()
+        ctx.check_hostname = False
+        ctx.verify_mode = ssl.CERT_NONE
+        return http.client.HTTPSConnection(host, int(port) if port else 443, timeout=10, context=ctx)
+    return http.client.HTTPConnection(host, int(port) if port else 80, timeout=10)
+
+
+def request(conn, method, path, body, headers):
+    conn.request(method, path, body, headers)
+    resp = conn.getresponse()
+    data = resp.read()
+    if resp.status != 200:
+        sys.exit("%s %s: %d %s" % (method, path, resp.status, data.decode(errors="replace")))
+    return json.loads(data)
+
+
+def upload(args, blob):
+    conn = connect(args.upload, args.https)
+    headers = {}
+
+    if args.user:
+        password = os.environ.get("SMARTHOME_PASSWORD") or getpass.getpass("Password of %s: " % args.user)
+        session = request(conn, "POST", "/api/auth/login", json.dumps({"user": args.user, "password": password}),
+                          {"Content-Type": "application/json"})
+        headers["Authorization"] = "Bearer " + session["token"]
+
+    scene = request(conn, "PUT", "/api/scenes/%d" % args.slot, blob,
+                    dict(headers, **{"Content-Type": "application/octet-stream"}))
+    print("slot %d: %d bytes stored%s" % (scene["slot"], scene["size"], ", autostart" if scene["autostart"] else ""))
+    if args.run:
+        scene = request(conn, "POST", "/api/scenes/%d/run" % args.slot, None, headers)
+        print("slot %d: %s" % (scene["slot"], scene["state"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", nargs="?", help="program source (.scn)")
+    parser.add_argument("-o", "--output", help="blob file, the source name with .bin by default")
+    parser.add_argument("--disasm", metavar="BLOB", help="list the instructions of a blob instead")
+    parser.add_argument("--upload", metavar="HOST[:PORT]", help="PUT the blob to /api/scenes/<slot>")
+    parser.add_argument("--slot", type=int, default=0, choices=range(4))
+    parser.add_argument("--run", action="store_true", help="start the program after the upload")
+    parser.add_argument("--https", action="store_true", help="upload over HTTPS")
+    parser.add_argument("--user", help="login before the upload (password from SMARTHOME_PASSWORD or a prompt)")
+    args = parser.parse_args()
+
+    try:
+        if args.disasm:
+            with open(args.disasm, "rb") as f:
+                print(disassemble(f.read()))
+            return
+        if not args.source:
+            parser.error("a source file or --disasm is needed")
+        with open(args.source) as f:
+            blob = assemble(f.read())
+    except AsmError as e:
+        sys.exit("%s: %s" % (args.disasm or args.source, e))
+
+    output = args.output or os.path.splitext(args.source)[0] + ".bin"
+    with open(output, "wb") as f:
+        f.write(blob)
+    print("wrote %s, %d bytes" % (output, len(blob)))
+
+    if args.upload:
+        upload(args, blob)
+
+
+if __name__ == "__main__":
+    main()
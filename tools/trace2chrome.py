@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+"""
+Converts an event trace dump of the device (GET /api/trace, main/trace.h) to Chrome trace
+JSON, open it in https://ui.perfetto.dev or chrome://tracing.
+
+Examples:
+    trace2chrome.py --fetch 192.168.0.50 --user admin      # -> trace.json
+    trace2chrome.py --fetch 192.168.0.50 --raw dump.bin    # keep the dump as well
+    trace2chrome.py dump.bin -o slow_toggle.json
+
+The device fetch dumps and clears the trace: reproduce the slow command, then fetch.
+Every task is a thread of the "device" process with its scopes (requests, handlers, queue
+hops, LED writes, log lines) and instant events. With CONFIG_TRACE_CONTEXT_SWITCHES the
+"cores" process shows which task ran on which core.
+
+Dump layout (must match main/trace.h), little endian:
+    header  u32 magic "TRC1", u16 version, u16 event_size, u16 cores, u16 names, u16 tasks,
+            u16 reserved, u32 events, u32 lost, u64 now_us
+    names   char[16] per event id
+    tasks   u32 handle, char[16] name
+    events  u32 time_us, u32 task, u32 arg, u16 id, u8 phase, u8 core; core by core, oldest first
+"""
+
+import argparse
+import getpass
+import http.client
+import json
+import os
+import ssl
+import struct
+import sys
+
+MAGIC = 0x31435254
+VERSION = 1
+HEADER = struct.Struct("<IHHHHHHIIQ")
+NAME_SIZE = 16
+TASK = struct.Struct("<I%ds" % NAME_SIZE)
+EVENT = struct.Struct("<IIIHBB")
+
+PHASE_BEGIN, PHASE_END, PHASE_INSTANT = 0, 1, 2
+EV_TASK_SWITCH = 0
+
+PID_DEVICE, PID_CORES = 1, 2
+
+
+class DumpError(Exception):
+    pass
+
+
+def cstr(raw):
+    return raw.split(b"\0", 1)[0].decode(errors="replace")
+
+
+def parse(data):
+    """Header fields, event names, task names by handle and events with 64-bit times."""
+    if len(data) < HEADER.size:
+        raise DumpError("%d bytes, no dump" % len(data))
+    magic, version, event_size, cores, names, tasks, _, count, lost, now_us = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or event_size != EVENT.size:
+        raise DumpError("no trace dump of version %d" % VERSION)
+    size = HEADER.size + names * NAME_SIZE + tasks * TASK.size + count * EVENT.size
+    if len(data) < size:
+        raise DumpError("truncated, %d of %d bytes" % (len(data), size))
+
+    pos = HEADER.size
+    event_names = [cstr(data[pos + i * NAME_SIZE:pos + (i + 1) * NAME_SIZE]) for i in range(names)]
+    pos += names * NAME_SIZE
+    task_names = {}
+    for i in range(tasks):
+        handle, name = TASK.unpack_from(data, pos + i * TASK.size)
+        task_names[handle] = cstr(name)
+    pos += tasks * TASK.size
+
+    events = []
+    for i in range(count):
+        time_us, task, arg, ev_id, phase, core = EVENT.unpack_from(data, pos + i * EVENT.size)
+        events.append({"time": time_us, "task": task, "arg": arg, "id": ev_id, "phase": phase, "core": core})
+
+    # 32-bit times wrap every 71 minutes: unwrap each core backwards from the time of the dump
+    for core in range(cores):
+        later_full, later_low = now_us, now_us & 0xFFFFFFFF
+        for ev in reversed([e for e in events if e["core"] == core]):
+            ev["time"] = later_full - ((later_low - ev["time"]) & 0xFFFFFFFF)
+            later_full, later_low = ev["time"], ev["time"] & 0xFFFFFFFF
+
+    events.sort(key=lambda e: e["time"])
+    return {"cores": cores, "lost": lost, "now_us": now_us}, event_names, task_names, events
+
+
+def to_chrome(header, event_names, task_names, events):
+    out = []
+    start = events[0]["time"] if events else header["now_us"]
+
+    def name_of(ev_id):
+        return event_names[ev_id] if ev_id < len(event_names) else "event_%d" % ev_id
+
+    def task_name(handle):
+        return task_names.get(handle, "0x%08x" % handle)
+
+    out.append({"ph": "M", "pid": PID_DEVICE, "name": "process_name", "args": {"name": "device"}})
+    out.append({"ph": "M", "pid": PID_CORES, "name": "process_name", "args": {"name": "cores"}})
+    for core in range(header["cores"]):
+        out.append({"ph": "M", "pid": PID_CORES, "tid": core, "name": "thread_name", "args": {"name": "core %d" % core}})
+    for handle in sorted({e["task"] for e in events if e["id"] != EV_TASK_SWITCH} | set(task_names)):
+        out.append({"ph": "M", "pid": PID_DEVICE, "tid": handle, "name": "thread_name", "args": {"name": task_name(handle)}})
+
+    # Scopes begun before the previous dump end in this one, their ends are dropped
+    open_scopes = {}
+    running = {}
+    for e in events:
+        ts = e["time"] - start
+        if e["id"] == EV_TASK_SWITCH:
+            prev = running.get(e["core"])
+            if prev is not None:
+                out.append({"ph": "X", "pid": PID_CORES, "tid": e["core"], "name": task_name(prev[0]),
+                            "ts": prev[1], "dur": ts - prev[1]})
+            running[e["core"]] = (e["arg"], ts)
+            continue
+
+        base = {"pid": PID_DEVICE, "tid": e["task"], "name": name_of(e["id"]), "ts": ts,
+                "args": {"arg": e["arg"], "core": e["core"]}}
+        key = (e["task"], e["id"])
+        if e["phase"] == PHASE_BEGIN:
+            open_scopes[key] = open_scopes.get(key, 0) + 1
+            out.append(dict(base, ph="B"))
+        elif e["phase"] == PHASE_END:
+            if open_scopes.get(key, 0) == 0:
+                continue
+            open_scopes[key] -= 1
+            out.append(dict(base, ph="E"))
+        else:
+            out.append(dict(base, ph="i", s="t"))
+
+    end = (events[-1]["time"] - start) if events else 0
+    for core, (handle, ts) in running.items():
+        out.append({"ph": "X", "pid": PID_CORES, "tid": core, "name": task_name(handle), "ts": ts, "dur": end - ts})
+
+    return {"traceEvents": out, "displayTimeUnit": "ms",
+            "otherData": {"lost_events": header["lost"], "dump_time_us": header["now_us"]}}
+
+
+def connect(target, https):
+    host, _, port = target.partition(":")
+    if https:
+        # The device certificate is self-signed (tools/gen_https_cert.sh)
+        ctx = ssl.create_default_context()
+        ctx.check_hostname = False
+        ctx.verify_mode = ssl.CERT_NONE
+        return http.client.HTTPSConnection(host, int(port) if port else 443, timeout=10, context=ctx)
+    return http.client.HTTPConnection(host, int(port) if port else 80, timeout=10)
+
+
+def request(conn, method, path, body, headers):
+    conn.request(method, path, body, headers)
+    resp = conn.getresponse()
+    data = resp.read()
+    if resp.status != 200:
+        sys.exit("%s %s: %d %s" % (method, path, resp.status, data.decode(errors="replace")))
+    return data
+
+
+def fetch(args):
+    conn = connect(args.fetch, args.https)
+    headers = {}
+
+    if args.user:
+        password = os.environ.get("SMARTHOME_PASSWORD") or getpass.getpass("Password of %s: " % args.user)
+        session = json.loads(request(conn, "POST", "/api/auth/login",
+                                     json.dumps({"user": args.user, "password": password}),
+                                     {"Content-Type": "application/json"}))
+        headers["Authorization"] = "Bearer " + session["token"]
+
+    return request(conn, "GET", "/api/trace", None, headers)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", nargs="?", help="dump file saved from GET /api/trace")
+    parser.add_argument("-o", "--output", default="trace.json", help="Chrome trace JSON, trace.json by default")
+    parser.add_argument("--fetch", metavar="HOST[:PORT]", help="dump the trace of the device instead")
+    parser.add_argument("--raw", metavar="FILE", help="also save the fetched dump")
+    parser.add_argument("--https", action="store_true", help="fetch over HTTPS")
+    parser.add_argument("--user", help="login before the fetch (password from SMARTHOME_PASSWORD or a prompt)")
+    args = parser.parse_args()
+
+    if args.fetch:
+        data = fetch(args)
+        if args.raw:
+            with open(args.raw, "wb") as f:
+                f.write(data)
+    elif args.dump:
+        with open(args.dump, "rb") as f:
+            data = f.read()
+    else:
+        parser.error("a dump file or --fetch is needed")
+
+    try:
+        header, event_names, task_names, events = parse(data)
+    except DumpError as e:
+        sys.exit("%s: %s" % (args.dump or args.fetch, e))
+
+    with open(args.output, "w") as f:
+        json.dump(to_chrome(header, event_names, task_names, events), f)
+
+    span_ms = (events[-1]["time"] - events[0]["time"]) / 1000.0 if events else 0
+    print("wrote %s, %d events over %.1f ms, %d tasks%s" % (args.output, len(events), span_ms, len(task_names),
+                                                            ", %d lost" % header["lost"] if header["lost"] else ""))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+UDP control protocol client and round-trip benchmark (see main/udp_ctrl.h).
+
+Examples:
+    udp_ctrl_bench.py 192.168.0.50 toggle --mask 0x1
+    udp_ctrl_bench.py 239.255.42.99 write --mask 0xf --value 0x0
+    udp_ctrl_bench.py 192.168.0.50 bench -n 500
+
+bench toggles LED1 n times over UDP and n times over HTTP
+(POST /api/leds/1/toggle) and prints p50/p99 round-trip times.
+"""
+
+import argparse
+import http.client
+import random
+import socket
+import struct
+import time
+
+MAGIC = 0x4355
+VERSION = 1
+ACK_FLAG = 0x80
+FRAME = struct.Struct("<HBBIBBH")
+CMDS = {"get": 0, "set": 1, "clear": 2, "toggle": 3, "write": 4}
+STATUS = {0: "ok", 1: "bad version", 2: "bad command", 3: "busy", 4: "locked (API login set)"}
+
+
+class UdpCtrl:
+    def __init__(self, host, port, timeout, retries):
+        self.addr = (host, port)
+        self.timeout = timeout
+        self.retries = retries
+        self.seq = random.getrandbits(32)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 1)
+
+    def request(self, cmd, mask=0, value=0, collect=False):
+        """Sends one command, re-sending the same seq until acked.
+        With collect, waits the whole timeout and returns every ack (multicast)."""
+        self.seq = (self.seq + 1) & 0xFFFFFFFF
+        frame = FRAME.pack(MAGIC, VERSION, cmd, self.seq, mask, value, 0)
+        acks = {}
+
+        for _ in range(self.retries + 1):
+            self.sock.sendto(frame, self.addr)
+            deadline = time.monotonic() + self.timeout
+            while True:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    break
+                self.sock.settimeout(remaining)
+                try:
+                    data, src = self.sock.recvfrom(64)
+                except socket.timeout:
+                    break
+                if len(data) != FRAME.size:
+                    continue
+                magic, _, ack_cmd, seq, state, status, _ = FRAME.unpack(data)
+                if magic != MAGIC or seq != self.seq or ack_cmd != (cmd | ACK_FLAG):
+                    continue
+                acks[src[0]] = (state, status)
+                if not collect:
+                    return acks
+            if acks:
+                return acks
+
+        raise TimeoutError("no ack for seq %d" % self.seq)
+
+
+def percentile(samples, p):
+    samples = sorted(samples)
+    return samples[min(len(samples) - 1, int(round(p / 100.0 * (len(samples) - 1))))]
+
+
+def report(name, samples):
+    print("%-5s n=%-5d p50=%7.2f ms  p99=%7.2f ms  max=%7.2f ms" % (
+        name, len(samples), percentile(samples, 50), percentile(samples, 99), max(samples)))
+
+
+def bench(args):
+    ctrl = UdpCtrl(args.host, args.port, args.timeout, args.retries)
+    udp = []
+    for _ in range(args.n):
+        t = time.perf_counter()
+        ctrl.request(CMDS["toggle"], 0x1)
+        udp.append((time.perf_counter() - t) * 1000.0)
+
+    conn = http.client.HTTPConnection(args.host, args.http_port, timeout=5)
+    web = []
+    for _ in range(args.n):
+        t = time.perf_counter()
+        conn.request("POST", "/api/leds/1/toggle", body="{}", headers={"Content-Type": "application/json"})
+        conn.getresponse().read()
+        web.append((time.perf_counter() - t) * 1000.0)
+    conn.close()
+
+    report("udp", udp)
+    report("http", web)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", help="device IP or the multicast group")
+    parser.add_argument("command", choices=list(CMDS) + ["bench"])
+    parser.add_argument("--port", type=int, default=4210)
+    parser.add_argument("--http-port", type=int, default=80)
+    parser.add_argument("--mask", type=lambda v: int(v, 0), default=0x1)
+    parser.add_argument("--value", type=lambda v: int(v, 0), default=0)
+    parser.add_argument("--timeout", type=float, default=0.2, help="seconds per attempt")
+    parser.add_argument("--retries", type=int, default=3)
+    parser.add_argument("-n", type=int, default=200, help="bench iterations per transport")
+    args = parser.parse_args()
+
+    if args.command == "bench":
+        bench(args)
+        return
+
+    ctrl = UdpCtrl(args.host, args.port, args.timeout, args.retries)
+    multicast = socket.inet_aton(args.host)[0] & 0xF0 == 0xE0
+    acks = ctrl.request(CMDS[args.command], args.mask, args.value, collect=multicast)
+    for ip, (state, status) in sorted(acks.items()):
+        print("%-15s state=0x%02x %s" % (ip, state, STATUS.get(status, status)))
+
+
+if __name__ == "__main__":
+    main()